@@ -1,6 +1,8 @@
 #ifndef APPLICATION_H
 #define APPLICATION_H
 
+#include <string>
+
 namespace mnemosy {
 	class MnemosyEngine;
 }
@@ -24,10 +26,14 @@ namespace mnemosy
 		static Application& GetInstance();
 		~Application() = default;
 
-		void Initialize();
+		void Initialize(const bool hiddenWindow = false);
 		void Run();
 		void Shutdown();
 
+		// Command line mode: renders new thumbnails for a library collection or a folder within it, e.g. "Materials/Metals".
+		// Returns the exit code of the app.
+		int RegenerateThumbnails(const std::string& collectionName, const std::string& folderPath);
+
 		gui::GuiPanelManager& GetGuiPanelManager() { return *m_pGuiPanelManager; }
 
 	private:
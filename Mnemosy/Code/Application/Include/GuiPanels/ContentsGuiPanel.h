@@ -11,6 +11,7 @@
 
 namespace mnemosy::systems {
 	class MaterialLibraryRegistry;
+	class ThumbnailManager;
 	enum LibEntryType;
 	struct LibEntry;
 	struct FolderNode;
@@ -48,6 +49,11 @@ namespace mnemosy::gui {
 		void DrawMaterialButtons();
 		void DrawMaterialButtonsOfSearch();
 
+		void DrawFolderButton(systems::FolderNode* folder);
+		void DrawLibEntryButton(systems::LibEntry* libEntry);
+		void DrawSearchResultButton(systems::LibEntry* libEntry);
+		int GridColumnsCount();
+
 
 
 		void ShortenNameStringToFitButtonSize(std::string& str, float currentImageButtonSize);
@@ -65,13 +71,14 @@ namespace mnemosy::gui {
 
 
 		systems::MaterialLibraryRegistry& m_materialRegistry;
+		systems::ThumbnailManager& m_thumbnailManager;
 		std::string m_rename_input_text;
 		
 		float m_imgButtonSize = 128.0f;
 
 		ImVec2 m_image_button_size = ImVec2(128.0f, 128.0f);
 
-		uint16_t m_currentFolder_id = 0;
+		uint32_t m_currentFolder_id = 0;
 
 		ImGuiInputTextFlags m_textInputFlags = ImGuiInputTextFlags_AutoSelectAll | ImGuiInputTextFlags_EnterReturnsTrue;
 
@@ -77,7 +77,7 @@ namespace mnemosy::gui
 
 		int m_onFileDropInput_callback_id = -1;
 
-		int m_lastActiveLibEntry_ID = -1;
+		uint32_t m_lastActiveLibEntry_ID = 0;
 		
 		bool m_isPanelHovered = false;
 		bool m_isAbedoButtonHovered = false;
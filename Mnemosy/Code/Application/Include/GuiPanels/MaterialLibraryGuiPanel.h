@@ -51,6 +51,12 @@ namespace mnemosy::gui
 		void PopupModal_Folder_DeleteHierarchy_Open(systems::FolderNode* folder);
 		void PopupModal_Folder_DeleteHierarchy();
 
+		void PopupModal_Folder_RegenerateThumbnails_Open(systems::FolderNode* folder);
+		void PopupModal_Folder_RegenerateThumbnails();
+
+		void PopupModal_Folder_RecompressTextures_Open(systems::FolderNode* folder);
+		void PopupModal_Folder_RecompressTextures();
+
 
 
 
@@ -67,7 +73,7 @@ namespace mnemosy::gui
 
 
 		//systems::FolderNode* m_selectedNode = nullptr;
-		const char* m_rightClickFolderOptions[7] = {"Add Subfolder", "Add PBR Material", "Add Unlit Texture", "Add Skybox" , "Delete", "Delete Hierarchy", "Open System Folder"};
+		const char* m_rightClickFolderOptions[9] = {"Add Subfolder", "Add PBR Material", "Add Unlit Texture", "Add Skybox" , "Delete", "Delete Hierarchy", "Open System Folder", "Regenerate Thumbnails", "Recompress Textures"};
 		const char* m_rightClickMaterialOptions[3] = { "Load", "Delete Selection", "Open System Folder" };
 		
 		ImGuiInputTextFlags m_textInputFlags = ImGuiInputTextFlags_AutoSelectAll | ImGuiInputTextFlags_EnterReturnsTrue;
@@ -76,10 +82,12 @@ namespace mnemosy::gui
 		std::string m_searchInput = "";
 		std::string m_renameLibCollectionText = "";
 
-		unsigned int m_folderIdToOpenNextFrame = 0;
+		uint32_t m_folderIdToOpenNextFrame = 0;
 		bool m_setFolderOpenNextFrame = false;
 
 		bool m_popupModal_folder_deleteHierarchy_triggered = false;
+		bool m_popupModal_folder_regenerateThumbnails_triggered = false;
+		bool m_popupModal_folder_recompressTextures_triggered = false;
 
 
 		bool m_matDragDropBegin = false;
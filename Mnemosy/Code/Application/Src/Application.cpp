@@ -5,6 +5,8 @@
 
 #include "Include/Core/Log.h"
 #include "Include/Core/Clock.h"
+#include "Include/Systems/MaterialLibraryRegistry.h"
+#include "Include/Systems/FolderTreeNode.h"
 
 #include "Include/Input/CameraInputController.h"
 #include "Include/GuiPanels/GuiPanelManager.h"
@@ -31,10 +33,10 @@ namespace mnemosy {
 		return *m_sInstance;
 	}
 
-	void Application::Initialize()	{
+	void Application::Initialize(const bool hiddenWindow)	{
 
 		std::string windowTitle = "Mnemosy v" + std::to_string(MNEMOSY_VERSION_MAJOR) + "." + std::to_string(MNEMOSY_VERSION_MINOR) + "-" + MNEMOSY_VERSION_SUFFIX;
-		m_mnemosyEngine.Initialize(windowTitle.c_str());
+		m_mnemosyEngine.Initialize(windowTitle.c_str(), hiddenWindow);
 
 
 		m_pCameraController = arena_placement_new(input::CameraInputController);
@@ -54,6 +56,81 @@ namespace mnemosy {
 		m_mnemosyEngine.Run();
 	}
 
+	int Application::RegenerateThumbnails(const std::string& collectionName, const std::string& folderPath) {
+
+		systems::MaterialLibraryRegistry& registry = m_mnemosyEngine.GetMaterialLibraryRegistry();
+
+		const std::vector<systems::LibCollection>& collections = registry.LibCollections_GetListVector();
+
+		unsigned int collectionIndex = (unsigned int)collections.size();
+		for (unsigned int i = 0; i < collections.size(); i++) {
+			if (collections[i].name == collectionName) {
+				collectionIndex = i;
+				break;
+			}
+		}
+
+		if (collectionIndex == collections.size()) {
+			MNEMOSY_ERROR("Regenerate thumbnails: There is no library collection named {}", collectionName);
+			return 1;
+		}
+
+		// the app opens with whatever collection was active last, so switch back afterwards
+		bool wasActive = registry.LibCollections_IsAnyActive();
+		unsigned int previousIndex = registry.LibCollections_GetCurrentSelectedID();
+
+		if (!wasActive || previousIndex != collectionIndex) {
+			registry.LibCollections_SwitchActiveCollection(collectionIndex);
+		}
+
+		if (!registry.LibCollections_IsAnyActive() || registry.LibCollections_GetCurrentSelectedID() != collectionIndex) {
+			MNEMOSY_ERROR("Regenerate thumbnails: Failed to load library collection {}", collectionName);
+			return 1;
+		}
+
+		// walk down the folder path from the root
+		systems::FolderNode* node = registry.GetRootFolder();
+
+		size_t start = 0;
+		while (node && start < folderPath.size()) {
+
+			size_t end = folderPath.find('/', start);
+			if (end == std::string::npos)
+				end = folderPath.size();
+
+			std::string folderName = folderPath.substr(start, end - start);
+			start = end + 1;
+
+			if (folderName.empty())
+				continue;
+
+			systems::FolderNode* subNode = nullptr;
+			for (systems::FolderNode* child : node->subNodes) {
+				if (child->name == folderName) {
+					subNode = child;
+					break;
+				}
+			}
+			node = subNode;
+		}
+
+		int exitCode = 0;
+
+		if (node == nullptr) {
+			MNEMOSY_ERROR("Regenerate thumbnails: There is no folder {} in library collection {}", folderPath, collectionName);
+			exitCode = 1;
+		}
+		else if (!m_mnemosyEngine.RunThumbnailRegeneration(node)) {
+			exitCode = 1;
+		}
+
+		if (wasActive && previousIndex != collectionIndex) {
+			registry.LibCollections_SwitchActiveCollection(previousIndex);
+		}
+
+		return exitCode;
+	}
+
 	void Application::Shutdown() {
 		
 		m_pGuiPanelManager->Shutdown();
@@ -10,6 +10,7 @@
 #include "Include/Core/Log.h"
 #include "Include/Core/FileDirectories.h"
 #include "Include/Systems/MaterialLibraryRegistry.h"
+#include "Include/Systems/ThumbnailManager.h"
 #include "Include/Systems/FolderTreeNode.h"
 #include "Include/Core/Utils/StringUtils.h"
 #include "Include/Graphics/Texture.h"
@@ -29,6 +30,7 @@ namespace mnemosy::gui {
 
 	ContentsGuiPanel::ContentsGuiPanel()
 		: m_materialRegistry{ MnemosyEngine::GetInstance().GetMaterialLibraryRegistry() }
+		, m_thumbnailManager{ MnemosyEngine::GetInstance().GetThumbnailManager() }
 	{
 		panelName = "Contents";
 		panelType = MNSY_GUI_PANEL_CONTENTS;
@@ -172,10 +174,6 @@ namespace mnemosy::gui {
 		ImGui::Spacing();
 
 
-		ImGuiStyle& style = ImGui::GetStyle();
-		float window_visible_x2 = ImGui::GetWindowPos().x + ImGui::GetWindowContentRegionMax().x;
-
-
 		// ===========================================================================================
 		// =========================== GLOBAL RIGHT CLICK MENU =======================================
 		// ===========================================================================================
@@ -230,387 +228,417 @@ namespace mnemosy::gui {
 
 
 		// ===========================================================================================
-		// =========================== DRAW FOLDERS ==================================================
+		// =========================== DRAW FOLDERS AND MATERIAL ENTRIES ============================
 		// ===========================================================================================
-		
-		unsigned int folderCount = selectedNode->subNodes.size();
-		unsigned int matEntriesCount = selectedNode->subEntries.size();
-		unsigned int buttonsCount = folderCount + matEntriesCount;
 
-		if (folderCount > 0) {
+		// Folders come first, then the entries. Only rows that are on screen are laid out,
+		// so folders with many thousand entries cost no more per frame than small ones.
 
-			for (unsigned int i = 0; i < selectedNode->subNodes.size(); i++) {
-			
-				systems::FolderNode* curr_folder = selectedNode->subNodes[i];
+		unsigned int buttonsCount = selectedNode->subNodes.size() + selectedNode->subEntries.size();
+		int columnsCount = GridColumnsCount();
+		int rowsCount = (buttonsCount + columnsCount - 1) / columnsCount;
 
-				ImGui::BeginGroup();
-				{
+		ImGuiListClipper clipper;
+		clipper.Begin(rowsCount);
 
-					std::string& folderName = curr_folder->name;
+		while (clipper.Step()) {
 
-					uint64_t textureId = 0;
-					if (m_folder_icon_tex) {
-						textureId = (uint64_t)m_folder_icon_tex->GetID();
-					}
-					
-					ImGui::PushID(folderName.c_str()); // we need this bc imageButton uses texture id as the id of the widgit which for folders will be the same..
-					
-					bool pressed = ImGui::ImageButton((void*)textureId, m_image_button_size, ImVec2(0, 1), ImVec2(1, 0),-1,ImVec4(0.1f, 0.1f, 0.1f, 1.0f), ImVec4(0.8f, 0.8f, 0.8f, 1.0f));
+			for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
 
+				for (int column = 0; column < columnsCount; column++) {
 
-					if (pressed) {					
-						m_materialRegistry.OpenFolderNode(curr_folder);
-					}
+					// buttons can move or rename folders and entries, so sizes are checked again for every button
+					unsigned int i = row * columnsCount + column;
+					unsigned int folderCount = selectedNode->subNodes.size();
 
+					if (i >= folderCount + selectedNode->subEntries.size())
+						break;
 
-					// ==================================================
-					// ========== FOLDER DRAG DROP TARGET ===============
-					// ==================================================
+					if (column > 0) {
+						ImGui::SameLine();
+					}
 
-					if (ImGui::BeginDragDropTarget()) {
+					if (i < folderCount) {
+						DrawFolderButton(selectedNode->subNodes[i]);
+					}
+					else {
+						DrawLibEntryButton(selectedNode->subEntries[i - folderCount]);
+					}
+				}
+			}
+		}
 
+		clipper.End();
+		
 
-						// == lib entry target
-						if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("Payload_SingleLibEntry")) {
+		// ===========================================================================================
+		// =========================== DRAG SELCTION (feature for the future) ========================
+		// ===========================================================================================
 
-							LibEntry_Payload* entry_Payload = static_cast<LibEntry_Payload*>(payload->Data);
 
-							systems::LibEntry* libEntry_payload = entry_Payload->libEntry;
+		//ImDrawList* draw_list =  ImGui::GetWindowDrawList();
+		//ImU32 col32 = ImColor(ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
 
+		//draw_list->AddRectFilled(ImVec2(50,50), ImVec2(100, 100),col32,0.0f );
 
-							if (libEntry_payload) {
+		//ImVec2 panelPos = ImGui::GetCursorScreenPos();
 
-								m_materialRegistry.LibEntry_Move(libEntry_payload->parent,curr_folder ,libEntry_payload);
-							}
-						}
-						
-						// == Folder target
+		//ImVec2 mouse = ImGui::GetMousePos();
 
-						if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("Payload_SingleFolder")) {
+		//ImGui::SetNextItemAllowOverlap();
+		//ImGui::GetWindowDrawList()->AddRectFilled(mouse, ImVec2(mouse.x + 50, mouse.y + 50), IM_COL32_WHITE);
 
-							gui::Folder_Payload* folder_payload = static_cast<gui::Folder_Payload*>(payload->Data);
 
-							systems::FolderNode* folderNode_payload = folder_payload->folderNode;
+	}
 
-							if (folderNode_payload) {
+	void ContentsGuiPanel::DrawMaterialButtonsOfSearch() {
 
+		namespace fs = std::filesystem;
 
-								m_materialRegistry.MoveFolder(folderNode_payload,curr_folder);
-							}
-						}
+		ImGui::Text("Search Results:");
+		ImGui::SameLine();
+		if(ImGui::SliderFloat("Icon Size", &m_imgButtonSize, 32.0f, 350.0f, "%.0f"))
+		{
+			m_image_button_size.x = m_imgButtonSize;
+			m_image_button_size.y = m_imgButtonSize;
+		}
 
-						ImGui::EndDragDropTarget();
-					}
+		ImGui::Spacing();
+		ImGui::Separator();
+		ImGui::Spacing();
 
-					// ==================================================
-					// ========== FOLDER DRAG DROP SOURCE ===============
-					// ==================================================
 
-					if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
+		std::vector<systems::LibEntry*>& searchResultsList = m_materialRegistry.GetSearchResultsList();
 
-						m_payload_folder_ptr->folderNode = curr_folder;
+		if (!searchResultsList.empty()) {
 
-						ImGui::SetDragDropPayload("Payload_SingleFolder", static_cast<void*>(m_payload_folder_ptr), sizeof(gui::Folder_Payload));
 
-						ImGui::EndDragDropSource();
-					}
+			int columnsCount = GridColumnsCount();
+			int rowsCount = ((int)searchResultsList.size() + columnsCount - 1) / columnsCount;
 
-					// ==================================================
-					// ========= RIGHT CLICK OPTIONS FODLER =============
-					// ==================================================
+			ImGuiListClipper clipper;
+			clipper.Begin(rowsCount);
 
-					if (ImGui::BeginPopupContextItem("FolderPopContext")) {
+			while (clipper.Step()) {
 
-						m_rename_input_text = folderName;
+				for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
 
-						ImGui::Text("Rename: ");
-						ImGui::SameLine();
+					for (int column = 0; column < columnsCount; column++) {
 
-						bool renamed = ImGui::InputText("##RenameFolderInput", &m_rename_input_text, m_textInputFlags);
-						if (renamed) {							
-							gui::GuiProcedures::folder_rename(curr_folder,m_rename_input_text);
-						}
-						
-						if (ImGui::Selectable("Delete##F")) {
+						unsigned int i = row * columnsCount + column;
+						if (i >= searchResultsList.size())
+							break;
 
-							Folder_DeleteButKeepChildren_Next_Frame(curr_folder, false);
+						if (column > 0) {
+							ImGui::SameLine();
 						}
 
-						if (ImGui::Selectable("Delete Hierachy##F")) {
-
-							PopupModal_Folder_DeleteHierachy_Open(curr_folder);				
-						}
+						DrawSearchResultButton(searchResultsList[i]);
+					}
+				}
+			}
 
-						if (ImGui::Selectable("Open System Folder##F")) {
+			clipper.End();
+		}
 
-							mnemosy::core::FileDialogs::OpenFolderAt(m_materialRegistry.Folder_GetFullPath(curr_folder));
-						}
+	}
 
-						ImGui::EndPopup();
-					}
+	void ContentsGuiPanel::DrawFolderButton(systems::FolderNode* curr_folder) {
 
-					ImGui::PopID(); // Pop Img button id
+		ImGui::BeginGroup();
+		{
 
+			const std::string& folderName = curr_folder->name;
 
-					std::string folderNameString = folderName;
-					ShortenNameStringToFitButtonSize(folderNameString, m_imgButtonSize);
+			uint64_t textureId = 0;
+			if (m_folder_icon_tex) {
+				textureId = (uint64_t)m_folder_icon_tex->GetID();
+			}
+			
+			ImGui::PushID(folderName.c_str()); // we need this bc imageButton uses texture id as the id of the widgit which for folders will be the same..
+			
+			bool pressed = ImGui::ImageButton((void*)textureId, m_image_button_size, ImVec2(0, 1), ImVec2(1, 0),-1,ImVec4(0.1f, 0.1f, 0.1f, 1.0f), ImVec4(0.8f, 0.8f, 0.8f, 1.0f));
 
-					ImGui::Text(folderNameString.c_str());
 
-				}
-				ImGui::EndGroup();
+			if (pressed) {					
+				m_materialRegistry.OpenFolderNode(curr_folder);
+			}
 
 
-				float last_button_x2 = ImGui::GetItemRectMax().x;
-				float next_button_x2 = last_button_x2 + style.ItemSpacing.x + m_image_button_size.x;
+			// ==================================================
+			// ========== FOLDER DRAG DROP TARGET ===============
+			// ==================================================
 
-				if (i + 1 < buttonsCount && next_button_x2 < window_visible_x2) {
-					ImGui::SameLine();
-				}
+			if (ImGui::BeginDragDropTarget()) {
 
-			}			
-		}
 
+				// == lib entry target
+				if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("Payload_SingleLibEntry")) {
 
-		// ===========================================================================================
-		// =========================== DRAW MATERIAL ENTRIES =========================================
-		// ===========================================================================================
-		
-		if (matEntriesCount > 0) {			
-			for (unsigned int i = 0; i < selectedNode->subEntries.size(); i++) {
+					LibEntry_Payload* entry_Payload = static_cast<LibEntry_Payload*>(payload->Data);
 
-				systems::LibEntry* curr_libEntry = selectedNode->subEntries[i];
+					systems::LibEntry* libEntry_payload = entry_Payload->libEntry;
 
-				ImGui::BeginGroup();
-				{
-					std::string& entryName = curr_libEntry->name;
 
+					if (libEntry_payload) {
 
-					// first casting to a uint64 is neccesary to get rid of waring for casting to void* in next line
-				
-					uint64_t thumb_tex_id = (uint64_t)curr_libEntry->thumbnailTexure_ID;
-					if (!curr_libEntry->thumbnailLoaded) {
-						thumb_tex_id = 0;
+						m_materialRegistry.LibEntry_Move(libEntry_payload->parent,curr_folder ,libEntry_payload);
 					}
+				}
+				
+				// == Folder target
 
-					ImGui::PushID(entryName.c_str());
+				if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("Payload_SingleFolder")) {
 
-					bool pressed = ImGui::ImageButton((void*)thumb_tex_id, m_image_button_size, ImVec2(0, 1), ImVec2(1, 0));
-					
-					if (pressed) {
+					gui::Folder_Payload* folder_payload = static_cast<gui::Folder_Payload*>(payload->Data);
 
-						// check if its already the active material
-						if (!m_materialRegistry.IsActiveEntry(curr_libEntry->runtime_ID)) {
-							m_materialRegistry.LibEntry_Load(curr_libEntry);
-						}
+					systems::FolderNode* folderNode_payload = folder_payload->folderNode;
+
+					if (folderNode_payload) {
+
+
+						m_materialRegistry.MoveFolder(folderNode_payload,curr_folder);
 					}
+				}
 
-					// ==================================================
-					// ========== DRAG DROP SOURCE ======================
-					// ==================================================
+				ImGui::EndDragDropTarget();
+			}
 
-					if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
+			// ==================================================
+			// ========== FOLDER DRAG DROP SOURCE ===============
+			// ==================================================
 
-						m_payload_libEntry_ptr->libEntry = curr_libEntry;
+			if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
 
-						ImGui::SetDragDropPayload("Payload_SingleLibEntry", static_cast<void*>(m_payload_libEntry_ptr), sizeof(LibEntry_Payload));
+				m_payload_folder_ptr->folderNode = curr_folder;
 
-						ImGui::EndDragDropSource();
-					}
+				ImGui::SetDragDropPayload("Payload_SingleFolder", static_cast<void*>(m_payload_folder_ptr), sizeof(gui::Folder_Payload));
 
+				ImGui::EndDragDropSource();
+			}
 
-					// ==================================================
-					// ========= RIGHT CLICK OPTIONS ====================
-					// ==================================================
+			// ==================================================
+			// ========= RIGHT CLICK OPTIONS FODLER =============
+			// ==================================================
 
-					if (ImGui::BeginPopupContextItem("EntryPopContext")) {
+			if (ImGui::BeginPopupContextItem("FolderPopContext")) {
 
-						m_rename_input_text = entryName;
+				m_rename_input_text = folderName;
 
-						ImGui::Text("Rename: ");
-						ImGui::SameLine();
+				ImGui::Text("Rename: ");
+				ImGui::SameLine();
 
-						bool renamed = ImGui::InputText("##RenameEntryInput", &m_rename_input_text, m_textInputFlags);
-						if (renamed) {
+				bool renamed = ImGui::InputText("##RenameFolderInput", &m_rename_input_text, m_textInputFlags);
+				if (renamed) {							
+					gui::GuiProcedures::folder_rename(curr_folder,m_rename_input_text);
+				}
+				
+				if (ImGui::Selectable("Delete##F")) {
 
-							gui::GuiProcedures::libEntry_rename(curr_libEntry,m_rename_input_text);
-						}
+					Folder_DeleteButKeepChildren_Next_Frame(curr_folder, false);
+				}
 
-						if (ImGui::Selectable("Delete Permanently##E")) {
+				if (ImGui::Selectable("Delete Hierachy##F")) {
 
-							PopupModel_LibEntry_Delete_Open(curr_libEntry);
-						}
+					PopupModal_Folder_DeleteHierachy_Open(curr_folder);				
+				}
 
+				if (ImGui::Selectable("Open System Folder##F")) {
 
-						if (ImGui::Selectable("Open System Folder##E")) {
+					mnemosy::core::FileDialogs::OpenFolderAt(m_materialRegistry.Folder_GetFullPath(curr_folder));
+				}
 
-							core::FileDialogs::OpenFolderAt(m_materialRegistry.LibEntry_GetFolderPath(curr_libEntry));
-						}
+				ImGui::EndPopup();
+			}
 
+			ImGui::PopID(); // Pop Img button id
 
-						ImGui::EndPopup();
-					}
 
+			std::string folderNameString = folderName;
+			ShortenNameStringToFitButtonSize(folderNameString, m_imgButtonSize);
 
+			ImGui::Text(folderNameString.c_str());
 
-					ImGui::PopID(); // Pop Image button ID
+		}
+		ImGui::EndGroup();
+	}
 
+	void ContentsGuiPanel::DrawLibEntryButton(systems::LibEntry* curr_libEntry) {
 
-					// == Name undeneith button
-					{
-						// Calculate size of the name and shorten it if its longer then the button size
-						std::string matNameString = entryName;
-						ShortenNameStringToFitButtonSize(matNameString,m_imgButtonSize);
+		ImGui::BeginGroup();
+		{
+			const std::string& entryName = curr_libEntry->name;
 
-						ImGui::Text(matNameString.c_str());
-					}
 
-				}
-				ImGui::EndGroup();
+			// first casting to a uint64 is neccesary to get rid of waring for casting to void* in next line
+		
+			uint64_t thumb_tex_id = (uint64_t)curr_libEntry->thumbnailTexure_ID;
+			if (!curr_libEntry->thumbnailLoaded) {
+				thumb_tex_id = 0;
+			}
 
-				float last_button_x2 = ImGui::GetItemRectMax().x;
-				float next_button_x2 = last_button_x2 + style.ItemSpacing.x + m_image_button_size.x;
-				
-				if (i + 1 < buttonsCount && next_button_x2 < window_visible_x2) {
-					ImGui::SameLine();
+			// thumbnails share atlas textures
+			ImVec2 thumb_uv0, thumb_uv1;
+			m_thumbnailManager.GetThumbnailUVs(curr_libEntry, thumb_uv0.x, thumb_uv0.y, thumb_uv1.x, thumb_uv1.y);
+
+			ImGui::PushID(entryName.c_str());
+
+			bool pressed = ImGui::ImageButton((void*)thumb_tex_id, m_image_button_size, thumb_uv0, thumb_uv1);
+
+			if (ImGui::IsItemVisible()) {
+				m_thumbnailManager.SetThumbnailVisible(curr_libEntry);
+			}
+			
+			if (pressed) {
+
+				// check if its already the active material
+				if (!m_materialRegistry.IsActiveEntry(curr_libEntry->runtime_ID)) {
+					m_materialRegistry.LibEntry_Load(curr_libEntry);
 				}
 			}
-		}
-		
 
-		// ===========================================================================================
-		// =========================== DRAG SELCTION (feature for the future) ========================
-		// ===========================================================================================
+			// ==================================================
+			// ========== DRAG DROP SOURCE ======================
+			// ==================================================
 
+			if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
 
-		//ImDrawList* draw_list =  ImGui::GetWindowDrawList();
-		//ImU32 col32 = ImColor(ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+				m_payload_libEntry_ptr->libEntry = curr_libEntry;
 
-		//draw_list->AddRectFilled(ImVec2(50,50), ImVec2(100, 100),col32,0.0f );
+				ImGui::SetDragDropPayload("Payload_SingleLibEntry", static_cast<void*>(m_payload_libEntry_ptr), sizeof(LibEntry_Payload));
 
-		//ImVec2 panelPos = ImGui::GetCursorScreenPos();
+				ImGui::EndDragDropSource();
+			}
 
-		//ImVec2 mouse = ImGui::GetMousePos();
 
-		//ImGui::SetNextItemAllowOverlap();
-		//ImGui::GetWindowDrawList()->AddRectFilled(mouse, ImVec2(mouse.x + 50, mouse.y + 50), IM_COL32_WHITE);
+			// ==================================================
+			// ========= RIGHT CLICK OPTIONS ====================
+			// ==================================================
 
+			if (ImGui::BeginPopupContextItem("EntryPopContext")) {
 
-	}
+				m_rename_input_text = entryName;
 
-	void ContentsGuiPanel::DrawMaterialButtonsOfSearch() {
+				ImGui::Text("Rename: ");
+				ImGui::SameLine();
 
-		namespace fs = std::filesystem;
+				bool renamed = ImGui::InputText("##RenameEntryInput", &m_rename_input_text, m_textInputFlags);
+				if (renamed) {
 
-		ImGui::Text("Search Results:");
-		ImGui::SameLine();
-		if(ImGui::SliderFloat("Icon Size", &m_imgButtonSize, 32.0f, 350.0f, "%.0f"))
-		{
-			m_image_button_size.x = m_imgButtonSize;
-			m_image_button_size.y = m_imgButtonSize;
-		}
+					gui::GuiProcedures::libEntry_rename(curr_libEntry,m_rename_input_text);
+				}
 
-		ImGui::Spacing();
-		ImGui::Separator();
-		ImGui::Spacing();
+				if (ImGui::Selectable("Delete Permanently##E")) {
 
+					PopupModel_LibEntry_Delete_Open(curr_libEntry);
+				}
 
-		std::vector<systems::LibEntry*>& searchResultsList = m_materialRegistry.GetSearchResultsList();
 
-		if (!searchResultsList.empty()) {
+				if (ImGui::Selectable("Open System Folder##E")) {
 
+					core::FileDialogs::OpenFolderAt(m_materialRegistry.LibEntry_GetFolderPath(curr_libEntry));
+				}
 
-			ImGuiStyle& style = ImGui::GetStyle();
-			float window_visible_x2 = ImGui::GetWindowPos().x + ImGui::GetWindowContentRegionMax().x;
 
-			unsigned int entryCount = searchResultsList.size();
+				ImGui::EndPopup();
+			}
 
-			for (unsigned int i = 0; i < entryCount; i++) {
 
 
+			ImGui::PopID(); // Pop Image button ID
 
-				ImGui::BeginGroup();
-				{
 
-					systems::LibEntry* curr_libEntry = searchResultsList[i];
+			// == Name undeneith button
+			{
+				// Calculate size of the name and shorten it if its longer then the button size
+				std::string matNameString = entryName;
+				ShortenNameStringToFitButtonSize(matNameString,m_imgButtonSize);
 
-					std::string& curr_entryName = curr_libEntry->name;
+				ImGui::Text(matNameString.c_str());
+			}
 
+		}
+		ImGui::EndGroup();
+	}
 
-					uint64_t thumb_tex_id = (uint64_t)curr_libEntry->thumbnailTexure_ID;
-					if (!curr_libEntry->thumbnailLoaded) {
-						thumb_tex_id = 0;
-					}
+	void ContentsGuiPanel::DrawSearchResultButton(systems::LibEntry* curr_libEntry) {
 
+		ImGui::BeginGroup();
+		{
+			const std::string& curr_entryName = curr_libEntry->name;
 
-					ImGui::PushID(curr_entryName.c_str());
 
-					bool pressed = ImGui::ImageButton((void*)thumb_tex_id, m_image_button_size, ImVec2(0, 1), ImVec2(1, 0));
+			uint64_t thumb_tex_id = (uint64_t)curr_libEntry->thumbnailTexure_ID;
+			if (!curr_libEntry->thumbnailLoaded) {
+				thumb_tex_id = 0;
+			}
 
-					if (pressed) {
+			ImVec2 thumb_uv0, thumb_uv1;
+			m_thumbnailManager.GetThumbnailUVs(curr_libEntry, thumb_uv0.x, thumb_uv0.y, thumb_uv1.x, thumb_uv1.y);
 
-						// check if its already the active material
-						if (!m_materialRegistry.IsActiveEntry(curr_libEntry->runtime_ID)) {
 
-							m_materialRegistry.LibEntry_Load(curr_libEntry);
-						}
-					}
+			ImGui::PushID(curr_entryName.c_str());
 
-					if (ImGui::BeginPopupContextItem("SearchContextMenu")) {
+			bool pressed = ImGui::ImageButton((void*)thumb_tex_id, m_image_button_size, thumb_uv0, thumb_uv1);
 
+			if (ImGui::IsItemVisible()) {
+				m_thumbnailManager.SetThumbnailVisible(curr_libEntry);
+			}
 
+			if (pressed) {
 
-						m_rename_input_text = curr_entryName;
+				// check if its already the active material
+				if (!m_materialRegistry.IsActiveEntry(curr_libEntry->runtime_ID)) {
 
-						ImGui::Text("Rename: ");
-						ImGui::SameLine();
+					m_materialRegistry.LibEntry_Load(curr_libEntry);
+				}
+			}
 
-						bool renamed = ImGui::InputText("##RenameEntryInputSearch", &m_rename_input_text, m_textInputFlags);
-						if (renamed) {
+			if (ImGui::BeginPopupContextItem("SearchContextMenu")) {
 
-							gui::GuiProcedures::libEntry_rename(curr_libEntry, m_rename_input_text);
-						}
 
-						// requires to update the search results list AND probably should wait until next frame as the current list is a refrence not a copy
-						//if (ImGui::Selectable("Delete Permanently##Search")) {
 
-						//	//PopupModel_LibEntry_Delete_Open(curr_libEntry);
-						//}
+				m_rename_input_text = curr_entryName;
 
-						if (ImGui::Selectable("Open System Folder##Search")) {
+				ImGui::Text("Rename: ");
+				ImGui::SameLine();
 
-							core::FileDialogs::OpenFolderAt(m_materialRegistry.LibEntry_GetFolderPath(curr_libEntry));
-						}
+				bool renamed = ImGui::InputText("##RenameEntryInputSearch", &m_rename_input_text, m_textInputFlags);
+				if (renamed) {
 
-						ImGui::EndPopup();
-					}
+					gui::GuiProcedures::libEntry_rename(curr_libEntry, m_rename_input_text);
+				}
 
+				// requires to update the search results list AND probably should wait until next frame as the current list is a refrence not a copy
+				//if (ImGui::Selectable("Delete Permanently##Search")) {
 
+				//	//PopupModel_LibEntry_Delete_Open(curr_libEntry);
+				//}
 
+				if (ImGui::Selectable("Open System Folder##Search")) {
 
+					core::FileDialogs::OpenFolderAt(m_materialRegistry.LibEntry_GetFolderPath(curr_libEntry));
+				}
 
-					ImGui::PopID(); // Pop Image Button ID
+				ImGui::EndPopup();
+			}
 
 
-					// Calculate size of the name and shorten it if its longer then the button size
-					std::string curr_entryNameCopy = curr_entryName;
-					ShortenNameStringToFitButtonSize(curr_entryNameCopy,m_imgButtonSize);
 
 
-					ImGui::Text(curr_entryNameCopy.c_str());
 
-				}
-				ImGui::EndGroup();
+			ImGui::PopID(); // Pop Image Button ID
 
-				float last_button_x2 = ImGui::GetItemRectMax().x;
-				float next_button_x2 = last_button_x2 + style.ItemSpacing.x + m_image_button_size.x;
 
-				if (i + 1 < entryCount && next_button_x2 < window_visible_x2) {
-					ImGui::SameLine();
-				}
-			}
-		}
+			// Calculate size of the name and shorten it if its longer then the button size
+			std::string curr_entryNameCopy = curr_entryName;
+			ShortenNameStringToFitButtonSize(curr_entryNameCopy,m_imgButtonSize);
+
+
+			ImGui::Text(curr_entryNameCopy.c_str());
 
+		}
+		ImGui::EndGroup();
 	}
 
 
@@ -620,6 +648,17 @@ namespace mnemosy::gui {
 	// =========================== HELPERS =======================================================
 	// ===========================================================================================
 
+	// how many buttons fit next to each other into the panel
+	int ContentsGuiPanel::GridColumnsCount() {
+
+		ImGuiStyle& style = ImGui::GetStyle();
+
+		float buttonWidth = m_image_button_size.x + style.FramePadding.x * 2.0f;
+		int columnsCount = (int)((ImGui::GetContentRegionAvail().x + style.ItemSpacing.x) / (buttonWidth + style.ItemSpacing.x));
+
+		return columnsCount > 1 ? columnsCount : 1;
+	}
+
 	void ContentsGuiPanel::ShortenNameStringToFitButtonSize(std::string& str, float currentImageButtonSize) {
 
 		if (ImGui::CalcTextSize(str.c_str()).x > (currentImageButtonSize - 5.0f)) {
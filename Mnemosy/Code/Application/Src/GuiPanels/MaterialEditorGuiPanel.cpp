@@ -76,7 +76,7 @@ namespace mnemosy::gui
 			ImGui::Text("No material selected yet");
 			ImGui::End();
 
-			m_lastActiveLibEntry_ID = -1;
+			m_lastActiveLibEntry_ID = 0;
 
 			return;
 		}
@@ -158,7 +158,7 @@ namespace mnemosy::gui
 	void MaterialEditorGuiPanel::DrawExportSettings(systems::LibEntry* activeLibEntry)
 	{
 		// Check if the active material changed			
-		int currentActiveMaterialID = activeLibEntry->runtime_ID;
+		uint32_t currentActiveMaterialID = activeLibEntry->runtime_ID;
 
 		systems::LibEntryType entryType = activeLibEntry->type;
 
@@ -308,6 +308,8 @@ namespace mnemosy::gui
 
 					if (fs::is_directory(exportPath)) {
 
+						// export needs all textures of the material uploaded at full resolution
+						m_materialRegistry.ActiveLibEntry_FinishLoading(true);
 
 						m_materialRegistry.ActiveLibEntry_SaveToFile();
 					
@@ -434,7 +436,7 @@ namespace mnemosy::gui
 
 			if (textureAssigned) {
 
-				std::string resolution = "Resolution: " + std::to_string(activeMat.GetAlbedoTexture().GetWidth()) + "x" + std::to_string(activeMat.GetAlbedoTexture().GetHeight());
+				std::string resolution = "Resolution: " + std::to_string(activeMat.GetAlbedoTexture().GetSourceWidth()) + "x" + std::to_string(activeMat.GetAlbedoTexture().GetSourceHeight());
 				ImGui::Text(resolution.c_str());
 
 
@@ -494,7 +496,7 @@ namespace mnemosy::gui
 			// Texture Info text
 			if (textureAssigned) {
 
-				std::string resolution = "Resolution: " + std::to_string(activeMat.GetRoughnessTexture().GetWidth()) + "x" + std::to_string(activeMat.GetRoughnessTexture().GetHeight());
+				std::string resolution = "Resolution: " + std::to_string(activeMat.GetRoughnessTexture().GetSourceWidth()) + "x" + std::to_string(activeMat.GetRoughnessTexture().GetSourceHeight());
 				ImGui::Text(resolution.c_str());
 			}
 
@@ -534,6 +536,8 @@ namespace mnemosy::gui
 
 					fs::path roughnessPath = materialFolderPath / fs::u8path(entry->name + texture_fileSuffix_roughness);
 
+					// the file is overwritten with the generated texture so it has to be generated from the full resolution
+					m_materialRegistry.ActiveLibEntry_FinishLoading(true);
 					MnemosyEngine::GetInstance().GetTextureGenerationManager().InvertRoughness(activeMat, roughnessPath.generic_string().c_str(), true);
 
 					// Load newly created texture as new roughness texture 
@@ -607,7 +611,7 @@ namespace mnemosy::gui
 			if (textureAssigned) {
 
 
-				std::string resolution = "Resolution: " + std::to_string(activeMat.GetNormalTexture().GetWidth()) + "x" + std::to_string(activeMat.GetNormalTexture().GetHeight());
+				std::string resolution = "Resolution: " + std::to_string(activeMat.GetNormalTexture().GetSourceWidth()) + "x" + std::to_string(activeMat.GetNormalTexture().GetSourceHeight());
 				ImGui::Text(resolution.c_str());
 
 			}
@@ -635,6 +639,8 @@ namespace mnemosy::gui
 					fs::path normalMapPath = materialFolderPath / fs::u8path(activeLibEntry->name + texture_fileSuffix_normal);
 
 					// Generate inverted normal Texture.
+					// the file is overwritten with the generated texture so it has to be generated from the full resolution
+					m_materialRegistry.ActiveLibEntry_FinishLoading(true);
 					MnemosyEngine::GetInstance().GetTextureGenerationManager().FlipNormalMap(normalMapPath.generic_string().c_str(), activeMat, true);
 
 
@@ -711,7 +717,7 @@ namespace mnemosy::gui
 			if (textureAssigned) {
 
 
-				std::string resolution = "Resolution: " + std::to_string(activeMat.GetMetallicTexture().GetWidth()) + "x" + std::to_string(activeMat.GetMetallicTexture().GetHeight());
+				std::string resolution = "Resolution: " + std::to_string(activeMat.GetMetallicTexture().GetSourceWidth()) + "x" + std::to_string(activeMat.GetMetallicTexture().GetSourceHeight());
 				ImGui::Text(resolution.c_str());
 
 			}
@@ -764,7 +770,7 @@ namespace mnemosy::gui
 			if (textureAssigned) {
 
 
-				std::string resolution = "Resolution: " + std::to_string(activeMat.GetAOTexture().GetWidth()) + "x" + std::to_string(activeMat.GetAOTexture().GetHeight());
+				std::string resolution = "Resolution: " + std::to_string(activeMat.GetAOTexture().GetSourceWidth()) + "x" + std::to_string(activeMat.GetAOTexture().GetSourceHeight());
 				ImGui::Text(resolution.c_str());
 
 			}
@@ -804,7 +810,7 @@ namespace mnemosy::gui
 
 			if (textureAssigned) {
 
-				std::string resolution = "Resolution: " + std::to_string(activeMat.GetEmissiveTexture().GetWidth()) + "x" + std::to_string(activeMat.GetEmissiveTexture().GetHeight());
+				std::string resolution = "Resolution: " + std::to_string(activeMat.GetEmissiveTexture().GetSourceWidth()) + "x" + std::to_string(activeMat.GetEmissiveTexture().GetSourceHeight());
 				ImGui::Text(resolution.c_str());
 			}
 
@@ -892,7 +898,7 @@ namespace mnemosy::gui
 			if (textureAssigned) {
 
 				// render info text
-				std::string resolution = "Resolution: " + std::to_string(activeMat.GetHeightTexture().GetWidth()) + "x" + std::to_string(activeMat.GetHeightTexture().GetHeight());
+				std::string resolution = "Resolution: " + std::to_string(activeMat.GetHeightTexture().GetSourceWidth()) + "x" + std::to_string(activeMat.GetHeightTexture().GetSourceHeight());
 				ImGui::Text(resolution.c_str());
 
 
@@ -982,7 +988,7 @@ namespace mnemosy::gui
 
 			if (textureAssigned) {
 				// render info text
-				std::string resolution = "Resolution: " + std::to_string(activeMat.GetOpacityTexture().GetWidth()) + "x" + std::to_string(activeMat.GetOpacityTexture().GetHeight());
+				std::string resolution = "Resolution: " + std::to_string(activeMat.GetOpacityTexture().GetSourceWidth()) + "x" + std::to_string(activeMat.GetOpacityTexture().GetSourceHeight());
 				ImGui::Text(resolution.c_str());
 
 
@@ -11,6 +11,7 @@
 #include "Include/Systems/MaterialLibraryRegistry.h"
 #include "Include/Systems/FolderTreeNode.h"
 #include "Include/Systems/ThumbnailManager.h"
+#include "Include/Systems/ExportManager.h"
 
 #include "Include/Graphics/Renderer.h"
 
@@ -82,7 +83,8 @@ namespace mnemosy::gui
 			ImGui::SameLine();
 
 			// === Search Bar
-			bool searchEnter = ImGui::InputText("##SearchInputField", &m_searchInput, m_textInputFlags);
+			// the search index answers fast enough to search on every key stroke
+			bool searchEnter = ImGui::InputText("##SearchInputField", &m_searchInput, ImGuiInputTextFlags_AutoSelectAll);
 			if (searchEnter) {
 
 				if (m_searchInput == "") {
@@ -93,25 +95,12 @@ namespace mnemosy::gui
 				else {
 					
 
-					bool searchResultsFound = m_materialRegistry.SearchLibEntriesForKeyword(m_searchInput);
+					m_materialRegistry.SearchLibEntriesForKeyword(m_searchInput);
 					m_materialRegistry.inSearchMode = true;
 
 
-					systems::ThumbnailManager& thumbManager = MnemosyEngine::GetInstance().GetThumbnailManager();
-
-					thumbManager.UnloadAllThumbnails();
-
-					if (searchResultsFound) {
-						
-						std::vector<systems::LibEntry*>& searchResultsList = m_materialRegistry.GetSearchResultsList();
-
-
-						for (unsigned int i = 0; i < searchResultsList.size(); i++) {
-							
-							thumbManager.AddLibEntryToActiveThumbnails(searchResultsList[i]);							
-						}						
-					}
-
+					// the results are registered with the thumbnail manager as the gui shows them
+					MnemosyEngine::GetInstance().GetThumbnailManager().UnloadAllThumbnails();
 				}
 
 			}
@@ -131,6 +120,8 @@ namespace mnemosy::gui
 
 					RecursivDrawSubfolders(m_materialRegistry.GetRootFolder());
 					PopupModal_Folder_DeleteHierarchy();
+					PopupModal_Folder_RegenerateThumbnails();
+					PopupModal_Folder_RecompressTextures();
 				}
 			}
 			else {
@@ -291,6 +282,14 @@ namespace mnemosy::gui
 						//fs::path pathToFolder = m_materialRegistry.Folder_GetFullPath(node);
 						mnemosy::core::FileDialogs::OpenFolderAt(m_materialRegistry.Folder_GetFullPath(node));
 					}
+					else if (i == 7) { // regenerate thumbnails
+
+						PopupModal_Folder_RegenerateThumbnails_Open(node);
+					}
+					else if (i == 8) { // recompress textures
+
+						PopupModal_Folder_RecompressTextures_Open(node);
+					}
 
 				}
 
@@ -310,8 +309,8 @@ namespace mnemosy::gui
 
 				if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_None)) {
 
-					unsigned int sourceNodeID = node->runtime_ID;
-					ImGui::SetDragDropPayload("DragPayload_ID", &sourceNodeID, sizeof(unsigned int));
+					uint32_t sourceNodeID = node->runtime_ID;
+					ImGui::SetDragDropPayload("DragPayload_ID", &sourceNodeID, sizeof(uint32_t));
 					ImGui::EndDragDropSource();
 				}
 			}
@@ -322,10 +321,10 @@ namespace mnemosy::gui
 					if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("DragPayload_ID")) {
 						//MNEMOSY_TRACE("Directory dragdrop target");
 
-						IM_ASSERT(payload->DataSize == sizeof(unsigned int));
-						unsigned int sourceNodeID = *(const unsigned int*)payload->Data;
+						IM_ASSERT(payload->DataSize == sizeof(uint32_t));
+						uint32_t sourceNodeID = *(const uint32_t*)payload->Data;
 					
-						systems::FolderNode* sourceNode = m_materialRegistry.GetFolderByID(m_materialRegistry.GetRootFolder(),sourceNodeID);
+						systems::FolderNode* sourceNode = m_materialRegistry.GetFolderByID(sourceNodeID);
 
 						if (sourceNode != nullptr) { // just in case. This should never happen.
 
@@ -357,7 +356,7 @@ namespace mnemosy::gui
 						MNEMOSY_ASSERT(sourceNode != nullptr, "A nullpointer folder node should never be passed into a drag and drop payload");
 
 						// need to make a copy of node.submaterials because it changed during the loop
-						std::vector<systems::LibEntry*> subMatsCopy = sourceNode->subEntries;
+						std::vector<systems::LibEntry*> subMatsCopy(sourceNode->subEntries.begin(), sourceNode->subEntries.end());
 
 						for (unsigned int b = 0; b < materialPayload.matList->materialListIndexes.size(); b++) {
 
@@ -522,7 +521,7 @@ namespace mnemosy::gui
 							else if (option == 1) { // delete
 								
 								// dude what the hell is going on here.. maybe i should just delay this to next frame..
-								std::vector<systems::LibEntry*> subMatsCopy = node->subEntries;
+								std::vector<systems::LibEntry*> subMatsCopy(node->subEntries.begin(), node->subEntries.end());
 
 								for (unsigned int a = 0; a < subMatsCopy.size(); a++) {
 
@@ -531,7 +530,7 @@ namespace mnemosy::gui
 
 										int posInList = -1;
 										// find posiiton in the original list which is changing as we delete materials
-										int runtimeID = subMatsCopy[a]->runtime_ID;
+										uint32_t runtimeID = subMatsCopy[a]->runtime_ID;
 										for (unsigned int b = 0; b < node->subEntries.size(); b++) {
 
 											if (runtimeID == node->subEntries[b]->runtime_ID) {
@@ -626,6 +625,92 @@ namespace mnemosy::gui
 
 	}
 
+	void MaterialLibraryGuiPanel::PopupModal_Folder_RegenerateThumbnails_Open(systems::FolderNode* folder) {
+
+		MnemosyEngine::GetInstance().GetThumbnailManager().GetBatchRegenerator().Start(folder);
+		m_popupModal_folder_regenerateThumbnails_triggered = true;
+	}
+
+	// The modal stays open while the batch runs so the library can not be changed underneath it.
+	void MaterialLibraryGuiPanel::PopupModal_Folder_RegenerateThumbnails() {
+
+		systems::ThumbnailBatchRegenerator& batch = MnemosyEngine::GetInstance().GetThumbnailManager().GetBatchRegenerator();
+
+		if (m_popupModal_folder_regenerateThumbnails_triggered) {
+
+			m_popupModal_folder_regenerateThumbnails_triggered = false; // to make sure its only called once
+			ImGui::OpenPopup("Regenerate Thumbnails");
+		}
+
+		if (ImGui::BeginPopupModal("Regenerate Thumbnails", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+
+			uint32_t total = batch.GetTotalCount();
+			uint32_t done = batch.GetFinishedCount() + batch.GetFailedCount();
+
+			float progress = total > 0 ? (float)done / (float)total : 1.0f;
+			std::string progressText = std::to_string(done) + " / " + std::to_string(total);
+
+			ImGui::ProgressBar(progress, ImVec2(300, 0), progressText.c_str());
+
+			if (batch.GetFailedCount() > 0) {
+				ImGui::Text("Failed: %u", batch.GetFailedCount());
+			}
+
+			if (ImGui::Button("Cancel", ImVec2(120, 0))) {
+				batch.Cancel();
+			}
+
+			if (!batch.IsRunning()) {
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::EndPopup();
+		}
+	}
+
+	void MaterialLibraryGuiPanel::PopupModal_Folder_RecompressTextures_Open(systems::FolderNode* folder) {
+
+		MnemosyEngine::GetInstance().GetExportManager().GetTiffStorageMigrator().Start(folder);
+		m_popupModal_folder_recompressTextures_triggered = true;
+	}
+
+	// Same as the thumbnail modal, textures are replaced on disk while it is open so the library must not change.
+	void MaterialLibraryGuiPanel::PopupModal_Folder_RecompressTextures() {
+
+		systems::TiffStorageMigrator& migrator = MnemosyEngine::GetInstance().GetExportManager().GetTiffStorageMigrator();
+
+		if (m_popupModal_folder_recompressTextures_triggered) {
+
+			m_popupModal_folder_recompressTextures_triggered = false; // to make sure its only called once
+			ImGui::OpenPopup("Recompress Textures");
+		}
+
+		if (ImGui::BeginPopupModal("Recompress Textures", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+
+			uint32_t total = migrator.GetTotalCount();
+			uint32_t done = migrator.GetFinishedCount() + migrator.GetFailedCount();
+
+			float progress = total > 0 ? (float)done / (float)total : 1.0f;
+			std::string progressText = std::to_string(done) + " / " + std::to_string(total);
+
+			ImGui::ProgressBar(progress, ImVec2(300, 0), progressText.c_str());
+
+			if (migrator.GetFailedCount() > 0) {
+				ImGui::Text("Failed: %u", migrator.GetFailedCount());
+			}
+
+			if (ImGui::Button("Cancel", ImVec2(120, 0))) {
+				migrator.Cancel();
+			}
+
+			if (!migrator.IsRunning()) {
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::EndPopup();
+		}
+	}
+
 	void MaterialLibraryGuiPanel::DrawLibrarySelection() {
 
 
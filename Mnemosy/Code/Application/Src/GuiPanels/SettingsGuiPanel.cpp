@@ -12,6 +12,7 @@
 #include "Include/Systems/SkyboxAssetRegistry.h"
 #include "Include/Systems/MaterialLibraryRegistry.h"
 #include "Include/Systems/FolderTreeNode.h"
+#include "Include/Systems/ExportManager.h"
 
 #include "Include/Graphics/Scene.h"
 #include "Include/Graphics/Camera.h"
@@ -245,6 +246,18 @@ namespace mnemosy::gui
 
 				}
 
+				// preview texture res
+				{
+					const char* Preview_Resolutions[4] = { "1024","2048","4096","Full"}; // they need to be ordered the same as in renderer PreviewTextureResolution Enum
+
+					int current_preview_res = (int)renderer.GetPreviewTextureResolutionEnum();
+					ImGui::Combo("Preview Texture Resolution", &current_preview_res, Preview_Resolutions, IM_ARRAYSIZE(Preview_Resolutions));
+					if (current_preview_res != (int)renderer.GetPreviewTextureResolutionEnum()) {
+						renderer.SetPreviewTextureResolution((graphics::PreviewTextureResolution)current_preview_res);
+					}
+					ImGui::SetItemTooltip("Largest texture size used for the preview. Exports always use the full resolution of the files.");
+				}
+
 
 
 			}
@@ -313,6 +326,27 @@ namespace mnemosy::gui
 
 
 
+			ImGui::TreePop();
+		}
+
+		ImGui::Separator();
+
+		// --- Storage Settings
+		if (ImGui::TreeNode("Storage"))
+		{
+			ImGui::Spacing();
+
+			systems::ExportManager& exportManager = engine.GetExportManager();
+
+			const char* TiffCompressions[4] = { "None","LZW","Deflate","Zstd" }; // they need to be ordered the same as in Picture TiffCompression Enum
+
+			int current_compression = (int)exportManager.GetTiffCompression();
+			ImGui::Combo("Tiff Compression", &current_compression, TiffCompressions, IM_ARRAYSIZE(TiffCompressions));
+			if (current_compression != (int)exportManager.GetTiffCompression()) {
+				exportManager.SetTiffCompression((graphics::TiffCompression)current_compression);
+			}
+			ImGui::SetItemTooltip("Lossless compression of library textures and exported tiff files. \nExisting textures are rewritten with 'Recompress Textures' in the folder menu of the library.");
+
 			ImGui::TreePop();
 		}
 
@@ -1,11 +1,28 @@
 #include "Include/Application.h"
 
-int main() {
+#include <string.h>
+#include <string>
+
+// mnemosy --regenerate-thumbnails "<library collection>" ["<folder/path>"]
+// renders new thumbnails without showing a window and exits
+int main(int argc, char* argv[]) {
 
 	mnemosy::Application& app = mnemosy::Application::GetInstance();
+
+	if (argc >= 3 && strcmp(argv[1], "--regenerate-thumbnails") == 0) {
+
+		std::string folderPath = argc >= 4 ? argv[3] : "";
+
+		app.Initialize(true);
+		int exitCode = app.RegenerateThumbnails(argv[2], folderPath);
+		app.Shutdown();
+
+		return exitCode;
+	}
+
 	app.Initialize();
 	app.Run();
 	app.Shutdown();
 
 	return 0;
-}
\ No newline at end of file
+}
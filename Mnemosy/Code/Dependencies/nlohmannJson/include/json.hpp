@@ -25576,18 +25576,11 @@ namespace flcrm {
                 m_jsonObject["1_Header"] = headerName;
                 m_jsonObject["2_Description"] = fileDescription;
 
-                std::ofstream outFileStream;
-                outFileStream.open(filepath);
-
-                if(m_prettyPrint){
-                    outFileStream << m_jsonObject.dump(4);
-                }else{
-                    outFileStream << m_jsonObject.dump(-1);
-                }
-
-                outFileStream.close();
-                
+                m_filepath = filepath;
                 m_fileIsOpen = true;
+                m_isDirty = true;
+
+                FileFlush(errorCheck);
                 return;
             }
 
@@ -25614,9 +25607,12 @@ namespace flcrm {
             inputFileStream.close();
 
             // header and description should always be set, if file was whiped for example they would dissapear bec its still a valid json file
-            m_jsonObject["1_Header"] = headerName;
-            m_jsonObject["2_Description"] = fileDescription;
-            
+            // a file that could not be parsed is dirty here and gets rewritten on close
+            m_isDirty = false;
+            WriteValue_Internal("1_Header", headerName);
+            WriteValue_Internal("2_Description", fileDescription);
+
+            m_filepath = filepath;
             m_fileIsOpen = true;
         }
 
@@ -25631,23 +25627,36 @@ namespace flcrm {
             }
 
 
-            std::ofstream outFileStream;
-            outFileStream.open(filepath);
-
-            if(m_prettyPrint){
-                outFileStream << m_jsonObject.dump(4);
+            // unchanged documents are never written, so only reading a file leaves it untouched on disk
+            if (m_isDirty || filepath != m_filepath) {
+                WriteFile_Internal(errorCheck, filepath);
             }
-            else{
-                outFileStream << m_jsonObject.dump(-1);
-            }
-
-            outFileStream.close();
 
             m_jsonObject.clear();
             m_jsonObject = nlohmann::json();
+            m_isDirty = false;
+            m_fileIsOpen = false;
+        }
+
+        // writes pending changes to the opened file without closing it, allows to batch many changes into one write
+        void FileFlush(bool& errorCheck){
+            errorCheck = true;
+
+            if(!m_fileIsOpen)
+            {
+                errorCheck = false;
+                m_lastErrorString = "No file has been opend yet.";
+                return;
+            }
+
+            if (m_isDirty) {
+                WriteFile_Internal(errorCheck, m_filepath);
+            }
         }
 
         bool FileIsOpen() { return m_fileIsOpen; }
+        // true if anything changed since the file was opened or last written
+        bool FileIsDirty() { return m_isDirty; }
 
         void FileWhipe(bool& errorCheck){
             errorCheck = true;
@@ -25657,6 +25666,9 @@ namespace flcrm {
                 return;
             }
 
+            if (!m_jsonObject.empty()) {
+                m_isDirty = true;
+            }
             m_jsonObject.clear();
         }
 
@@ -25677,6 +25689,8 @@ namespace flcrm {
                 m_lastErrorString = e.what();
                 return;
             }
+
+            m_isDirty = true;
         }
 
         void FilePrettyPrintSet(const bool prettyPrint){
@@ -25696,7 +25710,7 @@ namespace flcrm {
             m_lastErrorString = "you have to open the file first before you can write to it.";
             }
 
-            m_jsonObject[name] = value;
+            WriteValue_Internal(name, value);
         }
 
         void WriteInt(bool& errorCheck, const std::string& name, const int value){
@@ -25705,7 +25719,7 @@ namespace flcrm {
                 m_lastErrorString = "you have to open the file first before you can write to it.";
             }
 
-             m_jsonObject[name] = value;
+            WriteValue_Internal(name, value);
         }
 
         void WriteFloat(bool& errorCheck, const std::string& name, const float value){
@@ -25714,7 +25728,7 @@ namespace flcrm {
                 m_lastErrorString = "you have to open the file first before you can write to it.";
             }
 
-            m_jsonObject[name] = value;
+            WriteValue_Internal(name, value);
         }
 
         void WriteString(bool& errorCheck, const std::string& name, const std::string& value) {
@@ -25724,7 +25738,7 @@ namespace flcrm {
                 m_lastErrorString = "you have to open the file first before you can write to it.";
             }
 
-            m_jsonObject[name] = value;
+            WriteValue_Internal(name, value);
         }
 
 
@@ -25735,7 +25749,7 @@ namespace flcrm {
                 m_lastErrorString = "you have to open the file first before you can write to it.";
             }
 
-            m_jsonObject[name] = value;
+            WriteValue_Internal(name, value);
         }
 
         void WriteVectorInt(bool& errorCheck, const std::string& name, const std::vector<int>& value) {
@@ -25745,7 +25759,7 @@ namespace flcrm {
                 m_lastErrorString = "you have to open the file first before you can write to it.";
             }
 
-            m_jsonObject[name] = value;
+            WriteValue_Internal(name, value);
         }
 
         void WriteVectorFloat(bool& errorCheck, const std::string& name, const std::vector<float>& value) {
@@ -25755,7 +25769,7 @@ namespace flcrm {
                 m_lastErrorString = "you have to open the file first before you can write to it.";
             }
 
-            m_jsonObject[name] = value;
+            WriteValue_Internal(name, value);
         }
 
         void WriteVectorString(bool& errorCheck, const std::string& name, const std::vector<std::string>& value) {
@@ -25765,7 +25779,7 @@ namespace flcrm {
                 m_lastErrorString = "you have to open the file first before you can write to it.";
             }
 
-            m_jsonObject[name] = value;
+            WriteValue_Internal(name, value);
         }
 
     // Read Methods
@@ -25784,6 +25798,7 @@ namespace flcrm {
 
                 if(writeDefaultIfNotFound){
                     m_jsonObject[name] = defaultValue;
+                    m_isDirty = true;
                 }
                 else{
                     errorCheck = false;
@@ -25824,6 +25839,7 @@ namespace flcrm {
 
                 if(writeDefaultIfNotFound){
                     m_jsonObject[name] = defaultValue;
+                    m_isDirty = true;
                 }
                 else{
                     errorCheck = false;
@@ -25864,6 +25880,7 @@ namespace flcrm {
 
                 if(writeDefaultIfNotFound){
                     m_jsonObject[name] = defaultValue;
+                    m_isDirty = true;
                 }
                 else{
                     errorCheck = false;
@@ -25904,6 +25921,7 @@ namespace flcrm {
                 if(writeDefaultIfNotFound){
 
                     m_jsonObject[name] = defaultValue;
+                    m_isDirty = true;
                 }else{
                     errorCheck = false;
                     m_lastErrorString = "the given key does not exist yet - returning default";
@@ -25942,6 +25960,7 @@ namespace flcrm {
                 
                 if(writeDefaultIfNotFound){
                     m_jsonObject[name] = defaultValue;
+                    m_isDirty = true;
                 }
                 else{
                     errorCheck = false;
@@ -25980,6 +25999,7 @@ namespace flcrm {
             if(!m_jsonObject.contains(name)) {
                 if(writeDefaultIfNotFound){
                     m_jsonObject[name] = defaultValue;
+                    m_isDirty = true;
                 }
                 else{
                     errorCheck = false;
@@ -26018,6 +26038,7 @@ namespace flcrm {
             if(!m_jsonObject.contains(name)) {
                 if(writeDefaultIfNotFound){
                     m_jsonObject[name] = defaultValue;
+                    m_isDirty = true;
                 }
                 else{
                     errorCheck = false;
@@ -26056,6 +26077,7 @@ namespace flcrm {
             if(!m_jsonObject.contains(name)) {
                 if(writeDefaultIfNotFound){
                     m_jsonObject[name] = defaultValue;
+                    m_isDirty = true;
                 }
                 else{
                     errorCheck = false;
@@ -26083,10 +26105,60 @@ namespace flcrm {
 
 
     private:
+        // only marks the document dirty if the value actually changes
+        template<typename T>
+        void WriteValue_Internal(const std::string& name, const T& value) {
+
+            nlohmann::json newValue = value;
+
+            if (m_jsonObject.contains(name) && m_jsonObject[name] == newValue) {
+                return;
+            }
+
+            m_jsonObject[name] = std::move(newValue);
+            m_isDirty = true;
+        }
+
+        // writes to a temporary file next to the target and renames it over the target, so a crash never leaves a half written file behind
+        void WriteFile_Internal(bool& errorCheck, const std::filesystem::path& filepath) {
+            namespace fs = std::filesystem;
+
+            std::string contents = m_prettyPrint ? m_jsonObject.dump(4) : m_jsonObject.dump(-1);
+
+            fs::path tmpFilepath = filepath;
+            tmpFilepath += ".tmp";
+
+            std::ofstream outFileStream;
+            outFileStream.open(tmpFilepath, std::ios::binary | std::ios::trunc);
+            outFileStream.write(contents.data(), contents.size());
+            outFileStream.flush();
+
+            bool written = outFileStream.good();
+            outFileStream.close();
+
+            std::error_code ec;
+            if (written) {
+                fs::rename(tmpFilepath, filepath, ec);
+            }
+
+            if (!written || ec) {
+                errorCheck = false;
+                m_lastErrorString = "failed to write file: " + filepath.generic_string();
+                fs::remove(tmpFilepath, ec);
+                return;
+            }
+
+            if (filepath == m_filepath) {
+                m_isDirty = false;
+            }
+        }
+
         nlohmann::json m_jsonObject;
+        std::filesystem::path m_filepath;
 
         bool m_prettyPrint = false;
         bool m_fileIsOpen = false;
+        bool m_isDirty = false;
         std::string m_lastErrorString = "none";
 
     };
@@ -26106,6 +26178,7 @@ namespace flcrm {
 // Quick note. if you only want to read data it is not strictly nessesary to close the file. 
 // the file is actually closed already in FileOpen(), however the data will persits in the internally loaded json object untils the JsonSettings object goes out of scope
 // when anything was changed for example if for ReadMethods the writeDefaultValueIfKeyNotFound is set then the file has to be closed to update the data in the file.
+// FileClose() only writes the file if something changed, writes go to a temporary file first that then replaces the file. FileFlush() writes changes without closing.
 
 /*  
 
@@ -0,0 +1,93 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/*
+	Engine owned pool of worker threads.
+
+	Jobs are submitted with a priority and optionally a JobGroup.
+	Each worker owns a queue per priority and steals from the other workers when its own queues are empty.
+	Higher priorities are always drained first, so interactive work (e.g. opening a material) is not stuck behind background work (e.g. thumbnails).
+
+	A JobGroup is used to wait for a set of jobs or to cancel them. Cancelled jobs that have not started yet are skipped,
+	jobs that are already running can poll IsCancelled() on their group to exit early.
+*/
+
+namespace mnemosy::core
+{
+	enum JobPriority {
+		MNSY_JOB_PRIORITY_HIGH		= 0, // user is waiting on the result
+		MNSY_JOB_PRIORITY_NORMAL	= 1,
+		MNSY_JOB_PRIORITY_LOW		= 2, // background work like thumbnails
+		MNSY_JOB_PRIORITY_COUNT		= 3
+	};
+
+	class JobGroup {
+	public:
+		JobGroup() = default;
+		~JobGroup() = default;
+
+		void Cancel()				{ m_cancelled = true; }
+		bool IsCancelled() const	{ return m_cancelled; }
+		bool IsDone() const			{ return m_pendingJobs == 0; }
+
+	private:
+		friend class JobSystem;
+
+		std::atomic<uint32_t> m_pendingJobs = 0;
+		std::atomic<bool> m_cancelled = false;
+	};
+
+	class JobSystem
+	{
+	public:
+		JobSystem() = default;
+		~JobSystem();
+
+		void Init();
+		void Shutdown();
+
+		static std::shared_ptr<JobGroup> CreateGroup() { return std::make_shared<JobGroup>(); }
+
+		void Submit(std::function<void()> job, const JobPriority priority);
+		void Submit(const std::shared_ptr<JobGroup>& group, std::function<void()> job, const JobPriority priority);
+
+		// Blocks until all jobs of the group are done. The calling thread helps by running jobs of that group in the meantime.
+		void Wait(const std::shared_ptr<JobGroup>& group);
+
+		const uint32_t GetWorkerCount() { return (uint32_t)m_workers.size(); }
+
+	private:
+		struct Job {
+			std::function<void()> func;
+			std::shared_ptr<JobGroup> group;
+		};
+
+		struct WorkerQueue;
+
+		void WorkerLoop(const uint32_t workerIndex);
+		bool TryPopJob(const uint32_t startQueue, const JobGroup* onlyGroup, Job& outJob);
+		void RunJob(Job& job);
+
+		std::vector<std::thread> m_workers;
+		std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+
+		std::mutex m_wakeMutex;
+		std::condition_variable m_wakeCondition;
+
+		std::atomic<uint32_t> m_queuedJobs = 0;
+		std::atomic<uint32_t> m_nextSubmitQueue = 0;
+		std::atomic<bool> m_isRunning = false;
+	};
+
+} // !mnemosy::core
+
+#endif // !JOB_SYSTEM_H
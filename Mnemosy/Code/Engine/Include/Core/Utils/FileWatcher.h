@@ -3,9 +3,25 @@
 
 #include <filesystem>
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <memory>
 
 namespace fs = std::filesystem;
 
+/*
+	Watches files and directories for changes on a background thread.
+	The thread waits on change notifications of the os, ReadDirectoryChangesW on windows and inotify on linux, so watching costs nothing while nothing changes.
+	Directories the os can not watch, for example on some network shares, and other platforms fall back to comparing write times every couple of seconds.
+
+	Changes are coalesced per path: a path is reported once after no further change to it arrived for a short moment,
+	so an editor that writes a file in several steps triggers a single reload.
+*/
+
 namespace mnemosy::core {
 
 	class FileWatcher {
@@ -14,13 +30,42 @@ namespace mnemosy::core {
 		FileWatcher();
 		~FileWatcher();
 
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
 		void RegisterFile(fs::path filePath);
+		// every file inside the directory is watched, with recursive also everything in its subdirectories
+		void RegisterDirectory(fs::path directoryPath, const bool recursive);
+		// stops watching and forgets all files and directories
+		void Clear();
+
+		// true if any watched path changed since the last call, consumes the changes
 		bool DidAnyFileChange();
+		// appends the paths that changed since the last call, a directory path means anything inside it may have changed
+		void PopChangedPaths(std::vector<fs::path>& outPaths);
 
 	private:
+		struct Watch;
+
+		void Start_Internal();
+		void Stop_Internal();
+		void ThreadLoop_Internal();
+		// compares a directory the os does not notify us about against its last listing
+		void PollWatch_Internal(Watch& watch);
+		// called by the backend thread for every change notification
+		void OnChange_Internal(const fs::path& path);
+		bool IsWatched_Internal(const fs::path& path);
+
+		std::mutex m_mutex;
+		std::vector<std::shared_ptr<Watch>> m_watches;
+		// watches registered since the thread last looked, it picks them up on its next wake up
+		std::vector<std::shared_ptr<Watch>> m_newWatches;
+		std::unordered_set<fs::path::string_type> m_files;
+		// path -> time of the last change to it
+		std::unordered_map<fs::path::string_type, std::chrono::steady_clock::time_point> m_changes;
 
-		std::vector<fs::path> m_paths;
-		std::vector<fs::file_time_type> m_fileTimeTypes;
+		std::thread m_thread;
+		std::atomic<bool> m_stop = false;
 	};
 
 } // namespace mnemosy::core
@@ -0,0 +1,38 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <filesystem>
+#include <stdint.h>
+
+namespace mnemosy::core {
+
+	// Read only view of a whole file mapped into memory.
+	// The file can still be appended to by others while it is mapped, the view keeps the size it had when it was opened.
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// returns false if the file does not exist or could not be mapped. Empty files open successfully with GetData() == nullptr
+		bool Open(const std::filesystem::path& filepath);
+		void Close();
+
+		bool IsOpen() const { return m_isOpen; }
+		const uint8_t* GetData() const { return m_data; }
+		size_t GetSize() const { return m_size; }
+
+	private:
+		bool m_isOpen = false;
+		const uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+
+		void* m_fileHandle = nullptr;
+		void* m_mappingHandle = nullptr;
+	};
+
+} // !mnemosy::core
+
+#endif // !MAPPED_FILE_H
@@ -0,0 +1,66 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+namespace mnemosy::core {
+
+	// Unbounded lock free queue with many producers and a single consumer.
+	// Push() never blocks and can be called from any thread, TryPop() must only be called from the consuming thread.
+	// Used by jobs to hand their results back to the main thread.
+	template<typename T>
+	class MpscQueue {
+	public:
+		MpscQueue() {
+			Node* stub = new Node();
+			m_head.store(stub, std::memory_order_relaxed);
+			m_tail = stub;
+		}
+
+		~MpscQueue() {
+			T value;
+			while (TryPop(value)) {}
+			delete m_tail;
+		}
+
+		MpscQueue(const MpscQueue&) = delete;
+		MpscQueue& operator=(const MpscQueue&) = delete;
+
+		void Push(T value) {
+
+			Node* node = new Node();
+			node->value = std::move(value);
+
+			// the node is linked in after the exchange, until then the consumer sees the queue as ending at prev
+			Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+			prev->next.store(node, std::memory_order_release);
+		}
+
+		bool TryPop(T& outValue) {
+
+			Node* tail = m_tail;
+			Node* next = tail->next.load(std::memory_order_acquire);
+			if (next == nullptr)
+				return false;
+
+			// next becomes the new stub, its value is moved out
+			outValue = std::move(next->value);
+			m_tail = next;
+			delete tail;
+			return true;
+		}
+
+	private:
+		struct Node {
+			std::atomic<Node*> next = nullptr;
+			T value{};
+		};
+
+		std::atomic<Node*> m_head;	// last pushed node, written by producers
+		Node* m_tail;				// stub before the next node to pop, owned by the consumer
+	};
+
+} // !mnemosy::core
+
+#endif // !MPSC_QUEUE_H
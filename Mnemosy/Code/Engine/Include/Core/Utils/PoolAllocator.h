@@ -0,0 +1,85 @@
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include "Include/Core/flcrm_arena_alloc.h"
+
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace mnemosy::core {
+
+	// Fixed size object pool on top of flcrm::Arena blocks.
+	// Objects are carved out of blocks of ObjectsPerBlock objects, deleted objects go onto a free list and are reused before the block grows.
+	// Objects that are created together end up next to each other in memory instead of scattered across the heap.
+	template<typename T, size_t ObjectsPerBlock = 1024>
+	class PoolAllocator {
+	public:
+		PoolAllocator() = default;
+		~PoolAllocator() { FreeAll(); }
+
+		PoolAllocator(const PoolAllocator&) = delete;
+		PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+		template<typename... Args>
+		T* New(Args&&... args) {
+
+			void* memory = nullptr;
+
+			if (m_freeList) {
+				memory = m_freeList;
+				m_freeList = m_freeList->next;
+			}
+			else {
+				if (m_blocks.empty() || !m_blocks.back().arena_has_enough_memory(sizeof(Slot) + alignof(Slot))) {
+					m_blocks.emplace_back();
+					m_blocks.back().arena_init_allocate_buffer(sizeof(Slot) * ObjectsPerBlock + alignof(Slot));
+				}
+
+				memory = m_blocks.back().arena_allocate(sizeof(Slot), alignof(Slot));
+			}
+
+			m_liveCount++;
+			return new (memory) T(std::forward<Args>(args)...);
+		}
+
+		void Delete(T* object) {
+
+			if (object == nullptr)
+				return;
+
+			object->~T();
+
+			Slot* slot = reinterpret_cast<Slot*>(object);
+			slot->next = m_freeList;
+			m_freeList = slot;
+			m_liveCount--;
+		}
+
+		// releases the memory of all blocks, every object must have been deleted before
+		void FreeAll() {
+
+			for (flcrm::Arena& block : m_blocks) {
+				block.arena_free_all();
+			}
+			m_blocks.clear();
+			m_freeList = nullptr;
+			m_liveCount = 0;
+		}
+
+		size_t GetLiveCount() const { return m_liveCount; }
+
+	private:
+		union Slot {
+			Slot* next;
+			alignas(T) unsigned char storage[sizeof(T)];
+		};
+
+		std::vector<flcrm::Arena> m_blocks;
+		Slot* m_freeList = nullptr;
+		size_t m_liveCount = 0;
+	};
+
+} // !mnemosy::core
+
+#endif // !POOL_ALLOCATOR_H
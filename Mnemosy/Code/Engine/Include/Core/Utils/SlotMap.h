@@ -0,0 +1,108 @@
+#ifndef SLOT_MAP_H
+#define SLOT_MAP_H
+
+#include "Include/Core/Log.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace mnemosy::core {
+
+	// 32 bit handle: the low 20 bits are the slot index, the high 12 bits the generation of the slot.
+	// 0 is never handed out and can be used as 'no handle'.
+	typedef uint32_t Handle;
+
+	// Maps handles to objects in constant time. The objects are owned by the caller.
+	// A slot gets a new generation every time it is freed, so handles of removed objects resolve to nullptr
+	// instead of to whatever object reuses the slot later, at least until the generation wraps around after 4095 reuses.
+	template<typename T>
+	class SlotMap {
+	public:
+		static constexpr uint32_t IndexBits = 20;
+		static constexpr uint32_t IndexMask = (1u << IndexBits) - 1;
+		static constexpr uint32_t GenerationMask = (1u << (32 - IndexBits)) - 1;
+		static constexpr uint32_t MaxSlots = IndexMask + 1;
+
+		SlotMap() = default;
+		~SlotMap() = default;
+
+		Handle Insert(T* object) {
+
+			uint32_t index;
+			if (!m_freeSlots.empty()) {
+				index = m_freeSlots.back();
+				m_freeSlots.pop_back();
+			}
+			else {
+				MNEMOSY_ASSERT(m_slots.size() < MaxSlots, "Slot map is full");
+				index = (uint32_t)m_slots.size();
+				m_slots.emplace_back();
+			}
+
+			m_slots[index].object = object;
+			m_count++;
+
+			return (m_slots[index].generation << IndexBits) | index;
+		}
+
+		void Remove(const Handle handle) {
+
+			if (Get(handle) == nullptr)
+				return;
+
+			FreeSlot_Internal(handle & IndexMask);
+		}
+
+		// nullptr if the handle is 0, stale or out of range
+		T* Get(const Handle handle) const {
+
+			uint32_t index = handle & IndexMask;
+			if (index >= m_slots.size())
+				return nullptr;
+
+			const Slot& slot = m_slots[index];
+			if (slot.generation != (handle >> IndexBits))
+				return nullptr;
+
+			return slot.object;
+		}
+
+		// frees all slots, handles given out before stay invalid
+		void Clear() {
+
+			for (uint32_t index = 0; index < m_slots.size(); index++) {
+				if (m_slots[index].object) {
+					FreeSlot_Internal(index);
+				}
+			}
+		}
+
+		size_t Count() const { return m_count; }
+
+	private:
+		struct Slot {
+			T* object = nullptr;
+			uint32_t generation = 1;
+		};
+
+		void FreeSlot_Internal(const uint32_t index) {
+
+			Slot& slot = m_slots[index];
+			slot.object = nullptr;
+			slot.generation = (slot.generation + 1) & GenerationMask;
+			if (slot.generation == 0) {
+				slot.generation = 1;
+			}
+
+			m_freeSlots.push_back(index);
+			m_count--;
+		}
+
+		std::vector<Slot> m_slots;
+		std::vector<uint32_t> m_freeSlots;
+		size_t m_count = 0;
+	};
+
+} // !mnemosy::core
+
+#endif // !SLOT_MAP_H
@@ -0,0 +1,68 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <stddef.h>
+#include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_map>
+
+namespace mnemosy::core {
+
+	// Handle to a string owned by a StringPool. It is just a pointer, copying it is free and two strings of the same pool are equal exactly if their pointers are.
+	// Reads like a const std::string, a default constructed one is empty.
+	class InternedString {
+	public:
+		InternedString() = default;
+
+		const std::string& str() const { return m_string ? *m_string : Empty(); }
+		operator const std::string&() const { return str(); }
+
+		const char* c_str() const { return str().c_str(); }
+		size_t size() const { return str().size(); }
+		bool empty() const { return str().empty(); }
+
+		friend bool operator==(const InternedString& a, const InternedString& b) { return a.m_string == b.m_string || a.str() == b.str(); }
+		friend bool operator==(const InternedString& a, const std::string& b) { return a.str() == b; }
+		friend bool operator<(const InternedString& a, const InternedString& b) { return a.str() < b.str(); }
+
+		friend std::string operator+(const InternedString& a, const std::string& b) { return a.str() + b; }
+		friend std::string operator+(const InternedString& a, const char* b) { return a.str() + b; }
+		friend std::string operator+(const std::string& a, const InternedString& b) { return a + b.str(); }
+		friend std::string operator+(const char* a, const InternedString& b) { return a + b.str(); }
+
+	private:
+		friend class StringPool;
+		explicit InternedString(const std::string* string) : m_string(string) {}
+
+		static const std::string& Empty() {
+			static const std::string empty;
+			return empty;
+		}
+
+		const std::string* m_string = nullptr;
+	};
+
+	// Stores every distinct string once, for names that many objects share or keep around for a long time.
+	// Strings are never removed one by one, all of them stay valid until Clear().
+	class StringPool {
+	public:
+		StringPool() = default;
+		~StringPool() = default;
+
+		StringPool(const StringPool&) = delete;
+		StringPool& operator=(const StringPool&) = delete;
+
+		InternedString Intern(std::string_view string);
+		void Clear();
+
+		size_t GetCount() const { return m_strings.size(); }
+
+	private:
+		std::deque<std::string> m_strings; // a deque never moves its elements, views and handles stay valid
+		std::unordered_map<std::string_view, const std::string*> m_lookup; // views into m_strings
+	};
+
+} // !mnemosy::core
+
+#endif // !STRING_POOL_H
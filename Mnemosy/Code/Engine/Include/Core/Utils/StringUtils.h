@@ -39,7 +39,7 @@ namespace mnemosy::core
 		}
 
 		// if string is valid utf8 just returns it, otherwise first copies byte for byte into a wide string and then convert to a utf8string
-		static std::string string_fix_u8Encoding(std::string& str) {
+		static std::string string_fix_u8Encoding(const std::string& str) {
 
 
 			if (utf8::is_valid(str.begin(), str.end())) {
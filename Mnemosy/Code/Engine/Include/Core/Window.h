@@ -26,7 +26,8 @@ namespace mnemosy::core
 		~Window() = default;
 
 
-		void Init(const char* WindowTitle);
+		// a hidden window still gives us a gl context, used to render without showing anything
+		void Init(const char* WindowTitle, const bool hidden = false);
 		void Shutdown();
 
 
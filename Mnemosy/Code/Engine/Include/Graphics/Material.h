@@ -103,6 +103,8 @@ namespace mnemosy::graphics
 
 		bool SuffixExistsInPackedTexturesList(std::string& suffix);
 		bool IsTextureTypeAssigned(const PBRTextureType& pbrType);
+		// returns nullptr if texture is not assigned
+		Texture* GetTextureFromPBRTextureType(const PBRTextureType& pbrType);
 
 
 
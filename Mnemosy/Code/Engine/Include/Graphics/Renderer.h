@@ -45,6 +45,16 @@ namespace mnemosy::graphics
 
 	};
 
+	// largest texture size uploaded for the material shown in the preview viewport, larger textures are downscaled while loading.
+	enum PreviewTextureResolution
+	{
+		MNSY_PREVIEWRES_1024	= 0,
+		MNSY_PREVIEWRES_2048	= 1,
+		MNSY_PREVIEWRES_4096	= 2,
+		MNSY_PREVIEWRES_FULL	= 3, // no limit
+		MNSY_PREVIEWRES_COUNT
+	};
+
 	enum RenderModes
 	{
 		MNSY_RENDERMODE_SHADED				= 0,
@@ -108,11 +118,17 @@ namespace mnemosy::graphics
 		unsigned int GetThumbnailResolutionValue(ThumbnailResolution thumbnailResolution);
 		void SetThumbnailResolution(ThumbnailResolution thumbnailResolution) { m_thumbnailResolution = thumbnailResolution; }
 		ThumbnailResolution GetThumbnailResolutionEnum() { return m_thumbnailResolution; }
+
+		// returns 0 for MNSY_PREVIEWRES_FULL
+		uint16_t GetPreviewTextureResolutionValue(PreviewTextureResolution previewResolution);
+		void SetPreviewTextureResolution(PreviewTextureResolution previewResolution) { m_previewTextureResolution = previewResolution; }
+		PreviewTextureResolution GetPreviewTextureResolutionEnum() { return m_previewTextureResolution; }
 		
 		int GetCurrentRenderModeInt() { return (int)m_renderMode; }
 		void SetRenderMode(RenderModes mode);
 
-		void HotReloadPbrShader(float deltaSeconds);
+		// recompiles shaders whose files changed on disk
+		void HotReloadPbrShader();
 
 	private:
 
@@ -161,6 +177,8 @@ namespace mnemosy::graphics
 		// Thumbnails
 		ThumbnailResolution m_thumbnailResolution = ThumbnailResolution::MNSY_THUMBNAILRES_128;
 
+		PreviewTextureResolution m_previewTextureResolution = PreviewTextureResolution::MNSY_PREVIEWRES_4096;
+
 
 		unsigned int m_thumb_MSAA_Value = 16;
 		unsigned int m_thumb_MSAA_FBO = 0;
@@ -179,7 +197,6 @@ namespace mnemosy::graphics
 		core::FileWatcher m_shaderFileWatcher;
 		core::FileWatcher m_shaderUnlitFileWatcher;
 		core::FileWatcher m_shaderSkyboxFileWatcher;
-		float m_fileWatchTimeDelta = 0.0f;
 
 	};
 
@@ -3,6 +3,7 @@
 
 #include <glm/glm.hpp>
 #include <string>
+#include <stdint.h>
 
 namespace mnemosy::graphics
 {
@@ -37,9 +38,15 @@ namespace mnemosy::graphics
 
 		std::string m_pathVertex;
 		std::string m_pathFragment;
+		// keys of the two most recent program binaries in the ShaderBinaryCache, 0 if none was used
+		uint64_t m_binaryCacheKey = 0;
+		uint64_t m_previousBinaryCacheKey = 0;
 
 
 		bool CheckCompileErrors(unsigned int shader,const std::string& type);
+		bool LoadBinary_Internal(const uint64_t binaryCacheKey);
+		void StoreBinary_Internal(const uint64_t binaryCacheKey);
+		void KeepBinary_Internal(const uint64_t binaryCacheKey);
 
 	};
 
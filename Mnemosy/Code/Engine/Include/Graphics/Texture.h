@@ -23,6 +23,10 @@ namespace mnemosy::graphics
 		~Texture();
 		
 		void GenerateOpenGlTexture(const PictureInfo& info, const bool generateMipmaps);
+		// creates immutable storage matching the picture layout without uploading any pixels, they are filled in by the TextureUploader
+		void AllocateOpenGlTexture(const PictureInfo& info, const bool generateMipmaps);
+
+		static void GetOpenGlFormat(const TextureFormat format, const bool isHalfFloat, unsigned int& outInternalFormat, unsigned int& outFormat, unsigned int& outType);
 
 
 		bool IsInitialized() const;
@@ -39,12 +43,20 @@ namespace mnemosy::graphics
 		unsigned int GetWidth() { return m_width; }
 		unsigned int GetHeight() { return m_height; }
 
+		// resolution of the image file, larger than GetWidth() / GetHeight() if a downscaled version was uploaded
+		void SetSourceResolution(const uint16_t width, const uint16_t height) { m_sourceWidth = width; m_sourceHeight = height; }
+		unsigned int GetSourceWidth() { return m_sourceWidth; }
+		unsigned int GetSourceHeight() { return m_sourceHeight; }
+		bool IsDownscaled() { return m_width < m_sourceWidth || m_height < m_sourceHeight; }
+
 		unsigned int m_ID = 0;
 	private:
 		TextureFormat m_textureFormat;
 
 		uint16_t m_width = 0; 
 		uint16_t m_height = 0; 
+		uint16_t m_sourceWidth = 0;
+		uint16_t m_sourceHeight = 0;
 
 		bool m_isInitialized = false; 
 		uint8_t m_lastBoundLocation = 0; 
@@ -125,6 +125,8 @@ namespace mnemosy::graphics {
 
 #define texture_fileSuffix_thumbnail		"_thumbnail.ktx2"	// file name of the thumbnail texture (in ktx2 format)
 
+#define texture_cacheFolder					"cache"				// folder inside a material directory holding the decoded mip chains of its textures
+
 // unlit material
 
 #define texture_unlit_fileSuffix "_tex" + texture_fileExtentionTiff
@@ -216,7 +218,7 @@ namespace mnemosy::graphics {
 		}
 		
 		// Returns Empty string if PBRType is not found or not a type
-		static std::string get_filename_from_PBRTextureType(std::string& materialName,PBRTextureType textureType) {
+		static std::string get_filename_from_PBRTextureType(const std::string& materialName,PBRTextureType textureType) {
 			
 			switch (textureType)
 			{
@@ -234,6 +236,26 @@ namespace mnemosy::graphics {
 			return std::string();
 		}
 
+		// file name of the decoded mip chain inside texture_cacheFolder. Does not contain the material name so it stays valid when the material is renamed.
+		// Returns Empty string if PBRType is not found or not a type
+		static std::string get_cacheFilename_from_PBRTextureType(PBRTextureType textureType) {
+
+			switch (textureType)
+			{
+			case PBRTextureType::MNSY_TEXTURE_ALBEDO: 			return std::string("albedo")			+ texture_fileExtentionKtx2;	break;
+			case PBRTextureType::MNSY_TEXTURE_ROUGHNESS:		return std::string("roughness")			+ texture_fileExtentionKtx2;	break;
+			case PBRTextureType::MNSY_TEXTURE_METALLIC:			return std::string("metallic")			+ texture_fileExtentionKtx2;	break;
+			case PBRTextureType::MNSY_TEXTURE_NORMAL:			return std::string("normal")			+ texture_fileExtentionKtx2;	break;
+			case PBRTextureType::MNSY_TEXTURE_AMBIENTOCCLUSION:	return std::string("ambientOcclusion")	+ texture_fileExtentionKtx2;	break;
+			case PBRTextureType::MNSY_TEXTURE_EMISSION:			return std::string("emissive")			+ texture_fileExtentionKtx2;	break;
+			case PBRTextureType::MNSY_TEXTURE_HEIGHT:			return std::string("height")			+ texture_fileExtentionKtx2;	break;
+			case PBRTextureType::MNSY_TEXTURE_OPACITY:			return std::string("opacity")			+ texture_fileExtentionKtx2;	break;
+			default: return std::string() ;break;
+			}
+
+			return std::string();
+		}
+
 		// Returns Empty string if PBRType is not found or not a type
 		static std::string get_string_from_PBRTextureType(PBRTextureType type) {
 
@@ -374,6 +396,47 @@ namespace mnemosy::graphics {
 			return std::string("NONE");
 		}
 
+		// texture a pack component is read from, smoothness is read from the roughness texture
+		// Returns MNSY_TEXTURE_NONE for MNSY_PACKCOMPONENT_NONE
+		static PBRTextureType get_PBRTextureType_from_channelPackComponent(ChannelPackComponent packComponent) {
+
+			switch (packComponent)
+			{
+			case (MNSY_PACKCOMPONENT_ALBEDO_R):
+			case (MNSY_PACKCOMPONENT_ALBEDO_G):
+			case (MNSY_PACKCOMPONENT_ALBEDO_B):		return PBRTextureType::MNSY_TEXTURE_ALBEDO;	break;
+
+			case (MNSY_PACKCOMPONENT_NORMAL_R):
+			case (MNSY_PACKCOMPONENT_NORMAL_G):
+			case (MNSY_PACKCOMPONENT_NORMAL_B):		return PBRTextureType::MNSY_TEXTURE_NORMAL;	break;
+
+			case (MNSY_PACKCOMPONENT_EMISSIVE_R):
+			case (MNSY_PACKCOMPONENT_EMISSIVE_G):
+			case (MNSY_PACKCOMPONENT_EMISSIVE_B):	return PBRTextureType::MNSY_TEXTURE_EMISSION;	break;
+
+			case (MNSY_PACKCOMPONENT_ROUGHNESS):
+			case (MNSY_PACKCOMPONENT_SMOOTHNESS):	return PBRTextureType::MNSY_TEXTURE_ROUGHNESS;	break;
+			case (MNSY_PACKCOMPONENT_METALLIC):		return PBRTextureType::MNSY_TEXTURE_METALLIC;	break;
+			case (MNSY_PACKCOMPONENT_AO):			return PBRTextureType::MNSY_TEXTURE_AMBIENTOCCLUSION;	break;
+			case (MNSY_PACKCOMPONENT_HEIGHT):		return PBRTextureType::MNSY_TEXTURE_HEIGHT;	break;
+			case (MNSY_PACKCOMPONENT_OPACITY):		return PBRTextureType::MNSY_TEXTURE_OPACITY;	break;
+
+			default: return PBRTextureType::MNSY_TEXTURE_NONE; break;
+			}
+
+			return PBRTextureType::MNSY_TEXTURE_NONE;
+		}
+
+		// channel of the texture a pack component is read from.
+		// Components below 10 are the r, g and b channels of albedo, normal and emissive, all others are single channel textures.
+		static uint8_t get_sourceChannel_from_channelPackComponent(ChannelPackComponent packComponent) {
+
+			if (packComponent == MNSY_PACKCOMPONENT_NONE || (int)packComponent >= 10)
+				return 0;
+
+			return (uint8_t)(((int)packComponent - 1) % 3);
+		}
+
 		// Normal Map Format
 		static std::string get_string_from_normalMapFormat(graphics::NormalMapFormat normalMapFormat) {
 			return std::string(graphics::TexDefinitions::NormalMapFormats_string[(int)normalMapFormat]);
@@ -0,0 +1,100 @@
+#ifndef TEXTURE_UPLOADER_H
+#define TEXTURE_UPLOADER_H
+
+#include "Include/Graphics/Utils/Picture.h"
+
+#include <stdint.h>
+#include <vector>
+#include <mutex>
+
+/*
+	Asynchronous texture uploads through a ring of persistently mapped pixel buffer memory.
+
+	Decode jobs can reserve staging memory with TryAllocateStaging() and write the pixels straight into it,
+	the main thread then only issues the copy from the buffer into the texture which the driver performs without stalling the frame.
+	Pictures that did not get staging memory (ring was full) are copied into the ring in bands of rows across several frames.
+
+	Staging memory is recycled once the fence of the copy that read from it has signaled, each region on its own,
+	so a copy the gpu has not finished yet only holds on to its own region.
+*/
+
+namespace mnemosy::graphics
+{
+	class Texture;
+
+	// region of the upload ring. data points into mapped memory and can be written from any thread until it is handed to an upload.
+	struct StagingBuffer {
+		uint32_t id = 0;
+		size_t offset = 0;
+		size_t size = 0;
+		void* data = nullptr;
+
+		bool IsValid() const { return data != nullptr; }
+	};
+
+	// a texture upload that may span several frames. Owned by whoever started it, the uploader does not keep a reference.
+	struct TextureUpload {
+		Texture* texture = nullptr;		// created on the first ContinueUpload() call, the owner takes it over once IsDone()
+		PictureInfo info;				// layout of the picture, if info.pixels is set they are owned and freed by the upload
+		StagingBuffer staging;			// if valid it already holds all pixels of the picture
+		uint32_t mipLevels = 1;			// number of mip levels stored back to back in the pixels, more than one means the full chain is provided
+		bool generateMipmaps = true;	// ignored if the mip levels are provided
+		uint32_t rowsUploaded = 0;
+
+		bool IsDone() const { return texture != nullptr && rowsUploaded == info.height; }
+	};
+
+	class TextureUploader
+	{
+	public:
+		TextureUploader() = default;
+		~TextureUploader() = default;
+
+		void Init();
+		void Shutdown();
+
+		// recycles staging memory of copies the gpu has finished, called once per frame
+		void Update();
+
+		// Thread safe. Returns false if the ring has not enough free space right now.
+		bool TryAllocateStaging(const size_t size, StagingBuffer& outStaging);
+		// Thread safe. Gives back staging memory that will not be uploaded.
+		void ReleaseStaging(StagingBuffer& staging);
+
+		// Main thread. Uploads the next rows of the picture using at most maxBytes of the ring, call again in later frames until upload.IsDone()
+		void ContinueUpload(TextureUpload& upload, const size_t maxBytes);
+		// Main thread. Uploads everything right away, waits for the gpu to free ring memory if needed.
+		void FinishUpload(TextureUpload& upload);
+		// Main thread. Stops the upload and frees its texture and memory.
+		void CancelUpload(TextureUpload& upload);
+
+	private:
+		struct StagingRegion {
+			uint32_t id = 0;
+			size_t offset = 0;
+			size_t size = 0;			// aligned size
+			void* fence = nullptr;		// GLsync of the copy reading from the region
+			bool released = false;
+		};
+
+		bool AllocateRegion(const size_t size, StagingBuffer& outStaging);
+		void SubmitRegion(const uint32_t id);
+		// returns false if no submitted region is left to wait on
+		bool WaitForOldestRegion();
+		void UploadMipLevels(const TextureUpload& upload, const unsigned int format, const unsigned int type, const uint8_t* levelsSource);
+
+		bool m_isInitialized = false;
+
+		unsigned int m_bufferID = 0;
+		uint8_t* m_mappedData = nullptr;
+		size_t m_size = 0;
+
+		std::mutex m_mutex;
+		std::vector<StagingRegion> m_regions; // ordered by offset, the memory between them is free
+		size_t m_head = 0; // end of the last allocation, new ones are placed after it first so the ring is filled in order
+		uint32_t m_nextRegionID = 1;
+	};
+
+} // !mnemosy::graphics
+
+#endif // !TEXTURE_UPLOADER_H
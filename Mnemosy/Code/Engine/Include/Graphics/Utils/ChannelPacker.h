@@ -0,0 +1,34 @@
+#ifndef CHANNEL_PACKER_H
+#define CHANNEL_PACKER_H
+
+#include "Include/Graphics/Utils/Picture.h"
+
+/*
+	Channel packing on the cpu, it needs no openGl context and works at any resolution.
+
+	Every output channel takes one channel of a source picture or a constant value. Sources with a different size than the output are sampled bilinear like the gpu would.
+	The image is packed and compressed in strips of rows by jobs on the engine job system, the calling thread writes finished strips to the file in order
+	while the next strips are still being packed, so only a few strips of the output are ever in memory.
+	The file is written with the same strips, compression and predictor as Picture::WriteTiff().
+*/
+
+namespace mnemosy::graphics
+{
+	struct ChannelPackSource
+	{
+		const PictureInfo* picture = nullptr;	// nullptr uses value for every pixel
+		uint8_t channel = 0;					// channels the picture does not have read as 0
+		float value = 0.0f;
+		bool invert = false;					// 1 - value, the value is clamped to 0-1 first
+	};
+
+	class ChannelPacker {
+	public:
+		// Writes a tiff with numChannels (1 to 4) channels of 8 or 16 bit unsigned normalized or 32 bit float.
+		// Source rows are expected bottom to top like textures on the gpu, with flipVertically they are written top to bottom.
+		static void PackToTiff(PictureError& outPictureError, const char* filepath, const ChannelPackSource* sources, const uint8_t numChannels, const uint16_t width, const uint16_t height, const uint8_t bitDepth, const bool flipVertically);
+	};
+
+} // ! namespace mnemosy::graphics
+
+#endif // !CHANNEL_PACKER_H
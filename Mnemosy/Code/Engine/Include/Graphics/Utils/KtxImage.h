@@ -2,11 +2,14 @@
 #define KTX_IMAGE_H
 
 #include <stdint.h>
+#include <string>
+#include <vector>
 
 
 namespace mnemosy::graphics {
 	enum TextureFormat;
 	enum VkFormat;
+	struct PictureInfo;
 }
 
 namespace mnemosy::graphics
@@ -44,6 +47,22 @@ namespace mnemosy::graphics
 		// return ktx_error_code_e (enum)
 		unsigned int Save_WithoutMips(const char* filepath, void* pixels, const bool flipVertically, const TextureFormat format, const uint16_t _width, const uint16_t _height, const bool isHalfFloat);
 
+		// Mip chain cache of decoded textures. Levels are stored exactly as they are in memory (already flipped for openGl), largest first, zstd supercompressed.
+		// sourceStamp is stored in the key value data and identifies the file the levels were decoded from.
+		const bool SaveMipChain(const char* filepath, const std::vector<PictureInfo>& levels, const std::string& sourceStamp);
+		// Reads the levels starting at the first one that fits into maxResolution (0 = no limit) into one buffer, back to back.
+		// Fails if the file does not exist or its sourceStamp does not match, an empty sourceStamp accepts any file. outInfo.pixels has to be freed by the caller.
+		// width and height are set to the size of the largest level in the file.
+		const bool LoadMipChain(const char* filepath, const std::string& sourceStamp, const uint16_t maxResolution, PictureInfo& outInfo, uint32_t& outMipLevels);
+		// Same checks as LoadMipChain() but only the header is read, outInfo.pixels stays nullptr.
+		// The levels can then be read with ReadMipLevels() into memory of the caller, e.g. straight into the texture upload ring.
+		const bool OpenMipChain(const char* filepath, const std::string& sourceStamp, const uint16_t maxResolution, PictureInfo& outInfo, uint32_t& outMipLevels);
+		// Reads levelCount levels back to back into destination, level 0 is the first level of the chain OpenMipChain() returned.
+		const bool ReadMipLevels(void* destination, const uint32_t firstLevel, const uint32_t levelCount);
+		// Replaces the sourceStamp of a mip chain file in place if it currently is oldStamp, e.g. after its source file was rewritten with the same pixels.
+		// Both stamps need the same length. Returns false if the file is not a mip chain of oldStamp, it is left untouched then.
+		const bool RestampMipChain(const char* filepath, const std::string& oldStamp, const std::string& newStamp);
+
 
 		TextureFormat GetMnemosyFormatFromVkFormat(VkFormat vkFormat);
 		VkFormat GetVkFormatFromMnemosyFormat(TextureFormat mnsyFormat, bool isHalfFloat);
@@ -51,6 +70,12 @@ namespace mnemosy::graphics
 		uint16_t width	= 0;
 		uint16_t height = 0;
 		uint8_t numChannels = 0;
+
+	private:
+		std::string m_mipChainPath;				// of the last OpenMipChain()
+		std::vector<uint64_t> m_mipChainLevels;	// byteOffset, byteLength and uncompressedByteLength of each level of the opened chain
+		uint64_t m_mipChainFileSize = 0;
+		bool m_mipChainIsZstd = false;
 	};
 
 } // mnemosy::graphics
@@ -4,6 +4,7 @@
 #include "Include/Graphics/TextureDefinitions.h"
 
 #include <string>
+#include <vector>
 
 /*
 	
@@ -22,6 +23,8 @@
 	See bottom of this file for quick usage example.
 */
 
+struct tiff; // libtiff
+
 namespace mnemosy::graphics
 {
 	struct PictureInfo
@@ -58,6 +61,16 @@ namespace mnemosy::graphics
 		std::string what = "";
 	};
 
+	// Lossless compression of the tiff files written by WriteTiff().
+	// 8 and 16 bit samples are stored with the horizontal predictor, 32 bit float with the floating point predictor.
+	enum TiffCompression {
+		MNSY_TIFF_COMPRESSION_NONE		= 0,
+		MNSY_TIFF_COMPRESSION_LZW		= 1,
+		MNSY_TIFF_COMPRESSION_DEFLATE	= 2,
+		MNSY_TIFF_COMPRESSION_ZSTD		= 3,
+		MNSY_TIFF_COMPRESSION_COUNT
+	};
+
 	class Picture {
 
 	public:		
@@ -68,18 +81,41 @@ namespace mnemosy::graphics
 		// Same as ReadPicture() but instead of returning PictureInfo struct, it is passed as second parameter so we can use this procedure for multithreading when loading several images simultaniously
 		static void ReadPicture_PbrThreaded(PictureError& outPictureError, PictureInfo& outPicInfo, const std::string filepath, const bool flipVertically, graphics::PBRTextureType PBRTypeHint);
 
+		// Reads a smaller version of the picture the file stores next to the full resolution, the largest one whose longest side is at most maxSize.
+		// Only tiled mip or rip mapped exr files store one. Fails for every other file, the caller then has to decode the full picture and downscale it.
+		// outFullWidth and outFullHeight are set to the full resolution of the file on success.
+		static PictureInfo ReadPictureReduced(PictureError& outPictureError, const char* filepath, const bool flipVertically, const bool convertGrayToRGB, const bool convertEXRandHDRToSrgb, const uint16_t maxSize, uint16_t& outFullWidth, uint16_t& outFullHeight);
+
 		// general interface for writing images so it supports multiple formats
 		// Formats Exr and Hdr are assumed to be passes values in sRBG color space and will always convert to linear as this is the standard for these formats.
 		// for now, if data is already in linear space the respective write methods for exr and hdr must be called directly to specify wheather to convert to linear or not
 		static void WritePicture(PictureError& outPictureError, const char* filepath, const PictureInfo& pictureInfo, const bool flipVertically,const bool convertExrAndHdrToLinear);
 
-		// Read .tif images. Supports full RGBA channels with up to 32 bit.
+		// Read .tif images. Supports full RGBA channels with up to 32 bit, striped or tiled.
+		// Large images are decoded in parallel on the engine job system, each job opens its own handle and decodes whole strips (or rows of tiles).
+		// Gray to RGB conversion and vertical flip happen in the same pass while rows are written to the output buffer.
 		static PictureInfo ReadTiff(PictureError& outPictureError, const char* filepath, const bool flipVertically, const bool convertGrayToRGB);
 		
-		// Write image data to a tiff file. Using scaline interface
+		// True if ReadTiff() reads the file as format without any conversion, 8 and 16 bit as unsigned normalized and 32 bit as float, and the rows are stored top to bottom.
+		// The file also has to be stored with compression, MNSY_TIFF_COMPRESSION_COUNT accepts any codec libtiff can decode.
+		// Only the header is read. Such a file can be copied instead of decoding and writing it again.
+		static bool TiffMatchesFormat(const char* filepath, const TextureFormat format, const TiffCompression compression);
+
+		// Write image data to a tiff file with the compression set by SetTiffCompression().
+		// Rows are grouped into strips of about 256 KB. Large images have their strips compressed in parallel on the engine job system, the calling thread writes them in order.
 		static void WriteTiff(PictureError& outPictureError, const char* filepath,const PictureInfo& pictureInfo, const bool flipVertically);
 
+		// Compression used by all following WriteTiff() calls on any thread.
+		// Zstd falls back to deflate if libtiff is built without it, any other codec that is missing (including deflate) falls back to no compression.
+		static void SetTiffCompression(const TiffCompression compression);
+		static TiffCompression GetTiffCompression();
+
+		// Compression a tiff file is stored with. Returns MNSY_TIFF_COMPRESSION_COUNT if the file can not be opened or uses any other codec.
+		static TiffCompression ReadTiffCompression(const char* filepath);
+
 		// Reads .exr image files, returns pixel buffer as either half_float (16 bit) or float (32 bit), pictureInfo.isHalfFloat is true for 16bit images
+		// OpenExr decodes straight into the returned interleaved buffer, flipping only changes the row stride. Scanline and tiled files are supported,
+		// of multi-part files the first part that is not deep data and has the channels described below is read.
 		// The implementation only supports a subset of possilbe .exr configurations.
 		// Supported are channels R, RG, RGB, RGBA as either 16 or 32 bit, type UINT is not supported.  
 		// Furthemore channels are searched for in the order R,G,B and last A, if the previous channel did not exist all following will not be considered. 
@@ -91,8 +127,12 @@ namespace mnemosy::graphics
 
 		// Write .exr files. Exr should be provided with 32 bit float or 16 bit half-float data. Not 16 bit unsinged short data.
 		// CAUTION: feeding WriteExr with 8 bit pixels will work and try to promote to 16 bit but may produce unexpected results especially when combined with convert to linear
+		// Half float and float pixels are encoded without a copy unless they are converted to linear.
 		static void WriteExr(PictureError& outPictureError, const char* filepath, const PictureInfo& pictureInfo, const bool flipVertically, const bool convertToLinear);
 
+		// Threads OpenExr uses to decode and encode the chunks of a single file. 0 reads and writes on the calling thread only.
+		static void SetExrThreadCount(const uint32_t threadCount);
+
 		// Read .hdr files.  This will always return RGB32 format.
 		static PictureInfo ReadHdr(PictureError& outPictureError, const char* filepath, const bool flipVertically, const bool convertToSrgb);
 		
@@ -127,11 +167,56 @@ namespace mnemosy::graphics
 
 		static PictureError pic_util_check_input_pictureInfo(const PictureInfo& pictureInfo);
 
+		// Returns a box filtered copy that is at most maxSize pixels on its longest side. The size is reduced by a power of two like a mip level.
+		// The input buffer is not freed, the returned one has to be freed by the caller.
+		static PictureInfo pic_util_downscale(PictureError& outPictureError, const PictureInfo& pictureInfo, const uint16_t maxSize);
+		// Returns the next mip level with half the size rounded down like openGl does it, e.g 5x3 -> 2x1. The returned buffer has to be freed by the caller.
+		static PictureInfo pic_util_next_mip_level(PictureError& outPictureError, const PictureInfo& pictureInfo);
+		// Bytes of mipLevels levels stored back to back starting at the size of pictureInfo.
+		static size_t pic_util_mip_chain_size(const PictureInfo& pictureInfo, const uint32_t mipLevels);
+
 		static float pic_util_linear2srgb_float(float linearValue);
 		static float pic_util_srgb2linear_float(float srgbValue);
 
 	};
 
+	// Writes a tiff strip by strip with the strip size, compression and predictor of WriteTiff(), for images that are produced in parts like packed channels.
+	// Strips are encoded on any thread with EncodeStrip() and written in order with WriteStrip() on the thread that opened the file.
+	class TiffStripWriter {
+	public:
+		TiffStripWriter() = default;
+		// a file that is still open was not finished and is removed
+		~TiffStripWriter();
+
+		TiffStripWriter(const TiffStripWriter&) = delete;
+		TiffStripWriter& operator=(const TiffStripWriter&) = delete;
+
+		// uses the compression set by Picture::SetTiffCompression()
+		void Open(PictureError& outPictureError, const char* filepath, const uint16_t width, const uint16_t height, const TextureFormat format);
+		// Replaces the rows of strip, stored top to bottom, with the bytes that go into the file. Safe to call from any thread while the file is open.
+		bool EncodeStrip(const uint32_t strip, std::vector<uint8_t>& rows) const;
+		bool WriteStrip(const uint32_t strip, const std::vector<uint8_t>& data);
+		// finishes the file, it is removed unless every strip was written
+		void Close(PictureError& outPictureError);
+
+		uint32_t GetRowsPerStrip() const { return m_rowsPerStrip; }
+		uint32_t GetStripCount() const { return m_stripCount; }
+		size_t GetRowSize() const { return m_rowSize; }
+
+	private:
+		struct tiff* m_tif = nullptr;
+		std::string m_filepath;
+		uint32_t m_width = 0;
+		uint32_t m_height = 0;
+		TextureFormat m_format = MNSY_NONE;
+		uint16_t m_compression = 0; // libtiff tag
+		size_t m_rowSize = 0;		// in bytes
+		uint32_t m_rowsPerStrip = 0;
+		uint32_t m_stripCount = 0;
+		uint32_t m_writtenStrips = 0;
+		bool m_failed = false;
+	};
+
 
 } // ! namespace mnemosy::graphics
 
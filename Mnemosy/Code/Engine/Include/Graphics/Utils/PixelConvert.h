@@ -0,0 +1,63 @@
+#ifndef PIXEL_CONVERT_H
+#define PIXEL_CONVERT_H
+
+#include "Include/Graphics/TextureDefinitions.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+	Pixel conversions shared by the image readers and writers.
+
+	Convert() handles every pair of TextureFormat. Channels are expanded (gray to rgb, missing alpha becomes 1) or dropped,
+	samples are converted between 8 and 16 bit unsigned normalized, 16 bit half float and 32 bit float and a transfer function can be applied on the way.
+	There is one kernel per pair of sample types and color op, generated from a template.
+
+	The bulk work of the kernels (sample conversion, half floats, transfer functions) runs on the widest instruction set the cpu supports,
+	avx2 with f16c and fma, sse4.1 or plain c++. It is picked once at runtime so the build does not need any instruction set flags.
+	Transfer functions use polynomial approximations instead of pow(), they are exact to about 1e-6, well below the step of a 16 bit value.
+*/
+
+namespace mnemosy::graphics
+{
+	enum PixelColorOp {
+		MNSY_COLOR_OP_NONE				= 0,
+		MNSY_COLOR_OP_LINEAR_TO_SRGB	= 1,
+		MNSY_COLOR_OP_SRGB_TO_LINEAR	= 2
+	};
+
+	enum PixelSimdLevel {
+		MNSY_SIMD_SCALAR	= 0,
+		MNSY_SIMD_SSE41		= 1,
+		MNSY_SIMD_AVX2		= 2
+	};
+
+	class PixelConvert {
+	public:
+		// Converts pixelCount pixels from src to dst. 16 bit samples are half floats if the respective isHalfFloat is set.
+		// The color op is applied to the r, g and b channels but never to alpha.
+		// src and dst may be the same buffer if both formats have the same number of bytes per pixel.
+		static void Convert(const void* src, const TextureFormat srcFormat, const bool srcIsHalfFloat, void* dst, const TextureFormat dstFormat, const bool dstIsHalfFloat, const size_t pixelCount, const PixelColorOp colorOp);
+
+		// in place on every value of the buffer
+		static void LinearToSrgb(float* values, const size_t count);
+		static void SrgbToLinear(float* values, const size_t count);
+
+		static void HalfToFloat(const uint16_t* src, float* dst, const size_t count);
+		static void FloatToHalf(const float* src, uint16_t* dst, const size_t count);
+
+		// in place, converts 16 bit samples between big and little endian
+		static void SwapBytes16(uint16_t* values, const size_t count);
+
+		// single values, always computed without simd but with the same approximations
+		static float LinearToSrgb(const float value);
+		static float SrgbToLinear(const float value);
+		static float HalfToFloat(const uint16_t value);
+		static uint16_t FloatToHalf(const float value);
+
+		static PixelSimdLevel GetSimdLevel();
+	};
+
+} // ! namespace mnemosy::graphics
+
+#endif // !PIXEL_CONVERT_H
@@ -0,0 +1,33 @@
+#ifndef SHADER_BINARY_CACHE_H
+#define SHADER_BINARY_CACHE_H
+
+#include <string>
+#include <stdint.h>
+
+/*
+	Linked shader programs stored on disk with glGetProgramBinary, in Data/ShaderCache.
+	A program is found by a hash of its include expanded sources and the vendor, renderer and version strings of the driver,
+	so editing a shader, one of its includes or updating the driver simply misses the cache and the program is compiled again.
+
+	Drivers may still reject a binary they wrote themselves, then the file is deleted and the caller compiles from source.
+*/
+
+namespace mnemosy::graphics {
+
+	class ShaderBinaryCache {
+	public:
+		// stage is the first shader stage of the program, so the same sources used for different stages get different keys
+		static uint64_t MakeKey(const unsigned int stage, const std::string& firstStageSource, const std::string& fragmentSource);
+
+		// links the program from the cached binary, the program must not have shaders attached. false if there is no usable binary
+		static bool Load(const unsigned int program, const uint64_t key);
+		// call before linking so the driver keeps the binary around
+		static void PrepareForStore(const unsigned int program);
+		// writes the binary of a successfully linked program
+		static void Store(const unsigned int program, const uint64_t key);
+		static void Remove(const uint64_t key);
+	};
+
+} // !mnemosy::graphics
+
+#endif // !SHADER_BINARY_CACHE_H
@@ -11,6 +11,7 @@ namespace mnemosy::core
 	class Window;
 	class FileDirectories;
 	class DropHandler;
+	class JobSystem;
 }
 
 namespace mnemosy::systems
@@ -22,6 +23,7 @@ namespace mnemosy::systems
 	class TextureGenerationManager;
 	class ExportManager;
 	class MeshRegistry;
+	struct FolderNode;
 }
 
 namespace mnemosy::graphics
@@ -32,6 +34,7 @@ namespace mnemosy::graphics
 	class ImageBasedLightingRenderer;
 	class Scene;
 	class ThumbnailScene;
+	class TextureUploader;
 }
 
 namespace mnemosy::gui
@@ -56,16 +59,21 @@ namespace mnemosy
 
 		static MnemosyEngine& GetInstance();
 		
-		void Initialize(const char* WindowTitle);
+		void Initialize(const char* WindowTitle, const bool hiddenWindow = false);
 		void Run();
 		void Shutdown();
 
+		// Renders new thumbnails for all entries within the hierarchy of node without running the ui, returns false if any failed.
+		// Meant for the command line together with a hidden window.
+		bool RunThumbnailRegeneration(systems::FolderNode* node);
+
 
 		// Getters to the subsystems
 		core::Window& GetWindow()											{ return *m_pWindow; }
 		core::FileDirectories& GetFileDirectories()							{ return *m_pFileDirectories; }
 		core::Clock& GetClock()												{ return *m_pClock; }
 		core::DropHandler& GetDropHandler()									{ return *m_pDropHandler; }
+		core::JobSystem& GetJobSystem()										{ return *m_pJobSystem; }
 		
 		core::Logger& GetLogger() { return m_logger; }
 
@@ -81,6 +89,7 @@ namespace mnemosy
 		graphics::Renderer& GetRenderer() { return *m_pRenderer; }
 		graphics::Scene& GetScene() { return *m_pScene; }
 		graphics::ThumbnailScene& GetThumbnailScene() { return *m_pThumbnailScene; }
+		graphics::TextureUploader& GetTextureUploader() { return *m_pTextureUploader; }
 
 		gui::UserInterface& GetUserInterface() { return *m_pUserInterface; }
 
@@ -102,6 +111,7 @@ namespace mnemosy
 		core::FileDirectories* m_pFileDirectories;
 
 		core::DropHandler* m_pDropHandler;
+		core::JobSystem* m_pJobSystem = nullptr;
 		
 
 
@@ -120,6 +130,7 @@ namespace mnemosy
 
 		graphics::Scene* m_pScene;
 		graphics::ThumbnailScene* m_pThumbnailScene;
+		graphics::TextureUploader* m_pTextureUploader;
 
 		gui::UserInterface* m_pUserInterface;
 	
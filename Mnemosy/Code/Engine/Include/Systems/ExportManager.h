@@ -2,13 +2,19 @@
 #define EXPORT_MANAGER_H
 
 #include "Include/Graphics/TextureDefinitions.h"
+#include "Include/Systems/TiffStorageMigrator.h"
 
 
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <memory>
 //namespace fs = std::filesystem;
 
+namespace mnemosy::core {
+	class JobGroup;
+}
+
 namespace mnemosy::systems {
 	enum LibEntryType;
 	struct LibEntry;
@@ -21,6 +27,7 @@ namespace mnemosy::graphics
 	class PbrMaterial;
 	class Skybox;
 	class Texture;
+	struct PictureInfo;
 	enum NormalMapFormat;
 }
 
@@ -75,7 +82,18 @@ namespace mnemosy::systems
 		void SkyboxMat_ExportTextures(std::filesystem::path& exportFolderPath, systems::LibEntry* libEntry, graphics::Skybox& skyboxMat);
 
 
+		// Reads back the texture from the gpu on the calling thread and hands encoding and writing the file to the job system.
+		// Returns once the file is written unless called between BeginDeferredWrites() and EndDeferredWrites().
 		void GLTextureExport(const int glTextureID, TextureExportInfo& exportInfo);
+
+		// Writes a decoded picture without the gpu, converting it to the export format on the job system if needed.
+		// If sourceFilepath is a tiff already stored in the export format it is copied instead.
+		// The pixels are only read and must stay valid until the file is written, see GLTextureExport().
+		void PictureExport(const graphics::PictureInfo& pictureInfo, TextureExportInfo& exportInfo, const std::filesystem::path& sourceFilepath);
+
+		// Files exported in between are encoded and written in parallel. EndDeferredWrites() blocks until all of them are on disk.
+		void BeginDeferredWrites();
+		void EndDeferredWrites();
 		
 
 		// Export settings
@@ -89,11 +107,22 @@ namespace mnemosy::systems
 		void SetExportRoughnessAsSmoothness(bool exportRoughAsSmooth) { m_exportRoughnessAsSmoothness = exportRoughAsSmooth; }
 		bool GetExportRoughnessAsSmoothness() { return m_exportRoughnessAsSmoothness; }
 
+		// Compression of every tiff written, library textures as well as exports. Existing textures keep theirs until the migrator rewrites them.
+		graphics::TiffCompression GetTiffCompression() { return graphics::Picture::GetTiffCompression(); }
+		void SetTiffCompression(graphics::TiffCompression compression) { graphics::Picture::SetTiffCompression(compression); }
+
+		TiffStorageMigrator& GetTiffStorageMigrator() { return m_tiffStorageMigrator; }
+
 	private:
 		
 		graphics::ImageFileFormat m_exportFileFormat;
 		graphics::NormalMapFormat m_exportNormalFormat;
 		bool m_exportRoughnessAsSmoothness;
+
+		std::shared_ptr<core::JobGroup> m_pendingWrites;
+		unsigned int m_deferredWritesDepth = 0;
+
+		TiffStorageMigrator m_tiffStorageMigrator;
 	};
 
 
@@ -2,14 +2,22 @@
 #define FOLDER_TREE_H
 
 
+#include "Include/Systems/SearchIndex.h"
+#include "Include/Core/Utils/SlotMap.h"
+#include "Include/Core/Utils/PoolAllocator.h"
+#include "Include/Core/Utils/StringPool.h"
+#include "Include/Systems/FolderTreeNode.h"
+
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <json.hpp>
 
 namespace mnemosy::systems {
 	enum LibEntryType;
 	struct LibEntry;
 	struct FolderNode;
+	class LibraryIndex;
 }
 
 namespace mnemosy::systems {
@@ -46,12 +54,15 @@ namespace mnemosy::systems {
 
 		bool CollectMaterialsFromSearchKeyword(const std::string& searchKeyword);
 
-		FolderNode* RecursivGetNodeByID(FolderNode* startNode, const unsigned int id);
+		// nullptr if the folder or entry was deleted
+		FolderNode* GetNodeByID(const uint32_t id) { return m_folderSlots.Get(id); }
+		LibEntry* GetLibEntryByID(const uint32_t id) { return m_libEntrySlots.Get(id); }
 
 
 		std::string MakeNameUnique(const std::string& name);
 
 		void LoadFromJson(nlohmann::json& rootJson);
+		void LoadFromIndex(const LibraryIndex& index);
 		nlohmann::json* WriteToJson();
 		void Clear();
 
@@ -68,21 +79,55 @@ namespace mnemosy::systems {
 		void RecursivDeleteHierarchy(FolderNode* node);
 		//void RecursivUpdatePathFromRoot(FolderNode* node);
 
-		bool RecursivDoesNameExist(FolderNode* node, const std::string& name);
-
-		void RecursivCollectMaterialSearch(FolderNode* node, const std::string& searchKeyword);
+		void RegisterName_Internal(const std::string& name);
+		void UnregisterName_Internal(const std::string& name);
 
 		nlohmann::json RecursivWriteToJson(FolderNode* node);
 		void RecursivLoadFromJson(FolderNode* node, const nlohmann::json& jsonNode);
 
+		// The children of all folders, every folder owns a range of a power of two slots in here, enough for its count.
+		// A range that outgrows its slots grows in place at the end of the array or moves there, leaving its old slots unused.
+		template<typename T>
+		struct ChildArray {
+			std::vector<T*> slots;
+			size_t usedSlots = 0; // slots owned by a range, the rest were left behind by ranges that moved or shrank
+		};
+
+		template<typename T>
+		void AddChild_Internal(FolderChildRange<T>& range, ChildArray<T>& array, T* child);
+		template<typename T>
+		void RemoveChild_Internal(FolderChildRange<T>& range, ChildArray<T>& array, const size_t position);
+		template<typename T>
+		void ClearChildren_Internal(FolderChildRange<T>& range, ChildArray<T>& array);
+		// lays the ranges of both arrays out again depth first without unused slots
+		void CompactChildArrays_Internal();
+
 
 	private:
-		unsigned int m_runtimeIDCounter;
-		unsigned int m_runtimeMaterialIDCounter;
+		// all folders and entries of the tree live in these pools, declared before everything that points into them
+		core::PoolAllocator<FolderNode, 256> m_folderPool;
+		core::PoolAllocator<LibEntry> m_libEntryPool;
+
+		// runtime ids of folders and entries are handles into these
+		core::SlotMap<FolderNode> m_folderSlots;
+		core::SlotMap<LibEntry> m_libEntrySlots;
+
+		// names of all folders and entries, renamed ones keep their old string until Clear()
+		core::StringPool m_namePool;
+
+		ChildArray<FolderNode> m_childNodes;
+		ChildArray<LibEntry> m_childEntries;
 
 		//std::string m_treeName;
 		FolderNode* m_rootNode = nullptr;
 
+		// names are unique across all folders and entries ignoring case.
+		// lower case name -> how many folders and entries use it, more than one only happens with data files written by older versions
+		std::unordered_map<std::string, unsigned int> m_nameUseCounts;
+		// lower case base name -> last suffix MakeNameUnique() handed out for it, so colliding names do not probe from 1 again
+		std::unordered_map<std::string, unsigned int> m_nameSuffixCounters;
+
+		SearchIndex m_searchIndex;
 		std::vector<LibEntry*> m_searchResults;
 
 	}; 
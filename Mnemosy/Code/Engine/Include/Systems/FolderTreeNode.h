@@ -2,6 +2,9 @@
 #define FOLDER_TREE_NODE_H
 
 
+#include "Include/Core/Utils/StringPool.h"
+
+#include <stdint.h>
 #include <vector>
 #include <string>
 #include <filesystem>
@@ -21,34 +24,61 @@ namespace mnemosy::systems
 
 	// Runtime id  is assigned at runtime when material gets created and never changes until the app closes
 
+	// Folders and entries only hold what walking and drawing the tree needs. Their names live in the string pool of the FolderTree
+	// and the children of every folder in one of its child arrays, so a walk over the tree touches a few small objects and contiguous child lists.
+
 	struct FolderNode;
+	class FolderTree;
+
+	// The children of a folder, a range of one of the child arrays of the FolderTree. Only the tree changes it.
+	// Adding a child anywhere in the tree may move the arrays: pointers from begin() and end() are only valid until then, loops that change the tree go by index.
+	template<typename T>
+	class FolderChildRange {
+	public:
+		T* const* begin() const { return m_storage ? m_storage->data() + m_first : nullptr; }
+		T* const* end() const { return begin() + m_count; }
+
+		size_t size() const { return m_count; }
+		bool empty() const { return m_count == 0; }
+
+		T* operator[](const size_t index) const { return (*m_storage)[m_first + index]; }
+		T* back() const { return (*m_storage)[m_first + m_count - 1]; }
 
-	struct LibEntry { // 56 bytes wasting 4 bytes padding
+	private:
+		friend class FolderTree;
+		friend struct FolderNode;
+
+		std::vector<T*>* m_storage = nullptr; // nullptr while the folder never had children of this kind
+		uint32_t m_first = 0;
+		uint32_t m_count = 0;
+	};
+
+	struct LibEntry { // 40 bytes wasting 6 bytes padding
 	public:
 		FolderNode* parent = nullptr; // 8
+		core::InternedString name; // 8  set through the FolderTree which owns the string
 		LibEntryType type; // 4
-		
-		uint16_t runtime_ID; // 2
+
+		uint32_t runtime_ID = 0; // 4  handle, resolved by FolderTree::GetLibEntryByID()
+		unsigned int thumbnailTexure_ID = 0; // 4  atlas page the thumbnail lives in
+		uint32_t thumbnailAtlasTile = 0; // 4  small tiles give a page more tiles than fit into 16 bits
 		bool selected = false; // 1
 		bool thumbnailLoaded = false; // 1
-		unsigned int thumbnailTexure_ID = 0; // 4
-		std::string name; // 32
 
 
 		std::filesystem::path GetPathFromRoot();
 	};
 
-	struct FolderNode { // 128 bytes wasting 6 bytes padding
+	struct FolderNode { // 56 bytes wasting 4 bytes padding
 	public:
 
-		std::string name; // 32
-		FolderNode* parent; // 8
+		FolderNode* parent = nullptr; // 8
+		core::InternedString name; // 8  set through the FolderTree which owns the string
 
-		// consider if we can get rid of runtime id
-		uint16_t runtime_ID; // 2
+		FolderChildRange<FolderNode> subNodes; // 16
+		FolderChildRange<LibEntry> subEntries; // 16
 
-		std::vector<FolderNode*> subNodes; // 24
-		std::vector<LibEntry*> subEntries; // 24
+		uint32_t runtime_ID = 0; // 4  handle, resolved by FolderTree::GetNodeByID()
 
 
 		// we could potentially replace this with a method walking up parents and constructing the pathFromRoot dynamically.
@@ -25,6 +25,17 @@ namespace mnemosy::systems {
 #define jsonLibKey_materialEntries	"6_materialEntries"		// std::vector<std::string> - list of names of the materials contained
 #define jsonLibKey_entryTypes		"6_entryTypes"			// std::vector<int> - list of enum type LibEntryType stored as integers
 
+#define jsonLibKey_JournalSequence	"4_JournalSequence"		// uint64_t - sequence of the last journal operation contained in the file
+
+// json identifiers for the operations of the library journal, one json object per line
+#define jsonJournalKey_sequence		"seq"					// uint64_t - increasing number of the operation
+#define jsonJournalKey_operation	"op"					// int - enum type LibraryJournalOperation stored as integer
+#define jsonJournalKey_folder		"folder"				// std::vector<std::string> - names of the folders from root to the folder containing the changed folder or entry
+#define jsonJournalKey_name			"name"					// std::string - name of the changed folder or entry before the change
+#define jsonJournalKey_newName		"newName"				// std::string - name after a rename
+#define jsonJournalKey_target		"target"				// std::vector<std::string> - names of the folders from root to the folder a move goes into
+#define jsonJournalKey_entryType	"type"					// int - enum type LibEntryType of a created entry stored as integer
+
 
 // global keys
 
@@ -0,0 +1,72 @@
+#ifndef LIBRARY_FILE_CACHE_H
+#define LIBRARY_FILE_CACHE_H
+
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <stdint.h>
+
+/*
+	Listing of the files in the entry folders of the active library collection.
+	Opening a material or loading a thumbnail asks this cache whether its files exist instead of probing every file with its own stat call,
+	one directory listing returns the names, sizes and write times of all files in a folder at once.
+
+	When a collection is opened its entry folders are listed by jobs in the background, a folder that is asked for before a job got to it is listed right away.
+	A listing is trusted as long as the write time of its folder does not change, which it does whenever a file in it is created, deleted or renamed.
+	That check costs one stat per folder and is done at most once per frame, code that changes files and reads them back in the same frame calls InvalidateFolder().
+*/
+
+namespace mnemosy::core {
+	class JobGroup;
+}
+
+namespace mnemosy::systems {
+
+	struct CachedFileInfo {
+		uint64_t size = 0;
+		int64_t time = 0;	// last write time, same representation as ThumbnailStamp::time
+	};
+
+	class LibraryFileCache {
+	public:
+		LibraryFileCache() = default;
+		~LibraryFileCache() = default;
+
+		// lists the folders on job threads
+		void Prewarm(const std::vector<std::filesystem::path>& folderPaths);
+		// cancels prewarming and forgets all listings
+		void Clear();
+		// listings are revalidated at most once per frame, called once per frame
+		void Update();
+
+		bool Exists(const std::filesystem::path& filePath);
+		bool GetFileInfo(const std::filesystem::path& filePath, CachedFileInfo& outInfo);
+		// the folder is listed again on the next query
+		void InvalidateFolder(const std::filesystem::path& folderPath);
+
+	private:
+		struct CachedFolder {
+			bool exists = false;
+			int64_t time = 0;
+			uint64_t validatedFrame = 0;	// 0 if it was never validated on the main thread
+			std::unordered_map<std::filesystem::path::string_type, CachedFileInfo> files;
+		};
+
+		static void ListFolder_Internal(const std::filesystem::path& folderPath, CachedFolder& outFolder);
+		// returns a listing that is valid for this frame, the lock is released while the disk is accessed
+		CachedFolder& GetValidFolder_Internal(std::unique_lock<std::mutex>& lock, const std::filesystem::path& folderPath);
+
+		std::mutex m_mutex;
+		// keyed by the normalized folder path
+		std::unordered_map<std::filesystem::path::string_type, CachedFolder> m_folders;
+		std::atomic<uint64_t> m_frame = 1; // advanced by the main thread, read by loader jobs
+
+		std::shared_ptr<core::JobGroup> m_prewarmJobs;
+	};
+
+} // !mnemosy::systems
+
+#endif // !LIBRARY_FILE_CACHE_H
@@ -0,0 +1,79 @@
+#ifndef LIBRARY_INDEX_H
+#define LIBRARY_INDEX_H
+
+#include "Include/Core/Utils/MappedFile.h"
+
+#include <filesystem>
+#include <string_view>
+#include <vector>
+#include <stdint.h>
+
+/*
+	Binary copy of the folder tree stored in the data file of a library collection, MnemosyMaterialLibraryData.mnsyindex next to it.
+	Switching collections maps the index and builds the tree straight from its records instead of parsing the json data file.
+
+	Layout: a header, the folder records in depth first order so every parent comes before its children, the entry records grouped by folder
+	and a table of all names the records point into. The root is always the first folder.
+
+	The data file stays the source of truth. The header stores the size and write time of the data file the index was made from and a checksum of everything after the header,
+	an index that does not match its data file is ignored and rewritten after the json was parsed.
+*/
+
+namespace mnemosy::systems {
+	struct FolderNode;
+}
+
+namespace mnemosy::systems {
+
+	struct LibraryIndexFolder {
+		uint32_t parent;		// index of the parent folder, unused for the root
+		uint32_t nameOffset;	// into the name table
+		uint32_t nameLength;
+		uint32_t firstEntry;
+		uint32_t entryCount;
+	};
+
+	struct LibraryIndexEntry {
+		uint32_t nameOffset;
+		uint32_t nameLength;
+		uint32_t type;			// LibEntryType
+	};
+
+	class LibraryIndex {
+	public:
+		LibraryIndex() = default;
+		~LibraryIndex() = default;
+
+		static std::filesystem::path GetPathForDataFile(const std::filesystem::path& dataFilePath);
+
+		// serializes the tree below the root node, journalSequence is the one stored in the data file the tree is written to
+		static void Build(FolderNode* rootNode, const uint64_t journalSequence, std::vector<uint8_t>& outBuffer);
+		// stamps the buffer with the current version of the data file and replaces the index next to it
+		static bool Write(const std::filesystem::path& dataFilePath, std::vector<uint8_t>& buffer);
+
+		// maps the index of the data file, false if there is none or it is damaged or outdated
+		bool Open(const std::filesystem::path& dataFilePath);
+		void Close();
+
+		uint64_t GetJournalSequence() const;
+		uint32_t GetFolderCount() const { return m_folderCount; }
+		uint32_t GetEntryCount() const { return m_entryCount; }
+		const LibraryIndexFolder& GetFolder(const uint32_t index) const { return m_folders[index]; }
+		const LibraryIndexEntry& GetEntry(const uint32_t index) const { return m_entries[index]; }
+		std::string_view GetName(const uint32_t offset, const uint32_t length) const { return std::string_view(m_names + offset, length); }
+
+	private:
+		bool Validate_Internal(const std::filesystem::path& dataFilePath);
+
+		core::MappedFile m_file;
+
+		const LibraryIndexFolder* m_folders = nullptr;
+		const LibraryIndexEntry* m_entries = nullptr;
+		const char* m_names = nullptr;
+		uint32_t m_folderCount = 0;
+		uint32_t m_entryCount = 0;
+	};
+
+} // !mnemosy::systems
+
+#endif // !LIBRARY_INDEX_H
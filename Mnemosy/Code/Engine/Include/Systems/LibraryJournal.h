@@ -0,0 +1,102 @@
+#ifndef LIBRARY_JOURNAL_H
+#define LIBRARY_JOURNAL_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <filesystem>
+#include <json.hpp>
+
+/*
+	Append only journal of the changes made to the folder tree of a library collection since its data file was last written.
+	Every create, rename, move and delete appends one json line to MnemosyMaterialLibraryData.mnsyjournal instead of rewriting the whole data file,
+	so saving a change costs as much as the change and not as much as the library.
+
+	Operations carry an increasing sequence number and the data file stores the sequence of the last operation it contains.
+	When a collection is loaded the operations newer than the data file are replayed onto the tree, a line that was only partly written when the app crashed is skipped.
+
+	Once enough operations are journaled the tree is compacted: it is serialized on the main thread, then written to a temporary file and renamed over the data file by a job.
+	The journal is cut down to the operations the new data file does not contain only after the rename, so a crash at any point leaves either the old or the new data file plus a journal that matches it.
+*/
+
+namespace mnemosy::systems {
+	struct LibEntry;
+	struct FolderNode;
+	class FolderTree;
+}
+namespace mnemosy::core {
+	class JobGroup;
+}
+
+namespace mnemosy::systems {
+
+	enum LibraryJournalOperation {
+		MNSY_JOURNAL_OP_FOLDER_CREATE	= 0,
+		MNSY_JOURNAL_OP_FOLDER_RENAME	= 1,
+		MNSY_JOURNAL_OP_FOLDER_MOVE		= 2,
+		MNSY_JOURNAL_OP_FOLDER_DELETE	= 3,
+		MNSY_JOURNAL_OP_ENTRY_CREATE	= 4,
+		MNSY_JOURNAL_OP_ENTRY_RENAME	= 5,
+		MNSY_JOURNAL_OP_ENTRY_MOVE		= 6,
+		MNSY_JOURNAL_OP_ENTRY_DELETE	= 7
+	};
+
+	class LibraryJournal {
+	public:
+		LibraryJournal() = default;
+		~LibraryJournal() = default;
+
+		// starts journaling the tree loaded from the data file and replays the operations the data file does not contain yet
+		void Open(const std::filesystem::path& dataFilePath, FolderTree& folderTree, const uint64_t dataFileSequence);
+		// waits for a running compaction, does not write the tree
+		void Close();
+		bool IsOpen() const { return !m_dataFilePath.empty(); }
+
+		// finishes background compactions and starts one if enough operations are journaled, called once per frame
+		void Update(FolderTree& folderTree);
+		// writes the whole tree to the data file right away
+		bool Compact(FolderTree& folderTree);
+
+		// call after the change was made
+		void FolderCreated(FolderNode* node);
+		void FolderRenamed(FolderNode* node, const std::string& oldName);
+		void FolderMoved(FolderNode* node, FolderNode* oldParent);
+		void LibEntryCreated(LibEntry* libEntry);
+		void LibEntryRenamed(LibEntry* libEntry, const std::string& oldName);
+		void LibEntryMoved(LibEntry* libEntry, FolderNode* oldParent);
+		// call before the folder or entry is deleted from the tree
+		void FolderDeleted(FolderNode* node);
+		void LibEntryDeleted(LibEntry* libEntry);
+
+	private:
+		struct PendingOperation {
+			uint64_t sequence = 0;
+			std::string line;
+		};
+
+		struct Compaction;
+
+		void Append_Internal(nlohmann::json& operation);
+		void StartCompaction_Internal(FolderTree& folderTree, const bool runOnThisThread);
+		bool FinishCompaction_Internal();
+		bool RewriteJournalFile_Internal();
+		// runs on a job thread unless the compaction was started on this one
+		static void WriteSnapshot_Internal(Compaction& compaction);
+
+		std::filesystem::path m_dataFilePath;
+		std::filesystem::path m_journalFilePath;
+		std::ofstream m_journalStream;
+
+		uint64_t m_sequence = 0;
+		// operations that are not in the data file yet, in the order they were made
+		std::vector<PendingOperation> m_pendingOperations;
+		size_t m_compactAfterOperations = 0;
+
+		std::shared_ptr<Compaction> m_compaction;
+	};
+
+} // !mnemosy::systems
+
+#endif // !LIBRARY_JOURNAL_H
@@ -1,8 +1,13 @@
 #ifndef LIBRARY_PROCEDURES_H
 #define LIBRARY_PROCEDURES_H
 
+#include "Include/Graphics/Utils/Picture.h"
+#include "Include/Graphics/TextureUploader.h"
+
 #include <string>
 #include <filesystem>
+#include <memory>
+#include <atomic>
 
 
 namespace mnemosy::systems {
@@ -11,6 +16,10 @@ namespace mnemosy::systems {
 	struct FolderNode;
 }
 
+namespace mnemosy::core {
+	class JobGroup;
+}
+
 namespace mnemosy::graphics {
 	class UnlitMaterial;
 	class Skybox;
@@ -19,6 +28,27 @@ namespace mnemosy::graphics {
 
 namespace mnemosy::systems {
 
+	// Decode state of a pbr material whose textures are still being read by the job system.
+	// Jobs hold a shared_ptr to it so it stays valid if the load gets cancelled while decodes are still running.
+	// Each slot is streamed in two steps, a small preview level right after decoding and the full texture (limited to maxResolution) in a later frame.
+	struct PbrMaterialLoadState {
+		// textures of unfinished uploads must be deleted on the main thread with LibEntry_PbrMaterial_CancelUploads() first
+		~PbrMaterialLoadState();
+
+		std::shared_ptr<core::JobGroup> jobs;
+		uint16_t maxResolution = 0; // longest side of uploaded textures, 0 means no limit
+
+		graphics::PictureError errors[graphics::PBRTextureType::MNSY_TEXTURE_COUNT];
+		graphics::TextureUpload uploads[graphics::PBRTextureType::MNSY_TEXTURE_COUNT];	// decoded picture, staged in the upload ring if there was space
+		graphics::PictureInfo previews[graphics::PBRTextureType::MNSY_TEXTURE_COUNT];		// empty if the picture is small enough to upload right away
+		uint16_t sourceWidth[graphics::PBRTextureType::MNSY_TEXTURE_COUNT] = {};
+		uint16_t sourceHeight[graphics::PBRTextureType::MNSY_TEXTURE_COUNT] = {};
+		std::atomic<bool> decoded[graphics::PBRTextureType::MNSY_TEXTURE_COUNT] = {};	// set by the job once all of the above is written for the slot
+		std::atomic<bool> previewDecoded[graphics::PBRTextureType::MNSY_TEXTURE_COUNT] = {};	// set before decoded if the file stored a reduced level, previews and the source size are written then
+		bool pending[graphics::PBRTextureType::MNSY_TEXTURE_COUNT] = {};				// slot is waiting to be uploaded, main thread only
+		bool previewUploaded[graphics::PBRTextureType::MNSY_TEXTURE_COUNT] = {};		// main thread only
+	};
+
 
 	class LibProcedures {
 	public:
@@ -37,7 +67,8 @@ namespace mnemosy::systems {
 		static void LibEntry_SkyboxMaterial_CreateNewDataFile( systems::LibEntry* libEntry,bool prettyPring);
 
 		// save the material data for libEntry to its meta data file.
-		static void LibEntry_PbrMaterial_SaveToFile(systems::LibEntry* libEntry, graphics::PbrMaterial* pbrMat,bool prettyPrint);
+		// loadState may be null, if set textures that are still decoding are written as assigned.
+		static void LibEntry_PbrMaterial_SaveToFile(systems::LibEntry* libEntry, graphics::PbrMaterial* pbrMat, const PbrMaterialLoadState* loadState, bool prettyPrint);
 		static void LibEntry_UnlitMaterial_SaveToFile(systems::LibEntry* libEntry, graphics::UnlitMaterial* unlitMat,bool prettyPrint);
 		static void LibEntry_SkyboxMaterial_SaveToFile(systems::LibEntry* libEntry, graphics::Skybox* skybox,bool prettyPrint);
 		
@@ -48,10 +79,29 @@ namespace mnemosy::systems {
 		static void LibEntry_SkyboxMaterial_RenameFiles(LibEntry* libEntry, std::filesystem::path& entryFolderOldNamePath, std::string& oldName, bool prettyPrint);
 
 		// load libEntry material from file and return it
-		static graphics::PbrMaterial* LibEntry_PbrMaterial_LoadFromFile_Multithreaded(systems::LibEntry* libEntry, bool prettyPrint);
+		// maxResolution limits the longest side of the uploaded textures, 0 loads them at full resolution
+		static graphics::PbrMaterial* LibEntry_PbrMaterial_LoadFromFile_Multithreaded(systems::LibEntry* libEntry, bool prettyPrint, const uint16_t maxResolution);
+		// returns the material with its values but without textures, the textures are decoded by jobs tracked in outLoadState.
+		// background loads submit their jobs with low priority so they do not hold up materials the user opens.
+		static graphics::PbrMaterial* LibEntry_PbrMaterial_LoadFromFile_Async(systems::LibEntry* libEntry, bool prettyPrint, const uint16_t maxResolution, std::shared_ptr<PbrMaterialLoadState>& outLoadState, const bool background = false);
+		// uploads the preview of every texture that finished decoding since the last call and continues the full uploads with up to maxUploadBytes.
+		// SIZE_MAX uploads everything right away. Returns true once no texture is pending anymore. Main thread only.
+		static bool LibEntry_PbrMaterial_UploadDecodedTextures(graphics::PbrMaterial& pbrMat, PbrMaterialLoadState& loadState, const size_t maxUploadBytes);
+		// deletes textures of uploads that were started but not finished. Main thread only.
+		static void LibEntry_PbrMaterial_CancelUploads(PbrMaterialLoadState& loadState);
+		// reloads every texture of pbrMat that was downscaled while loading at the full resolution of its file. Blocks until they are uploaded.
+		static void LibEntry_PbrMaterial_LoadFullResolutionTextures(systems::LibEntry* libEntry, graphics::PbrMaterial& pbrMat);
+		// reads one texture of a pbr material at full resolution from its mip chain cache, or from the texture file if the cache is missing or outdated.
+		// rows are stored bottom to top like the uploaded textures. Safe to call from job threads. outPicInfo.pixels has to be freed by the caller.
+		static void PbrMaterial_ReadTexture(graphics::PictureError& outPictureError, graphics::PictureInfo& outPicInfo, const std::filesystem::path& materialDir, const std::string& entryName, const graphics::PBRTextureType type);
+		// Identifies the version of a texture file its mip chain cache was built from, empty if the file can't be accessed. All stamps have the same length.
+		static std::string PbrMaterial_GetTextureSourceStamp(const std::filesystem::path& texturePath);
+		// Moves every mip chain cache in materialDir that was built from the file version oldStamp over to newStamp,
+		// for a texture that was rewritten without changing its pixels. Returns the number of caches that were updated.
+		static uint32_t PbrMaterial_RestampTextureCaches(const std::filesystem::path& materialDir, const std::string& oldStamp, const std::string& newStamp);
 		static graphics::UnlitMaterial* LibEntry_UnlitMaterial_LoadFromFile(systems::LibEntry* libEntry, bool prettyPrint);
 		// uses different interface because skybox regestry wants to use the same method essentially for loading preview skyboxes but they are not libEntries
-		static graphics::Skybox* LibEntry_SkyboxMaterial_LoadFromFile(std::filesystem::path& folderPath,std::string& name, bool prettyPrint);
+		static graphics::Skybox* LibEntry_SkyboxMaterial_LoadFromFile(std::filesystem::path& folderPath,const std::string& name, bool prettyPrint);
 
 	};
 
@@ -1,18 +1,25 @@
 #ifndef MATERIAL_LIBRARY_REGISTRY_H
 #define MATERIAL_LIBRARY_REGISTRY_H
 
+#include "Include/Systems/LibraryJournal.h"
+#include "Include/Systems/LibraryFileCache.h"
+#include "Include/Core/Utils/FileWatcher.h"
+
 #include <vector>
 #include <string>
 #include <filesystem>
+#include <memory>
 
 namespace mnemosy::systems {
 	enum LibEntryType;
 	struct LibEntry;
 	struct FolderNode;
 	class FolderTree;
+	struct PbrMaterialLoadState;
 }
 namespace mnemosy::core {
 	class FileDirectories;
+	class JobGroup;
 }
 namespace mnemosy::graphics {
 	enum PBRTextureType;
@@ -40,6 +47,8 @@ namespace mnemosy::systems
 
 		void Init();
 		void Shutdown();
+		// swaps in textures of the active entry as their decode jobs finish and compacts the library journal, called once per frame
+		void Update();
 
 		void SaveCurrentSate();
 
@@ -59,9 +68,13 @@ namespace mnemosy::systems
 		
 		void LibEntry_Load(systems::LibEntry* libEntry);
 
-		bool IsActiveEntry(uint16_t runtimeID);
+		bool IsActiveEntry(uint32_t runtimeID);
 		systems::LibEntry* ActiveLibEntry_Get() { return m_activeLibEntry; }
 		void ActiveLibEntry_SaveToFile();
+		// blocks until all textures of the active entry are loaded. Call before anything that needs the complete material or touches its files.
+		// fullResolution also replaces textures that were downscaled for the preview, needed for exports and texture generation.
+		void ActiveLibEntry_FinishLoading(const bool fullResolution);
+		bool ActiveLibEntry_IsLoading() { return m_activePbrMatLoad != nullptr; }
 
 		std::vector<std::string> ActiveLibEntry_GetTexturePaths();
 
@@ -89,8 +102,10 @@ namespace mnemosy::systems
 
 		// Getters
 		FolderNode* GetRootFolder();
-		FolderNode* GetFolderByID(FolderNode* node, const unsigned int id);
+		FolderNode* GetFolderByID(const uint32_t id);
+		LibEntry* GetLibEntryByID(const uint32_t id);
 		FolderNode* GetSelectedNode() { return m_selectedFolderNode; }
+		LibraryFileCache& GetFileCache() { return m_fileCache; }
 		
 		std::filesystem::path Folder_GetFullPath(FolderNode* node);
 
@@ -123,6 +138,10 @@ namespace mnemosy::systems
 		const bool LibCollection_LoadIntoActiveTree(std::filesystem::path& folderPath);
 		void ActiveLibCollection_SaveToFile();
 		void ActiveLibCollection_Unload();
+		void ActiveLibCollection_PrewarmFileCache();
+		void ActiveLibCollection_ProcessFileChanges();
+
+		void ActiveLibEntry_CancelLoading();
 		
 		void LibCollections_SaveToFile();
 		void LibCollections_LoadFromFile();
@@ -134,11 +153,22 @@ namespace mnemosy::systems
 		int m_libCollection_currentSlected_id = -1; // if -1 it means none is selected
 
 		FolderTree* m_folderTree = nullptr;
+		// changes to the tree since the data file of the active collection was last written
+		LibraryJournal m_journal;
+		// files in the entry folders of the active collection
+		LibraryFileCache m_fileCache;
+		// reports files of the active collection that were changed, also by other programs
+		core::FileWatcher m_libraryWatcher;
 		core::FileDirectories* m_fileDirectories = nullptr;
 		FolderNode* m_selectedFolderNode = nullptr;
 
 		systems::LibEntry* m_activeLibEntry = nullptr;
 		systems::LibEntryType m_lastActiveMaterialLibEntry;
+
+		// textures of the active pbr entry that are still decoding
+		std::shared_ptr<PbrMaterialLoadState> m_activePbrMatLoad;
+		// jobs of cancelled loads, they may still be running and reading files of their entry
+		std::vector<std::shared_ptr<core::JobGroup>> m_cancelledLoadJobs;
 		
 		// data file 
 		bool prettyPrintDataFile = false;
@@ -0,0 +1,69 @@
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/*
+	Trigram index over the names of all lib entries of a folder tree, kept up to date by the FolderTree whenever entries are created, renamed or deleted.
+	Moving an entry does not change its name so the index does not care about it.
+
+	A search only looks at the entries of the rarest trigram of the keyword and checks those for the full substring,
+	so its cost depends on how many entries share that trigram and not on the size of the library.
+	Keywords that extend the previous one only check the previous results.
+
+	Removed entries leave stale ids in the trigram lists, they are skipped during searches and dropped once there are more stale than live ids.
+*/
+
+namespace mnemosy::systems {
+	struct LibEntry;
+}
+
+namespace mnemosy::systems {
+
+	class SearchIndex {
+	public:
+		SearchIndex() = default;
+		~SearchIndex() = default;
+
+		void Add(LibEntry* libEntry);
+		void Remove(LibEntry* libEntry);
+		// call after the name of the entry changed
+		void Rename(LibEntry* libEntry);
+		void Clear();
+
+		// collects all entries whose name contains the keyword, ignoring case
+		void Search(const std::string& keyword, std::vector<LibEntry*>& outResults);
+
+	private:
+		struct Slot {
+			LibEntry* libEntry = nullptr; // nullptr if the slot is free
+			std::string lowerName;
+			uint32_t searchStamp = 0; // to skip ids that are listed more than once under a trigram
+		};
+
+		bool MatchSlot_Internal(const uint32_t slot, const std::string& lowerKeyword);
+		void AddPostings_Internal(const uint32_t slot);
+		void RebuildPostings_Internal();
+
+		std::vector<Slot> m_slots;
+		std::vector<uint32_t> m_freeSlots;
+		std::unordered_map<LibEntry*, uint32_t> m_slotOfEntry;
+		std::unordered_map<uint32_t, std::vector<uint32_t>> m_postings; // trigram -> slots of the entries containing it
+
+		size_t m_livePostingsCount = 0;
+		size_t m_stalePostingsCount = 0;
+		uint32_t m_searchStamp = 0;
+
+		// the last search, used to narrow down the next one if the index did not change in between
+		uint64_t m_version = 0;
+		uint64_t m_lastSearchVersion = 0;
+		std::string m_lastKeyword;
+		std::vector<uint32_t> m_lastResultSlots;
+	};
+
+} // !mnemosy::systems
+
+#endif // !SEARCH_INDEX_H
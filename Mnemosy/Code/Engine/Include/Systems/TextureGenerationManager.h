@@ -2,6 +2,7 @@
 #define TEXTURE_GENERATION_MANAGER_H
 
 #include <filesystem>
+#include <string>
 
 namespace fs = std::filesystem;
 
@@ -36,6 +37,10 @@ namespace mnemosy::systems
 
 		bool GenerateChannelPackedTexture(graphics::PbrMaterial& material, const char* exportPath, bool exportTexture, graphics::ChannelPackType packType, graphics::ChannelPackComponent packComponent_R, graphics::ChannelPackComponent packComponent_G, graphics::ChannelPackComponent packComponent_B, graphics::ChannelPackComponent packComponent_A, unsigned int width, unsigned int height,uint8_t bitDepth);
 
+		// Same as GenerateChannelPackedTexture() but packs on the cpu from the texture files in materialDir (or their decoded caches) and always writes a .tif file.
+		// Needs no openGl context and keeps the full resolution of the files. Returns false if a texture could not be read or the file could not be written.
+		bool GenerateChannelPackedTexture_Cpu(graphics::PbrMaterial& material, const fs::path& materialDir, const std::string& entryName, const char* exportPath, graphics::ChannelPackType packType, graphics::ChannelPackComponent packComponent_R, graphics::ChannelPackComponent packComponent_G, graphics::ChannelPackComponent packComponent_B, graphics::ChannelPackComponent packComponent_A, unsigned int width, unsigned int height, uint8_t bitDepth);
+
 
 		unsigned int GetRenderTextureID() { return m_renderTexture_ID; }
 
@@ -0,0 +1,98 @@
+#ifndef THUMBNAIL_BATCH_REGENERATOR_H
+#define THUMBNAIL_BATCH_REGENERATOR_H
+
+#include "Include/Core/Utils/MpscQueue.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+/*
+	Renders new thumbnails for every entry of a folder hierarchy, e.g. after the thumbnail resolution or the thumbnail scene changed.
+
+	Each entry goes through three stages that run at the same time for different entries:
+	1. the textures of the material are decoded by the job system, a few materials ahead of the one being rendered
+	2. the main thread renders the thumbnail and starts an asynchronous read back into a pixel buffer
+	3. once the read back arrived the pixels are encoded to ktx2 and written by a worker
+
+	Update() is driven by the ThumbnailManager while the app runs, or in a loop by MnemosyEngine::RunThumbnailRegeneration() without a visible window.
+*/
+
+namespace mnemosy::systems {
+	struct LibEntry;
+	struct FolderNode;
+	struct PbrMaterialLoadState;
+}
+namespace mnemosy::graphics {
+	class PbrMaterial;
+}
+namespace mnemosy::core {
+	class JobGroup;
+}
+
+namespace mnemosy::systems {
+
+	class ThumbnailBatchRegenerator {
+	public:
+		ThumbnailBatchRegenerator() = default;
+		~ThumbnailBatchRegenerator() = default;
+
+		void Shutdown();
+
+		// collects all entries within the hierarchy of node, does nothing if a batch is already running
+		void Start(FolderNode* node);
+		void Cancel();
+
+		// Main thread. Advances the batch until budgetSeconds are used up.
+		void Update(const double budgetSeconds);
+
+		bool IsRunning() const { return m_isRunning; }
+		uint32_t GetTotalCount() const { return (uint32_t)m_entries.size(); }
+		uint32_t GetFinishedCount() const { return m_finishedCount; }
+		uint32_t GetFailedCount() const { return m_failedCount; }
+
+	private:
+		struct LoadingEntry {
+			LibEntry* libEntry = nullptr;
+			graphics::PbrMaterial* pbrMat = nullptr;
+			std::shared_ptr<PbrMaterialLoadState> loadState;
+		};
+
+		struct Readback {
+			LibEntry* libEntry = nullptr;
+			std::filesystem::path thumbnailPath;
+			unsigned int bufferID = 0;
+			void* fence = nullptr;
+			uint16_t resolution = 0;
+		};
+
+		void StartLoading_Internal(LibEntry* libEntry);
+		bool RenderThumbnail_Internal(LoadingEntry& entry);
+		void StartReadback_Internal(LibEntry* libEntry);
+		bool FinishReadback_Internal(Readback& readback, const bool wait);
+		void CollectEntries_Internal(FolderNode* node);
+		void Finish_Internal();
+
+		bool m_isRunning = false;
+
+		std::vector<LibEntry*> m_entries;
+		size_t m_nextEntry = 0;
+
+		std::deque<LoadingEntry> m_loading;		// stage 1, in the order they are rendered
+		std::deque<Readback> m_readbacks;		// stage 2, waiting for the gpu
+		std::vector<unsigned int> m_freeBuffers;
+
+		std::shared_ptr<core::JobGroup> m_encodeJobs; // stage 3
+		core::MpscQueue<LibEntry*> m_encodedEntries;
+
+		std::atomic<uint32_t> m_finishedCount = 0;
+		std::atomic<uint32_t> m_failedCount = 0;
+		double m_startTime = 0.0;
+	};
+
+} // !mnemosy::systems
+
+#endif // !THUMBNAIL_BATCH_REGENERATOR_H
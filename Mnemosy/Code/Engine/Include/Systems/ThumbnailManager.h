@@ -1,8 +1,16 @@
 #ifndef THUMBNAIL_MANAGER_H
 #define THUMBNAIL_MANAGER_H
 
+#include "Include/Systems/ThumbnailPack.h"
+#include "Include/Systems/ThumbnailBatchRegenerator.h"
+#include "Include/Core/Utils/MpscQueue.h"
+
 #include <filesystem>
+#include <memory>
+#include <string>
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
 
 
 namespace mnemosy::systems {
@@ -12,6 +20,9 @@ namespace mnemosy::systems {
 namespace mnemosy::graphics {
 	class PbrMaterial;
 }
+namespace mnemosy::core {
+	class JobGroup;
+}
 
 namespace mnemosy::systems {
 
@@ -29,21 +40,89 @@ namespace mnemosy::systems {
 		void RenderThumbnailForActiveLibEntry(LibEntry* activeLibEntry);
 
 
-		void AddLibEntryToActiveThumbnails(LibEntry* libEntry);
+		// does nothing for entries the gui never showed since the last UnloadAllThumbnails()
 		void RemoveLibEntryFromActiveThumbnails(LibEntry* libEntry);
 
 		void UnloadAllThumbnails();
+		// unmaps the thumbnail pack of the active collection, it is opened again the next time thumbnails are loaded
+		void CloseThumbnailPack();
 
 		void RenderThumbnailForAnyLibEntry_Slow_Fallback(LibEntry* libEntry);
+		// the thumbnail file of the entry changed, reloads it if it is currently shown
+		void RefreshThumbnail(LibEntry* libEntry);
+		// files the thumbnail is rendered from changed, renders it again if it is currently shown
+		void QueueThumbnailRender(LibEntry* libEntry);
+
+		// renders thumbnails of whole folder hierarchies, advanced a little every frame while it runs
+		ThumbnailBatchRegenerator& GetBatchRegenerator() { return m_batchRegenerator; }
+
+		// texture coordinates of the thumbnail inside its atlas page (libEntry->thumbnailTexure_ID), already flipped for imGui
+		void GetThumbnailUVs(const LibEntry* libEntry, float& outU0, float& outV0, float& outU1, float& outV1);
+
+		// called by the gui for thumbnails that are on screen this frame, only those are loaded.
+		// Entries are only known to the manager from the first time they are shown, opening a large folder costs nothing up front.
+		void SetThumbnailVisible(LibEntry* libEntry);
+
+		// time the main thread may spend per frame copying thumbnails into the atlas
+		void SetUploadBudget(const double milliseconds) { m_uploadBudgetMilliseconds = milliseconds; }
+		double GetUploadBudget() { return m_uploadBudgetMilliseconds; }
 	private:
 
+		// Thumbnails are drawn from a few large textures instead of one texture per entry. 
+		// Each page only holds tiles of one size, thumbnails rendered at different resolution settings end up on different pages.
+		struct AtlasPage {
+			unsigned int textureID = 0;
+			uint32_t tileSize = 0;
+			uint32_t tilesPerRow = 0;
+			uint32_t usedTilesCount = 0;
+			std::vector<bool> usedTiles;
+		};
+
+		// pixels of a thumbnail ktx2 read by a worker, handed back to the main thread through m_decodeResults
+		struct DecodeResult {
+			uint32_t runtimeID = 0;
+			uint32_t ticket = 0;	// only accepted while m_pendingDecodes still holds the same ticket for the entry
+			std::string packKey;
+			ThumbnailStamp stamp;
+			uint8_t* pixels = nullptr; // nullptr if the file could not be read, freed by the main thread
+			uint16_t width = 0;
+			uint16_t height = 0;
+			uint8_t channels = 0;
+		};
+
 		void DeleteThumbnailGLTexture_Internal(LibEntry* libEntry);
-		void LoadThumbnailForMaterial_Internal(LibEntry* libEntry);
+		void LoadThumbnailForMaterial_Internal(LibEntry* libEntry, const double budgetEndTime);
+		void SubmitThumbnailDecode_Internal(LibEntry* libEntry, const std::filesystem::path& thumbnailPath, const std::string& packKey, const ThumbnailStamp& stamp);
+		void HandleDecodeResult_Internal(DecodeResult& result);
+		// returns the group of the cancelled reads, they may still be running
+		std::shared_ptr<core::JobGroup> CancelDecodes_Internal();
+		bool UploadThumbnailToAtlas_Internal(LibEntry* libEntry, const uint8_t* pixels, const uint16_t width, const uint16_t height, const uint8_t channels);
+		void DeleteEmptyAtlasPages_Internal();
+		void EvictOffscreenThumbnails_Internal();
+		bool OpenPackOfActiveCollection_Internal();
+		std::string GetPackKey_Internal(const LibEntry* libEntry);
+
+		ThumbnailPack m_pack;
+		std::vector<AtlasPage> m_atlasPages;
+
+		std::unordered_map<uint32_t, LibEntry*> m_activeEntriesByID;	// entries of the open folder or search the gui has shown so far
+		std::vector<uint32_t> m_visibleEntryIDs;				// not yet loaded entries the gui drew this frame
+		std::unordered_set<uint32_t> m_loadedEntryIDs;
+		std::unordered_map<uint32_t, uint64_t> m_lastVisibleFrame;
+		uint64_t m_frameIndex = 0;
+		std::unordered_map<uint32_t, uint32_t> m_pendingDecodes;	// runtime id -> ticket of the read a worker is doing for the entry
+		std::unordered_set<uint32_t> m_thumbnailsQuedForRendering;	// runtime ids of entries without a readable thumbnail file
+
+		core::MpscQueue<DecodeResult> m_decodeResults;
+		std::shared_ptr<core::JobGroup> m_decodeGroup;
+		uint32_t m_nextDecodeTicket = 1; // every submitted read gets a new one, results of erased or replaced reads are thrown away
+
+		double m_uploadBudgetMilliseconds = 2.0;
 
+		ThumbnailBatchRegenerator m_batchRegenerator;
+		double m_batchBudgetMilliseconds = 30.0; // the app stays responsive but slow while a batch runs
 
 		std::vector<systems::LibEntry*> m_thumbnailsQuedForRefresh;		
-		std::vector<systems::LibEntry*> m_activeEntries;
-		bool m_activeEntriesFullyLoaded = false;
 	
 	};
 } // ! mnemosy::systems
@@ -0,0 +1,78 @@
+#ifndef THUMBNAIL_PACK_H
+#define THUMBNAIL_PACK_H
+
+#include "Include/Core/Utils/MappedFile.h"
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <stdint.h>
+
+/*
+	All thumbnails of a library collection in one memory mapped file.
+
+	The <name>_thumbnail.ktx2 files in the entry folders stay the source of truth, the pack is only a cache of their pixels.
+	Every record stores the size and write time of the ktx2 it was read from, a record whose ktx2 changed since is ignored and replaced.
+	Records are keyed by the path of the entry relative to the library root, so renamed or moved entries simply get a new record.
+
+	The file is append only: a header followed by records { keyLength, width, height, channels, stampSize, stampTime, key, pixels }.
+	The newest record of a key wins. Superseded records are dropped when the pack is rewritten on open.
+*/
+
+namespace mnemosy::systems {
+
+	// identifies the version of a thumbnail ktx2 file
+	struct ThumbnailStamp {
+		uint64_t size = 0;
+		int64_t time = 0;
+	};
+
+	class ThumbnailPack {
+	public:
+		ThumbnailPack() = default;
+		~ThumbnailPack() = default;
+
+		// maps the pack, creates it if it does not exist yet. thumbnailsRoot is the folder the keys are relative to.
+		bool Open(const std::filesystem::path& filepath, const std::filesystem::path& thumbnailsRoot);
+		void Close();
+		bool IsOpen() const { return m_file.IsOpen(); }
+		const std::filesystem::path& GetPath() const { return m_path; }
+
+		// pointer into the mapped file, valid until the pack is closed or remapped. nullptr if there is no up to date record.
+		const uint8_t* Find(const std::string& key, const ThumbnailStamp& stamp, uint16_t& outWidth, uint16_t& outHeight, uint8_t& outChannels);
+
+		// writes a record to the end of the file, it can be found after the next Remap()
+		bool Append(const std::string& key, const ThumbnailStamp& stamp, const uint8_t* pixels, const uint16_t width, const uint16_t height, const uint8_t channels);
+		bool HasUnmappedRecords() const { return m_hasUnmappedRecords; }
+		// maps the grown file again, only the records appended since the last read are indexed
+		void Remap();
+
+		static bool GetStamp(const std::filesystem::path& thumbnailPath, ThumbnailStamp& outStamp);
+
+	private:
+		struct Record {
+			ThumbnailStamp stamp;
+			size_t dataOffset = 0;
+			uint16_t width = 0;
+			uint16_t height = 0;
+			uint8_t channels = 0;
+		};
+
+		bool MapAndReadIndex();
+		// indexes the records from offset to the end of the mapping
+		void ReadRecords(size_t offset);
+		void Rewrite();
+
+		std::filesystem::path m_path;
+		std::filesystem::path m_thumbnailsRoot;
+		core::MappedFile m_file;
+		std::unordered_map<std::string, Record> m_records;
+
+		size_t m_liveBytes = 0;		// bytes of the records in m_records
+		size_t m_validBytes = 0;	// bytes up to the end of the last complete record
+		bool m_hasUnmappedRecords = false;
+	};
+
+} // !mnemosy::systems
+
+#endif // !THUMBNAIL_PACK_H
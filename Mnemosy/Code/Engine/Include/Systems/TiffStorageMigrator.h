@@ -0,0 +1,80 @@
+#ifndef TIFF_STORAGE_MIGRATOR_H
+#define TIFF_STORAGE_MIGRATOR_H
+
+#include "Include/Graphics/Utils/Picture.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/*
+	Rewrites the tiff textures of every entry within a folder hierarchy with the current tiff compression, e.g. after the setting changed.
+
+	Each entry is one low priority job on the engine job system. A texture is decoded, written to a temporary file next to it,
+	read back and compared to the decoded pixels before it replaces the original. If the original changed in the meantime it is left alone.
+	Textures that are already stored with the compression or in a layout WriteTiff() would not reproduce are skipped.
+
+	A replaced texture decodes to the same pixels, so its mip chain caches are moved over to the new file instead of being rebuilt
+	and the library can ask WasRewrittenByMigration() to tell the file watcher events of our rewrites apart from real edits.
+*/
+
+namespace mnemosy::systems {
+	struct FolderNode;
+}
+namespace mnemosy::core {
+	class JobGroup;
+}
+
+namespace mnemosy::systems {
+
+	class TiffStorageMigrator {
+	public:
+		TiffStorageMigrator() = default;
+		~TiffStorageMigrator() = default;
+
+		void Shutdown();
+
+		// collects all entries within the hierarchy of node, does nothing if a migration is already running
+		void Start(FolderNode* node);
+		// Entries that have not started return right away, running ones stop after the texture they are working on.
+		// The summary is logged once every entry job has returned, cancelled or not.
+		void Cancel();
+
+		bool IsRunning() const;
+		uint32_t GetTotalCount() const { return (uint32_t)m_entryFolders.size(); }
+		uint32_t GetFinishedCount() const { return m_finishedCount; }
+		uint32_t GetFailedCount() const { return m_failedCount; }
+
+		// true if path is a texture the last migration replaced and it has not been written since. Safe to call from any thread.
+		bool WasRewrittenByMigration(const std::filesystem::path& path);
+
+	private:
+		void MigrateEntry_Internal(const std::filesystem::path& entryFolder);
+		bool MigrateTexture_Internal(const std::filesystem::path& texturePath);
+		void CollectEntries_Internal(FolderNode* node);
+		void Finish_Internal();
+
+		std::vector<std::filesystem::path> m_entryFolders;
+		graphics::TiffCompression m_compression = graphics::MNSY_TIFF_COMPRESSION_NONE;
+
+		std::shared_ptr<core::JobGroup> m_jobs;
+
+		std::atomic<uint32_t> m_finishedCount = 0;
+		std::atomic<uint32_t> m_failedCount = 0;
+		std::atomic<uint32_t> m_processedCount = 0;	// entries whose job returned, including skipped ones
+		std::atomic<bool> m_cancelled = false;
+		std::atomic<uint64_t> m_bytesBefore = 0;	// of the textures that were rewritten
+		std::atomic<uint64_t> m_bytesAfter = 0;
+
+		std::mutex m_rewrittenMutex;
+		// normalized path -> write time of the file that replaced it
+		std::unordered_map<std::filesystem::path::string_type, std::filesystem::file_time_type> m_rewrittenTextures;
+	};
+
+} // !mnemosy::systems
+
+#endif // !TIFF_STORAGE_MIGRATOR_H
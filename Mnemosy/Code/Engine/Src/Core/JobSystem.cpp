@@ -0,0 +1,203 @@
+#include "Include/Core/JobSystem.h"
+
+#include "Include/Core/Log.h"
+
+#include <deque>
+
+namespace mnemosy::core
+{
+	struct JobSystem::WorkerQueue {
+		std::mutex mutex;
+		std::deque<Job> jobs[MNSY_JOB_PRIORITY_COUNT];
+	};
+
+	// defined here where WorkerQueue is complete
+	JobSystem::~JobSystem() = default;
+
+	// index of the queue owned by the current thread, jobs submitted from inside a job land in the queue of the worker running it.
+	static thread_local int s_workerQueueIndex = -1;
+
+	void JobSystem::Init() {
+
+		// leave one core for the main thread
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		uint32_t workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+
+		m_isRunning = true;
+
+		m_queues.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; i++) {
+			m_queues.push_back(std::make_unique<WorkerQueue>());
+		}
+
+		m_workers.reserve(workerCount);
+		for (uint32_t i = 0; i < workerCount; i++) {
+			m_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+		}
+
+		MNEMOSY_TRACE("JobSystem: started {} worker threads", workerCount);
+	}
+
+	void JobSystem::Shutdown() {
+
+		// cancel whatever is still queued, running jobs finish normally.
+		for (std::unique_ptr<WorkerQueue>& queue : m_queues) {
+
+			std::lock_guard<std::mutex> lock(queue->mutex);
+			for (int p = 0; p < MNSY_JOB_PRIORITY_COUNT; p++) {
+				for (Job& job : queue->jobs[p]) {
+					if (job.group) {
+						job.group->Cancel();
+					}
+				}
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_wakeMutex);
+			m_isRunning = false;
+		}
+		m_wakeCondition.notify_all();
+
+		for (std::thread& worker : m_workers) {
+			worker.join();
+		}
+
+		m_workers.clear();
+		m_queues.clear();
+	}
+
+	void JobSystem::Submit(std::function<void()> job, const JobPriority priority) {
+		Submit(nullptr, std::move(job), priority);
+	}
+
+	void JobSystem::Submit(const std::shared_ptr<JobGroup>& group, std::function<void()> job, const JobPriority priority) {
+
+		MNEMOSY_ASSERT(priority < MNSY_JOB_PRIORITY_COUNT, "Invalid job priority");
+
+		// no workers (not initialized or already shut down), just run it right here
+		if (!m_isRunning) {
+			if (!group || !group->IsCancelled()) {
+				job();
+			}
+			return;
+		}
+
+		if (group) {
+			group->m_pendingJobs++;
+		}
+
+		uint32_t queueIndex = s_workerQueueIndex >= 0 ? (uint32_t)s_workerQueueIndex : m_nextSubmitQueue.fetch_add(1) % (uint32_t)m_queues.size();
+
+		// counted under the queue lock before anyone can pop the job, a worker stealing it right away must not decrement first
+		{
+			std::lock_guard<std::mutex> lock(m_queues[queueIndex]->mutex);
+			m_queuedJobs++;
+			m_queues[queueIndex]->jobs[priority].push_back(Job{ std::move(job), group });
+		}
+
+		// a worker that checked the count before the increment is waiting by the time we get the lock, so it gets the notification
+		{
+			std::lock_guard<std::mutex> lock(m_wakeMutex);
+		}
+		m_wakeCondition.notify_one();
+	}
+
+	void JobSystem::Wait(const std::shared_ptr<JobGroup>& group) {
+
+		if (!group)
+			return;
+
+		while (!group->IsDone()) {
+
+			Job job;
+			if (TryPopJob(0, group.get(), job)) {
+				RunJob(job);
+			}
+			else {
+				// all remaining jobs of the group are already running on workers
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void JobSystem::WorkerLoop(const uint32_t workerIndex) {
+
+		s_workerQueueIndex = (int)workerIndex;
+
+		while (true) {
+
+			Job job;
+			if (TryPopJob(workerIndex, nullptr, job)) {
+				RunJob(job);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_wakeMutex);
+			m_wakeCondition.wait(lock, [this] { return m_queuedJobs > 0 || !m_isRunning; });
+
+			if (!m_isRunning && m_queuedJobs == 0) {
+				break;
+			}
+		}
+
+		s_workerQueueIndex = -1;
+	}
+
+	// Looks for the next job, highest priority first. Starts at the own queue and steals from the other workers if it is empty.
+	// Jobs are taken in submission order. If onlyGroup is set only jobs of that group are considered.
+	bool JobSystem::TryPopJob(const uint32_t startQueue, const JobGroup* onlyGroup, Job& outJob) {
+
+		uint32_t queueCount = (uint32_t)m_queues.size();
+
+		for (int p = 0; p < MNSY_JOB_PRIORITY_COUNT; p++) {
+
+			for (uint32_t i = 0; i < queueCount; i++) {
+
+				uint32_t queueIndex = (startQueue + i) % queueCount;
+
+				WorkerQueue& queue = *m_queues[queueIndex];
+				std::lock_guard<std::mutex> lock(queue.mutex);
+
+				std::deque<Job>& jobs = queue.jobs[p];
+				if (jobs.empty())
+					continue;
+
+				if (onlyGroup == nullptr) {
+					outJob = std::move(jobs.front());
+					jobs.pop_front();
+				}
+				else {
+
+					auto it = jobs.begin();
+					while (it != jobs.end() && it->group.get() != onlyGroup) {
+						it++;
+					}
+
+					if (it == jobs.end())
+						continue;
+
+					outJob = std::move(*it);
+					jobs.erase(it);
+				}
+
+				m_queuedJobs--;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void JobSystem::RunJob(Job& job) {
+
+		if (!job.group || !job.group->IsCancelled()) {
+			job.func();
+		}
+
+		if (job.group) {
+			job.group->m_pendingJobs--;
+		}
+	}
+
+} // !mnemosy::core
@@ -1,23 +1,75 @@
 #include "Include/Core/Utils/FileWatcher.h"
 
+#include "Include/MnemosyConfig.h"
 #include "Include/Core/Log.h"
 
+#include <algorithm>
+
+#if defined MNEMOSY_PLATFORM_WINDOWS
+#include <windows.h>
+#elif defined MNEMOSY_PLATFORM_LINUX
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+// how long the thread sleeps at most before it checks for new watches or whether it should stop
+#define FILE_WATCHER_WAIT_MILLISECONDS 100
+// a path is reported once it did not change for this long
+#define FILE_WATCHER_SETTLE_MILLISECONDS 150
+// directories without os notifications are compared against their last listing this often
+#define FILE_WATCHER_POLL_MILLISECONDS 2000
+
 namespace mnemosy::core {
 
-	FileWatcher::FileWatcher() {
-		m_paths = std::vector<fs::path>();
-		m_fileTimeTypes = std::vector<fs::file_time_type>();
-	}
-	FileWatcher::~FileWatcher() {
+	struct FileWatcher::Watch {
+		fs::path directory;
+		bool recursive = false;
+		// false if the directory is only watched for files that were registered on their own
+		bool isRegisteredDirectory = false;
 
-		if (!m_paths.empty()) {
-			m_paths.clear();
-		}
+		// set if the os can not notify us about this directory
+		bool polling = false;
+		std::unordered_map<fs::path::string_type, fs::file_time_type> pollSnapshot;
 
-		if (!m_fileTimeTypes.empty()) {
-			m_fileTimeTypes.clear();
+#if defined MNEMOSY_PLATFORM_WINDOWS
+		HANDLE handle = INVALID_HANDLE_VALUE;
+		OVERLAPPED overlapped = {};
+		std::vector<DWORD> buffer;	// FILE_NOTIFY_INFORMATION records must be dword aligned
+#endif
+	};
+
+	static void FileWatcher_TakeSnapshot(const fs::path& directory, const bool recursive, std::unordered_map<fs::path::string_type, fs::file_time_type>& outSnapshot) {
+
+		outSnapshot.clear();
+
+		std::error_code ec;
+		if (recursive) {
+			for (fs::recursive_directory_iterator it(directory, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+				std::error_code entryEc;
+				fs::file_time_type time = it->last_write_time(entryEc);
+				if (!entryEc)
+					outSnapshot[it->path().native()] = time;
+			}
+		}
+		else {
+			for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+				std::error_code entryEc;
+				fs::file_time_type time = it->last_write_time(entryEc);
+				if (!entryEc)
+					outSnapshot[it->path().native()] = time;
+			}
 		}
+	}
+
+	FileWatcher::FileWatcher() {
+
+	}
+
+	FileWatcher::~FileWatcher() {
 
+		Stop_Internal();
 	}
 
 	void FileWatcher::RegisterFile(fs::path filePath) {
@@ -33,36 +85,504 @@ namespace mnemosy::core {
 		}
 
 		//MNEMOSY_DEBUG("FileWatcher::RegisterFile: {}", filePath.generic_string());
-		fs::directory_entry file = fs::directory_entry(filePath);
+		filePath = filePath.lexically_normal();
+		fs::path directory = filePath.parent_path();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_files.insert(filePath.native());
+
+			// files in the same directory share one watch
+			for (const std::shared_ptr<Watch>& watch : m_watches) {
+				if (watch->directory == directory) {
+					return;
+				}
+			}
+
+			std::shared_ptr<Watch> watch = std::make_shared<Watch>();
+			watch->directory = directory;
+			m_watches.push_back(watch);
+			m_newWatches.push_back(watch);
+		}
 
-		m_paths.push_back(filePath);
-		m_fileTimeTypes.push_back(file.last_write_time());
+		Start_Internal();
+	}
+
+	void FileWatcher::RegisterDirectory(fs::path directoryPath, const bool recursive) {
+
+		if (!fs::is_directory(directoryPath)) {
+			MNEMOSY_ERROR("Path is not a directory. {}", directoryPath.generic_string());
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			std::shared_ptr<Watch> watch = std::make_shared<Watch>();
+			watch->directory = directoryPath.lexically_normal();
+			watch->recursive = recursive;
+			watch->isRegisteredDirectory = true;
+			m_watches.push_back(watch);
+			m_newWatches.push_back(watch);
+		}
+
+		Start_Internal();
+	}
+
+	void FileWatcher::Clear() {
+
+		Stop_Internal();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_watches.clear();
+		m_newWatches.clear();
+		m_files.clear();
+		m_changes.clear();
 	}
 
 	bool FileWatcher::DidAnyFileChange() {
 
-		if (m_paths.empty()) {
-			return false;
+		std::vector<fs::path> changedPaths;
+		PopChangedPaths(changedPaths);
+
+		return !changedPaths.empty();
+	}
+
+	void FileWatcher::PopChangedPaths(std::vector<fs::path>& outPaths) {
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_changes.empty())
+			return;
+
+		std::chrono::steady_clock::time_point settledBefore = std::chrono::steady_clock::now() - std::chrono::milliseconds(FILE_WATCHER_SETTLE_MILLISECONDS);
+
+		for (auto it = m_changes.begin(); it != m_changes.end();) {
+
+			if (it->second <= settledBefore) {
+				outPaths.push_back(fs::path(it->first));
+				it = m_changes.erase(it);
+			}
+			else {
+				++it;
+			}
 		}
+	}
+
+	// private
 
+	void FileWatcher::Start_Internal() {
 
-		bool changed = false;
-		for (size_t i = 0; i < m_paths.size(); i++) {
+		if (m_thread.joinable())
+			return;
 
+		m_stop = false;
+		m_thread = std::thread(&FileWatcher::ThreadLoop_Internal, this);
+	}
+
+	void FileWatcher::Stop_Internal() {
+
+		if (!m_thread.joinable())
+			return;
 
-			fs::directory_entry dir = fs::directory_entry(m_paths[i]);
+		m_stop = true;
+		m_thread.join();
 
-			if (m_fileTimeTypes[i] != dir.last_write_time()) {
+		// the thread is gone, a restart has to set up every watch again
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_newWatches = m_watches;
+	}
+
+	void FileWatcher::OnChange_Internal(const fs::path& path) {
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (IsWatched_Internal(path)) {
+			m_changes[path.native()] = std::chrono::steady_clock::now();
+		}
+	}
 
-				m_fileTimeTypes[i] = dir.last_write_time();
-				changed = true;
+	bool FileWatcher::IsWatched_Internal(const fs::path& path) {
+
+		if (m_files.count(path.native()) != 0)
+			return true;
+
+		for (const std::shared_ptr<Watch>& watch : m_watches) {
+
+			// the os reports the directory itself if it dropped notifications
+			if (path == watch->directory)
 				return true;
-				// we want to continue the loop here to update all remaining files in the list.
+
+			if (!watch->isRegisteredDirectory)
+				continue;
+
+			if (!watch->recursive) {
+				if (path.parent_path() == watch->directory)
+					return true;
+				continue;
 			}
+
+			fs::path relative = path.lexically_relative(watch->directory);
+			if (!relative.empty() && *relative.begin() != fs::path(".."))
+				return true;
 		}
 
-		return changed;
+		return false;
+	}
+
+#if defined MNEMOSY_PLATFORM_WINDOWS
+
+	static bool FileWatcher_IssueRead(HANDLE handle, OVERLAPPED& overlapped, std::vector<DWORD>& buffer, const bool recursive) {
+
+		const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+
+		return ReadDirectoryChangesW(handle, buffer.data(), (DWORD)(buffer.size() * sizeof(DWORD)), recursive ? TRUE : FALSE, filter, nullptr, &overlapped, nullptr) != 0;
 	}
 
+	static void FileWatcher_CloseWatch(HANDLE& handle, OVERLAPPED& overlapped) {
+
+		if (handle != INVALID_HANDLE_VALUE) {
+			// the read writes into the buffer until it is cancelled, wait for that before the buffer can go away
+			DWORD bytes = 0;
+			CancelIoEx(handle, &overlapped);
+			GetOverlappedResult(handle, &overlapped, &bytes, TRUE);
+			CloseHandle(handle);
+			handle = INVALID_HANDLE_VALUE;
+		}
+
+		if (overlapped.hEvent) {
+			CloseHandle(overlapped.hEvent);
+			overlapped.hEvent = nullptr;
+		}
+	}
+
+	void FileWatcher::ThreadLoop_Internal() {
+
+		std::vector<std::shared_ptr<Watch>> watches;
+		std::chrono::steady_clock::time_point lastPoll = std::chrono::steady_clock::now();
+
+		while (!m_stop) {
+
+			std::vector<std::shared_ptr<Watch>> newWatches;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				newWatches.swap(m_newWatches);
+			}
+
+			for (std::shared_ptr<Watch>& watch : newWatches) {
+
+				size_t notifiedCount = std::count_if(watches.begin(), watches.end(), [](const std::shared_ptr<Watch>& w) { return !w->polling; });
+
+				watch->polling = true;
+
+				// WaitForMultipleObjects takes at most MAXIMUM_WAIT_OBJECTS handles, any more directories are polled
+				if (notifiedCount < MAXIMUM_WAIT_OBJECTS) {
+
+					watch->handle = CreateFileW(watch->directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+					watch->overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+					// network shares do not accept buffers larger than 64kb
+					watch->buffer.resize(65536 / sizeof(DWORD));
+
+					if (watch->handle != INVALID_HANDLE_VALUE && watch->overlapped.hEvent && FileWatcher_IssueRead(watch->handle, watch->overlapped, watch->buffer, watch->recursive)) {
+						watch->polling = false;
+					}
+					else {
+						FileWatcher_CloseWatch(watch->handle, watch->overlapped);
+					}
+				}
+
+				if (watch->polling) {
+					MNEMOSY_WARN("FileWatcher: Directory can not be watched for changes, it is checked every {} ms instead. \nPath: {}", FILE_WATCHER_POLL_MILLISECONDS, watch->directory.generic_string());
+					FileWatcher_TakeSnapshot(watch->directory, watch->recursive, watch->pollSnapshot);
+				}
+
+				watches.push_back(watch);
+			}
+
+			std::vector<HANDLE> events;
+			std::vector<Watch*> eventWatches;
+			for (std::shared_ptr<Watch>& watch : watches) {
+				if (!watch->polling) {
+					events.push_back(watch->overlapped.hEvent);
+					eventWatches.push_back(watch.get());
+				}
+			}
+
+			if (events.empty()) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(FILE_WATCHER_WAIT_MILLISECONDS));
+			}
+			else {
+
+				DWORD result = WaitForMultipleObjects((DWORD)events.size(), events.data(), FALSE, FILE_WATCHER_WAIT_MILLISECONDS);
+				if (result >= WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + events.size()) {
+
+					Watch& watch = *eventWatches[result - WAIT_OBJECT_0];
+
+					DWORD bytes = 0;
+					if (GetOverlappedResult(watch.handle, &watch.overlapped, &bytes, FALSE) && bytes != 0) {
+
+						const uint8_t* record = (const uint8_t*)watch.buffer.data();
+						while (true) {
+
+							const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)record;
+							OnChange_Internal(watch.directory / std::wstring(info->FileName, info->FileNameLength / sizeof(WCHAR)));
+
+							if (info->NextEntryOffset == 0)
+								break;
+							record += info->NextEntryOffset;
+						}
+					}
+					else {
+						// the buffer overflowed and the notifications are lost
+						OnChange_Internal(watch.directory);
+					}
+
+					if (!FileWatcher_IssueRead(watch.handle, watch.overlapped, watch.buffer, watch.recursive)) {
+						FileWatcher_CloseWatch(watch.handle, watch.overlapped);
+						watch.polling = true;
+						FileWatcher_TakeSnapshot(watch.directory, watch.recursive, watch.pollSnapshot);
+						OnChange_Internal(watch.directory);
+					}
+				}
+			}
+
+			if (std::chrono::steady_clock::now() - lastPoll >= std::chrono::milliseconds(FILE_WATCHER_POLL_MILLISECONDS)) {
+
+				lastPoll = std::chrono::steady_clock::now();
+				for (std::shared_ptr<Watch>& watch : watches) {
+					if (watch->polling) {
+						PollWatch_Internal(*watch);
+					}
+				}
+			}
+		}
+
+		for (std::shared_ptr<Watch>& watch : watches) {
+			FileWatcher_CloseWatch(watch->handle, watch->overlapped);
+		}
+	}
+
+#elif defined MNEMOSY_PLATFORM_LINUX
+
+	// Returns the number of directories that could not be watched, e.g. because the per user watch limit is reached (ENOSPC).
+	// Descriptors that did not exist before are appended to outAdded so they can be removed again.
+	static uint32_t FileWatcher_AddInotifyWatches(const int fd, const fs::path& directory, const bool recursive, std::unordered_map<int, std::pair<fs::path, bool>>& descriptors, std::vector<int>& outAdded) {
+
+		const uint32_t mask = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+		int wd = inotify_add_watch(fd, directory.c_str(), mask);
+		if (wd < 0) {
+			// the directory may be gone again already, nothing is missed then
+			return errno == ENOENT ? 0 : 1;
+		}
+
+		if (descriptors.count(wd) == 0) {
+			outAdded.push_back(wd);
+		}
+
+		std::pair<fs::path, bool>& descriptor = descriptors[wd];
+		descriptor.first = directory;
+		descriptor.second = descriptor.second || recursive;
+
+		if (!recursive)
+			return 0;
+
+		uint32_t failedCount = 0;
+
+		// inotify only covers one directory, subdirectories need their own watch
+		std::error_code ec;
+		for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+			std::error_code entryEc;
+			if (it->is_directory(entryEc) && !it->is_symlink(entryEc)) {
+				failedCount += FileWatcher_AddInotifyWatches(fd, it->path(), true, descriptors, outAdded);
+			}
+		}
+
+		return failedCount;
+	}
+
+	static void FileWatcher_RemoveInotifyWatches(const int fd, const std::vector<int>& added, std::unordered_map<int, std::pair<fs::path, bool>>& descriptors) {
+
+		for (int wd : added) {
+			inotify_rm_watch(fd, wd);
+			descriptors.erase(wd);
+		}
+	}
+
+	void FileWatcher::ThreadLoop_Internal() {
+
+		std::vector<std::shared_ptr<Watch>> watches;
+		std::chrono::steady_clock::time_point lastPoll = std::chrono::steady_clock::now();
+
+		int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		// watch descriptor -> directory and whether its new subdirectories are watched too
+		std::unordered_map<int, std::pair<fs::path, bool>> descriptors;
+
+		while (!m_stop) {
+
+			std::vector<std::shared_ptr<Watch>> newWatches;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				newWatches.swap(m_newWatches);
+			}
+
+			for (std::shared_ptr<Watch>& watch : newWatches) {
+
+				// a single directory of the hierarchy without a watch would miss its changes, the whole watch is polled then
+				watch->polling = fd < 0;
+				if (fd >= 0) {
+
+					std::vector<int> added;
+					if (FileWatcher_AddInotifyWatches(fd, watch->directory, watch->recursive, descriptors, added) != 0) {
+						FileWatcher_RemoveInotifyWatches(fd, added, descriptors);
+						watch->polling = true;
+					}
+				}
+
+				if (watch->polling) {
+					MNEMOSY_WARN("FileWatcher: Directory can not be watched for changes, it is checked every {} ms instead. \nPath: {}", FILE_WATCHER_POLL_MILLISECONDS, watch->directory.generic_string());
+					FileWatcher_TakeSnapshot(watch->directory, watch->recursive, watch->pollSnapshot);
+				}
+
+				watches.push_back(watch);
+			}
+
+			if (fd < 0 || descriptors.empty()) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(FILE_WATCHER_WAIT_MILLISECONDS));
+			}
+			else {
+
+				pollfd pfd = {};
+				pfd.fd = fd;
+				pfd.events = POLLIN;
+
+				if (poll(&pfd, 1, FILE_WATCHER_WAIT_MILLISECONDS) > 0 && (pfd.revents & POLLIN)) {
+
+					alignas(inotify_event) char buffer[16384];
+
+					ssize_t length;
+					while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+
+						for (char* record = buffer; record < buffer + length; record += sizeof(inotify_event) + ((inotify_event*)record)->len) {
+
+							const inotify_event* event = (const inotify_event*)record;
+
+							if (event->mask & IN_Q_OVERFLOW) {
+								for (std::shared_ptr<Watch>& watch : watches) {
+									OnChange_Internal(watch->directory);
+								}
+								continue;
+							}
+
+							auto it = descriptors.find(event->wd);
+							if (it == descriptors.end())
+								continue;
+
+							if (event->mask & IN_IGNORED) {
+								descriptors.erase(it);
+								continue;
+							}
+
+							if (event->len == 0)
+								continue;
+
+							fs::path path = it->second.first / event->name;
+							OnChange_Internal(path);
+
+							if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)) && it->second.second) {
+
+								std::vector<int> added;
+								if (FileWatcher_AddInotifyWatches(fd, path, true, descriptors, added) != 0) {
+
+									// the recursive watches the new directory belongs to are polled from now on
+									for (std::shared_ptr<Watch>& watch : watches) {
+
+										fs::path relative = path.lexically_relative(watch->directory);
+										if (!watch->recursive || watch->polling || relative.empty() || *relative.begin() == fs::path(".."))
+											continue;
+
+										MNEMOSY_WARN("FileWatcher: Directory can not be watched for changes anymore, it is checked every {} ms instead. \nPath: {}", FILE_WATCHER_POLL_MILLISECONDS, watch->directory.generic_string());
+										watch->polling = true;
+										FileWatcher_TakeSnapshot(watch->directory, watch->recursive, watch->pollSnapshot);
+									}
+								}
+							}
+						}
+					}
+				}
+			}
+
+			if (std::chrono::steady_clock::now() - lastPoll >= std::chrono::milliseconds(FILE_WATCHER_POLL_MILLISECONDS)) {
+
+				lastPoll = std::chrono::steady_clock::now();
+				for (std::shared_ptr<Watch>& watch : watches) {
+					if (watch->polling) {
+						PollWatch_Internal(*watch);
+					}
+				}
+			}
+		}
+
+		if (fd >= 0) {
+			close(fd);
+		}
+	}
+
+#else
+
+	void FileWatcher::ThreadLoop_Internal() {
+
+		std::vector<std::shared_ptr<Watch>> watches;
+
+		while (!m_stop) {
+
+			std::vector<std::shared_ptr<Watch>> newWatches;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				newWatches.swap(m_newWatches);
+			}
+
+			for (std::shared_ptr<Watch>& watch : newWatches) {
+				watch->polling = true;
+				FileWatcher_TakeSnapshot(watch->directory, watch->recursive, watch->pollSnapshot);
+				watches.push_back(watch);
+			}
+
+			for (std::shared_ptr<Watch>& watch : watches) {
+				PollWatch_Internal(*watch);
+			}
+
+			// sleep in short steps so stopping does not have to wait for a whole poll interval
+			for (int waited = 0; waited < FILE_WATCHER_POLL_MILLISECONDS && !m_stop; waited += FILE_WATCHER_WAIT_MILLISECONDS) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(FILE_WATCHER_WAIT_MILLISECONDS));
+			}
+		}
+	}
+
+#endif // MNEMOSY_PLATFORM_WINDOWS
+
+	void FileWatcher::PollWatch_Internal(Watch& watch) {
+
+		std::unordered_map<fs::path::string_type, fs::file_time_type> snapshot;
+		FileWatcher_TakeSnapshot(watch.directory, watch.recursive, snapshot);
+
+		for (const auto& [path, time] : snapshot) {
+
+			auto it = watch.pollSnapshot.find(path);
+			if (it == watch.pollSnapshot.end() || it->second != time) {
+				OnChange_Internal(fs::path(path));
+			}
+		}
+
+		for (const auto& [path, time] : watch.pollSnapshot) {
+
+			if (snapshot.count(path) == 0) {
+				OnChange_Internal(fs::path(path));
+			}
+		}
+
+		watch.pollSnapshot.swap(snapshot);
+	}
 
-} // namespace mnemosy::core
\ No newline at end of file
+} // namespace mnemosy::core
@@ -0,0 +1,138 @@
+#include "Include/Core/Utils/MappedFile.h"
+
+#include "Include/MnemosyConfig.h"
+#include "Include/Core/Log.h"
+
+#ifdef MNEMOSY_PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mnemosy::core {
+
+	MappedFile::~MappedFile() {
+		Close();
+	}
+
+#ifdef MNEMOSY_PLATFORM_WINDOWS
+
+	bool MappedFile::Open(const std::filesystem::path& filepath) {
+
+		Close();
+
+		// share write and delete so the file can be appended to or replaced while we look at it
+		HANDLE file = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize)) {
+			CloseHandle(file);
+			return false;
+		}
+
+		m_fileHandle = file;
+		m_isOpen = true;
+
+		// empty files can not be mapped
+		if (fileSize.QuadPart == 0) {
+			return true;
+		}
+
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr) {
+			MNEMOSY_ERROR("MappedFile::Open: CreateFileMapping failed with error {} \nPath: {}", (unsigned int)GetLastError(), filepath.generic_string());
+			Close();
+			return false;
+		}
+		m_mappingHandle = mapping;
+
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (view == nullptr) {
+			MNEMOSY_ERROR("MappedFile::Open: MapViewOfFile failed with error {} \nPath: {}", (unsigned int)GetLastError(), filepath.generic_string());
+			Close();
+			return false;
+		}
+
+		m_data = (const uint8_t*)view;
+		m_size = (size_t)fileSize.QuadPart;
+		return true;
+	}
+
+	void MappedFile::Close() {
+
+		if (m_data) {
+			UnmapViewOfFile(m_data);
+		}
+		if (m_mappingHandle) {
+			CloseHandle((HANDLE)m_mappingHandle);
+		}
+		if (m_fileHandle) {
+			CloseHandle((HANDLE)m_fileHandle);
+		}
+
+		m_data = nullptr;
+		m_size = 0;
+		m_mappingHandle = nullptr;
+		m_fileHandle = nullptr;
+		m_isOpen = false;
+	}
+
+#else
+
+	bool MappedFile::Open(const std::filesystem::path& filepath) {
+
+		Close();
+
+		int fd = open(filepath.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return false;
+		}
+
+		struct stat fileStat;
+		if (fstat(fd, &fileStat) != 0) {
+			close(fd);
+			return false;
+		}
+
+		m_isOpen = true;
+
+		if (fileStat.st_size == 0) {
+			close(fd);
+			return true;
+		}
+
+		void* view = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		// the mapping stays valid after the descriptor is closed
+		close(fd);
+
+		if (view == MAP_FAILED) {
+			MNEMOSY_ERROR("MappedFile::Open: mmap failed \nPath: {}", filepath.generic_string());
+			m_isOpen = false;
+			return false;
+		}
+
+		m_data = (const uint8_t*)view;
+		m_size = (size_t)fileStat.st_size;
+		return true;
+	}
+
+	void MappedFile::Close() {
+
+		if (m_data) {
+			munmap((void*)m_data, m_size);
+		}
+
+		m_data = nullptr;
+		m_size = 0;
+		m_isOpen = false;
+	}
+
+#endif // MNEMOSY_PLATFORM_WINDOWS
+
+} // !mnemosy::core
@@ -0,0 +1,23 @@
+#include "Include/Core/Utils/StringPool.h"
+
+namespace mnemosy::core {
+
+	InternedString StringPool::Intern(std::string_view string) {
+
+		auto it = m_lookup.find(string);
+		if (it != m_lookup.end())
+			return InternedString(it->second);
+
+		const std::string& stored = m_strings.emplace_back(string);
+		m_lookup.emplace(std::string_view(stored), &stored);
+
+		return InternedString(&stored);
+	}
+
+	void StringPool::Clear() {
+
+		m_lookup.clear();
+		m_strings.clear();
+	}
+
+} // !mnemosy::core
@@ -58,7 +58,7 @@ namespace mnemosy::core
 
 
 
-	void Window::Init(const char* WindowTitle){
+	void Window::Init(const char* WindowTitle, const bool hidden){
 
 		m_currentWindowWidth = MNEMOSY_SRC_WINDOW_WIDTH;
 		m_currentWindowHeight = MNEMOSY_SRC_WIDNOW_HEIGHT;
@@ -77,6 +77,7 @@ namespace mnemosy::core
 		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);            // 3.0+ only
 		glfwWindowHint(GLFW_SAMPLES, 4);
+		glfwWindowHint(GLFW_VISIBLE, hidden ? GLFW_FALSE : GLFW_TRUE);
 #ifdef MNEMOSY_CONFIG_DEBUG
 		glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, true);
 #endif // MNEMOSY_CONFIG_DEBUG
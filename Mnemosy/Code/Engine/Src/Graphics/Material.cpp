@@ -402,6 +402,24 @@ namespace mnemosy::graphics
 		return false;
 	}
 
+	Texture* PbrMaterial::GetTextureFromPBRTextureType(const PBRTextureType& pbrType) {
+
+		switch (pbrType)
+		{
+		case mnemosy::graphics::MNSY_TEXTURE_ALBEDO:			return m_pAlbedoTexture;			break;
+		case mnemosy::graphics::MNSY_TEXTURE_ROUGHNESS:			return m_pRoughnessTexture;			break;
+		case mnemosy::graphics::MNSY_TEXTURE_METALLIC:			return m_pMetallicTexture;			break;
+		case mnemosy::graphics::MNSY_TEXTURE_NORMAL:			return m_pNormalTexture;			break;
+		case mnemosy::graphics::MNSY_TEXTURE_AMBIENTOCCLUSION:	return m_pAmbientOcclusionTexture;	break;
+		case mnemosy::graphics::MNSY_TEXTURE_EMISSION:			return m_pEmissiveTexture;			break;
+		case mnemosy::graphics::MNSY_TEXTURE_HEIGHT:			return m_pHeightTexture;			break;
+		case mnemosy::graphics::MNSY_TEXTURE_OPACITY:			return m_pOpacityTexture;			break;
+		default: return nullptr; break;
+		}
+
+		return nullptr;
+	}
+
 
 	// returns nullptr if texture is not assigned
 	Texture* PbrMaterial::GetTextureFromPackComponent(ChannelPackComponent packComponent) {
@@ -74,8 +74,6 @@ namespace mnemosy::graphics
 
 		m_renderMode = MNSY_RENDERMODE_SHADED;
 
-		m_fileWatchTimeDelta = 0.0f;
-
 		// load shaders
 
 		MnemosyEngine& engine = MnemosyEngine::GetInstance();
@@ -112,11 +110,6 @@ namespace mnemosy::graphics
 		CreateBlitFramebuffer(w, h);
 		CreateThumbnailFramebuffers();
 
-		m_shaderFileWatcher = core::FileWatcher();
-		m_shaderSkyboxFileWatcher = core::FileWatcher();
-
-		m_shaderUnlitFileWatcher = core::FileWatcher();
-
 		// init FileWatcher
 		{
 
@@ -874,6 +867,20 @@ namespace mnemosy::graphics
 		return 0;
 	}
 
+	uint16_t Renderer::GetPreviewTextureResolutionValue(PreviewTextureResolution previewResolution) {
+		switch (previewResolution)
+		{
+		case mnemosy::graphics::MNSY_PREVIEWRES_1024:	return 1024;	break;
+		case mnemosy::graphics::MNSY_PREVIEWRES_2048:	return 2048;	break;
+		case mnemosy::graphics::MNSY_PREVIEWRES_4096:	return 4096;	break;
+		case mnemosy::graphics::MNSY_PREVIEWRES_FULL:	return 0;		break;
+		default: return 0;
+			break;
+		}
+
+		return 0;
+	}
+
 	// private
 	void Renderer::CreateRenderingFramebuffer(unsigned int width, unsigned int height) {
 		// MSAA FRAMEBUFFERS
@@ -1031,25 +1038,9 @@ namespace mnemosy::graphics
 		m_renderMode = mode;
 	}
 
-	void Renderer::HotReloadPbrShader(float deltaSeconds) {
-
-
-		float waitTime = 5.0f;
-#ifdef MNEMOSY_CONFIG_DEBUG
-		waitTime = 0.5f;
-#endif // MNEMOSY_CONFIG_DEBUG
-
-
-		// only check every couple of seconds
-		m_fileWatchTimeDelta += deltaSeconds;
-		if (m_fileWatchTimeDelta >= waitTime) {
-
-			m_fileWatchTimeDelta = 0.0f;
-		}
-		else {
-			return;
-		}
+	void Renderer::HotReloadPbrShader() {
 
+		// the watchers collect changes on their own threads, asking them does not touch the disk
 
 		// check unlit shader
 
@@ -1164,6 +1155,7 @@ namespace mnemosy::graphics
 
 		int Msaa = renderSettings.ReadInt(success,"renderSettings_MSAA", 4, true);
 		int thumbnailRes = renderSettings.ReadInt(success, "renderSettings_ThumbnailResolution", 256, true);
+		int previewTextureRes = renderSettings.ReadInt(success, "renderSettings_PreviewTextureResolution", 4096, true);
 
 		renderSettings.FilePrettyPrintSet(true);
 		renderSettings.FileClose(success,renderSettingsFilePath);
@@ -1201,6 +1193,16 @@ namespace mnemosy::graphics
 			}
 		}
 
+		// apply preview texture resolution
+		for (int previewResEnum = 0; previewResEnum < (int)PreviewTextureResolution::MNSY_PREVIEWRES_COUNT; previewResEnum++) {
+
+			if (previewTextureRes == GetPreviewTextureResolutionValue((PreviewTextureResolution)previewResEnum)) {
+
+				SetPreviewTextureResolution((PreviewTextureResolution)previewResEnum);
+				break;
+			}
+		}
+
 	}
 
 	void Renderer::SaveUserSettings() {
@@ -1212,6 +1214,7 @@ namespace mnemosy::graphics
 
 		int thumbnailRes = GetThumbnailResolutionValue(m_thumbnailResolution);
 
+		int previewTextureRes = GetPreviewTextureResolutionValue(m_previewTextureResolution);
 
 		bool success;
 
@@ -1220,6 +1223,7 @@ namespace mnemosy::graphics
 
 		renderSettings.WriteInt(success, "renderSettings_MSAA", Msaa);
 		renderSettings.WriteInt(success, "renderSettings_ThumbnailResolution", thumbnailRes);
+		renderSettings.WriteInt(success, "renderSettings_PreviewTextureResolution", previewTextureRes);
 
 
 		renderSettings.FilePrettyPrintSet(true);
@@ -2,6 +2,7 @@
 
 #include "Include/Core/Log.h"
 #include "Include/Graphics/Utils/ShaderIncludeParser.h"
+#include "Include/Graphics/Utils/ShaderBinaryCache.h"
 
 #include <glad/glad.h>
 #include <glm/gtc/type_ptr.hpp>
@@ -36,6 +37,13 @@ namespace mnemosy::graphics
 		std::string vertexCode = Shadinclude::load(vertexPath, "#include");
 		std::string fragmentCode = Shadinclude::load(fragmentPath, "#include");
 
+		// a program linked from the same sources by this driver before is loaded from its binary instead of compiling it again
+		uint64_t binaryCacheKey = ShaderBinaryCache::MakeKey(GL_VERTEX_SHADER, vertexCode, fragmentCode);
+		if (LoadBinary_Internal(binaryCacheKey)) {
+			MNEMOSY_DEBUG("Loaded cached Shader Program: \n - VertexShader: {} - FragmentShader: {}", vertexPath, fragmentPath);
+			return true;
+		}
+
 		const char* vertexShaderCode = vertexCode.c_str();
 		const char* fragmentShaderCode = fragmentCode.c_str();
 
@@ -62,12 +70,14 @@ namespace mnemosy::graphics
 		ID = glCreateProgram();
 		glAttachShader(ID, vertexShader);
 		glAttachShader(ID, fragmentShader);
+		ShaderBinaryCache::PrepareForStore(ID);
 		glLinkProgram(ID);
 
 		bool compilationSuccessfull = CheckCompileErrors(ID, "PROGRAM");
 
 		if (compilationSuccessfull) {
 			MNEMOSY_DEBUG("Compiled Shader Program: \n - VertexShader: {} - FragmentShader: {}", vertexPath, fragmentPath);
+			StoreBinary_Internal(binaryCacheKey);
 		}
 
 		glDeleteShader(vertexShader);
@@ -88,6 +98,12 @@ namespace mnemosy::graphics
 		std::string vertexCode = Shadinclude::load(meshPath, "#include");
 		std::string fragmentCode = Shadinclude::load(fragmentPath, "#include");
 
+		uint64_t binaryCacheKey = ShaderBinaryCache::MakeKey(GL_MESH_SHADER_NV, vertexCode, fragmentCode);
+		if (LoadBinary_Internal(binaryCacheKey)) {
+			MNEMOSY_DEBUG("Loaded cached Shader Program:\nMeshShader: {}\nFragmentShader: {}", meshPath, fragmentPath);
+			return true;
+		}
+
 		const char* vertexShaderCode = vertexCode.c_str();
 		const char* fragmentShaderCode = fragmentCode.c_str();
 
@@ -113,11 +129,15 @@ namespace mnemosy::graphics
 		ID = glCreateProgram();
 		glAttachShader(ID, vertexShader);
 		glAttachShader(ID, fragmentShader);
+		ShaderBinaryCache::PrepareForStore(ID);
 		glLinkProgram(ID);
 
 
 		bool compilationSuccess = true;
 		compilationSuccess = CheckCompileErrors(ID, "PROGRAM");
+		if (compilationSuccess) {
+			StoreBinary_Internal(binaryCacheKey);
+		}
 
 		MNEMOSY_DEBUG("Compiled Shader Program:\nMeshShader: {}\nFragmentShader: {}", meshPath, fragmentPath);
 
@@ -181,6 +201,41 @@ namespace mnemosy::graphics
 	}
 	// private
 
+	bool Shader::LoadBinary_Internal(const uint64_t binaryCacheKey) {
+
+		ID = glCreateProgram();
+		if (ShaderBinaryCache::Load(ID, binaryCacheKey)) {
+			KeepBinary_Internal(binaryCacheKey);
+			return true;
+		}
+
+		glDeleteProgram(ID);
+		ID = NULL;
+		return false;
+	}
+
+	// only called once the program linked, a reload that fails to compile never costs the binaries of the sources before it
+	void Shader::StoreBinary_Internal(const uint64_t binaryCacheKey) {
+
+		ShaderBinaryCache::Store(ID, binaryCacheKey);
+		KeepBinary_Internal(binaryCacheKey);
+	}
+
+	// The binaries of the current and the previous sources are kept so reverting an edit loads the program again instead of compiling it.
+	// Anything older is removed as it would only pile up while shaders are edited.
+	void Shader::KeepBinary_Internal(const uint64_t binaryCacheKey) {
+
+		if (binaryCacheKey == m_binaryCacheKey)
+			return;
+
+		if (m_previousBinaryCacheKey != 0 && m_previousBinaryCacheKey != binaryCacheKey) {
+			ShaderBinaryCache::Remove(m_previousBinaryCacheKey);
+		}
+
+		m_previousBinaryCacheKey = m_binaryCacheKey;
+		m_binaryCacheKey = binaryCacheKey;
+	}
+
 	bool Shader::CheckCompileErrors(unsigned int shader,const std::string& type) {
 
 
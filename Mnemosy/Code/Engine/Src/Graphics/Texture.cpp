@@ -9,6 +9,7 @@
 #include <glad/glad.h>
 #include <math.h>
 #include <filesystem>
+#include <algorithm>
 
 
 namespace mnemosy::graphics
@@ -83,6 +84,8 @@ namespace mnemosy::graphics
 		// update info
 		m_width = info.width;
 		m_height = info.height;
+		m_sourceWidth = info.width;
+		m_sourceHeight = info.height;
 		m_textureFormat = info.textureFormat;
 		m_isHalfFloat = info.isHalfFloat;
 		void* pixelBuffer = info.pixels;
@@ -112,28 +115,11 @@ namespace mnemosy::graphics
 
 
 		
-		uint32_t halfFloatType = GL_UNSIGNED_SHORT;
-		if (m_isHalfFloat) {
-			halfFloatType = GL_HALF_FLOAT;
-		}
+		unsigned int internalFormat, format, type;
+		GetOpenGlFormat(m_textureFormat, m_isHalfFloat, internalFormat, format, type);
 
-		switch (m_textureFormat)
-		{
-			case mnemosy::graphics::MNSY_NONE: break;
-			// 8 bit
-			case mnemosy::graphics::MNSY_R8:    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8	 , m_width, m_height, 0, GL_RED , GL_UNSIGNED_BYTE, pixelBuffer);	break;
-			case mnemosy::graphics::MNSY_RGB8:  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8	 , m_width, m_height, 0, GL_RGB , GL_UNSIGNED_BYTE, pixelBuffer);	break;
-			case mnemosy::graphics::MNSY_RGBA8: glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8	 , m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixelBuffer);	break;
-			// 16 bit
-			case mnemosy::graphics::MNSY_R16:	glTexImage2D(GL_TEXTURE_2D, 0, GL_R16    , m_width, m_height, 0, GL_RED , halfFloatType, pixelBuffer);	break;
-			case mnemosy::graphics::MNSY_RGB16:	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16  , m_width, m_height, 0, GL_RGB , halfFloatType, pixelBuffer);	break;
-			case mnemosy::graphics::MNSY_RGBA16:glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16 , m_width, m_height, 0, GL_RGBA, halfFloatType, pixelBuffer);	break;
-			// 32 bit
-			case mnemosy::graphics::MNSY_R32:	glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F	 , m_width, m_height, 0, GL_RED , GL_FLOAT, pixelBuffer);	break;
-			case mnemosy::graphics::MNSY_RGB32:	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F , m_width, m_height, 0, GL_RGB , GL_FLOAT, pixelBuffer);	break;
-			case mnemosy::graphics::MNSY_RGBA32:glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, m_width, m_height, 0, GL_RGBA, GL_FLOAT, pixelBuffer);	break;
-		
-			default:break;
+		if (internalFormat != 0) {
+			glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, m_width, m_height, 0, format, type, pixelBuffer);
 		}
 
 
@@ -146,4 +132,69 @@ namespace mnemosy::graphics
 		return;
 	}
 
+	void Texture::AllocateOpenGlTexture(const PictureInfo& info, const bool generateMipmaps) {
+
+		// make sure previous texture is cleared if any
+		clear();
+
+		m_width = info.width;
+		m_height = info.height;
+		m_sourceWidth = info.width;
+		m_sourceHeight = info.height;
+		m_textureFormat = info.textureFormat;
+		m_isHalfFloat = info.isHalfFloat;
+
+		unsigned int internalFormat, format, type;
+		GetOpenGlFormat(m_textureFormat, m_isHalfFloat, internalFormat, format, type);
+
+		MNEMOSY_ASSERT(internalFormat != 0, "This method should be provided with a valid texture format");
+
+		int mipLevels = 1;
+		if (generateMipmaps) {
+			mipLevels = (int)floor(log2((double)std::max(m_width, m_height))) + 1;
+		}
+
+		glGenTextures(1, &m_ID);
+		glBindTexture(GL_TEXTURE_2D, m_ID);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexStorage2D(GL_TEXTURE_2D, mipLevels, internalFormat, m_width, m_height);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		m_isInitialized = true;
+	}
+
+	void Texture::GetOpenGlFormat(const TextureFormat format, const bool isHalfFloat, unsigned int& outInternalFormat, unsigned int& outFormat, unsigned int& outType) {
+
+		unsigned int halfFloatType = GL_UNSIGNED_SHORT;
+		if (isHalfFloat) {
+			halfFloatType = GL_HALF_FLOAT;
+		}
+
+		outInternalFormat = 0;
+		outFormat = 0;
+		outType = 0;
+
+		switch (format)
+		{
+			case mnemosy::graphics::MNSY_NONE: break;
+			// 8 bit
+			case mnemosy::graphics::MNSY_R8:    outInternalFormat = GL_R8;		outFormat = GL_RED;		outType = GL_UNSIGNED_BYTE;	break;
+			case mnemosy::graphics::MNSY_RGB8:  outInternalFormat = GL_RGB8;	outFormat = GL_RGB;		outType = GL_UNSIGNED_BYTE;	break;
+			case mnemosy::graphics::MNSY_RGBA8: outInternalFormat = GL_RGBA8;	outFormat = GL_RGBA;	outType = GL_UNSIGNED_BYTE;	break;
+			// 16 bit
+			case mnemosy::graphics::MNSY_R16:	outInternalFormat = GL_R16;		outFormat = GL_RED;		outType = halfFloatType;	break;
+			case mnemosy::graphics::MNSY_RGB16:	outInternalFormat = GL_RGB16;	outFormat = GL_RGB;		outType = halfFloatType;	break;
+			case mnemosy::graphics::MNSY_RGBA16:outInternalFormat = GL_RGBA16;	outFormat = GL_RGBA;	outType = halfFloatType;	break;
+			// 32 bit
+			case mnemosy::graphics::MNSY_R32:	outInternalFormat = GL_R32F;	outFormat = GL_RED;		outType = GL_FLOAT;	break;
+			case mnemosy::graphics::MNSY_RGB32:	outInternalFormat = GL_RGB32F;	outFormat = GL_RGB;		outType = GL_FLOAT;	break;
+			case mnemosy::graphics::MNSY_RGBA32:outInternalFormat = GL_RGBA32F;	outFormat = GL_RGBA;	outType = GL_FLOAT;	break;
+
+			default:break;
+		}
+	}
+
 } // !mnemosy::graphics
\ No newline at end of file
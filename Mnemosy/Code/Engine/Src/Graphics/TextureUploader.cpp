@@ -0,0 +1,422 @@
+#include "Include/Graphics/TextureUploader.h"
+
+#include "Include/Core/Log.h"
+#include "Include/Graphics/Texture.h"
+#include "Include/Graphics/TextureDefinitions.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+
+// size of the persistently mapped upload ring
+#define TEXTURE_UPLOADER_RING_SIZE 134217728 // 128 mb
+// offsets of staging regions are aligned to this
+#define TEXTURE_UPLOADER_ALIGNMENT 256
+
+namespace mnemosy::graphics
+{
+	void TextureUploader::Init() {
+
+		m_size = TEXTURE_UPLOADER_RING_SIZE;
+
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		glGenBuffers(1, &m_bufferID);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_bufferID);
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, m_size, nullptr, flags);
+		m_mappedData = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, m_size, flags);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		if (!m_mappedData) {
+			MNEMOSY_ERROR("TextureUploader: Failed to map upload buffer, textures are uploaded from client memory.");
+			glDeleteBuffers(1, &m_bufferID);
+			m_bufferID = 0;
+			return;
+		}
+
+		m_head = 0;
+		m_isInitialized = true;
+	}
+
+	void TextureUploader::Shutdown() {
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_isInitialized)
+			return;
+
+		for (StagingRegion& region : m_regions) {
+			if (region.fence) {
+				glClientWaitSync((GLsync)region.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+				glDeleteSync((GLsync)region.fence);
+			}
+		}
+		m_regions.clear();
+
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_bufferID);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glDeleteBuffers(1, &m_bufferID);
+
+		m_bufferID = 0;
+		m_mappedData = nullptr;
+		m_isInitialized = false;
+	}
+
+	void TextureUploader::Update() {
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// every region is recycled as soon as its own copy is done, one the gpu is still reading from does not hold back the others
+		for (size_t i = 0; i < m_regions.size(); ) {
+
+			StagingRegion& region = m_regions[i];
+
+			if (region.fence) {
+
+				GLenum status = glClientWaitSync((GLsync)region.fence, 0, 0);
+				if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+					i++;
+					continue;
+				}
+
+				glDeleteSync((GLsync)region.fence);
+			}
+			else if (!region.released) {
+				i++;
+				continue;
+			}
+
+			m_regions.erase(m_regions.begin() + i);
+		}
+
+		if (m_regions.empty()) {
+			m_head = 0;
+		}
+	}
+
+	bool TextureUploader::TryAllocateStaging(const size_t size, StagingBuffer& outStaging) {
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return AllocateRegion(size, outStaging);
+	}
+
+	void TextureUploader::ReleaseStaging(StagingBuffer& staging) {
+
+		if (!staging.IsValid())
+			return;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		for (StagingRegion& region : m_regions) {
+			if (region.id == staging.id) {
+				region.released = true;
+				break;
+			}
+		}
+
+		staging = StagingBuffer();
+	}
+
+	void TextureUploader::ContinueUpload(TextureUpload& upload, const size_t maxBytes) {
+
+		if (upload.IsDone())
+			return;
+
+		if (!upload.texture) {
+			upload.texture = new Texture();
+			upload.texture->AllocateOpenGlTexture(upload.info, upload.generateMipmaps || upload.mipLevels > 1);
+		}
+
+		uint8_t numChannels, bitsPerChannel, bytesPerPixel;
+		TexUtil::get_information_from_textureFormat(upload.info.textureFormat, numChannels, bitsPerChannel, bytesPerPixel);
+
+		unsigned int internalFormat, format, type;
+		Texture::GetOpenGlFormat(upload.info.textureFormat, upload.info.isHalfFloat, internalFormat, format, type);
+
+		size_t rowSize = (size_t)upload.info.width * bytesPerPixel;
+		size_t baseLevelSize = rowSize * upload.info.height;
+
+		// the alignment is global state, it is put back once the upload is done with it
+		GLint previousAlignment = 4;
+		glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousAlignment);
+
+		glBindTexture(GL_TEXTURE_2D, upload.texture->GetID());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, rowSize % 4 == 0 ? 4 : 1);
+
+		if (upload.staging.IsValid()) {
+
+			// pixels were written into the ring by the decode job already
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_bufferID);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, upload.info.width, upload.info.height, format, type, (const void*)upload.staging.offset);
+			UploadMipLevels(upload, format, type, (const uint8_t*)(upload.staging.offset + baseLevelSize));
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+			SubmitRegion(upload.staging.id);
+			upload.staging = StagingBuffer();
+			upload.rowsUploaded = upload.info.height;
+		}
+		else if (!m_isInitialized) {
+
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, upload.info.width, upload.info.height, format, type, upload.info.pixels);
+			UploadMipLevels(upload, format, type, (const uint8_t*)upload.info.pixels + baseLevelSize);
+			upload.rowsUploaded = upload.info.height;
+		}
+		else {
+
+			// The picture was decoded while the ring was full so its pixels only exist in client memory.
+			// copy bands of rows into the ring, a band never takes more than a quarter of it so other uploads can go on in the meantime
+			size_t maxBandSize = std::min(maxBytes, m_size / 4);
+			uint32_t rowsPerBand = (uint32_t)std::max<size_t>(1, maxBandSize / rowSize);
+			size_t usedBytes = 0;
+
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_bufferID);
+
+			while (upload.rowsUploaded < upload.info.height && usedBytes < maxBytes) {
+
+				uint32_t rows = std::min(rowsPerBand, upload.info.height - upload.rowsUploaded);
+				size_t bandSize = rows * rowSize;
+
+				StagingBuffer band;
+				if (!TryAllocateStaging(bandSize, band)) {
+					break; // ring is full, continue next frame
+				}
+
+				memcpy(band.data, (uint8_t*)upload.info.pixels + upload.rowsUploaded * rowSize, bandSize);
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, upload.rowsUploaded, upload.info.width, rows, format, type, (const void*)band.offset);
+				SubmitRegion(band.id);
+
+				upload.rowsUploaded += rows;
+				usedBytes += bandSize;
+			}
+
+			// the smaller levels are a third of the base level at most, they go in one piece once the base level is complete
+			if (upload.rowsUploaded == upload.info.height && upload.mipLevels > 1) {
+
+				size_t levelsSize = Picture::pic_util_mip_chain_size(upload.info, upload.mipLevels) - baseLevelSize;
+				const uint8_t* levelsPixels = (const uint8_t*)upload.info.pixels + baseLevelSize;
+
+				StagingBuffer levels;
+				if (TryAllocateStaging(levelsSize, levels)) {
+					memcpy(levels.data, levelsPixels, levelsSize);
+					UploadMipLevels(upload, format, type, (const uint8_t*)levels.offset);
+					SubmitRegion(levels.id);
+				}
+				else {
+					glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+					UploadMipLevels(upload, format, type, levelsPixels);
+				}
+			}
+
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+
+		if (upload.rowsUploaded == upload.info.height) {
+
+			if (upload.generateMipmaps && upload.mipLevels == 1) {
+				glGenerateMipmap(GL_TEXTURE_2D);
+			}
+
+			if (upload.info.pixels) {
+				free(upload.info.pixels);
+				upload.info.pixels = nullptr;
+			}
+		}
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, previousAlignment);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	void TextureUploader::FinishUpload(TextureUpload& upload) {
+
+		while (!upload.IsDone()) {
+
+			uint32_t rowsBefore = upload.rowsUploaded;
+			ContinueUpload(upload, SIZE_MAX);
+
+			if (upload.IsDone() || upload.rowsUploaded != rowsBefore)
+				continue;
+
+			// no progress because the ring is full, wait for the gpu to finish the oldest copy
+			if (WaitForOldestRegion()) {
+				Update();
+			}
+			else {
+
+				// the ring is held by reservations that were not submitted yet, there is nothing to wait on. upload the rest directly.
+				uint8_t numChannels, bitsPerChannel, bytesPerPixel;
+				TexUtil::get_information_from_textureFormat(upload.info.textureFormat, numChannels, bitsPerChannel, bytesPerPixel);
+
+				unsigned int internalFormat, format, type;
+				Texture::GetOpenGlFormat(upload.info.textureFormat, upload.info.isHalfFloat, internalFormat, format, type);
+
+				size_t rowSize = (size_t)upload.info.width * bytesPerPixel;
+
+				GLint previousAlignment = 4;
+				glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousAlignment);
+
+				glBindTexture(GL_TEXTURE_2D, upload.texture->GetID());
+				glPixelStorei(GL_UNPACK_ALIGNMENT, rowSize % 4 == 0 ? 4 : 1);
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, upload.rowsUploaded, upload.info.width, upload.info.height - upload.rowsUploaded, format, type, (uint8_t*)upload.info.pixels + upload.rowsUploaded * rowSize);
+				UploadMipLevels(upload, format, type, (const uint8_t*)upload.info.pixels + rowSize * upload.info.height);
+
+				if (upload.generateMipmaps && upload.mipLevels == 1) {
+					glGenerateMipmap(GL_TEXTURE_2D);
+				}
+				glPixelStorei(GL_UNPACK_ALIGNMENT, previousAlignment);
+				glBindTexture(GL_TEXTURE_2D, 0);
+
+				free(upload.info.pixels);
+				upload.info.pixels = nullptr;
+				upload.rowsUploaded = upload.info.height;
+			}
+		}
+	}
+
+	void TextureUploader::CancelUpload(TextureUpload& upload) {
+
+		ReleaseStaging(upload.staging);
+
+		if (upload.texture) {
+			delete upload.texture;
+			upload.texture = nullptr;
+		}
+
+		if (upload.info.pixels) {
+			free(upload.info.pixels);
+			upload.info.pixels = nullptr;
+		}
+
+		upload.rowsUploaded = 0;
+	}
+
+	// private
+
+	// expects m_mutex to be locked
+	bool TextureUploader::AllocateRegion(const size_t size, StagingBuffer& outStaging) {
+
+		if (!m_isInitialized)
+			return false;
+
+		size_t alignedSize = (size + TEXTURE_UPLOADER_ALIGNMENT - 1) & ~((size_t)TEXTURE_UPLOADER_ALIGNMENT - 1);
+
+		if (alignedSize > m_size)
+			return false;
+
+		// free memory is the gaps between the regions. the first gap that fits after the head is taken, otherwise wrap around to the first one that fits from the beginning
+		size_t offset = SIZE_MAX;
+		size_t insertAt = 0;
+		size_t wrapOffset = SIZE_MAX;
+		size_t wrapInsertAt = 0;
+		size_t gapStart = 0;
+
+		for (size_t i = 0; i <= m_regions.size(); i++) {
+
+			size_t gapEnd = i < m_regions.size() ? m_regions[i].offset : m_size;
+
+			size_t start = std::max(gapStart, m_head);
+			if (start < gapEnd && gapEnd - start >= alignedSize) {
+				offset = start;
+				insertAt = i;
+				break;
+			}
+
+			if (wrapOffset == SIZE_MAX && gapEnd - gapStart >= alignedSize) {
+				wrapOffset = gapStart;
+				wrapInsertAt = i;
+			}
+
+			if (i < m_regions.size()) {
+				gapStart = m_regions[i].offset + m_regions[i].size;
+			}
+		}
+
+		if (offset == SIZE_MAX) {
+
+			if (wrapOffset == SIZE_MAX)
+				return false;
+
+			offset = wrapOffset;
+			insertAt = wrapInsertAt;
+		}
+
+		StagingRegion region;
+		region.id = m_nextRegionID++;
+		region.offset = offset;
+		region.size = alignedSize;
+		m_regions.insert(m_regions.begin() + insertAt, region);
+
+		m_head = offset + alignedSize;
+
+		outStaging.id = region.id;
+		outStaging.offset = offset;
+		outStaging.size = size;
+		outStaging.data = m_mappedData + offset;
+
+		return true;
+	}
+
+	// places the fence for a region after the copy command that reads from it
+	void TextureUploader::SubmitRegion(const uint32_t id) {
+
+		GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		for (StagingRegion& region : m_regions) {
+			if (region.id == id) {
+				region.fence = (void*)fence;
+				return;
+			}
+		}
+
+		glDeleteSync(fence);
+	}
+
+	// uploads level 1 and up of the texture bound to GL_TEXTURE_2D. levelsSource points to the first of them in client memory or, if the ring is bound, is an offset into it.
+	void TextureUploader::UploadMipLevels(const TextureUpload& upload, const unsigned int format, const unsigned int type, const uint8_t* levelsSource) {
+
+		uint8_t numChannels, bitsPerChannel, bytesPerPixel;
+		TexUtil::get_information_from_textureFormat(upload.info.textureFormat, numChannels, bitsPerChannel, bytesPerPixel);
+
+		uint32_t width = upload.info.width;
+		uint32_t height = upload.info.height;
+		size_t offset = 0;
+
+		for (uint32_t level = 1; level < upload.mipLevels; level++) {
+
+			width = std::max(width / 2, 1u);
+			height = std::max(height / 2, 1u);
+
+			size_t rowSize = (size_t)width * bytesPerPixel;
+
+			glPixelStorei(GL_UNPACK_ALIGNMENT, rowSize % 4 == 0 ? 4 : 1);
+			glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, format, type, levelsSource + offset);
+
+			offset += rowSize * height;
+		}
+	}
+
+	bool TextureUploader::WaitForOldestRegion() {
+
+		GLsync fence = nullptr;
+		{
+			// ids grow with every allocation, the smallest one with a fence was submitted first
+			std::lock_guard<std::mutex> lock(m_mutex);
+			uint32_t oldestID = UINT32_MAX;
+			for (const StagingRegion& region : m_regions) {
+				if (region.fence && region.id < oldestID) {
+					oldestID = region.id;
+					fence = (GLsync)region.fence;
+				}
+			}
+		}
+
+		if (!fence)
+			return false;
+
+		glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		return true;
+	}
+
+} // !mnemosy::graphics
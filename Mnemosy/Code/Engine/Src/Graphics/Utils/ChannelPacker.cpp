@@ -0,0 +1,410 @@
+#include "Include/Graphics/Utils/ChannelPacker.h"
+
+#include "Include/MnemosyEngine.h"
+#include "Include/Core/JobSystem.h"
+#include "Include/Graphics/Utils/PixelConvert.h"
+
+// std
+#include <filesystem>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+// SIMD SSE2
+//#define CHANNEL_PACKER_DISABLE_SIMD
+
+#include <immintrin.h>
+
+// strips packed at once per worker, each job packs and compresses one strip of the tiff file.
+// The next batch is packed while the previous one is written, so at most twice as many strips are in memory.
+#define CHANNEL_PACKER_STRIPS_PER_WORKER 2
+
+namespace mnemosy::graphics
+{
+	// how an output channel reads its source, set up once before packing starts and only read by the jobs
+	struct ChannelPackSampler {
+		const uint8_t* pixels = nullptr; // nullptr uses value for every pixel
+		float value = 0.0f;
+		bool invert = false;
+
+		uint8_t channel = 0;
+		uint8_t channels = 0;
+		uint8_t bitsPerChannel = 0;
+		bool isHalfFloat = false;
+		uint16_t width = 0;
+		uint16_t height = 0;
+		size_t rowBytes = 0;
+
+		// sources with another size than the output are sampled bilinear, these hold the two source columns and the weight of the second one for every output column
+		bool resample = false;
+		std::vector<uint16_t> x0;
+		std::vector<uint16_t> x1;
+		std::vector<float> xWeight;
+	};
+
+	// a batch of strips that is packed at once
+	struct ChannelPackBatch {
+		std::shared_ptr<core::JobGroup> jobs;
+		uint32_t firstStrip = 0;
+		uint32_t stripCount = 0;
+		std::vector<std::vector<uint8_t>> buffers;
+	};
+
+	// clamps to 0-1, nan becomes 0 like it does with the simd min and max
+	static inline float ChannelPacker_Saturate(const float value) {
+		return value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+	}
+
+	// writes the channel of a source row as floats, one for each pixel of the source
+	static void ChannelPacker_DecodeRow(const ChannelPackSampler& sampler, const uint32_t row, float* out) {
+
+		const uint8_t* src = sampler.pixels + (size_t)row * sampler.rowBytes;
+		const uint32_t stride = sampler.channels;
+		const uint32_t width = sampler.width;
+
+		// single channel rows are contiguous and converted in bulk
+		if (stride == 1) {
+			TextureFormat format = sampler.bitsPerChannel == 8 ? MNSY_R8 : (sampler.bitsPerChannel == 16 ? MNSY_R16 : MNSY_R32);
+			PixelConvert::Convert(src, format, sampler.isHalfFloat, out, MNSY_R32, false, width, MNSY_COLOR_OP_NONE);
+			return;
+		}
+
+		if (sampler.bitsPerChannel == 8) {
+
+			const uint8_t* p = src + sampler.channel;
+			for (uint32_t x = 0; x < width; x++) {
+				out[x] = (float)p[x * stride] * (1.0f / 255.0f);
+			}
+		}
+		else if (sampler.bitsPerChannel == 16) {
+
+			const uint16_t* p = (const uint16_t*)src + sampler.channel;
+
+			if (sampler.isHalfFloat) {
+				for (uint32_t x = 0; x < width; x++) {
+					out[x] = PixelConvert::HalfToFloat(p[x * stride]);
+				}
+			}
+			else {
+				for (uint32_t x = 0; x < width; x++) {
+					out[x] = (float)p[x * stride] * (1.0f / 65535.0f);
+				}
+			}
+		}
+		else {
+
+			const float* p = (const float*)src + sampler.channel;
+			for (uint32_t x = 0; x < width; x++) {
+				out[x] = p[x * stride];
+			}
+		}
+	}
+
+	// a += (b - a) * t
+	static void ChannelPacker_Lerp(float* a, const float* b, const float t, const uint32_t count) {
+
+		uint32_t i = 0;
+
+#ifndef CHANNEL_PACKER_DISABLE_SIMD
+		const __m128 weight = _mm_set1_ps(t);
+
+		for (; i + 4 <= count; i += 4) {
+			__m128 va = _mm_loadu_ps(a + i);
+			__m128 vb = _mm_loadu_ps(b + i);
+			_mm_storeu_ps(a + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), weight)));
+		}
+#endif // !CHANNEL_PACKER_DISABLE_SIMD
+
+		for (; i < count; i++) {
+			a[i] += (b[i] - a[i]) * t;
+		}
+	}
+
+	// values = 1 - saturate(values)
+	static void ChannelPacker_Invert(float* values, const uint32_t count) {
+
+		uint32_t i = 0;
+
+#ifndef CHANNEL_PACKER_DISABLE_SIMD
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+
+		for (; i + 4 <= count; i += 4) {
+			__m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values + i), zero), one);
+			_mm_storeu_ps(values + i, _mm_sub_ps(one, v));
+		}
+#endif // !CHANNEL_PACKER_DISABLE_SIMD
+
+		for (; i < count; i++) {
+			values[i] = 1.0f - ChannelPacker_Saturate(values[i]);
+		}
+	}
+
+	// writes the values of the output row to out, one for each output pixel
+	static void ChannelPacker_SampleRow(const ChannelPackSampler& sampler, const uint32_t row, const uint16_t width, const uint16_t height, float* out, float* scratchA, float* scratchB) {
+
+		if (!sampler.pixels) {
+			std::fill(out, out + width, sampler.value);
+			return;
+		}
+
+		if (!sampler.resample) {
+			ChannelPacker_DecodeRow(sampler, row, out);
+			return;
+		}
+
+		// pixel centers of the output mapped onto the source, same as sampling with normalized uvs on the gpu
+		float sourceY = ((float)row + 0.5f) * (float)sampler.height / (float)height - 0.5f;
+		sourceY = std::max(sourceY, 0.0f);
+
+		uint32_t y0 = std::min((uint32_t)sourceY, (uint32_t)sampler.height - 1);
+		uint32_t y1 = std::min(y0 + 1, (uint32_t)sampler.height - 1);
+		float yWeight = std::min(sourceY - (float)y0, 1.0f);
+
+		ChannelPacker_DecodeRow(sampler, y0, scratchA);
+		if (y1 != y0 && yWeight > 0.0f) {
+			ChannelPacker_DecodeRow(sampler, y1, scratchB);
+			ChannelPacker_Lerp(scratchA, scratchB, yWeight, sampler.width);
+		}
+
+		for (uint32_t x = 0; x < width; x++) {
+			float a = scratchA[sampler.x0[x]];
+			float b = scratchA[sampler.x1[x]];
+			out[x] = a + (b - a) * sampler.xWeight[x];
+		}
+	}
+
+	// runs on a job thread, packs rowCount rows starting at firstRow of the file into out
+	static void ChannelPacker_PackStrip(const ChannelPackSampler* samplers, const uint8_t numChannels, const uint16_t width, const uint16_t height, const uint8_t bitDepth, const bool flipVertically, const uint32_t firstRow, const uint32_t rowCount, uint8_t* out) {
+
+		uint32_t maxSourceWidth = width;
+		for (uint8_t c = 0; c < numChannels; c++) {
+			maxSourceWidth = std::max(maxSourceWidth, (uint32_t)samplers[c].width);
+		}
+
+		std::vector<float> values(width);
+		std::vector<float> scratchA(maxSourceWidth);
+		std::vector<float> scratchB(maxSourceWidth);
+		std::vector<uint16_t> quantized(width); // also used for 8 bit values
+
+		const size_t rowBytes = (size_t)width * numChannels * (bitDepth / 8);
+
+		for (uint32_t r = 0; r < rowCount; r++) {
+
+			uint32_t fileRow = firstRow + r;
+			uint32_t row = flipVertically ? height - 1 - fileRow : fileRow;
+			uint8_t* dst = out + r * rowBytes;
+
+			for (uint8_t c = 0; c < numChannels; c++) {
+
+				const ChannelPackSampler& sampler = samplers[c];
+
+				ChannelPacker_SampleRow(sampler, row, width, height, values.data(), scratchA.data(), scratchB.data());
+
+				if (sampler.invert) {
+					ChannelPacker_Invert(values.data(), width);
+				}
+
+				if (bitDepth == 8) {
+
+					// saturate, scale and round to nearest like the gpu does when converting to unsigned normalized formats
+					uint8_t* q = (uint8_t*)quantized.data();
+					PixelConvert::Convert(values.data(), MNSY_R32, false, q, MNSY_R8, false, width, MNSY_COLOR_OP_NONE);
+
+					for (uint32_t x = 0; x < width; x++) {
+						dst[x * numChannels + c] = q[x];
+					}
+				}
+				else if (bitDepth == 16) {
+
+					PixelConvert::Convert(values.data(), MNSY_R32, false, quantized.data(), MNSY_R16, false, width, MNSY_COLOR_OP_NONE);
+
+					uint16_t* d = (uint16_t*)dst;
+					for (uint32_t x = 0; x < width; x++) {
+						d[x * numChannels + c] = quantized[x];
+					}
+				}
+				else {
+					// float outputs are not clamped, same as reading back a float render target
+					float* d = (float*)dst;
+					for (uint32_t x = 0; x < width; x++) {
+						d[x * numChannels + c] = values[x];
+					}
+				}
+			}
+		}
+	}
+
+	// each job packs its strip into its buffer of the batch and replaces it with the encoded strip, an empty buffer means it failed
+	static void ChannelPacker_SubmitBatch(ChannelPackBatch& batch, const uint32_t firstStrip, const uint32_t stripCount, const TiffStripWriter& writer, const ChannelPackSampler* samplers, const uint8_t numChannels, const uint16_t width, const uint16_t height, const uint8_t bitDepth, const bool flipVertically) {
+
+		core::JobSystem& jobSystem = MnemosyEngine::GetInstance().GetJobSystem();
+
+		batch.jobs = core::JobSystem::CreateGroup();
+		batch.firstStrip = firstStrip;
+		batch.stripCount = stripCount;
+
+		const uint32_t rowsPerStrip = writer.GetRowsPerStrip();
+		const size_t rowBytes = writer.GetRowSize();
+
+		for (uint32_t i = 0; i < stripCount; i++) {
+
+			uint32_t strip = firstStrip + i;
+			uint32_t firstRow = strip * rowsPerStrip;
+			uint32_t rowCount = std::min(rowsPerStrip, (uint32_t)height - firstRow);
+			std::vector<uint8_t>* buffer = &batch.buffers[i];
+
+			jobSystem.Submit(batch.jobs, [=, &writer]() {
+
+				// the previous strip in this buffer may have been compressed to another size
+				buffer->resize(rowCount * rowBytes);
+				ChannelPacker_PackStrip(samplers, numChannels, width, height, bitDepth, flipVertically, firstRow, rowCount, buffer->data());
+
+				if (!writer.EncodeStrip(strip, *buffer)) {
+					buffer->clear();
+				}
+			}, core::MNSY_JOB_PRIORITY_HIGH);
+		}
+	}
+
+	void ChannelPacker::PackToTiff(PictureError& outPictureError, const char* filepath, const ChannelPackSource* sources, const uint8_t numChannels, const uint16_t width, const uint16_t height, const uint8_t bitDepth, const bool flipVertically) {
+
+		// initialize outputs
+		outPictureError.wasSuccessfull = true;
+		outPictureError.what = "";
+
+		if (numChannels < 1 || numChannels > 4 || width == 0 || height == 0 || (bitDepth != 8 && bitDepth != 16 && bitDepth != 32)) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "PackToTiff: Unsupported output size or format.";
+			return;
+		}
+
+		ChannelPackSampler samplers[4];
+
+		for (uint8_t c = 0; c < numChannels; c++) {
+
+			const ChannelPackSource& source = sources[c];
+			ChannelPackSampler& sampler = samplers[c];
+
+			sampler.value = source.value;
+			sampler.invert = source.invert;
+
+			const PictureInfo* picture = source.picture;
+			if (!picture)
+				continue;
+
+			uint8_t channels, bitsPerChannel, bytesPerPixel;
+			TexUtil::get_information_from_textureFormat(picture->textureFormat, channels, bitsPerChannel, bytesPerPixel);
+
+			if (!picture->pixels || picture->width == 0 || picture->height == 0 || channels == 0) {
+				outPictureError.wasSuccessfull = false;
+				outPictureError.what = "PackToTiff: Source picture has no pixels.";
+				return;
+			}
+
+			// the gpu reads missing color channels as 0 too
+			if (source.channel >= channels) {
+				sampler.value = 0.0f;
+				continue;
+			}
+
+			sampler.pixels = (const uint8_t*)picture->pixels;
+			sampler.channel = source.channel;
+			sampler.channels = channels;
+			sampler.bitsPerChannel = bitsPerChannel;
+			sampler.isHalfFloat = picture->isHalfFloat;
+			sampler.width = picture->width;
+			sampler.height = picture->height;
+			sampler.rowBytes = (size_t)picture->width * bytesPerPixel;
+			sampler.resample = picture->width != width || picture->height != height;
+
+			if (sampler.resample) {
+
+				sampler.x0.resize(width);
+				sampler.x1.resize(width);
+				sampler.xWeight.resize(width);
+
+				for (uint32_t x = 0; x < width; x++) {
+
+					float sourceX = std::max(((float)x + 0.5f) * (float)picture->width / (float)width - 0.5f, 0.0f);
+					uint32_t x0 = std::min((uint32_t)sourceX, (uint32_t)picture->width - 1);
+
+					sampler.x0[x] = (uint16_t)x0;
+					sampler.x1[x] = (uint16_t)std::min(x0 + 1, (uint32_t)picture->width - 1);
+					sampler.xWeight[x] = std::min(sourceX - (float)x0, 1.0f);
+				}
+			}
+		}
+
+		// 8 bit formats come first, then 16 and 32 bit, each with 1 to 4 channels
+		TextureFormat format = (TextureFormat)((bitDepth == 8 ? 0 : (bitDepth == 16 ? 4 : 8)) + numChannels);
+
+		// same strips, compression and predictor as WriteTiff()
+		TiffStripWriter writer;
+		writer.Open(outPictureError, filepath, width, height, format);
+		if (!outPictureError.wasSuccessfull) {
+			outPictureError.what = "PackToTiff: " + outPictureError.what;
+			return;
+		}
+
+		const uint32_t stripCount = writer.GetStripCount();
+		const uint32_t workerCount = std::max(MnemosyEngine::GetInstance().GetJobSystem().GetWorkerCount(), 1u);
+		const uint32_t stripsPerBatch = std::min(workerCount * CHANNEL_PACKER_STRIPS_PER_WORKER, stripCount);
+
+		ChannelPackBatch batches[2];
+		for (ChannelPackBatch& batch : batches) {
+			batch.buffers.resize(stripsPerBatch);
+			for (std::vector<uint8_t>& buffer : batch.buffers) {
+				buffer.reserve(writer.GetRowSize() * writer.GetRowsPerStrip());
+			}
+		}
+
+		core::JobSystem& jobSystem = MnemosyEngine::GetInstance().GetJobSystem();
+
+		ChannelPacker_SubmitBatch(batches[0], 0, stripsPerBatch, writer, samplers, numChannels, width, height, bitDepth, flipVertically);
+
+		bool writeFailed = false;
+
+		for (uint32_t b = 0; ; b ^= 1) {
+
+			ChannelPackBatch& batch = batches[b];
+			ChannelPackBatch& nextBatch = batches[b ^ 1];
+
+			jobSystem.Wait(batch.jobs);
+
+			// pack the next strips while these are written
+			uint32_t nextStrip = batch.firstStrip + batch.stripCount;
+			if (nextStrip < stripCount) {
+				ChannelPacker_SubmitBatch(nextBatch, nextStrip, std::min(stripsPerBatch, stripCount - nextStrip), writer, samplers, numChannels, width, height, bitDepth, flipVertically);
+			}
+
+			for (uint32_t i = 0; i < batch.stripCount && !writeFailed; i++) {
+
+				if (batch.buffers[i].empty() || !writer.WriteStrip(batch.firstStrip + i, batch.buffers[i])) {
+					writeFailed = true;
+				}
+			}
+
+			if (nextStrip >= stripCount)
+				break;
+
+			if (writeFailed) {
+				// the jobs write into our buffers and read the samplers, they have to finish before we return
+				nextBatch.jobs->Cancel();
+				jobSystem.Wait(nextBatch.jobs);
+				break;
+			}
+		}
+
+		// removes the file if a strip is missing
+		writer.Close(outPictureError);
+
+		if (writeFailed) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "PackToTiff: Failed to write pixel data. Path: " + std::string(filepath);
+		}
+	}
+
+} // ! namespace mnemosy::graphics
@@ -6,12 +6,16 @@
 #include "Include/Core/Utils/StringUtils.h"
 
 #include "Include/Graphics/TextureDefinitions.h"
+#include "Include/Graphics/Utils/Picture.h"
 
 #include <filesystem>
+#include <fstream>
+#include <algorithm>
 #include <math.h>
 #include <stdio.h>
 
 #include <thread>
+#include <atomic>
 
 #include <glad/glad.h>
 
@@ -20,11 +24,21 @@
 //#include <vk_format.h>
 //#include <ktxvulkan.h>
 #include <ktxint.h>
+#include <basisu/zstd/zstd.h> // part of the static libktx build
 
 #include <half.h>
 
 // TODO: try to clean this up.. unneccessary dublicated functionality...
 
+// key value entry of mip chain cache files, identifies the source file the levels were decoded from
+#define KTXIMAGE_SOURCE_STAMP_KEY "MnemosySourceStamp"
+// the level index of a ktx2 file starts right after the fixed size header
+#define KTXIMAGE_KTX2_LEVEL_INDEX_OFFSET 80
+// kvdByteOffset and kvdByteLength of a ktx2 file, both uint32
+#define KTXIMAGE_KTX2_KVD_INDEX_OFFSET 56
+// zstd level the mip chain cache is supercompressed with, decoding speed does not depend on it
+#define KTXIMAGE_MIP_CHAIN_ZSTD_LEVEL 3
+
 
 namespace mnemosy::graphics
 {
@@ -992,6 +1006,373 @@ namespace mnemosy::graphics
 		return (unsigned int)KTX_SUCCESS;
 	}
 
+	const bool KtxImage::SaveMipChain(const char* filepath, const std::vector<PictureInfo>& levels, const std::string& sourceStamp) {
+
+		namespace fs = std::filesystem;
+
+		std::string utf8Path{ filepath };
+		utf8Path = core::StringUtils::string_fix_u8Encoding(utf8Path);
+
+		if (levels.empty() || levels[0].pixels == nullptr || levels[0].textureFormat == TextureFormat::MNSY_NONE) {
+			return false;
+		}
+
+		const PictureInfo& base = levels[0];
+
+		uint8_t _numChannels, _bitsPerChannel, _bytesPerPixel;
+		graphics::TexUtil::get_information_from_textureFormat(base.textureFormat, _numChannels, _bitsPerChannel, _bytesPerPixel);
+
+		ktxTexture2* kTexture = nullptr;
+		ktxTextureCreateInfo createInfo;
+		KTX_error_code errorCode;
+
+		createInfo.vkFormat = GetVkFormatFromMnemosyFormat(base.textureFormat, base.isHalfFloat);
+		createInfo.baseWidth = base.width;
+		createInfo.baseHeight = base.height;
+		createInfo.baseDepth = 1;
+		createInfo.numDimensions = 2;
+		createInfo.numLevels = (ktx_uint32_t)levels.size();
+		createInfo.numLayers = 1;
+		createInfo.numFaces = 1;
+		createInfo.isArray = KTX_FALSE;
+		createInfo.generateMipmaps = KTX_FALSE;
+
+		errorCode = ktxTexture2_Create(&createInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &kTexture);
+		if (errorCode != 0) {
+			MNEMOSY_ERROR("KtxImage::SaveMipChain: Create Texture Failed \nError code: {}", ktxErrorString(errorCode));
+			if (kTexture) {
+				ktxTexture_Destroy(ktxTexture(kTexture));
+			}
+			return false;
+		}
+
+		for (ktx_uint32_t level = 0; level < createInfo.numLevels; level++) {
+
+			size_t levelSize = (size_t)levels[level].width * levels[level].height * _bytesPerPixel;
+
+			errorCode = ktxTexture_SetImageFromMemory(ktxTexture(kTexture), level, 0, 0, (const ktx_uint8_t*)levels[level].pixels, levelSize);
+			if (errorCode != 0) {
+				MNEMOSY_ERROR("KtxImage::SaveMipChain: SetImageFromMemory Failed \nError code: {}", ktxErrorString(errorCode));
+				ktxTexture_Destroy(ktxTexture(kTexture));
+				return false;
+			}
+		}
+
+		// the cache sits next to the originals, compressing it keeps it from doubling the size of the library
+		errorCode = ktxTexture2_DeflateZstd(kTexture, KTXIMAGE_MIP_CHAIN_ZSTD_LEVEL);
+		if (errorCode != 0) {
+			MNEMOSY_ERROR("KtxImage::SaveMipChain: DeflateZstd Failed \nError code: {}", ktxErrorString(errorCode));
+			ktxTexture_Destroy(ktxTexture(kTexture));
+			return false;
+		}
+
+		ktxHashList_AddKVPair(&kTexture->kvDataHead, KTXIMAGE_SOURCE_STAMP_KEY, (unsigned int)sourceStamp.size() + 1, sourceStamp.c_str());
+
+		// write to a temporary file first so a reader never sees a half written file,
+		// the counter keeps two writers of the same slot from writing into one temporary file
+		static std::atomic<uint32_t> s_tmpCounter = 0;
+		std::string tmpPath = utf8Path + "." + std::to_string(s_tmpCounter++) + ".tmp";
+
+		errorCode = ktxTexture_WriteToNamedFile(ktxTexture(kTexture), tmpPath.c_str());
+		ktxTexture_Destroy(ktxTexture(kTexture));
+
+		std::error_code ec;
+
+		if (errorCode != 0) {
+			MNEMOSY_ERROR("KtxImage::SaveMipChain: WriteToNamedFile Failed \nError code: {}", ktxErrorString(errorCode));
+			fs::remove(fs::u8path(tmpPath), ec);
+			return false;
+		}
+
+		fs::rename(fs::u8path(tmpPath), fs::u8path(utf8Path), ec);
+		if (ec) {
+			MNEMOSY_ERROR("KtxImage::SaveMipChain: Failed to move file into place \nMessage: {}", ec.message());
+			fs::remove(fs::u8path(tmpPath), ec);
+			return false;
+		}
+
+		return true;
+	}
+
+	const bool KtxImage::LoadMipChain(const char* filepath, const std::string& sourceStamp, const uint16_t maxResolution, PictureInfo& outInfo, uint32_t& outMipLevels) {
+
+		PictureInfo info;
+		uint32_t mipLevels = 0;
+
+		if (!OpenMipChain(filepath, sourceStamp, maxResolution, info, mipLevels)) {
+			return false;
+		}
+
+		uint8_t* buffer = (uint8_t*)malloc(Picture::pic_util_mip_chain_size(info, mipLevels));
+		if (!buffer) {
+			return false;
+		}
+
+		if (!ReadMipLevels(buffer, 0, mipLevels)) {
+			free(buffer);
+			return false;
+		}
+
+		info.pixels = buffer;
+		outInfo = info;
+		outMipLevels = mipLevels;
+
+		return true;
+	}
+
+	const bool KtxImage::OpenMipChain(const char* filepath, const std::string& sourceStamp, const uint16_t maxResolution, PictureInfo& outInfo, uint32_t& outMipLevels) {
+
+		namespace fs = std::filesystem;
+
+		m_mipChainPath.clear();
+		m_mipChainLevels.clear();
+		m_mipChainFileSize = 0;
+		m_mipChainIsZstd = false;
+
+		std::string utf8Path{ filepath };
+		utf8Path = core::StringUtils::string_fix_u8Encoding(utf8Path);
+
+		std::error_code ec;
+		if (!fs::exists(fs::u8path(utf8Path), ec)) {
+			return false;
+		}
+
+		// without flags only the header and key value data are read, the levels we need are read by ReadMipLevels().
+		ktxTexture2* kTexture = nullptr;
+		KTX_error_code errorCode = ktxTexture2_CreateFromNamedFile(utf8Path.c_str(), KTX_TEXTURE_CREATE_NO_FLAGS, &kTexture);
+		if (errorCode != 0) {
+			if (kTexture) {
+				ktxTexture_Destroy(ktxTexture(kTexture));
+			}
+			return false;
+		}
+
+		unsigned int stampLength = 0;
+		void* stampValue = nullptr;
+		bool stampMatches = sourceStamp.empty() || ktxHashList_FindValue(&kTexture->kvDataHead, KTXIMAGE_SOURCE_STAMP_KEY, &stampLength, &stampValue) == KTX_SUCCESS
+			&& stampLength == sourceStamp.size() + 1
+			&& memcmp(stampValue, sourceStamp.c_str(), stampLength) == 0;
+
+		VkFormat vkFormat = (VkFormat)kTexture->vkFormat;
+		TextureFormat format = GetMnemosyFormatFromVkFormat(vkFormat);
+		bool isHalfFloat = vkFormat == VK_FORMAT_R16_SFLOAT || vkFormat == VK_FORMAT_R16G16_SFLOAT || vkFormat == VK_FORMAT_R16G16B16_SFLOAT || vkFormat == VK_FORMAT_R16G16B16A16_SFLOAT;
+		bool isZstd = kTexture->supercompressionScheme == KTX_SS_ZSTD;
+		bool isSupported = format != TextureFormat::MNSY_NONE && (kTexture->supercompressionScheme == KTX_SS_NONE || isZstd) && kTexture->numFaces == 1 && !kTexture->isArray;
+
+		uint32_t numLevels = kTexture->numLevels;
+		uint32_t baseWidth = kTexture->baseWidth;
+		uint32_t baseHeight = kTexture->baseHeight;
+
+		ktxTexture_Destroy(ktxTexture(kTexture));
+
+		if (!stampMatches || !isSupported) {
+			return false;
+		}
+
+		// skip levels that are larger than maxResolution
+		uint32_t firstLevel = 0;
+		uint32_t levelWidth = baseWidth;
+		uint32_t levelHeight = baseHeight;
+
+		while (maxResolution != 0 && std::max(levelWidth, levelHeight) > maxResolution && firstLevel + 1 < numLevels) {
+			firstLevel++;
+			levelWidth = std::max(levelWidth / 2, 1u);
+			levelHeight = std::max(levelHeight / 2, 1u);
+		}
+
+		std::ifstream file(fs::u8path(utf8Path), std::ios::binary | std::ios::ate);
+		if (!file) {
+			return false;
+		}
+
+		uint64_t fileSize = (uint64_t)file.tellg();
+
+		// for each level: byteOffset, byteLength, uncompressedByteLength
+		std::vector<uint64_t> levelIndex((size_t)numLevels * 3);
+		file.seekg(KTXIMAGE_KTX2_LEVEL_INDEX_OFFSET);
+		file.read((char*)levelIndex.data(), levelIndex.size() * sizeof(uint64_t));
+		if (!file) {
+			return false;
+		}
+
+		uint8_t _numChannels, _bitsPerChannel, _bytesPerPixel;
+		graphics::TexUtil::get_information_from_textureFormat(format, _numChannels, _bitsPerChannel, _bytesPerPixel);
+
+		// every level, including skipped ones, has to match the size the header describes and lie within the file.
+		// Without supercompression the stored and uncompressed lengths are the same, with zstd only the uncompressed one is known up front.
+		{
+			uint32_t checkWidth = baseWidth;
+			uint32_t checkHeight = baseHeight;
+
+			for (uint32_t level = 0; level < numLevels; level++) {
+
+				uint64_t expectedSize = (uint64_t)checkWidth * checkHeight * _bytesPerPixel;
+				uint64_t byteOffset = levelIndex[level * 3];
+				uint64_t byteLength = levelIndex[level * 3 + 1];
+				uint64_t uncompressedByteLength = levelIndex[level * 3 + 2];
+
+				bool lengthMatches = isZstd ? byteLength != 0 : byteLength == expectedSize;
+
+				if (!lengthMatches || uncompressedByteLength != expectedSize || byteOffset > fileSize || byteLength > fileSize - byteOffset) {
+					MNEMOSY_WARN("KtxImage::OpenMipChain: Level {} does not match the header, file is ignored \nPath: {}", level, utf8Path);
+					return false;
+				}
+
+				checkWidth = std::max(checkWidth / 2, 1u);
+				checkHeight = std::max(checkHeight / 2, 1u);
+			}
+		}
+
+		m_mipChainPath = utf8Path;
+		m_mipChainFileSize = fileSize;
+		m_mipChainIsZstd = isZstd;
+		for (uint32_t level = firstLevel; level < numLevels; level++) {
+			m_mipChainLevels.push_back(levelIndex[level * 3]);
+			m_mipChainLevels.push_back(levelIndex[level * 3 + 1]);
+			m_mipChainLevels.push_back(levelIndex[level * 3 + 2]);
+		}
+
+		outInfo = PictureInfo((uint16_t)levelWidth, (uint16_t)levelHeight, format, isHalfFloat, nullptr);
+		outMipLevels = numLevels - firstLevel;
+
+		width = (uint16_t)baseWidth;
+		height = (uint16_t)baseHeight;
+		numChannels = _numChannels;
+
+		return true;
+	}
+
+	const bool KtxImage::ReadMipLevels(void* destination, const uint32_t firstLevel, const uint32_t levelCount) {
+
+		namespace fs = std::filesystem;
+
+		if (m_mipChainPath.empty() || (size_t)(firstLevel + levelCount) * 3 > m_mipChainLevels.size()) {
+			return false;
+		}
+
+		// the cache may have been written again since it was opened
+		std::ifstream file(fs::u8path(m_mipChainPath), std::ios::binary | std::ios::ate);
+		if (!file || (uint64_t)file.tellg() != m_mipChainFileSize) {
+			return false;
+		}
+
+		size_t offset = 0;
+
+		// compressed levels go through this buffer and are decompressed straight into the destination
+		std::vector<char> compressed;
+
+		for (uint32_t level = firstLevel; level < firstLevel + levelCount; level++) {
+
+			size_t byteLength = (size_t)m_mipChainLevels[level * 3 + 1];
+			size_t levelSize = (size_t)m_mipChainLevels[level * 3 + 2];
+
+			file.seekg(m_mipChainLevels[level * 3]);
+
+			if (!m_mipChainIsZstd) {
+
+				file.read((char*)destination + offset, levelSize);
+				if (!file) {
+					return false;
+				}
+			}
+			else {
+
+				compressed.resize(byteLength);
+				file.read(compressed.data(), byteLength);
+				if (!file) {
+					return false;
+				}
+
+				size_t decompressedSize = ZSTD_decompress((char*)destination + offset, levelSize, compressed.data(), byteLength);
+				if (ZSTD_isError(decompressedSize) || decompressedSize != levelSize) {
+					MNEMOSY_WARN("KtxImage::ReadMipLevels: Failed to decompress level {} \nPath: {}", level, m_mipChainPath);
+					return false;
+				}
+			}
+
+			offset += levelSize;
+		}
+
+		return true;
+	}
+
+	const bool KtxImage::RestampMipChain(const char* filepath, const std::string& oldStamp, const std::string& newStamp) {
+
+		namespace fs = std::filesystem;
+
+		if (oldStamp.size() != newStamp.size()) {
+			return false;
+		}
+
+		std::string utf8Path{ filepath };
+		utf8Path = core::StringUtils::string_fix_u8Encoding(utf8Path);
+
+		std::fstream file(fs::u8path(utf8Path), std::ios::binary | std::ios::in | std::ios::out);
+		if (!file) {
+			return false;
+		}
+
+		static const uint8_t ktx2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+		uint8_t identifier[12];
+		file.read((char*)identifier, sizeof(identifier));
+		if (!file || memcmp(identifier, ktx2Identifier, sizeof(identifier)) != 0) {
+			return false;
+		}
+
+		uint32_t kvdIndex[2];
+		file.seekg(KTXIMAGE_KTX2_KVD_INDEX_OFFSET);
+		file.read((char*)kvdIndex, sizeof(kvdIndex));
+		if (!file) {
+			return false;
+		}
+
+		uint32_t kvdByteOffset = kvdIndex[0];
+		uint32_t kvdByteLength = kvdIndex[1];
+
+		std::vector<char> kvd(kvdByteLength);
+		file.seekg(kvdByteOffset);
+		file.read(kvd.data(), kvd.size());
+		if (!file) {
+			return false;
+		}
+
+		// every entry is its uint32 keyAndValueByteLength, the key including its terminator and the value, padded to 4 bytes
+		const size_t keySize = sizeof(KTXIMAGE_SOURCE_STAMP_KEY); // including the terminator
+		size_t pos = 0;
+
+		while (pos + sizeof(uint32_t) <= kvd.size()) {
+
+			uint32_t keyAndValueByteLength = 0;
+			memcpy(&keyAndValueByteLength, kvd.data() + pos, sizeof(uint32_t));
+
+			size_t entry = pos + sizeof(uint32_t);
+			if (keyAndValueByteLength > kvd.size() - entry) {
+				return false;
+			}
+
+			if (keyAndValueByteLength >= keySize && memcmp(kvd.data() + entry, KTXIMAGE_SOURCE_STAMP_KEY, keySize) == 0) {
+
+				size_t valueOffset = entry + keySize;
+				size_t valueLength = keyAndValueByteLength - keySize;
+
+				if (valueLength != oldStamp.size() + 1 || memcmp(kvd.data() + valueOffset, oldStamp.c_str(), valueLength) != 0) {
+					return false;
+				}
+
+				file.seekp((std::streamoff)kvdByteOffset + (std::streamoff)valueOffset);
+				file.write(newStamp.c_str(), newStamp.size() + 1);
+				file.flush();
+
+				return (bool)file;
+			}
+
+			pos = entry + ((keyAndValueByteLength + 3) & ~3u);
+		}
+
+		return false;
+	}
+
 	TextureFormat KtxImage::GetMnemosyFormatFromVkFormat(VkFormat vkFormat) {
 		switch (vkFormat)
 		{
@@ -1005,11 +1386,10 @@ namespace mnemosy::graphics
 		case VK_FORMAT_R16G16B16_UNORM:		return TextureFormat::MNSY_RGB16;
 		case VK_FORMAT_R16G16B16A16_UNORM:	return TextureFormat::MNSY_RGBA16;
 
-		// for future
-		//case VK_FORMAT_R16_SFLOAT:			return TextureFormat::MNSY_NONE;
-		//case VK_FORMAT_R16G16_SFLOAT:		return TextureFormat::MNSY_NONE;
-		//case VK_FORMAT_R16G16B16_SFLOAT:	return TextureFormat::MNSY_NONE;
-		//case VK_FORMAT_R16G16B16A16_SFLOAT: return TextureFormat::MNSY_NONE;
+		case VK_FORMAT_R16_SFLOAT:			return TextureFormat::MNSY_R16;
+		case VK_FORMAT_R16G16_SFLOAT:		return TextureFormat::MNSY_RG16;
+		case VK_FORMAT_R16G16B16_SFLOAT:	return TextureFormat::MNSY_RGB16;
+		case VK_FORMAT_R16G16B16A16_SFLOAT: return TextureFormat::MNSY_RGBA16;
 
 		case VK_FORMAT_R32_SFLOAT:				return TextureFormat::MNSY_R32;
 		case VK_FORMAT_R32G32_SFLOAT:			return TextureFormat::MNSY_RG32;
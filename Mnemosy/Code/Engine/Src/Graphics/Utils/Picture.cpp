@@ -5,6 +5,8 @@
 
 #include "Include/MnemosyEngine.h"
 #include "Include/Core/Clock.h"
+#include "Include/Core/JobSystem.h"
+#include "Include/Graphics/Utils/PixelConvert.h"
 
 // std
 #include <filesystem>
@@ -13,11 +15,15 @@
 #include <stdint.h>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <algorithm>
+#include <string.h>
+#include <stdio.h>
 
-// SIMD SSE/AVX
-//#define PICTURE_DISABLE_SIMD
-
-#include <immintrin.h>
+// Tiff images with a decoded size below this are read and written on the calling thread only.
+#define PICTURE_TIFF_PARALLEL_MIN_BYTES 4194304 // 4 MB
+// uncompressed size of the strips written by WriteTiff. big enough for the codecs to find redundancy and to keep reads to a few calls, small enough to spread an image across the workers
+#define PICTURE_TIFF_STRIP_BYTES 262144 // 256 KB
 
 
 // Png - lodepng
@@ -38,6 +44,11 @@
 #include <ImfStringAttribute.h>
 #include <ImfEnvmapAttribute.h>
 #include <ImfFrameBuffer.h>
+#include <ImfMultiPartInputFile.h>
+#include <ImfInputPart.h>
+#include <ImfTiledInputPart.h>
+#include <ImfPartType.h>
+#include <ImfThreading.h>
 
 // jpg, hdr - stbImage
 //#define STBI_NO_JPEG
@@ -65,139 +76,339 @@
 
 namespace mnemosy::graphics {
 
-	void TiffReadStripsPerThread(TIFF* handle,void* buffer,graphics::TextureFormat channelFormat,uint32_t stripSize, uint32_t stripStart,uint32_t stripEnd ) {
+	// describes one parallel tiff decode. a 'band' is either one strip or one row of tiles, the unit of work handed to a worker.
+	struct TiffDecodeJob {
+		void* dstBuffer = nullptr;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t srcChannels = 0;
+		uint32_t dstChannels = 0;
+		uint32_t bytesPerChannel = 0;
+		TextureFormat srcFormat = MNSY_NONE;
+		TextureFormat dstFormat = MNSY_NONE;
+		bool flipVertically = false;
+		bool isTiled = false;
+		uint32_t bandHeight = 0;	// rows per strip or tile length
+		uint32_t tileWidth = 0;		// only used if isTiled
+		uint32_t bandCount = 0;
+		size_t scratchSize = 0;		// strip or tile size in bytes
+	};
+
+	TIFF* TiffOpenForRead(const char* filepath) {
+
+		TIFFOpenOptions* opts = TIFFOpenOptionsAlloc();
 
+		// make sure we can read big enough images
+		tmsize_t limit = (sizeof(uint32_t) * 4 * 16384 * 16384); // sizeof(uint32_t) * channels * width * height
 
-		if (channelFormat == TextureFormat::MNSY_R8) {
+		TIFFOpenOptionsSetMaxSingleMemAlloc(opts, limit);
 
-			for (uint32_t strip = stripStart; strip < stripEnd; strip++) {
-				size_t offset = strip * stripSize;
-				TIFFReadEncodedStrip(handle, strip, (uint8_t*)buffer + offset, -1);
-			}
+		TIFF* tif = TIFFOpenExt(filepath, "r", opts);
+
+		TIFFOpenOptionsFree(opts);
+
+		return tif;
+	}
+
+	// copies pixelCount pixels from a decoded scanline into the destination row, duplicating gray to RGB if src has 1 and dst has 3 channels.
+	void TiffConvertScanline(const void* src, void* dst, uint32_t pixelCount, const TiffDecodeJob& job) {
+		PixelConvert::Convert(src, job.srcFormat, false, dst, job.dstFormat, false, pixelCount, MNSY_COLOR_OP_NONE);
+	}
+
+	// Decodes bands until none are left. Bands are claimed through the shared atomic counter so faster workers pick up more of the work.
+	// Each decoded row is converted and written straight to its final (possibly flipped) position in the destination buffer.
+	void TiffDecodeBandsPerThread(TIFF* handle, const TiffDecodeJob& job, std::atomic<uint32_t>& nextBand, std::atomic<bool>& failed) {
+
+		unsigned char* scratch = (unsigned char*)malloc(job.scratchSize);
+		if (!scratch) {
+			failed = true;
+			return;
 		}
-		else if (channelFormat == TextureFormat::MNSY_R16) {
 
-			uint32_t stripOffset = stripSize / sizeof(uint16_t);
+		const size_t srcBytesPerPixel = (size_t)job.srcChannels * job.bytesPerChannel;
+		const size_t dstBytesPerPixel = (size_t)job.dstChannels * job.bytesPerChannel;
+		const size_t dstRowSize = job.width * dstBytesPerPixel;
+
+		uint32_t band = nextBand.fetch_add(1);
+
+		while (band < job.bandCount && !failed) {
+
+			uint32_t rowStart = band * job.bandHeight;
+			uint32_t rowEnd = std::min(rowStart + job.bandHeight, job.height);
+
+			if (!job.isTiled) {
+
+				if (TIFFReadEncodedStrip(handle, band, scratch, -1) == -1) {
+					failed = true;
+					break;
+				}
+
+				size_t srcRowSize = job.width * srcBytesPerPixel;
+
+				for (uint32_t row = rowStart; row < rowEnd; row++) {
+
+					uint32_t dstRow = job.flipVertically ? (job.height - row - 1) : row;
+
+					const unsigned char* src = scratch + (row - rowStart) * srcRowSize;
+					unsigned char* dst = (unsigned char*)job.dstBuffer + dstRow * dstRowSize;
 
-			for (uint32_t strip = stripStart; strip < stripEnd; strip++) {
-				size_t offset = strip * stripOffset;
-				TIFFReadEncodedStrip(handle, strip, (uint16_t*)buffer + offset, -1);
+					TiffConvertScanline(src, dst, job.width, job);
+				}
 			}
-		}
-		else if (channelFormat == TextureFormat::MNSY_R32) {
+			else {
 
-			uint32_t stripOffset = stripSize / sizeof(uint32_t);
+				size_t tileRowSize = job.tileWidth * srcBytesPerPixel;
 
-			for (uint32_t strip = stripStart; strip < stripEnd; strip++) {
-				size_t offset = strip * stripOffset;
-				TIFFReadEncodedStrip(handle, strip, (uint32_t*)buffer + offset, -1);
+				for (uint32_t x = 0; x < job.width; x += job.tileWidth) {
+
+					if (TIFFReadEncodedTile(handle, TIFFComputeTile(handle, x, rowStart, 0, 0), scratch, -1) == -1) {
+						failed = true;
+						break;
+					}
+
+					// tiles at the right border are padded, only take the columns inside the image
+					uint32_t columns = std::min(job.tileWidth, job.width - x);
+
+					for (uint32_t row = rowStart; row < rowEnd; row++) {
+
+						uint32_t dstRow = job.flipVertically ? (job.height - row - 1) : row;
+
+						const unsigned char* src = scratch + (row - rowStart) * tileRowSize;
+						unsigned char* dst = (unsigned char*)job.dstBuffer + dstRow * dstRowSize + x * dstBytesPerPixel;
+
+						TiffConvertScanline(src, dst, columns, job);
+					}
+				}
 			}
+
+			band = nextBand.fetch_add(1);
+		}
+
+		free(scratch);
+	}
+
+	// Worker entry point, opens its own handle to the file because a TIFF handle must not be shared between threads.
+	void TiffDecodeWorker(const std::string& filepath, const TiffDecodeJob& job, std::atomic<uint32_t>& nextBand, std::atomic<bool>& failed) {
+
+		// other workers may have already taken all bands by the time this job starts
+		if (nextBand >= job.bandCount || failed) {
+			return;
 		}
+
+		TIFF* handle = TiffOpenForRead(filepath.c_str());
+		if (handle == nullptr) {
+			// the calling thread keeps decoding with its own handle so the remaining bands still get picked up.
+			return;
+		}
+
+		TiffDecodeBandsPerThread(handle, job, nextBand, failed);
+
+		TIFFClose(handle);
 	}
 
-	void pic_util_SwapEndianness(unsigned char* buf, uint32_t bufStart, uint32_t bufEnd) {
+	static std::atomic<TiffCompression> Picture_TiffCompression = MNSY_TIFF_COMPRESSION_DEFLATE;
+
+	uint16_t TiffCompressionToTag(const TiffCompression compression) {
 
+		switch (compression)
+		{
+		case MNSY_TIFF_COMPRESSION_LZW:		return COMPRESSION_LZW;
+		case MNSY_TIFF_COMPRESSION_DEFLATE:	return COMPRESSION_ADOBE_DEFLATE;
+		case MNSY_TIFF_COMPRESSION_ZSTD:	return COMPRESSION_ZSTD;
+		default:							return COMPRESSION_NONE;
+		}
+	}
 
-#ifndef PICTURE_DISABLE_SIMD
+	TiffCompression TiffCompressionFromTag(const uint16_t compression) {
 
+		switch (compression)
+		{
+		case COMPRESSION_NONE:				return MNSY_TIFF_COMPRESSION_NONE;
+		case COMPRESSION_LZW:				return MNSY_TIFF_COMPRESSION_LZW;
+		case COMPRESSION_ADOBE_DEFLATE:		return MNSY_TIFF_COMPRESSION_DEFLATE;
+		case COMPRESSION_DEFLATE:			return MNSY_TIFF_COMPRESSION_DEFLATE;
+		case COMPRESSION_ZSTD:				return MNSY_TIFF_COMPRESSION_ZSTD;
+		default:							return MNSY_TIFF_COMPRESSION_COUNT;
+		}
+	}
 
-		// Process 16 bytes (8 pixels) at a time using SSE2
-		const uint32_t pixelsPerIteration = 8;
-		const uint32_t bytesPerIteration = pixelsPerIteration * 2;
+	// Sets every tag WriteTiff writes. The strip encoders use it for their in memory files as well so the compressed strips fit the real file.
+	void TiffSetWriteFields(TIFF* tif, const uint32_t width, const uint32_t height, const uint32_t rowsPerStrip, const TextureFormat format, const uint16_t compression) {
 
-		// Start pointer
-		unsigned char* start = buf + bufStart * 2;
-		unsigned char* end = buf + bufEnd * 2;
+		uint8_t channels;
+		uint8_t bitsPerChannel;
+		uint8_t bytesPerPixel;
+		graphics::TexUtil::get_information_from_textureFormat(format, channels, bitsPerChannel, bytesPerPixel);
 
-		// Loop through the buffer in chunks of 16 bytes
-		for (; start + bytesPerIteration <= end; start += bytesPerIteration) {
-			// Load 16 bytes (8 pixels) into an SSE2 register
-			__m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(start));
+		TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, width);
+		TIFFSetField(tif, TIFFTAG_IMAGELENGTH, height);
+		TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, (uint16_t)channels); // channels per pixel (1,2,3,4)
+		TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, (uint16_t)bitsPerChannel); // bits per channel (8 , 16 or 32)
 
-			// Swap adjacent bytes in the 16-byte chunk
-			__m128i swapped = _mm_or_si128(
-				_mm_slli_epi16(data, 8), // Shift left by 8 bits
-				_mm_srli_epi16(data, 8) // Shift right by 8 bits
-			);
+		TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, rowsPerStrip);
+		TIFFSetField(tif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
+		TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
 
-			// Store the swapped data back to memory
-			_mm_storeu_si128(reinterpret_cast<__m128i*>(start), swapped);
+		// for grayscale images set different tag
+		if (format == graphics::MNSY_R8 || format == graphics::MNSY_R16 || format == graphics::MNSY_R32) {
+			TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK);
+		}
+		else {
+			TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
 		}
 
-		// Handle remaining pixels (less than 8 pixels) with scalar code
-		for (; start < end; start += 2) {
-			std::swap(start[0], start[1]);
+		// the fourth channel is alpha, without saying so readers warn about the sample count not matching rgb
+		if (channels == 4) {
+			uint16_t extraSamples[1] = { EXTRASAMPLE_UNASSALPHA };
+			TIFFSetField(tif, TIFFTAG_EXTRASAMPLES, 1, extraSamples);
 		}
-#else
 
-		for (size_t i = bufStart; i < bufEnd; i++) {
-			// The pointer to the current 16-bit pixel
-			unsigned char* pixel = buf + i * 2;
-			// Swap the two bytes to convert from big-endian to little-endian
-			unsigned char temp = pixel[0];
-			pixel[0] = pixel[1];
-			pixel[1] = temp;
+		// if we have 32 bit it means we have floating point data which has to be explicitly set in a tiff tag.
+		TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, bitsPerChannel == 32 ? SAMPLEFORMAT_IEEEFP : SAMPLEFORMAT_UINT);
+
+		TIFFSetField(tif, TIFFTAG_COMPRESSION, compression);
+
+		// predictors store the difference to the previous sample, which compresses a lot better on photos and gradients.
+		// the floating point predictor additionally splits the floats into byte planes.
+		if (compression != COMPRESSION_NONE) {
+			TIFFSetField(tif, TIFFTAG_PREDICTOR, bitsPerChannel == 32 ? PREDICTOR_FLOATINGPOINT : PREDICTOR_HORIZONTAL);
 		}
+	}
+
+	// in memory file that a strip encoder hands to libtiff, only the compressed strip is taken out of it afterwards.
+	struct TiffMemoryFile {
+		std::vector<uint8_t> data;
+		size_t position = 0;
+	};
+
+	tmsize_t TiffMemoryFile_Read(thandle_t handle, void* buffer, tmsize_t size) {
+
+		TiffMemoryFile* file = (TiffMemoryFile*)handle;
+		if (size <= 0 || file->position >= file->data.size())
+			return 0;
+
+		size_t count = std::min((size_t)size, file->data.size() - file->position);
+		memcpy(buffer, file->data.data() + file->position, count);
+		file->position += count;
+		return (tmsize_t)count;
+	}
+
+	tmsize_t TiffMemoryFile_Write(thandle_t handle, void* buffer, tmsize_t size) {
 
-#endif // PICTURE_USE_SIMD
+		TiffMemoryFile* file = (TiffMemoryFile*)handle;
+		if (size <= 0)
+			return 0;
 
+		if (file->position + size > file->data.size()) {
+			file->data.resize(file->position + size);
+		}
+		memcpy(file->data.data() + file->position, buffer, (size_t)size);
+		file->position += size;
+		return size;
 	}
 
+	toff_t TiffMemoryFile_Seek(thandle_t handle, toff_t offset, int whence) {
 
-	void pic_util_linear2srgb_floatBuffer(float* buffer, size_t pixelCount) {
+		TiffMemoryFile* file = (TiffMemoryFile*)handle;
+		if (whence == SEEK_CUR)
+			file->position += (size_t)offset;
+		else if (whence == SEEK_END)
+			file->position = file->data.size() + (size_t)offset;
+		else
+			file->position = (size_t)offset;
 
-#ifndef PICTURE_DISABLE_SIMD
+		return (toff_t)file->position;
+	}
 
-		const __m256 threshold = _mm256_set1_ps(0.0031308f);
-		const __m256 multiplier = _mm256_set1_ps(12.92f);
-		const __m256 a = _mm256_set1_ps(1.055f);
-		const __m256 b = _mm256_set1_ps(0.055f);
-		const __m256 exponent = _mm256_set1_ps(1.0f / 2.4f);
+	int TiffMemoryFile_Close(thandle_t handle) {
+		return 0;
+	}
 
-		size_t simdWidth = 8; // AVX processes 8 floats at a time
-		size_t simdCount = pixelCount / simdWidth;
+	toff_t TiffMemoryFile_Size(thandle_t handle) {
+		return (toff_t)((TiffMemoryFile*)handle)->data.size();
+	}
 
-		for (size_t i = 0; i < simdCount; ++i) {
-			// Load 8 floats from the buffer
-			__m256 linearValue = _mm256_loadu_ps(buffer + i * simdWidth);
+	int TiffMemoryFile_Map(thandle_t handle, void** base, toff_t* size) {
+		return 0;
+	}
 
-			// Perform the linear-to-sRGB transformation
-			__m256 mask = _mm256_cmp_ps(linearValue, threshold, _CMP_LE_OS); // linearValue <= 0.0031308f
-			__m256 lowerPart = _mm256_mul_ps(linearValue, multiplier);       // linearValue * 12.92f
+	void TiffMemoryFile_Unmap(thandle_t handle, void* base, toff_t size) {
+	}
 
-			// Compute pow(linearValue, 1.0 / 2.4)
-			__m256 upperPart = _mm256_sub_ps(
-				_mm256_mul_ps(a, _mm256_pow_ps(linearValue, exponent)), b);
+	// describes one parallel tiff encode. strips are compressed into their own buffers by the workers and written to the file in order afterwards.
+	struct TiffEncodeJob {
+		const uint8_t* srcBuffer = nullptr;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		TextureFormat format = MNSY_NONE;
+		uint16_t compression = COMPRESSION_NONE;
+		bool flipVertically = false;
+		size_t rowSize = 0;			// in bytes
+		uint32_t rowsPerStrip = 0;
+		uint32_t stripCount = 0;
+		std::vector<std::vector<uint8_t>> strips;
+	};
 
-			// Select between lowerPart and upperPart based on the mask
-			__m256 result = _mm256_blendv_ps(upperPart, lowerPart, mask);
+	// copies the rows of a strip in the order they are stored in the file, the first row of the file is the last one of the buffer if flipped.
+	void TiffGatherStripRows(const TiffEncodeJob& job, const uint32_t strip, const uint32_t rowCount, uint8_t* dst) {
 
-			// Store the result back to the buffer
-			_mm256_storeu_ps(buffer + i * simdWidth, result);
-		}
+		for (uint32_t r = 0; r < rowCount; r++) {
 
-		// Handle any remaining pixels that don't fit into an AVX register
-		size_t remainingStart = simdCount * simdWidth;
-		for (size_t i = remainingStart; i < pixelCount; ++i) {
-			float val = buffer[i];
-			if (val <= 0.0031308f) {
-				buffer[i] = val * 12.92f;
-			}
-			else {
-				buffer[i] = 1.055f * std::pow(val, 1.0f / 2.4f) - 0.055f;
-			}
-		}
-#else
-		for (int p = 0; p < pixelCount; p++) {
+			uint32_t fileRow = strip * job.rowsPerStrip + r;
+			uint32_t srcRow = job.flipVertically ? job.height - 1 - fileRow : fileRow;
 
-				float val = buffer[p];
-				buffer[p] = Picture::pic_util_linear2srgb_float(val);
+			memcpy(dst + r * job.rowSize, job.srcBuffer + srcRow * job.rowSize, job.rowSize);
 		}
+	}
 
-#endif // PICTURE_USE_SIMD
+	// libtiff does not expose its codecs on their own, so the strip is written as a single strip image into a memory file and its compressed bytes are copied out.
+	// file is reused between calls of the same thread.
+	bool TiffEncodeStrip(TiffMemoryFile& file, const uint32_t width, const uint32_t rowCount, const size_t rowSize, const TextureFormat format, const uint16_t compression, const uint8_t* rows, std::vector<uint8_t>& outData) {
 
+		file.data.clear();
+		file.position = 0;
+
+		TIFF* mem = TIFFClientOpen("TiffStrip", "wm", (thandle_t)&file, TiffMemoryFile_Read, TiffMemoryFile_Write, TiffMemoryFile_Seek, TiffMemoryFile_Close, TiffMemoryFile_Size, TiffMemoryFile_Map, TiffMemoryFile_Unmap);
+		if (mem == nullptr)
+			return false;
+
+		TiffSetWriteFields(mem, width, rowCount, rowCount, format, compression);
+
+		bool encoded = TIFFWriteEncodedStrip(mem, 0, (void*)rows, (tmsize_t)(rowCount * rowSize)) >= 0;
+
+		uint64_t offset = encoded ? TIFFGetStrileOffset(mem, 0) : 0;
+		uint64_t byteCount = encoded ? TIFFGetStrileByteCount(mem, 0) : 0;
+
+		TIFFClose(mem);
+
+		if (!encoded || byteCount == 0 || offset + byteCount > file.data.size())
+			return false;
+
+		outData.assign(file.data.begin() + (size_t)offset, file.data.begin() + (size_t)(offset + byteCount));
+		return true;
 	}
 
+	// Compresses strips until none are left, claimed through the shared atomic counter like the decode bands.
+	void TiffEncodeStripsPerThread(TiffEncodeJob& job, std::atomic<uint32_t>& nextStrip, std::atomic<bool>& failed) {
+
+		std::vector<uint8_t> rows(job.rowSize * job.rowsPerStrip);
+		TiffMemoryFile file;
+
+		while (!failed) {
+
+			uint32_t strip = nextStrip.fetch_add(1);
+			if (strip >= job.stripCount)
+				break;
+
+			uint32_t rowCount = std::min(job.rowsPerStrip, job.height - strip * job.rowsPerStrip);
+			TiffGatherStripRows(job, strip, rowCount, rows.data());
+
+			if (!TiffEncodeStrip(file, job.width, rowCount, job.rowSize, job.format, job.compression, rows.data(), job.strips[strip])) {
+				failed = true;
+				break;
+			}
+		}
+	}
 
 	PictureInfo Picture::ReadPicture(PictureError& outPictureError, const char* filepath,const bool flipVertically, const bool convertGrayToRGB, const bool convertEXRandHDRToSrgb) {
 		outPictureError.wasSuccessfull = true;
@@ -332,24 +543,13 @@ namespace mnemosy::graphics {
 
 
 		// open the tiff file.
-		{
-			TIFFOpenOptions* opts = TIFFOpenOptionsAlloc();
+		tif = TiffOpenForRead(filepath);
 
-			// make sure we can read big enough images
-			tmsize_t limit = (sizeof(uint32_t) * 4 * 16384 * 16384); // sizeof(uint32_t) * channels * width * height
-
-			TIFFOpenOptionsSetMaxSingleMemAlloc(opts, limit);
-			
-			tif = TIFFOpenExt(filepath, "r", opts);
-			
-			TIFFOpenOptionsFree(opts);
-
-			if (tif == nullptr) {
-				outPictureError.wasSuccessfull = false;
-				outPictureError.what = "ReadTiff: failed to open file. corrupted?";
-				return PictureInfo();
-			}		
-		}		
+		if (tif == nullptr) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "ReadTiff: failed to open file. corrupted?";
+			return PictureInfo();
+		}
 
 		uint32_t width = 0;
 		uint32_t height = 0;
@@ -364,8 +564,6 @@ namespace mnemosy::graphics {
 		// not needed
 		//uint32_t sampleformat = 0;
 		//TIFFGetField(tif, TIFFTAG_SAMPLEFORMAT, &sampleformat);
-		//uint32_t config = 0;
-		//TIFFGetField(tif, TIFFTAG_PLANARCONFIG, &config);
 
 		if (width == 0 || height == 0) {
 
@@ -421,349 +619,483 @@ namespace mnemosy::graphics {
 		}		
 		
 		
-		// allocate pixel buffer
-		size_t bytesPerPixel = channels * (bitsPerChannel / 8);
-		size_t bufferSize = width * height * bytesPerPixel;
-		uint32_t numberOfStrips = TIFFNumberOfStrips(tif);
-		size_t stripSize = TIFFStripSize(tif);
-		void* buffer = malloc(bufferSize);
-		
-		tmsize_t tiffError = 0;
-		{ 
-			// read pixel data per strip
-			if (channelFormat == TextureFormat::MNSY_R8) {
+		// if we need to convert gray to rgb this happens in the same pass as decoding and flipping.
+		bool expandGrayToRGB = channels == 1 && convertGrayToRGB;
+		TextureFormat decodedFormat = format;
+		if (expandGrayToRGB) {
+			// updateing format from single channel to RGB 
+			format = (TextureFormat)((uint8_t)channelFormat + 2);
+		}
+
+		// only contiguous (interleaved) samples are supported, wich is what every common writer including our own WriteTiff produces
+		uint16_t planarConfig = PLANARCONFIG_CONTIG;
+		TIFFGetField(tif, TIFFTAG_PLANARCONFIG, &planarConfig);
+		if (channels > 1 && planarConfig != PLANARCONFIG_CONTIG) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "ReadTiff: planar configuration separate is not supported";
+			TIFFClose(tif);
+			return PictureInfo();
+		}
+
+		// setup decode job
+		TiffDecodeJob job;
+		job.width = width;
+		job.height = height;
+		job.srcChannels = channels;
+		job.dstChannels = expandGrayToRGB ? 3 : channels;
+		job.bytesPerChannel = bitsPerChannel / 8;
+		job.srcFormat = decodedFormat;
+		job.dstFormat = format;
+		job.flipVertically = flipVertically;
+		job.isTiled = TIFFIsTiled(tif);
+
+		if (job.isTiled) {
+			uint32_t tileWidth = 0;
+			uint32_t tileLength = 0;
+			TIFFGetField(tif, TIFFTAG_TILEWIDTH, &tileWidth);
+			TIFFGetField(tif, TIFFTAG_TILELENGTH, &tileLength);
+
+			job.tileWidth = tileWidth;
+			job.bandHeight = tileLength;
+			job.scratchSize = TIFFTileSize(tif);
+		}
+		else {
+			uint32_t rowsPerStrip = height;
+			TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
 
-				for (uint32_t strip = 0; strip < numberOfStrips; strip++) {
-					//size_t offset = strip * stripSize;
+			job.bandHeight = std::min(rowsPerStrip, height);
+			job.scratchSize = TIFFStripSize(tif);
+		}
 
-					tiffError = TIFFReadEncodedStrip(tif, strip, (uint8_t*)buffer + (strip * stripSize) , -1);
-				}
-			}
-			else if (channelFormat == TextureFormat::MNSY_R16) {
+		if (job.bandHeight == 0 || job.scratchSize == 0 || (job.isTiled && job.tileWidth == 0)) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "ReadTiff: invalid strip or tile layout";
+			TIFFClose(tif);
+			return PictureInfo();
+		}
 
-				uint32_t stripIncrement = stripSize / sizeof(uint16_t);
+		job.bandCount = (height + job.bandHeight - 1) / job.bandHeight;
 
-				for (uint32_t strip = 0; strip < numberOfStrips; strip++) {
-					//size_t offset = strip * stripOffset;
-					
-					tiffError = TIFFReadEncodedStrip(tif, strip, (uint16_t*)buffer + (strip * stripIncrement), -1);
-				}
-			}
-			else if (channelFormat == TextureFormat::MNSY_R32) {
+		// allocate final pixel buffer
+		size_t bufferSize = (size_t)width * height * job.dstChannels * job.bytesPerChannel;
+		job.dstBuffer = malloc(bufferSize);
+		if (!job.dstBuffer) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "ReadTiff: failed to allocate memory";
+			TIFFClose(tif);
+			return PictureInfo();
+		}
 
-				uint32_t stripIncrement = stripSize / sizeof(uint32_t);
+		std::atomic<uint32_t> nextBand = 0;
+		std::atomic<bool> failed = false;
 
-				for (uint32_t strip = 0; strip < numberOfStrips; strip++) {
-					//size_t offset = strip * stripOffset;
-					tiffError = TIFFReadEncodedStrip(tif, strip, (uint32_t*)buffer + (strip * stripIncrement), -1);
-				}
-			}
+		// fan bands out across the engine job system. small images are not worth the cost of opening additional handles so they are decoded on this thread only.
+		core::JobSystem& jobSystem = MnemosyEngine::GetInstance().GetJobSystem();
+		std::shared_ptr<core::JobGroup> decodeJobs = core::JobSystem::CreateGroup();
+
+		uint32_t workerCount = 0;
+		if (bufferSize >= PICTURE_TIFF_PARALLEL_MIN_BYTES) {
+			workerCount = std::min(jobSystem.GetWorkerCount(), job.bandCount - 1); // calling thread is a worker too
+		}
+
+		std::string filepathStr = std::string(filepath);
+		for (uint32_t i = 0; i < workerCount; i++) {
+			jobSystem.Submit(decodeJobs, [&filepathStr, &job, &nextBand, &failed]() { TiffDecodeWorker(filepathStr, job, nextBand, failed); }, core::MNSY_JOB_PRIORITY_HIGH);
 		}
 
+		TiffDecodeBandsPerThread(tif, job, nextBand, failed);
+
+		jobSystem.Wait(decodeJobs);
+
 		TIFFClose(tif);
 		tif = nullptr;
 
-		if (tiffError == -1) {
+		if (failed) {
 			outPictureError.wasSuccessfull = false;
-			outPictureError.what = "ReadTiff: failed to read Stip";
-			free(buffer);
+			outPictureError.what = "ReadTiff: failed to read Stip or Tile";
+			free(job.dstBuffer);
 			return PictureInfo();
 		}
 
-		// if we need to convert gray channel to rgb  this branch also handles flipVertically at the same time, if its set.
-		if(channels == 1 && convertGrayToRGB){
-			// updateing format from single channel to RGB 
-			format = (TextureFormat)((uint8_t)channelFormat + 2); 
+		// fill info struct
+		PictureInfo info;
+		info.textureFormat = format;
+		info.isHalfFloat = false;
+		info.width = (uint16_t)width;
+		info.height = (uint16_t)height;
+		info.pixels = job.dstBuffer;
+		
+		return info;	
+	}
+	
+	bool Picture::TiffMatchesFormat(const char* filepath, const TextureFormat format, const TiffCompression compression) {
+
+#ifdef MNEMOSY_CONFIG_RELEASE
+		TIFFSetWarningHandler(NULL);
+		TIFFSetErrorHandler(NULL);
+#endif // MNEMOSY_CONFIG_RELEASE
 
-			void* pixels = malloc(width * height * 3 * (bitsPerChannel / 8));
-			size_t srcPixelBytes = bitsPerChannel / 8;
+		uint8_t channels, bitsPerChannel, bytesPerPixel;
+		graphics::TexUtil::get_information_from_textureFormat(format, channels, bitsPerChannel, bytesPerPixel);
+		if (channels == 0)
+			return false;
 
+		TIFF* tif = TiffOpenForRead(filepath);
+		if (tif == nullptr)
+			return false;
 
-			if (channelFormat == TextureFormat::MNSY_R8) {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint16_t fileChannels = 0;
+		uint16_t fileBitsPerChannel = 0;
+		uint16_t sampleFormat = SAMPLEFORMAT_UINT;
+		uint16_t planarConfig = PLANARCONFIG_CONTIG;
+		uint16_t orientation = ORIENTATION_TOPLEFT;
+		uint16_t photometric = 0;
+		uint16_t fileCompression = COMPRESSION_NONE;
 
-				for (uint16_t h = 0; h < height; h++) {
+		TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+		TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+		TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &fileChannels);
+		TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &fileBitsPerChannel);
+		TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLEFORMAT, &sampleFormat);
+		TIFFGetFieldDefaulted(tif, TIFFTAG_PLANARCONFIG, &planarConfig);
+		TIFFGetFieldDefaulted(tif, TIFFTAG_ORIENTATION, &orientation);
+		TIFFGetFieldDefaulted(tif, TIFFTAG_COMPRESSION, &fileCompression);
+		TIFFGetField(tif, TIFFTAG_PHOTOMETRIC, &photometric);
 
-					uint16_t y = height - h - 1; // awsume we want to flip vertically
-					if (!flipVertically) {
-						y = h;
-					}
+		TIFFClose(tif);
 
-					for (uint16_t w = 0; w < width; w++) {
+		// samples are only ever read as unsigned normalized or float, anything else would be reinterpreted
+		uint16_t expectedSampleFormat = bitsPerChannel == 32 ? SAMPLEFORMAT_IEEEFP : SAMPLEFORMAT_UINT;
 
+		bool photometricMatches = false;
+		if (channels == 1)
+			photometricMatches = photometric == PHOTOMETRIC_MINISBLACK;
+		else if (channels == 2)
+			photometricMatches = photometric == PHOTOMETRIC_MINISBLACK || photometric == PHOTOMETRIC_RGB;
+		else
+			photometricMatches = photometric == PHOTOMETRIC_RGB;
 
-						size_t offsetSrc = (y * width + w);
-						size_t offsetDest = (h * width + w) * 3; // 3 bc we now have RGB channels in destination buffer
+		bool compressionMatches = compression == MNSY_TIFF_COMPRESSION_COUNT ? TIFFIsCODECConfigured(fileCompression) : TiffCompressionFromTag(fileCompression) == compression;
 
-						uint8_t val = *((uint8_t*)buffer + offsetSrc);
-						((uint8_t*)pixels)[offsetDest + 0] = val;
-						((uint8_t*)pixels)[offsetDest + 1] = val;
-						((uint8_t*)pixels)[offsetDest + 2] = val;
-					}
-				}
+		return width != 0 && width <= UINT16_MAX && height != 0 && height <= UINT16_MAX
+			&& fileChannels == channels && fileBitsPerChannel == bitsPerChannel && sampleFormat == expectedSampleFormat
+			&& planarConfig == PLANARCONFIG_CONTIG && orientation == ORIENTATION_TOPLEFT && photometricMatches
+			&& compressionMatches;
+	}
 
-			}
-			else if (channelFormat == TextureFormat::MNSY_R16) {
+	void Picture::WriteTiff(PictureError& outPictureError, const char* filepath, const PictureInfo& pictureInfo, const bool flipVertically) {
+		
+		// initialize outputs
+		outPictureError.wasSuccessfull = true;
+		outPictureError.what = "";
+
+		PictureError err = Picture::pic_util_check_input_pictureInfo(pictureInfo);
+		if(!err.wasSuccessfull){
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "WriteTiff: " + err.what;
+			return;
+		}
 
-#ifndef PICTURE_DISABLE_SIMD
-				// Some SIMD experimental goodness happening here.
+		uint8_t channels;
+		uint8_t bitsPerChannel;
+		uint8_t bytesPerPixel;
 
+		graphics::TexUtil::get_information_from_textureFormat(pictureInfo.textureFormat, channels, bitsPerChannel, bytesPerPixel);			
 
-				size_t rowStride = width * 3;
+		TiffEncodeJob job;
+		job.srcBuffer = (const uint8_t*)pictureInfo.pixels;
+		job.width = pictureInfo.width;
+		job.height = pictureInfo.height;
+		job.format = pictureInfo.textureFormat;
+		job.compression = TiffCompressionToTag(Picture_TiffCompression);
+		job.flipVertically = flipVertically;
+		job.rowSize = (size_t)pictureInfo.width * bytesPerPixel;
+		job.rowsPerStrip = (uint32_t)std::clamp(PICTURE_TIFF_STRIP_BYTES / job.rowSize, (size_t)1, (size_t)job.height);
+		job.stripCount = (job.height + job.rowsPerStrip - 1) / job.rowsPerStrip;
 
-				for (uint16_t h = 0; h < height; h++) {
+		size_t bufferSize = job.rowSize * job.height;
 
+		// compress all strips first, uncompressed strips are gathered while writing them
+		bool failed = false;
+		if (job.compression != COMPRESSION_NONE) {
 
+			job.strips.resize(job.stripCount);
 
-					uint16_t y = flipVertically ? (height - h - 1) : h;
-					size_t srcRowOffset = y * width;
-					size_t destRowOffset = h * rowStride;
+			std::atomic<uint32_t> nextStrip = 0;
+			std::atomic<bool> encodeFailed = false;
 
-					uint16_t w = 0;
-					// Process pixels in blocks of 8 using SIMD (128 bits = 8  16-bit values)
-					for (; w <= width - 8; w += 8) {
-						// Load 8 16-bit grayscale values from the source buffer
-						__m128i grayscale = _mm_loadu_si128((__m128i*)((uint16_t*)buffer + srcRowOffset + w));
+			core::JobSystem& jobSystem = MnemosyEngine::GetInstance().GetJobSystem();
+			std::shared_ptr<core::JobGroup> encodeJobs = core::JobSystem::CreateGroup();
 
-						// Duplicate grayscale values into RGB format
-						__m128i rValues = grayscale; // R values (same as grayscale)
-						__m128i gValues = grayscale; // G values (same as grayscale)
-						__m128i bValues = grayscale; // B values (same as grayscale)
+			uint32_t workerCount = 0;
+			if (bufferSize >= PICTURE_TIFF_PARALLEL_MIN_BYTES) {
+				workerCount = std::min(jobSystem.GetWorkerCount(), job.stripCount - 1); // calling thread is a worker too
+			}
 
-						// Store RGB values in the destination buffer
-						_mm_storeu_si128((__m128i*)((uint16_t*)pixels + destRowOffset + w * 3 + 0), rValues); // R channel
-						_mm_storeu_si128((__m128i*)((uint16_t*)pixels + destRowOffset + w * 3 + 8), gValues); // G channel
-						_mm_storeu_si128((__m128i*)((uint16_t*)pixels + destRowOffset + w * 3 + 16), bValues); // B channel
-					}
+			for (uint32_t i = 0; i < workerCount; i++) {
+				jobSystem.Submit(encodeJobs, [&job, &nextStrip, &encodeFailed]() { TiffEncodeStripsPerThread(job, nextStrip, encodeFailed); }, core::MNSY_JOB_PRIORITY_HIGH);
+			}
 
-					// Process remaining pixels
-					for (; w < width; w++) {
-						uint16_t val = ((uint16_t*)buffer)[srcRowOffset + w];
-						size_t destOffset = destRowOffset + w * 3;
-						((uint16_t*)pixels)[destOffset + 0] = val; // R
-						((uint16_t*)pixels)[destOffset + 1] = val; // G
-						((uint16_t*)pixels)[destOffset + 2] = val; // B
-					}
-				}
+			TiffEncodeStripsPerThread(job, nextStrip, encodeFailed);
 
+			jobSystem.Wait(encodeJobs);
 
-#else
-				for (uint16_t h = 0; h < height; h++) {
+			failed = encodeFailed;
+		}
 
-					uint16_t y = height - h - 1; // awsume we want to flip vertically
-					if (!flipVertically) {
-						y = h;
-					}
+		if (failed) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "WriteTiff: failed to compress strips.";
+			return;
+		}
 
-					for (uint16_t w = 0; w < width; w++) {
+		// this should make sure we are allowed to allocate large amounts of data
+		TIFFOpenOptions* opts = TIFFOpenOptionsAlloc();
+		TIFFOpenOptionsSetMaxSingleMemAlloc(opts, (tmsize_t)bufferSize);
 
+		TIFF* tif = TIFFOpenExt(filepath, "w",opts);
+		TIFFOpenOptionsFree(opts);
 
-						size_t offsetSrc = (y * width + w);
-						size_t offsetDest = (h * width + w) * 3; // 3 bc we now have RGB channels in destination buffer
+		if (tif == nullptr) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "WriteTiff: failed to open file for writing.";
+			return;
+		}
 
-						uint16_t val = *((uint16_t*)buffer + offsetSrc);
-						((uint16_t*)pixels)[offsetDest + 0] = val;
-						((uint16_t*)pixels)[offsetDest + 1] = val;
-						((uint16_t*)pixels)[offsetDest + 2] = val;
-					}
-				}
+		TiffSetWriteFields(tif, job.width, job.height, job.rowsPerStrip, job.format, job.compression);
 
-#endif // !PICTURE_DISABLE_SIMD
-			}
-			else if(channelFormat == TextureFormat::MNSY_R32) {
+		if (job.compression != COMPRESSION_NONE) {
 
-				for (uint16_t h = 0; h < height; h++) {
+			for (uint32_t strip = 0; strip < job.stripCount && !failed; strip++) {
 
-					uint16_t y = height - h - 1; // awsume we want to flip vertically
-					if (!flipVertically) {
-						y = h;
-					}
+				std::vector<uint8_t>& data = job.strips[strip];
+				failed = TIFFWriteRawStrip(tif, strip, data.data(), (tmsize_t)data.size()) < 0;
+			}
+		}
+		else {
 
-					for (uint16_t w = 0; w < width; w++) {
+			std::vector<uint8_t> rows(job.rowSize * job.rowsPerStrip);
 
+			for (uint32_t strip = 0; strip < job.stripCount && !failed; strip++) {
 
-						size_t offsetSrc = (y * width + w);
-						size_t offsetDest = (h * width + w) * 3; // 3 bc we now have RGB channels in destination buffer
+				uint32_t rowCount = std::min(job.rowsPerStrip, job.height - strip * job.rowsPerStrip);
+				TiffGatherStripRows(job, strip, rowCount, rows.data());
 
-						float val = *((float*)buffer + offsetSrc);
-						((float*)pixels)[offsetDest + 0] = val;
-						((float*)pixels)[offsetDest + 1] = val;
-						((float*)pixels)[offsetDest + 2] = val;
-					}
-				}
+				failed = TIFFWriteEncodedStrip(tif, strip, rows.data(), (tmsize_t)(rowCount * job.rowSize)) < 0;
 			}
-
-			free(buffer);
-			buffer = pixels;
 		}
 
-		// handeling flip vertically here seperatly if i dont have to convertGrayToRGB because if we only want to flip vertically it is much faster to copy row by row than pixel py pixel which is required if we convert gray to RGB
-		bool alreadyFilpped = channels == 1 && convertGrayToRGB && flipVertically;
+		TIFFClose(tif); // write the file
 
-		if (flipVertically && !alreadyFilpped) {
-			size_t rowSize = width * bytesPerPixel;
-			unsigned char* tempRowBuf = static_cast<unsigned char*>(malloc(rowSize));
+		if (failed) {
 
-			uint16_t heightHalf = height / 2;
-			uint16_t heightMinusOne = height - 1;
+			std::error_code ec;
+			std::filesystem::remove(std::filesystem::u8path(filepath), ec);
 
-			for (uint32_t h = 0; h < heightHalf; h++) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "WriteTiff: Tiff strip write failed.";
+		}
+	}
 
-				unsigned char* rowTop	 = static_cast<unsigned char*>(buffer) + h * rowSize;
-				unsigned char* rowBottom = static_cast<unsigned char*>(buffer) + (heightMinusOne - h) * rowSize;
+	void Picture::SetTiffCompression(const TiffCompression compression) {
 
-				memcpy(tempRowBuf, rowTop, rowSize); // copy top row to temp
-				memcpy(rowTop, rowBottom, rowSize);  // coppy bottom to top
-				memcpy(rowBottom, tempRowBuf, rowSize); // copy top from temp to bottom
-			}
+		TiffCompression available = compression;
 
-			free(tempRowBuf);
+		if (available == MNSY_TIFF_COMPRESSION_ZSTD && !TIFFIsCODECConfigured(COMPRESSION_ZSTD)) {
+			MNEMOSY_WARN("Picture::SetTiffCompression: libtiff is built without zstd, using deflate instead.");
+			available = MNSY_TIFF_COMPRESSION_DEFLATE;
 		}
 
-		// fill info struct
-		PictureInfo info;
-		info.textureFormat = format;
-		info.isHalfFloat = false;
-		info.width = (uint16_t)width;
-		info.height = (uint16_t)height;
-		info.pixels = buffer;
-		
-		return info;	
+		if (!TIFFIsCODECConfigured(TiffCompressionToTag(available))) {
+			MNEMOSY_WARN("Picture::SetTiffCompression: libtiff is built without the codec, tiff files are written uncompressed.");
+			available = MNSY_TIFF_COMPRESSION_NONE;
+		}
+
+		Picture_TiffCompression = available;
 	}
-	
-	void Picture::WriteTiff(PictureError& outPictureError, const char* filepath, const PictureInfo& pictureInfo, const bool flipVertically) {
-		
-		// initialize outputs
-		outPictureError.wasSuccessfull = true;
-		outPictureError.what = "";
 
-		PictureError err = Picture::pic_util_check_input_pictureInfo(pictureInfo);
-		if(!err.wasSuccessfull){
-			outPictureError.wasSuccessfull = false;
-			outPictureError.what = "WriteTiff: " + err.what;
-			return;
+	TiffCompression Picture::GetTiffCompression() {
+		return Picture_TiffCompression;
+	}
+
+	TiffCompression Picture::ReadTiffCompression(const char* filepath) {
+
+#ifdef MNEMOSY_CONFIG_RELEASE
+		TIFFSetWarningHandler(NULL);
+		TIFFSetErrorHandler(NULL);
+#endif // MNEMOSY_CONFIG_RELEASE
+
+		TIFF* tif = TiffOpenForRead(filepath);
+		if (tif == nullptr)
+			return MNSY_TIFF_COMPRESSION_COUNT;
+
+		uint16_t compression = COMPRESSION_NONE;
+		TIFFGetFieldDefaulted(tif, TIFFTAG_COMPRESSION, &compression);
+
+		TIFFClose(tif);
+
+		return TiffCompressionFromTag(compression);
+	}
+
+	TiffStripWriter::~TiffStripWriter() {
+
+		if (m_tif) {
+			PictureError err;
+			Close(err);
 		}
+	}
 
-		TextureFormat format = pictureInfo.textureFormat;
-		uint16_t height = pictureInfo.height;
-		uint16_t width = pictureInfo.width;
+	void TiffStripWriter::Open(PictureError& outPictureError, const char* filepath, const uint16_t width, const uint16_t height, const TextureFormat format) {
 
-		uint8_t channels;
-		uint8_t bitsPerChannel;
-		uint8_t bytesPerPixel;
+		// initialize outputs
+		outPictureError.wasSuccessfull = true;
+		outPictureError.what = "";
 
-		graphics::TexUtil::get_information_from_textureFormat(format, channels, bitsPerChannel, bytesPerPixel);			
+		uint8_t channels, bitsPerChannel, bytesPerPixel;
+		graphics::TexUtil::get_information_from_textureFormat(format, channels, bitsPerChannel, bytesPerPixel);
+
+		if (m_tif || width == 0 || height == 0 || channels == 0) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "TiffStripWriter: Unsupported output size or format.";
+			return;
+		}
+
+		m_filepath = filepath;
+		m_width = width;
+		m_height = height;
+		m_format = format;
+		m_compression = TiffCompressionToTag(Picture_TiffCompression);
+		m_rowSize = (size_t)width * bytesPerPixel;
+		m_rowsPerStrip = (uint32_t)std::clamp(PICTURE_TIFF_STRIP_BYTES / m_rowSize, (size_t)1, (size_t)height);
+		m_stripCount = (m_height + m_rowsPerStrip - 1) / m_rowsPerStrip;
+		m_writtenStrips = 0;
+		m_failed = false;
 
-		// this should make sure we are allowed to allocate large amounts of data
-		tmsize_t limit = (bytesPerPixel * pictureInfo.width * pictureInfo.height);
 		TIFFOpenOptions* opts = TIFFOpenOptionsAlloc();
-		TIFFOpenOptionsSetMaxSingleMemAlloc(opts, limit);
+		TIFFOpenOptionsSetMaxSingleMemAlloc(opts, (tmsize_t)(m_rowSize * m_rowsPerStrip));
 
-		TIFF* tif = TIFFOpenExt(filepath, "w",opts);
+		m_tif = TIFFOpenExt(filepath, "w", opts);
 		TIFFOpenOptionsFree(opts);
 
-		// Set neccessary tiff tag fields
-		TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, pictureInfo.width);
-		TIFFSetField(tif, TIFFTAG_IMAGELENGTH, pictureInfo.height);
-		TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, channels); // channels per pixel (1,2,3,4)
-		TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, bitsPerChannel); // bits per channel (8 , 16 or 32)
+		if (m_tif == nullptr) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "TiffStripWriter: Failed to open file for writing. Path: " + m_filepath;
+			return;
+		}
 
-		TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, 1);
-		TIFFSetField(tif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
-		TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+		TiffSetWriteFields(m_tif, m_width, m_height, m_rowsPerStrip, m_format, m_compression);
+	}
 
-		// for grayscale images set different tag
-		if (format == graphics::MNSY_R8 || format == graphics::MNSY_R16 || format == graphics::MNSY_R32) {
-			TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK);
-		}
-		else {
-			TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
-		}	
+	bool TiffStripWriter::EncodeStrip(const uint32_t strip, std::vector<uint8_t>& rows) const {
 
-		// if we have 32 bit it means we have floating point data which has to be explicitly set in a tiff tag.
-		if (bitsPerChannel == 32) {
-			
-			TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_IEEEFP);
+		if (strip >= m_stripCount)
+			return false;
+
+		uint32_t rowCount = std::min(m_rowsPerStrip, m_height - strip * m_rowsPerStrip);
+		size_t stripSize = rowCount * m_rowSize;
+		if (rows.size() < stripSize)
+			return false;
+
+		// uncompressed strips are written as they are
+		if (m_compression == COMPRESSION_NONE) {
+			rows.resize(stripSize);
+			return true;
 		}
-		else {
-			TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_UINT);
+
+		TiffMemoryFile file;
+		std::vector<uint8_t> data;
+		if (!TiffEncodeStrip(file, m_width, rowCount, m_rowSize, m_format, m_compression, rows.data(), data))
+			return false;
+
+		rows.swap(data);
+		return true;
+	}
+
+	bool TiffStripWriter::WriteStrip(const uint32_t strip, const std::vector<uint8_t>& data) {
+
+		if (m_tif == nullptr || m_failed)
+			return false;
+
+		m_failed = TIFFWriteRawStrip(m_tif, strip, (void*)data.data(), (tmsize_t)data.size()) < 0;
+		if (!m_failed) {
+			m_writtenStrips++;
 		}
+		return !m_failed;
+	}
 
-		// set no compression
-		TIFFSetField(tif, TIFFTAG_COMPRESSION, COMPRESSION_NONE);
+	void TiffStripWriter::Close(PictureError& outPictureError) {
 
+		// initialize outputs
+		outPictureError.wasSuccessfull = true;
+		outPictureError.what = "";
 
-		uint32_t rowSize = width * channels;
+		if (m_tif == nullptr)
+			return;
 
-		// 8 bit per channel
-		if (bitsPerChannel == 8) {
+		TIFFClose(m_tif);
+		m_tif = nullptr;
 
-			uint8_t* srcBuffer = (uint8_t*)pictureInfo.pixels;
+		if (m_failed || m_writtenStrips != m_stripCount) {
 
-			if (flipVertically) {
-				srcBuffer += (height - 1) * rowSize;
-				for (uint16_t h = 0; h < height; h++) {
-					TIFFWriteScanline(tif, srcBuffer, h, 0);
-					srcBuffer -= rowSize;
-				}
-			}
-			else {
-				for (uint16_t h = 0; h < height; h++) {
-					TIFFWriteScanline(tif, srcBuffer, h, 0);
-					srcBuffer += rowSize;
-				}
-			}
+			std::error_code ec;
+			std::filesystem::remove(std::filesystem::u8path(m_filepath), ec);
+
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "TiffStripWriter: Failed to write pixel data. Path: " + m_filepath;
 		}
-		// 16 bit per channel
-		else if (bitsPerChannel == 16) {
-			
-			uint16_t* srcBuffer = (uint16_t*)pictureInfo.pixels;
+	}
 
-			if (flipVertically) {				
-				srcBuffer += (height - 1) * rowSize;				
-				for (uint16_t h = 0; h < height; h++) {
-					TIFFWriteScanline(tif, srcBuffer, h, 0);
-					srcBuffer -= rowSize;
-				}
-			}
-			else {
-				for (uint16_t h = 0; h < height; h++) {					
-					TIFFWriteScanline(tif, srcBuffer, h, 0);
-					srcBuffer += rowSize;
-				}
-			}
+	// Inserts one slice per channel that points straight into an interleaved buffer of the size of the data window, so openExr reads or writes the pixels in place.
+	// Rows are stored top to bottom, or bottom to top with a negative y stride if flipped.
+	void pic_util_exr_insert_interleaved_slices(Imf::FrameBuffer& framebuffer, const char* const* channelNames, const uint8_t numChannels, const Imf::PixelType pixelType, char* buffer, const Imath::Box2i& dw, const bool flipVertically) {
+
+		size_t sampleSize = pixelType == Imf::PixelType::HALF ? sizeof(uint16_t) : sizeof(float);
+		size_t width = (size_t)(dw.max.x - dw.min.x + 1);
+		size_t height = (size_t)(dw.max.y - dw.min.y + 1);
+
+		ptrdiff_t xStride = (ptrdiff_t)(numChannels * sampleSize);
+		ptrdiff_t yStride = xStride * (ptrdiff_t)width;
+
+		char* firstRow = buffer;
+		if (flipVertically) {
+			firstRow = buffer + (height - 1) * (size_t)yStride;
+			yStride = -yStride;
 		}
-		// 32 bit per channel
-		else if (bitsPerChannel == 32) { 
 
-			uint32_t* srcBuffer = (uint32_t*)pictureInfo.pixels;
+		// openExr addresses a sample as base + x * xStride + y * yStride with x and y in data window coordinates
+		for (uint8_t c = 0; c < numChannels; c++) {
+			char* base = firstRow + c * sampleSize - (ptrdiff_t)dw.min.x * xStride - (ptrdiff_t)dw.min.y * yStride;
+			framebuffer.insert(channelNames[c], Imf::Slice(pixelType, base, (size_t)xStride, (size_t)yStride, 1, 1, 0.0, false, false));
+		}
+	}
 
-			if (flipVertically) {
-				srcBuffer += (height - 1) * rowSize;
-				for (uint16_t h = 0; h < height; h++) {
-					TIFFWriteScanline(tif, srcBuffer, h, 0);
-					srcBuffer -= rowSize;
-				}
+	// openExr reports broken files with exceptions
+	// level 0 is read like scanlines, lower levels of a tiled multi resolution part tile by tile
+	bool pic_util_exr_read_pixels(Imf::MultiPartInputFile& multiPartFile, const int partIndex, Imf::InputPart& part, const Imf::FrameBuffer& framebuffer, const Imath::Box2i& dw, const int level, std::string& outError) {
+
+		try {
+			if (level == 0) {
+				part.setFrameBuffer(framebuffer);
+				part.readPixels(dw.min.y, dw.max.y);
 			}
 			else {
-				for (uint16_t h = 0; h < height; h++) {
-					TIFFWriteScanline(tif, srcBuffer, h, 0);
-					srcBuffer += rowSize;
-				}
+				Imf::TiledInputPart tiledPart(multiPartFile, partIndex);
+				tiledPart.setFrameBuffer(framebuffer);
+				tiledPart.readTiles(0, tiledPart.numXTiles(level) - 1, 0, tiledPart.numYTiles(level) - 1, level, level);
 			}
 		}
-
-		TIFFClose(tif); // write the file
-
-		/*if (error == -1) {
-			outPictureError.wasSuccessfull = false;
-			outPictureError.what = "WriteTiff: Tiff Scanline write failed.";
-		}*/
-
-		return;
+		catch (const std::exception& e) {
+			outError = e.what();
+			return false;
+		}
+		return true;
 	}
 
-	// could use some performance improvements (e.g smd)
-	PictureInfo Picture::ReadExr(PictureError& outPictureError, const char* filepath, const bool flipVertically, const bool convertToSrgb, const bool convertGrayToRGB) {
+	// Reads the first level of the part whose longest side is at most maxLevelSize, 0 reads the full resolution.
+	// Only tiled mip or rip mapped parts store other levels, the read fails for any other part if maxLevelSize is set.
+	PictureInfo pic_util_exr_read(PictureError& outPictureError, const char* filepath, const bool flipVertically, const bool convertToSrgb, const bool convertGrayToRGB, const uint16_t maxLevelSize, uint16_t& outFullWidth, uint16_t& outFullHeight) {
 	
 		namespace exr = Imf;
 
@@ -788,10 +1120,80 @@ namespace mnemosy::graphics {
 			}
 		}
 
-		exr::InputFile file = { filepath };
+		// a file can hold several images, the first one with channels we understand is read. tiled parts are read like scanlines by openExr.
+		std::unique_ptr<exr::MultiPartInputFile> multiPartFile;
+		std::unique_ptr<exr::InputPart> part;
+		int partIndex = 0;
+		try {
+			multiPartFile = std::make_unique<exr::MultiPartInputFile>(filepath);
+
+			for (int p = 0; p < multiPartFile->parts(); p++) {
+
+				const exr::Header& partHeader = multiPartFile->header(p);
+				if (partHeader.hasType() && exr::isDeepData(partHeader.type()))
+					continue;
+
+				const exr::ChannelList& partChannels = partHeader.channels();
+				if (partChannels.findChannel("R") || partChannels.findChannel("Y") || partChannels.findChannel("Z")) {
+					part = std::make_unique<exr::InputPart>(*multiPartFile, p);
+					partIndex = p;
+					break;
+				}
+			}
+		}
+		catch (const std::exception& e) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "ReadExr: failed to open file: " + std::string(e.what());
+			return outInfo;
+		}
+
+		if (!part) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "ReadExr: the file does not contain either an R-channel or any grayscale channels - other purposes are not supported";
+			return outInfo;
+		}
+
+		exr::InputPart& file = *part;
 
 		Imath::Box2i dw = file.header().dataWindow();
 
+		outFullWidth = dw.max.x - dw.min.x + 1;
+		outFullHeight = dw.max.y - dw.min.y + 1;
+
+		// the level is chosen by its size, the full resolution is never read for a reduced one.
+		// Rip maps are only read along their diagonal, those levels are the same as the ones of a mip map.
+		int level = 0;
+		if (maxLevelSize != 0) {
+
+			const exr::Header& header = file.header();
+			bool hasLevels = header.hasTileDescription() && header.tileDescription().mode != exr::ONE_LEVEL;
+			bool levelFound = false;
+
+			if (hasLevels) {
+				try {
+					exr::TiledInputPart tiledPart(*multiPartFile, partIndex);
+					int levelCount = std::min(tiledPart.numXLevels(), tiledPart.numYLevels());
+
+					for (; level < levelCount; level++) {
+						if (std::max(tiledPart.levelWidth(level), tiledPart.levelHeight(level)) <= (int)maxLevelSize) {
+							dw = tiledPart.dataWindowForLevel(level, level);
+							levelFound = true;
+							break;
+						}
+					}
+				}
+				catch (const std::exception&) {
+					levelFound = false;
+				}
+			}
+
+			if (!levelFound) {
+				outPictureError.wasSuccessfull = false;
+				outPictureError.what = "ReadExr: the file stores no level that small";
+				return outInfo;
+			}
+		}
+
 		uint16_t width = dw.max.x - dw.min.x + 1;
 		uint16_t height = dw.max.y - dw.min.y + 1;
 		uint8_t numChannels = 0;
@@ -890,102 +1292,37 @@ namespace mnemosy::graphics {
 				numChannels = 1;
 			}
 
-			exr::FrameBuffer fb;
-
-			exr::Array2D<Imath::half> gray_pixels_half;
-			exr::Array2D<float> gray_pixels_float;
-
-
-			void* buffer = nullptr;
-
-
-			if (channel_format == TextureFormat::MNSY_R16) {
+			bool isHalf = channel_format == TextureFormat::MNSY_R16;
+			TextureFormat outFormat = convertGrayToRGB ? (TextureFormat)((uint8_t)channel_format + 2) : channel_format;
+			size_t bytesPerSample = isHalf ? sizeof(uint16_t) : sizeof(float);
+			size_t pixelCount = (size_t)width * height;
 
-				gray_pixels_half.resizeErase(height, width);
-				fb.insert(gray_channel_name.c_str(), exr::Slice(exr::PixelType::HALF, (char*)(&gray_pixels_half[0][0] - dw.min.x - dw.min.y * width), sizeof(gray_pixels_half[0][0]), sizeof(gray_pixels_half[0][0]) * width, 1, 1, 0.0, false, false));
-
-				file.setFrameBuffer(fb);
-				file.readPixels(dw.min.y, dw.max.y);
-				
-				size_t totalBufferSize = (size_t)width * (size_t)height * (uint16_t)numChannels * sizeof(uint16_t);
-
-				// MEM Alloc
-				buffer = malloc(totalBufferSize);
-				
-
-				for (uint16_t h = 0; h < height; h++) {
-
-					for (uint16_t w = 0; w < width; w++) {
-
-						// awsume we want to flip vertically
-						uint16_t x = w;
-						uint16_t y = height - h - 1;
-						if (!flipVertically) {
-							y = h;
-						}
-
-						if (convertToSrgb)
-							gray_pixels_half[y][x] = (Imath::half)pic_util_linear2srgb_float((float)gray_pixels_half[y][x]);
-
-
-						size_t offset = (h * width + w) * numChannels;
-
-						if (!convertGrayToRGB) {
-							memcpy((uint16_t*)buffer + offset, &gray_pixels_half[y][x], sizeof(uint16_t));
-						}
-						else { // copy the gray channel 3 times
-							memcpy((uint16_t*)buffer + offset + 0, &gray_pixels_half[y][x], sizeof(uint16_t));
-							memcpy((uint16_t*)buffer + offset + 1, &gray_pixels_half[y][x], sizeof(uint16_t));
-							memcpy((uint16_t*)buffer + offset + 2, &gray_pixels_half[y][x], sizeof(uint16_t));
-						}
-
-					} // loop width
-				}	// loop height
+			// MEM Alloc
+			void* buffer = malloc(pixelCount * numChannels * bytesPerSample);
 
+			// without expanding the gray channel is read straight into the output, otherwise into a temporary buffer that is expanded to rgb in one pass with the color conversion.
+			std::vector<char> gray_pixels;
+			char* grayBase = (char*)buffer;
+			if (convertGrayToRGB) {
+				gray_pixels.resize(pixelCount * bytesPerSample);
+				grayBase = gray_pixels.data();
 			}
-			else if (channel_format == TextureFormat::MNSY_R32) {
-
-				gray_pixels_float.resizeErase(height, width);
-				fb.insert(gray_channel_name.c_str(), exr::Slice(exr::PixelType::FLOAT, (char*)(&gray_pixels_float[0][0] - dw.min.x - dw.min.y * width), sizeof(gray_pixels_float[0][0]) * 1, sizeof(gray_pixels_float[0][0]) * width, 1, 1, 0.0, false, false));
-
-				file.setFrameBuffer(fb);
-				file.readPixels(dw.min.y, dw.max.y);
-
-				size_t totalBufferSize = (size_t)width * (size_t)height * (uint16_t)numChannels * sizeof(float);
-
-				buffer = malloc(totalBufferSize);
-						
-
-				for (uint16_t h = 0; h < height; h++) {
-
-					for (uint16_t w = 0; w < width; w++) {
-
-						// awsume we want to flip vertically
-						uint16_t x = w;
-						uint16_t y = height - h - 1;
-						if (!flipVertically) {
-							y = h;
-						}
-
-						size_t offset = (h * width + w) * numChannels;
 
-						if (convertToSrgb)
-							gray_pixels_float[y][x] = pic_util_linear2srgb_float(gray_pixels_float[y][x]);
-
-						if (!convertGrayToRGB) {
-							memcpy((float*)buffer + offset, &gray_pixels_float[y][x], sizeof(float));
-						}
-						else {
-							memcpy((float*)buffer + offset + 0, &gray_pixels_float[y][x], sizeof(float));
-							memcpy((float*)buffer + offset + 1, &gray_pixels_float[y][x], sizeof(float));
-							memcpy((float*)buffer + offset + 2, &gray_pixels_float[y][x], sizeof(float));
-						}
-												
-					} // loop width
-				} // loop height
+			const char* grayName = gray_channel_name.c_str();
+			exr::FrameBuffer fb;
+			pic_util_exr_insert_interleaved_slices(fb, &grayName, 1, isHalf ? exr::PixelType::HALF : exr::PixelType::FLOAT, grayBase, dw, flipVertically);
 
-			} 
+			std::string readError;
+			if (!pic_util_exr_read_pixels(*multiPartFile, partIndex, file, fb, dw, level, readError)) {
+				free(buffer);
+				outPictureError.wasSuccessfull = false;
+				outPictureError.what = "ReadExr: failed to read pixels: " + readError;
+				return outInfo;
+			}
 
+			if (convertGrayToRGB || convertToSrgb) {
+				PixelConvert::Convert(grayBase, channel_format, isHalf, buffer, outFormat, isHalf, pixelCount, convertToSrgb ? MNSY_COLOR_OP_LINEAR_TO_SRGB : MNSY_COLOR_OP_NONE);
+			}
 
 			// fill info struct
 			outInfo.width = width;
@@ -1050,265 +1387,76 @@ namespace mnemosy::graphics {
 				outPictureError.what = "ReadExr: channel format UINT is not supported";
 				return outInfo;
 			}
-			numChannels = 3;
-		}
-
-		// check A channel 
-		const exr::Channel* channel_a = channelsList.findChannel("A");
-		bool a_channel_exists = false;
-		TextureFormat a_channel_format = TextureFormat::MNSY_NONE;
-
-		if (channel_a && b_channel_exists) {
-			a_channel_exists = true;
-
-			exr::PixelType type = channel_a->type;
-
-			if (type == exr::PixelType::HALF) {
-				a_channel_format = TextureFormat::MNSY_R16;
-			}
-			else if (type == exr::PixelType::FLOAT) {
-				a_channel_format = TextureFormat::MNSY_R32;
-			}
-			else if (type == exr::PixelType::UINT) {
-				outPictureError.wasSuccessfull = false;
-				outPictureError.what = "ReadExr: channel format UINT is not supported";
-				return outInfo;
-			}
-			numChannels = 4;
-		}
-
-		// we dont support loading images where differnt channels have different bit depths. except alpha which will be promoted or demoted to fit the other channels
-		{
-			bool throwIncompatibleFormatError = false;
-			if (g_channel_exists) {
-				if (g_channel_format != channel_format) {
-					throwIncompatibleFormatError = true;
-				}
-			}
-			if (b_channel_exists) {
-				if (b_channel_format != channel_format) {
-					throwIncompatibleFormatError = true;
-				}
-			}
-			if (throwIncompatibleFormatError) {
-				outPictureError.wasSuccessfull = false;
-				outPictureError.what = "ReadExr: A channel had a different bit depth than the previous one. This is not supported";
-				return outInfo;
-			}
-		}
-
-
-		exr::FrameBuffer framebuffer;
-
-		// only the once that are present will be filled with data
-		exr::Array2D<Imath::half> r_pixels_half;
-		exr::Array2D<Imath::half> g_pixels_half;
-		exr::Array2D<Imath::half> b_pixels_half;
-		exr::Array2D<Imath::half> a_pixels_half;
-		
-
-		exr::Array2D<float> r_pixels_float;
-		exr::Array2D<float> g_pixels_float;
-		exr::Array2D<float> b_pixels_float;
-		exr::Array2D<float> a_pixels_float;
-		
-		if (channel_format == TextureFormat::MNSY_R16) {
-
-			if (r_channel_exists) { // actually must exist reduntant check but its more tidy
-				r_pixels_half.resizeErase(height, width);
-				framebuffer.insert("R", exr::Slice(exr::PixelType::HALF, (char*)(&r_pixels_half[0][0] - dw.min.x - dw.min.y * width), sizeof(r_pixels_half[0][0]), sizeof(r_pixels_half[0][0]) * width, 1, 1, 0.0, false, false));
-			}			
-			if (g_channel_exists) {
-				g_pixels_half.resizeErase(height,width);
-				framebuffer.insert("G", exr::Slice(exr::PixelType::HALF, (char*)(&g_pixels_half[0][0] - dw.min.x - dw.min.y * width), sizeof(g_pixels_half[0][0]), sizeof(g_pixels_half[0][0]) * width, 1, 1, 0.0, false, false));
-			}
-			if (b_channel_exists) {
-				b_pixels_half.resizeErase(height, width);
-				framebuffer.insert("B", exr::Slice(exr::PixelType::HALF, (char*)(&b_pixels_half[0][0] - dw.min.x - dw.min.y * width), sizeof(b_pixels_half[0][0]), sizeof(b_pixels_half[0][0]) * width, 1, 1, 0.0, false, false));
-			}
-		}
-		else if (channel_format == TextureFormat::MNSY_R32) {
-
-			if (r_channel_exists) {
-				r_pixels_float.resizeErase(height, width);
-				framebuffer.insert("R", exr::Slice(exr::PixelType::FLOAT, (char*)(&r_pixels_float[0][0] - dw.min.x - dw.min.y * width), sizeof(r_pixels_float[0][0]) * 1, sizeof(r_pixels_float[0][0])* width, 1, 1, 0.0, false, false));
-			}
-			if (g_channel_exists) {
-				g_pixels_float.resizeErase(height, width);
-				framebuffer.insert("G", exr::Slice(exr::PixelType::FLOAT, (char*)(&g_pixels_float[0][0] - dw.min.x - dw.min.y * width), sizeof(g_pixels_float[0][0]) * 1, sizeof(g_pixels_float[0][0]) * width, 1, 1, 0.0, false, false));
-			}
-			if (b_channel_exists) {
-				b_pixels_float.resizeErase(height, width);
-				framebuffer.insert("B", exr::Slice(exr::PixelType::FLOAT, (char*)(&b_pixels_float[0][0] - dw.min.x - dw.min.y * width), sizeof(b_pixels_float[0][0]) * 1, sizeof(b_pixels_float[0][0]) * width, 1, 1, 0.0, false, false));
-			}
-		}
-
-		if (a_channel_exists) {
-			if (a_channel_format == TextureFormat::MNSY_R16) {
-				a_pixels_half.resizeErase(height, width);
-				framebuffer.insert("A", exr::Slice(exr::PixelType::HALF, (char*)(&a_pixels_half[0][0] - dw.min.x - dw.min.y * width), sizeof(a_pixels_half[0][0]), sizeof(a_pixels_half[0][0]) * width, 1, 1, 0.0, false, false));
-			}
-			else if (a_channel_format == TextureFormat::MNSY_R32) {
-				a_pixels_float.resizeErase(height, width);
-				framebuffer.insert("A", exr::Slice(exr::PixelType::FLOAT, (char*)(&a_pixels_float[0][0] - dw.min.x - dw.min.y * width), sizeof(a_pixels_float[0][0]) * 1, sizeof(a_pixels_float[0][0])* width, 1, 1, 0.0, false, false));
-			}
-		}
-
-
-
-		file.setFrameBuffer(framebuffer);
-		file.readPixels(dw.min.y, dw.max.y);
-
-
-		void* buffer = nullptr;
-
-		// 16 bit half float
-		if (channel_format == TextureFormat::MNSY_R16) {
-
-			uint8_t bytesPerSample = sizeof(uint16_t);
-			uint16_t bytesPerPixel = (uint16_t)bytesPerSample * (uint16_t)numChannels;
-			size_t totalBufferSize = (size_t)bytesPerPixel * (size_t)width * (size_t)height;
-
-			// MEM Alloc
-			buffer = malloc(totalBufferSize);
-
-			for (uint8_t c = 1; c <= numChannels; c++) { // loop through r g b a channels
-
-				for (uint16_t h = 0; h < height; h++) {
-
-					for (uint16_t w = 0; w < width; w++) {
-
-						// awsume we want to flip vertically
-						uint16_t x = w;
-						uint16_t y = height - h - 1;
-						if (!flipVertically) {
-							y = h;
-						}					
-
-						size_t offset = (h * width + w) * numChannels + (c - 1);
-
-						if (c == 1) { // red channel
-							
-							if(convertToSrgb)
-								r_pixels_half[y][x] = (Imath::half)pic_util_linear2srgb_float((float)r_pixels_half[y][x]);
-
-							memcpy((uint16_t*)buffer + offset, &r_pixels_half[y][x], sizeof(uint16_t));
-						}
-						else if (c == 2) { // green channel
-
-
-							if (convertToSrgb)
-								g_pixels_half[y][x] = (Imath::half)pic_util_linear2srgb_float((float)g_pixels_half[y][x]);
-
-							memcpy((uint16_t*)buffer + offset, &g_pixels_half[y][x], sizeof(uint16_t));
-						}
-						else if (c == 3) { // blue channel
-
-							if (convertToSrgb)
-								b_pixels_half[y][x] = (Imath::half)pic_util_linear2srgb_float((float)b_pixels_half[y][x]);
-
-							memcpy((uint16_t*)buffer + offset, &b_pixels_half[y][x], sizeof(uint16_t));
-						}
-						else if (c == 4) { // alpha channel
-
-							if (a_channel_format == TextureFormat::MNSY_R16) {
-								
-								if (convertToSrgb)
-									a_pixels_half[y][x] = (Imath::half)pic_util_linear2srgb_float((float)a_pixels_half[y][x]);
-
-								memcpy((uint16_t*)buffer + offset, &a_pixels_half[y][x], sizeof(uint16_t));
-							}
-							else if (a_channel_format == TextureFormat::MNSY_R32) { 
-
-								// alpha channel will be demoted from float to half
-								float valueTemp = a_pixels_float[y][x];
-
-								if (convertToSrgb)
-									valueTemp = (Imath::half)pic_util_linear2srgb_float(valueTemp);
-
-								Imath::half value = Imath::half(valueTemp);
-
-								memcpy((uint16_t*)buffer + offset, &value, sizeof(uint16_t));
-							}
-
-						}						
-
-					} // loop width
-				}	// loop height
-			} // loop numChannels
-
-		}
-		// 32 bit float
-		else if (channel_format == TextureFormat::MNSY_R32) {
-			
-			uint8_t bytesPerSample = sizeof(float);
-			uint16_t bytesPerPixel = (uint16_t)bytesPerSample * (uint16_t)numChannels;
-			size_t totalBufferSize = (size_t)bytesPerPixel * width * height;
-
-			buffer = malloc(totalBufferSize);
-
-			for (int c = 1; c <= numChannels; c++) { // loop through r g b a channels
-
-				for (uint16_t h = 0; h < height; h++) {
-
-					for (uint16_t w = 0; w < width; w++) {
-
-						// awsume we want to flip vertically
-						uint16_t x = w;
-						uint16_t y = height - h - 1;
-						if (!flipVertically) {
-							y = h;
-						}
-
-						size_t offset = (h * width + w) * numChannels + (c - 1);
-
-						if (c == 1) { // red channel
-
-							if(convertToSrgb)
-								r_pixels_float[y][x] = pic_util_linear2srgb_float(r_pixels_float[y][x]);
+			numChannels = 3;
+		}
 
-							memcpy((float*)buffer + offset, &r_pixels_float[y][x], sizeof(float));
-						}
-						else if (c == 2) { // green channel
-							
-							if (convertToSrgb)
-								g_pixels_float[y][x] = pic_util_linear2srgb_float(g_pixels_float[y][x]);
+		// check A channel 
+		const exr::Channel* channel_a = channelsList.findChannel("A");
+		bool a_channel_exists = false;
+		TextureFormat a_channel_format = TextureFormat::MNSY_NONE;
 
-							memcpy((float*)buffer + offset, &g_pixels_float[y][x], sizeof(float));
-						}
-						else if (c == 3) { // blue channel
-							
-							if (convertToSrgb)
-								b_pixels_float[y][x] = pic_util_linear2srgb_float(b_pixels_float[y][x]);
+		if (channel_a && b_channel_exists) {
+			a_channel_exists = true;
 
-							memcpy((float*)buffer + offset, &b_pixels_float[y][x], sizeof(float));
-						}
-						else if (c == 4) { // alpha channel
+			exr::PixelType type = channel_a->type;
 
-							if (a_channel_format == TextureFormat::MNSY_R32) {
+			if (type == exr::PixelType::HALF) {
+				a_channel_format = TextureFormat::MNSY_R16;
+			}
+			else if (type == exr::PixelType::FLOAT) {
+				a_channel_format = TextureFormat::MNSY_R32;
+			}
+			else if (type == exr::PixelType::UINT) {
+				outPictureError.wasSuccessfull = false;
+				outPictureError.what = "ReadExr: channel format UINT is not supported";
+				return outInfo;
+			}
+			numChannels = 4;
+		}
 
-								if (convertToSrgb)
-									a_pixels_float[y][x] = pic_util_linear2srgb_float(a_pixels_float[y][x]);
+		// we dont support loading images where differnt channels have different bit depths. except alpha which will be promoted or demoted to fit the other channels
+		{
+			bool throwIncompatibleFormatError = false;
+			if (g_channel_exists) {
+				if (g_channel_format != channel_format) {
+					throwIncompatibleFormatError = true;
+				}
+			}
+			if (b_channel_exists) {
+				if (b_channel_format != channel_format) {
+					throwIncompatibleFormatError = true;
+				}
+			}
+			if (throwIncompatibleFormatError) {
+				outPictureError.wasSuccessfull = false;
+				outPictureError.what = "ReadExr: A channel had a different bit depth than the previous one. This is not supported";
+				return outInfo;
+			}
+		}
 
-								memcpy((float*)buffer + offset, &a_pixels_float[y][x], sizeof(float));
-							}
-							else if (a_channel_format == TextureFormat::MNSY_R16) {
 
-								// alpha channel gets promoted from half to float
+		TextureFormat format = (TextureFormat)((uint8_t)channel_format + (numChannels - 1));
+		bool isHalf = channel_format == TextureFormat::MNSY_R16;
+		size_t pixelCount = (size_t)width * height;
 
-								Imath::half valueTemp = a_pixels_half[y][x];
+		// MEM Alloc
+		void* buffer = malloc(pixelCount * numChannels * (isHalf ? sizeof(uint16_t) : sizeof(float)));
 
-								if (convertToSrgb)
-									valueTemp = (Imath::half)pic_util_linear2srgb_float((float)valueTemp);
+		// openExr interleaves the channels into the output itself, an alpha channel of the other float type is converted while reading
+		const char* channelNames[4] = { "R", "G", "B", "A" };
+		exr::FrameBuffer framebuffer;
+		pic_util_exr_insert_interleaved_slices(framebuffer, channelNames, numChannels, isHalf ? exr::PixelType::HALF : exr::PixelType::FLOAT, (char*)buffer, dw, flipVertically);
 
-								float value = (float)valueTemp;
+		std::string readError;
+		if (!pic_util_exr_read_pixels(*multiPartFile, partIndex, file, framebuffer, dw, level, readError)) {
+			free(buffer);
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "ReadExr: failed to read pixels: " + readError;
+			return outInfo;
+		}
 
-								memcpy((float*)buffer + offset, &value, sizeof(float));
-							}
-						}
-					} // loop width
-				} // loop height
-			} // loop numChannels
+		if (convertToSrgb) {
+			PixelConvert::Convert(buffer, format, isHalf, buffer, format, isHalf, pixelCount, MNSY_COLOR_OP_LINEAR_TO_SRGB);
 		}
 
 		// fill info struct
@@ -1321,6 +1469,33 @@ namespace mnemosy::graphics {
 		return outInfo;
 	}
 
+	PictureInfo Picture::ReadExr(PictureError& outPictureError, const char* filepath, const bool flipVertically, const bool convertToSrgb, const bool convertGrayToRGB) {
+
+		uint16_t fullWidth = 0;
+		uint16_t fullHeight = 0;
+		return pic_util_exr_read(outPictureError, filepath, flipVertically, convertToSrgb, convertGrayToRGB, 0, fullWidth, fullHeight);
+	}
+
+	PictureInfo Picture::ReadPictureReduced(PictureError& outPictureError, const char* filepath, const bool flipVertically, const bool convertGrayToRGB, const bool convertEXRandHDRToSrgb, const uint16_t maxSize, uint16_t& outFullWidth, uint16_t& outFullHeight) {
+
+		outPictureError.wasSuccessfull = true;
+		outPictureError.what = "";
+		outFullWidth = 0;
+		outFullHeight = 0;
+
+		std::filesystem::path p = { filepath };
+		ImageFileFormat fileFormat = TexUtil::get_imageFileFormat_from_fileExtentionString(p.extension().generic_string());
+
+		if (fileFormat == ImageFileFormat::MNSY_FILE_FORMAT_EXR && maxSize != 0) {
+			return pic_util_exr_read(outPictureError, filepath, flipVertically, convertEXRandHDRToSrgb, convertGrayToRGB, maxSize, outFullWidth, outFullHeight);
+		}
+
+		// tif, png and hdr have no smaller levels, stb_image decodes jpg at full size only and ktx2 can't be read as a picture yet
+		outPictureError.wasSuccessfull = false;
+		outPictureError.what = "ReadPictureReduced: the file format stores no reduced resolution.";
+		return PictureInfo();
+	}
+
 	void Picture::WriteExr(PictureError& outPictureError, const char* filepath, const PictureInfo& pictureInfo, const bool flipVertically, const bool convertToLinear) {
 
 		namespace exr = Imf;
@@ -1357,11 +1532,6 @@ namespace mnemosy::graphics {
 
 		exr::Header header(width, height);
 
-		void* r_pixels = nullptr;
-		void* g_pixels = nullptr;
-		void* b_pixels = nullptr;
-		void* a_pixels = nullptr;
-
 		if (channelFormat == TextureFormat::MNSY_R8) {
 			// care we will have to promote the values to half_float
 
@@ -1397,240 +1567,50 @@ namespace mnemosy::graphics {
 				header.channels().insert("A", exr::Channel(exr::PixelType::FLOAT));
 		}
 
-		exr::OutputFile file(filepath, header);
-		exr::FrameBuffer framebuffer;
-
-		exr::PixelType pixelType = exr::PixelType::HALF;
-		uint8_t pixelTypeSize = sizeof(uint16_t);
-
-		void* inputBuffer = pictureInfo.pixels;
-
-		if (channelFormat == TextureFormat::MNSY_R8) {
-
-			pixelType = exr::PixelType::HALF;
-			pixelTypeSize = sizeof(uint16_t);
-			// care we will have to promote the values to half float
-
-			pixelType = exr::PixelType::HALF;
-			pixelTypeSize = sizeof(uint16_t);
-
-			Imath::half* r_pixels_half = nullptr;
-			Imath::half* g_pixels_half = nullptr;
-			Imath::half* b_pixels_half = nullptr;
-			Imath::half* a_pixels_half = nullptr;
-
-			size_t channelBufferSize = width * height * sizeof(uint16_t);
-
-			// allocate memory for pixel buffers
-			if (r_channel_exists) { r_pixels_half = (Imath::half*)malloc(channelBufferSize); }
-			if (g_channel_exists) { g_pixels_half = (Imath::half*)malloc(channelBufferSize); }
-			if (b_channel_exists) { b_pixels_half = (Imath::half*)malloc(channelBufferSize); }
-			if (a_channel_exists) { a_pixels_half = (Imath::half*)malloc(channelBufferSize); }
-
-			for (uint16_t h = 0; h < height; h++) {
-				for (uint16_t w = 0; w < width; w++) {
-					for (uint8_t c = 0; c < numChannels; c++) {
-
-						size_t offsetInputBuffer = (h * width + w) * numChannels + c;
-						// asume we flip vertically
-						uint16_t y = height - h - 1;
-						if (!flipVertically) {
-							y = h;
-						}
-
-						size_t offsetChannelBuffer = y * width + w;
-
-						// promoting the input buffer wich is 8bits to half float // not sure if just casting is how to properly do this
-						uint8_t byte = *((uint8_t*)inputBuffer + offsetInputBuffer);
-						
-						float valueAsFloat = (float)byte;
-
-						Imath::half value = Imath::half(valueAsFloat);
-
-						if (convertToLinear) {
-							value = (Imath::half)pic_util_srgb2linear_float((float)value);
-						}
-
-
-						if (c == 0) { // r channel
-							memcpy(r_pixels_half + offsetChannelBuffer, &value, sizeof(value));
-						}
-						else if (c == 1) { // g channel
-							memcpy(g_pixels_half + offsetChannelBuffer, &value, sizeof(value));
-						}
-						else if (c == 2) { // b channel
-							memcpy(b_pixels_half + offsetChannelBuffer, &value, sizeof(value));
-						}
-						else if (c == 3) { // a channel
-							memcpy(a_pixels_half + offsetChannelBuffer, &value, sizeof(value));
-						}
-					} // loop channels
-				} // loop width
-			} // loop height
-
-
-			r_pixels = (void*)r_pixels_half;
-			g_pixels = (void*)g_pixels_half;
-			b_pixels = (void*)b_pixels_half;
-			a_pixels = (void*)a_pixels_half;
-
-
-
-		}
-		else if (channelFormat == TextureFormat::MNSY_R16) {
-			
-			pixelType = exr::PixelType::HALF;
-			pixelTypeSize = sizeof(uint16_t);
-
-			Imath::half* r_pixels_half = nullptr;
-			Imath::half* g_pixels_half = nullptr;
-			Imath::half* b_pixels_half = nullptr;
-			Imath::half* a_pixels_half = nullptr;
-
-			size_t channelBufferSize = width * height * sizeof(uint16_t);
-
-			// allocate memory for pixel buffers
-			if (r_channel_exists) { r_pixels_half = (Imath::half*)malloc(channelBufferSize); }
-			if (g_channel_exists) {	g_pixels_half = (Imath::half*)malloc(channelBufferSize); }
-			if (b_channel_exists) {	b_pixels_half = (Imath::half*)malloc(channelBufferSize); }
-			if (a_channel_exists) {	a_pixels_half = (Imath::half*)malloc(channelBufferSize); }
-
-			for (uint16_t h = 0; h < height; h++) {
-				for (uint16_t w = 0; w < width; w++) {
-					for (uint8_t c = 0; c < numChannels; c++) {
-
-						size_t offsetInputBuffer = (h * width + w) * numChannels + c;
-						// asume we flip vertically
-						uint16_t y = height - h - 1;
-						if (!flipVertically) { 
-							y = h; 
-						}
-
-						size_t offsetChannelBuffer = y * width + w;
-
-						Imath::half value =  *((Imath::half*)inputBuffer + offsetInputBuffer);
-						if (convertToLinear) {
-							value = (Imath::half)pic_util_srgb2linear_float((float)value);
-						}
-
-
-						if (c == 0) { // r channel
-							memcpy(r_pixels_half + offsetChannelBuffer, &value, sizeof(value));
-						}
-						else if (c == 1) { // g channel
-							memcpy(g_pixels_half + offsetChannelBuffer, &value, sizeof(value));
-						}
-						else if (c == 2) { // b channel
-							memcpy(b_pixels_half + offsetChannelBuffer, &value, sizeof(value));
-						}
-						else if (c == 3) { // a channel
-							memcpy(a_pixels_half + offsetChannelBuffer, &value, sizeof(value));
-						}
-					} // loop channels
-				} // loop width
-			} // loop height
-
-
-			r_pixels = (void*)r_pixels_half;
-			g_pixels = (void*)g_pixels_half;
-			b_pixels = (void*)b_pixels_half;
-			a_pixels = (void*)a_pixels_half;
+		// 8 and 16 bit are written as half float, unsigned normalized values are converted to 0-1
+		bool writeFloat = channelFormat == TextureFormat::MNSY_R32;
+		exr::PixelType pixelType = writeFloat ? exr::PixelType::FLOAT : exr::PixelType::HALF;
+		size_t pixelTypeSize = writeFloat ? sizeof(float) : sizeof(uint16_t);
+		TextureFormat outFormat = (TextureFormat)((uint8_t)(writeFloat ? TextureFormat::MNSY_R32 : TextureFormat::MNSY_R16) + (numChannels - 1));
+		size_t pixelCount = (size_t)width * height;
 
-		}
-		else if (channelFormat == TextureFormat::MNSY_R32) {
-			
-			pixelType = exr::PixelType::FLOAT;
-			pixelTypeSize = sizeof(uint32_t);
-
-			float* r_pixels_float = nullptr;
-			float* g_pixels_float = nullptr;
-			float* b_pixels_float = nullptr;
-			float* a_pixels_float = nullptr;
+		// half and float pixels are handed to openExr as they are, everything else is converted into a temporary buffer first
+		bool needsConversion = convertToLinear || (channelFormat == TextureFormat::MNSY_R8) || (channelFormat == TextureFormat::MNSY_R16 && !pictureInfo.isHalfFloat);
 
-			size_t channelBufferSize = width * height * sizeof(float);
+		char* pixels = (char*)pictureInfo.pixels;
+		if (needsConversion) {
 
-			//allocate memory for pixel buffers
-			if (r_channel_exists) {
-				r_pixels_float = (float*)malloc(channelBufferSize);
-			}
-			if (g_channel_exists) {
-				g_pixels_float = (float*)malloc(channelBufferSize);
-			}
-			if (b_channel_exists) {
-				b_pixels_float = (float*)malloc(channelBufferSize);
-			}
-			if (a_channel_exists) {
-				a_pixels_float = (float*)malloc(channelBufferSize);
+			pixels = (char*)malloc(pixelCount * numChannels * pixelTypeSize);
+			if (!pixels) {
+				outPictureError.wasSuccessfull = false;
+				outPictureError.what = "WriteExr: failed to allocate memory";
+				return;
 			}
 
-			for (uint16_t h = 0; h < height; h++) {
-				for (uint16_t w = 0; w < width; w++) {
-					for (uint8_t c = 0; c < numChannels; c++) { 
-
-						size_t offsetInputBuffer = (h * width + w) * numChannels + c;
-
-						// asume we flip vertically
-						uint16_t y = height - h -1;
-
-						if (!flipVertically) { y = h; }
-
-						size_t offsetChannelBuffer = y *width + w;
-
-						float value = *((float*)inputBuffer + offsetInputBuffer);
-						if (convertToLinear) {
-							value = pic_util_srgb2linear_float(value);
-						}						
-
-						if (c == 0) { // r channel
-							memcpy(r_pixels_float + offsetChannelBuffer, &value, sizeof(value));
-						}
-						else if (c == 1) { // g channel
-							memcpy(g_pixels_float + offsetChannelBuffer, &value, sizeof(value));
-						}
-						else if (c == 2) { // b channel
-							memcpy(b_pixels_float + offsetChannelBuffer, &value, sizeof(value));
-						}
-						else if (c == 3) { // a channel
-							memcpy(a_pixels_float + offsetChannelBuffer, &value, sizeof(value));
-						}
-					} // loop channels
-				} // loop width
-			} // loop height
-
-
-			r_pixels = (void*)r_pixels_float;
-			g_pixels = (void*)g_pixels_float;
-			b_pixels = (void*)b_pixels_float;
-			a_pixels = (void*)a_pixels_float;
-		} // TextureFormat::MNSY_R32
+			PixelConvert::Convert(pictureInfo.pixels, format, pictureInfo.isHalfFloat, pixels, outFormat, !writeFloat, pixelCount, convertToLinear ? MNSY_COLOR_OP_SRGB_TO_LINEAR : MNSY_COLOR_OP_NONE);
+		}
 
+		const char* channelNames[4] = { "R", "G", "B", "A" };
+		exr::FrameBuffer framebuffer;
+		pic_util_exr_insert_interleaved_slices(framebuffer, channelNames, numChannels, pixelType, pixels, header.dataWindow(), flipVertically);
 
-		if (r_channel_exists) {
-			framebuffer.insert("R", exr::Slice(pixelType, (char*)r_pixels, pixelTypeSize * 1, pixelTypeSize * width));
-		}
-		if (g_channel_exists) {
-			framebuffer.insert("G", exr::Slice(pixelType, (char*)g_pixels, pixelTypeSize * 1, pixelTypeSize * width));
+		try {
+			exr::OutputFile file(filepath, header);
+			file.setFrameBuffer(framebuffer);
+			file.writePixels(height);
 		}
-		if (b_channel_exists) {
-			framebuffer.insert("B", exr::Slice(pixelType, (char*)b_pixels, pixelTypeSize * 1, pixelTypeSize * width));
-		}
-		if (a_channel_exists) {
-			framebuffer.insert("A", exr::Slice(pixelType, (char*)a_pixels, pixelTypeSize * 1, pixelTypeSize * width));
+		catch (const std::exception& e) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "WriteExr: " + std::string(e.what());
 		}
 
-		file.setFrameBuffer(framebuffer);
-		file.writePixels(height);
-
-
-		if (r_pixels)
-			free(r_pixels);
-		if (g_pixels)
-			free(g_pixels);
-		if (b_pixels)
-			free(b_pixels);
-		if (a_pixels)
-			free(a_pixels);
+		if (needsConversion) {
+			free(pixels);
+		}
+	}
 
+	void Picture::SetExrThreadCount(const uint32_t threadCount) {
+		Imf::setGlobalThreadCount((int)threadCount);
 	}
 
 	PictureInfo Picture::ReadHdr(PictureError& outPictureError, const char* filepath, const bool flipVertically, const bool convertToSrgb) {
@@ -1645,14 +1625,10 @@ namespace mnemosy::graphics {
 		float* buffer = stbi_loadf(filepath, &width, &height, &channels, 3);
 		
 		
-		if (convertToSrgb) {
-
-			size_t pixelCount = width * height * channels;
-
-			pic_util_linear2srgb_floatBuffer(buffer, pixelCount);
-
-
-		} // end convertToSrgb
+		// stbi always gives us the 3 channels we asked for
+		if (convertToSrgb && buffer) {
+			PixelConvert::LinearToSrgb(buffer, (size_t)width * height * 3);
+		}
 
 
 		return PictureInfo(width,height,graphics::TextureFormat::MNSY_RGB32 ,false,(void*)buffer);
@@ -1691,14 +1667,7 @@ namespace mnemosy::graphics {
 		uint16_t height = pictureInfo.height;
 
 		if (convertToLinear) {
-						
-			size_t pixelCount = width * height * channels;
-
-			for (int p = 0; p < pixelCount; p++) {
-
-				float val = buffer[p];
-				buffer[p] = Picture::pic_util_srgb2linear_float(val);
-			}
+			PixelConvert::Convert(buffer, pictureInfo.textureFormat, false, buffer, pictureInfo.textureFormat, false, (size_t)width * height, MNSY_COLOR_OP_SRGB_TO_LINEAR);
 		}
 
 		stbi_flip_vertically_on_write(flipVertically);
@@ -1735,19 +1704,9 @@ namespace mnemosy::graphics {
 		if (channels == 1 && convertGrayToRGB) {
 
 			format = TextureFormat::MNSY_RGB8;
-			void* pixels = malloc(width * height * 3 * sizeof(uint8_t));
-						
-			for (uint16_t h = 0; h < height; h++) {
-				for (uint16_t w = 0; w < width; w++) {
-
-					size_t offsetSrc = (h * width + w);
-					size_t offsetDest = offsetSrc * 3; // 3 bc we now have RGB channels in destination buffer
+			void* pixels = malloc((size_t)width * height * 3 * sizeof(uint8_t));
 
-					memcpy((uint8_t*)pixels + offsetDest + 0, (uint8_t*)buffer + offsetSrc, sizeof(uint8_t));
-					memcpy((uint8_t*)pixels + offsetDest + 1, (uint8_t*)buffer + offsetSrc, sizeof(uint8_t));
-					memcpy((uint8_t*)pixels + offsetDest + 2, (uint8_t*)buffer + offsetSrc, sizeof(uint8_t));					
-				}
-			}
+			PixelConvert::Convert(buffer, TextureFormat::MNSY_R8, false, pixels, TextureFormat::MNSY_RGB8, false, (size_t)width * height, MNSY_COLOR_OP_NONE);
 
 			free(buffer);
 			buffer = pixels;
@@ -1805,41 +1764,12 @@ namespace mnemosy::graphics {
 			
 			MNEMOSY_TRACE("Converting 16 bit to 8 bit");
 
-			void* buffer = malloc(width * height * channels * sizeof(uint8_t));
-			
-
-			for (uint16_t h = 0; h < height; h++) {
-				for (uint16_t w = 0; w < width; w++) {
-
-
-					// since both src and destination buffers have the exact same layout only different bit depth offset is the same for both
-					size_t offset = (h * width + w) * channels;
-					
-					if (channels >= 1) { // red
-						uint16_t value16 = *((uint16_t*)srcBuffer + offset + 0) / (uint16_t)UINT8_MAX;	// scary shit but basically the value at the srcBuffer / 255
-						uint8_t value8 = (uint8_t)std::clamp(value16,(uint16_t)0, (uint16_t)UINT8_MAX); // now we clamp it to be sure
-
-						memcpy((uint8_t*)buffer + offset + 0, &value8, sizeof(uint8_t));
-					}
-					if (channels >= 2) { // green 
-						uint16_t value16 = *((uint16_t*)srcBuffer + offset + 1) / (uint16_t)UINT8_MAX;
-						uint8_t value8 = (uint8_t)std::clamp(value16, (uint16_t)0, (uint16_t)UINT8_MAX); 
-
-						memcpy((uint8_t*)buffer + offset + 1, &value8, sizeof(uint8_t));
-					}
-					if (channels >= 3) { // blue
-						uint16_t value16 = *((uint16_t*)srcBuffer + offset + 2) / (uint16_t)UINT8_MAX;
-						uint8_t value8 = (uint8_t)std::clamp(value16, (uint16_t)0, (uint16_t)UINT8_MAX);
+			// 16 bit formats are 4 values after their 8 bit counterpart
+			TextureFormat format8 = (TextureFormat)((uint8_t)pictureInfo.textureFormat - 4);
 
-						memcpy((uint8_t*)buffer + offset + 2, &value8, sizeof(uint8_t));
-					}
-					if (channels == 4) { // alpha
-						// since alpha will be discarded anyway we dont care what ends up in alpha channel
-						memset((uint8_t*)buffer + offset + 3, 0, sizeof(uint8_t));
-					}
-				} // loop width
-			}// loop heigth
+			void* buffer = malloc((size_t)width * height * channels * sizeof(uint8_t));
 
+			PixelConvert::Convert(srcBuffer, pictureInfo.textureFormat, pictureInfo.isHalfFloat, buffer, format8, false, (size_t)width * height, MNSY_COLOR_OP_NONE);
 
 			int stbiErrorCheck = stbi_write_jpg(filepath, pictureInfo.width, pictureInfo.height, channels, buffer, 100);
 
@@ -2016,9 +1946,7 @@ namespace mnemosy::graphics {
 		// this is neccesary because png always uses Big endian and lodePng doesn't convert for us
 		if (bitsPerChannel == 16) {
 
-			size_t pixelCount = width * height * numChannels;
-
-			pic_util_SwapEndianness(pixelBuffer,0,pixelCount);
+			PixelConvert::SwapBytes16((uint16_t*)pixelBuffer, (size_t)width * height * numChannels);
 		}		
 
 		if (flipVertically) {
@@ -2118,9 +2046,7 @@ namespace mnemosy::graphics {
 		//convert little to big endian for 16 bit images
 		if (bitsPerChannel == 16) {
 
-			size_t pixelCount = width * height * numChannels;
-
-			pic_util_SwapEndianness(bufferCopy, 0, pixelCount);
+			PixelConvert::SwapBytes16((uint16_t*)bufferCopy, (size_t)width * height * numChannels);
 		}
 
 
@@ -2297,22 +2223,170 @@ namespace mnemosy::graphics {
 		return PictureError(true, "");
 	}
 
-	float Picture::pic_util_linear2srgb_float(float linearValue) {
+	// averages blocks of factor x factor pixels, blocks at the right and bottom border may be smaller if the size is not divisible by factor.
+	template<typename T>
+	void pic_util_downscale_box(const T* src, T* dst, uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight, uint32_t channels, uint32_t factor) {
+
+		for (uint32_t y = 0; y < dstHeight; y++) {
+
+			uint32_t yBegin = y * factor;
+			uint32_t yEnd = std::min(yBegin + factor, srcHeight);
+
+			for (uint32_t x = 0; x < dstWidth; x++) {
+
+				uint32_t xBegin = x * factor;
+				uint32_t xEnd = std::min(xBegin + factor, srcWidth);
+
+				float sums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+				for (uint32_t sy = yBegin; sy < yEnd; sy++) {
 
-		if(linearValue <= 0.0031308f){
-	    	return linearValue * 12.92f;
-	  	}
-	    
-	  	return 1.055f* std::pow(linearValue,(1.0f / 2.4f) ) - 0.055f;
+					const T* srcRow = src + ((size_t)sy * srcWidth + xBegin) * channels;
+
+					for (uint32_t sx = 0; sx < xEnd - xBegin; sx++) {
+						for (uint32_t c = 0; c < channels; c++) {
+							sums[c] += (float)srcRow[sx * channels + c];
+						}
+					}
+				}
+
+				float sampleCount = (float)((yEnd - yBegin) * (xEnd - xBegin));
+				T* dstPixel = dst + ((size_t)y * dstWidth + x) * channels;
+
+				for (uint32_t c = 0; c < channels; c++) {
+
+					if constexpr (std::is_integral_v<T>) {
+						dstPixel[c] = (T)(sums[c] / sampleCount + 0.5f);
+					}
+					else {
+						dstPixel[c] = (T)(sums[c] / sampleCount);
+					}
+				}
+			}
+		}
 	}
 
-	float Picture::pic_util_srgb2linear_float(float srgbValue) {
+	PictureInfo Picture::pic_util_downscale(PictureError& outPictureError, const PictureInfo& pictureInfo, const uint16_t maxSize) {
+
+		PictureError err = pic_util_check_input_pictureInfo(pictureInfo);
+		if (!err.wasSuccessfull) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "pic_util_downscale: " + err.what;
+			return PictureInfo();
+		}
+
+		if (maxSize == 0) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "pic_util_downscale: maxSize must be larger than 0";
+			return PictureInfo();
+		}
+
+		uint8_t numChannels, bitsPerChannel, bytesPerPixel;
+		TexUtil::get_information_from_textureFormat(pictureInfo.textureFormat, numChannels, bitsPerChannel, bytesPerPixel);
+
+		uint32_t srcWidth = pictureInfo.width;
+		uint32_t srcHeight = pictureInfo.height;
+
+		uint32_t factor = 1;
+		while ((srcWidth + factor - 1) / factor > maxSize || (srcHeight + factor - 1) / factor > maxSize) {
+			factor *= 2;
+		}
+
+		uint32_t dstWidth = (srcWidth + factor - 1) / factor;
+		uint32_t dstHeight = (srcHeight + factor - 1) / factor;
+
+		void* buffer = malloc((size_t)dstWidth * dstHeight * bytesPerPixel);
+		if (!buffer) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "pic_util_downscale: failed to allocate memory";
+			return PictureInfo();
+		}
+
+		if (bitsPerChannel == 8) {
+			pic_util_downscale_box<uint8_t>((const uint8_t*)pictureInfo.pixels, (uint8_t*)buffer, srcWidth, srcHeight, dstWidth, dstHeight, numChannels, factor);
+		}
+		else if (bitsPerChannel == 16 && pictureInfo.isHalfFloat) {
+			pic_util_downscale_box<Imath::half>((const Imath::half*)pictureInfo.pixels, (Imath::half*)buffer, srcWidth, srcHeight, dstWidth, dstHeight, numChannels, factor);
+		}
+		else if (bitsPerChannel == 16) {
+			pic_util_downscale_box<uint16_t>((const uint16_t*)pictureInfo.pixels, (uint16_t*)buffer, srcWidth, srcHeight, dstWidth, dstHeight, numChannels, factor);
+		}
+		else {
+			pic_util_downscale_box<float>((const float*)pictureInfo.pixels, (float*)buffer, srcWidth, srcHeight, dstWidth, dstHeight, numChannels, factor);
+		}
+
+		outPictureError.wasSuccessfull = true;
+		return PictureInfo((uint16_t)dstWidth, (uint16_t)dstHeight, pictureInfo.textureFormat, pictureInfo.isHalfFloat, buffer);
+	}
+
+	PictureInfo Picture::pic_util_next_mip_level(PictureError& outPictureError, const PictureInfo& pictureInfo) {
+
+		PictureError err = pic_util_check_input_pictureInfo(pictureInfo);
+		if (!err.wasSuccessfull) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "pic_util_next_mip_level: " + err.what;
+			return PictureInfo();
+		}
+
+		uint8_t numChannels, bitsPerChannel, bytesPerPixel;
+		TexUtil::get_information_from_textureFormat(pictureInfo.textureFormat, numChannels, bitsPerChannel, bytesPerPixel);
+
+		uint32_t srcWidth = pictureInfo.width;
+		uint32_t srcHeight = pictureInfo.height;
+		uint32_t dstWidth = std::max(srcWidth / 2, 1u);
+		uint32_t dstHeight = std::max(srcHeight / 2, 1u);
+
+		void* buffer = malloc((size_t)dstWidth * dstHeight * bytesPerPixel);
+		if (!buffer) {
+			outPictureError.wasSuccessfull = false;
+			outPictureError.what = "pic_util_next_mip_level: failed to allocate memory";
+			return PictureInfo();
+		}
+
+		// an odd last row or column is dropped, same as the gpu would do it
+		if (bitsPerChannel == 8) {
+			pic_util_downscale_box<uint8_t>((const uint8_t*)pictureInfo.pixels, (uint8_t*)buffer, srcWidth, srcHeight, dstWidth, dstHeight, numChannels, 2);
+		}
+		else if (bitsPerChannel == 16 && pictureInfo.isHalfFloat) {
+			pic_util_downscale_box<Imath::half>((const Imath::half*)pictureInfo.pixels, (Imath::half*)buffer, srcWidth, srcHeight, dstWidth, dstHeight, numChannels, 2);
+		}
+		else if (bitsPerChannel == 16) {
+			pic_util_downscale_box<uint16_t>((const uint16_t*)pictureInfo.pixels, (uint16_t*)buffer, srcWidth, srcHeight, dstWidth, dstHeight, numChannels, 2);
+		}
+		else {
+			pic_util_downscale_box<float>((const float*)pictureInfo.pixels, (float*)buffer, srcWidth, srcHeight, dstWidth, dstHeight, numChannels, 2);
+		}
 
-		if(srgbValue <= 0.04045f){
-		    return srgbValue/12.92f;
-		 }
+		outPictureError.wasSuccessfull = true;
+		return PictureInfo((uint16_t)dstWidth, (uint16_t)dstHeight, pictureInfo.textureFormat, pictureInfo.isHalfFloat, buffer);
+	}
+
+	size_t Picture::pic_util_mip_chain_size(const PictureInfo& pictureInfo, const uint32_t mipLevels) {
+
+		uint8_t numChannels, bitsPerChannel, bytesPerPixel;
+		TexUtil::get_information_from_textureFormat(pictureInfo.textureFormat, numChannels, bitsPerChannel, bytesPerPixel);
+
+		size_t size = 0;
+		uint32_t width = pictureInfo.width;
+		uint32_t height = pictureInfo.height;
+
+		for (uint32_t level = 0; level < mipLevels; level++) {
+
+			size += (size_t)width * height * bytesPerPixel;
 
-		 return std::pow( (srgbValue + 0.055f)/ 1.055f, 2.4f);
+			width = std::max(width / 2, 1u);
+			height = std::max(height / 2, 1u);
+		}
+
+		return size;
+	}
+
+	float Picture::pic_util_linear2srgb_float(float linearValue) {
+		return PixelConvert::LinearToSrgb(linearValue);
+	}
+
+	float Picture::pic_util_srgb2linear_float(float srgbValue) {
+		return PixelConvert::SrgbToLinear(srgbValue);
 	}
 
 }
\ No newline at end of file
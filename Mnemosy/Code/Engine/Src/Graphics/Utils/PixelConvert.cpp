@@ -0,0 +1,906 @@
+#include "Include/Graphics/Utils/PixelConvert.h"
+
+// std
+#include <string.h>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define PIXEL_CONVERT_X86
+#endif
+
+// forces the plain c++ kernels on every cpu
+//#define PIXEL_CONVERT_DISABLE_SIMD
+
+#if defined(PIXEL_CONVERT_X86) && !defined(PIXEL_CONVERT_DISABLE_SIMD)
+	#define PIXEL_CONVERT_USE_SIMD
+#endif
+
+#ifdef PIXEL_CONVERT_USE_SIMD
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
+// msvc compiles intrinsics of every instruction set as is, gcc and clang have to be told per function
+#if defined(_MSC_VER) && !defined(__clang__)
+	#define PIXEL_CONVERT_TARGET_SSE41
+	#define PIXEL_CONVERT_TARGET_AVX2
+#else
+	#define PIXEL_CONVERT_TARGET_SSE41 __attribute__((target("sse4.1")))
+	#define PIXEL_CONVERT_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+#endif
+
+// pixels converted per step, the float values of one step stay in the cache between the stages
+#define PIXEL_CONVERT_BLOCK_PIXELS 256
+
+namespace mnemosy::graphics
+{
+	// bulk kernels of one instruction set
+	struct PixelKernels {
+		void (*linearToSrgb)(float* values, size_t count);
+		void (*srgbToLinear)(float* values, size_t count);
+		void (*halfToFloat)(const uint16_t* src, float* dst, size_t count);
+		void (*floatToHalf)(const float* src, uint16_t* dst, size_t count);
+		void (*u8ToFloat)(const uint8_t* src, float* dst, size_t count);
+		void (*u16ToFloat)(const uint16_t* src, float* dst, size_t count);
+		void (*floatToU8)(const float* src, uint8_t* dst, size_t count);
+		void (*floatToU16)(const float* src, uint16_t* dst, size_t count);
+		void (*swapBytes16)(uint16_t* values, size_t count);
+	};
+
+	// ===== Scalar =====
+
+	static inline float PixelConvert_AsFloat(const uint32_t bits) {
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	static inline uint32_t PixelConvert_AsBits(const float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	// clamps to 0-1, nan becomes 0 like it does with the simd min and max
+	static inline float PixelConvert_Saturate(const float value) {
+		return value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+	}
+
+	// For positive normal floats. The mantissa is moved into [sqrt(0.5), sqrt(2)) and its logarithm is taken from the series of 2 * atanh((m - 1) / (m + 1)).
+	static inline float PixelConvert_Log2_Scalar(const float x) {
+
+		uint32_t bits = PixelConvert_AsBits(x);
+		int32_t exponent = (int32_t)(bits >> 23) - 127;
+		float m = PixelConvert_AsFloat((bits & 0x007fffff) | 0x3f800000);
+
+		if (m > 1.41421356f) {
+			m *= 0.5f;
+			exponent += 1;
+		}
+
+		float t = (m - 1.0f) / (m + 1.0f);
+		float t2 = t * t;
+		float series = 1.0f + t2 * (1.0f / 3.0f + t2 * (1.0f / 5.0f + t2 * (1.0f / 7.0f + t2 * (1.0f / 9.0f))));
+
+		return (float)exponent + t * series * (2.0f * 1.44269504f);
+	}
+
+	// 2^y split into 2^n * e^(f * ln2) with f in [-0.5, 0.5], the exponential is a taylor polynomial of degree 7
+	static inline float PixelConvert_Exp2_Scalar(float y) {
+
+		y = std::min(std::max(y, -126.0f), 127.0f);
+
+		float n = (float)(int32_t)(y + (y >= 0.0f ? 0.5f : -0.5f));
+		float g = (y - n) * 0.693147181f;
+		float p = 1.0f + g * (1.0f + g * (1.0f / 2.0f + g * (1.0f / 6.0f + g * (1.0f / 24.0f + g * (1.0f / 120.0f + g * (1.0f / 720.0f + g * (1.0f / 5040.0f)))))));
+
+		return p * PixelConvert_AsFloat((uint32_t)((int32_t)n + 127) << 23);
+	}
+
+	static inline float PixelConvert_LinearToSrgb_Value(const float value) {
+
+		if (!(value > 0.0031308f)) {
+			return value * 12.92f;
+		}
+		return 1.055f * PixelConvert_Exp2_Scalar(PixelConvert_Log2_Scalar(value) * (1.0f / 2.4f)) - 0.055f;
+	}
+
+	static inline float PixelConvert_SrgbToLinear_Value(const float value) {
+
+		if (!(value > 0.04045f)) {
+			return value * (1.0f / 12.92f);
+		}
+		return PixelConvert_Exp2_Scalar(PixelConvert_Log2_Scalar((value + 0.055f) * (1.0f / 1.055f)) * 2.4f);
+	}
+
+	static void PixelConvert_LinearToSrgb_Scalar(float* values, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			values[i] = PixelConvert_LinearToSrgb_Value(values[i]);
+		}
+	}
+
+	static void PixelConvert_SrgbToLinear_Scalar(float* values, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			values[i] = PixelConvert_SrgbToLinear_Value(values[i]);
+		}
+	}
+
+	static void PixelConvert_HalfToFloat_Scalar(const uint16_t* src, float* dst, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			dst[i] = PixelConvert::HalfToFloat(src[i]);
+		}
+	}
+
+	static void PixelConvert_FloatToHalf_Scalar(const float* src, uint16_t* dst, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			dst[i] = PixelConvert::FloatToHalf(src[i]);
+		}
+	}
+
+	static void PixelConvert_U8ToFloat_Scalar(const uint8_t* src, float* dst, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			dst[i] = (float)src[i] * (1.0f / 255.0f);
+		}
+	}
+
+	static void PixelConvert_U16ToFloat_Scalar(const uint16_t* src, float* dst, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			dst[i] = (float)src[i] * (1.0f / 65535.0f);
+		}
+	}
+
+	static void PixelConvert_FloatToU8_Scalar(const float* src, uint8_t* dst, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			dst[i] = (uint8_t)(PixelConvert_Saturate(src[i]) * 255.0f + 0.5f);
+		}
+	}
+
+	static void PixelConvert_FloatToU16_Scalar(const float* src, uint16_t* dst, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			dst[i] = (uint16_t)(PixelConvert_Saturate(src[i]) * 65535.0f + 0.5f);
+		}
+	}
+
+	static void PixelConvert_SwapBytes16_Scalar(uint16_t* values, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			values[i] = (uint16_t)((values[i] << 8) | (values[i] >> 8));
+		}
+	}
+
+#ifdef PIXEL_CONVERT_USE_SIMD
+
+	// ===== SSE 4.1 =====
+	// same math as the scalar versions, 4 values at a time
+
+	PIXEL_CONVERT_TARGET_SSE41 static inline __m128 PixelConvert_Log2_Sse41(const __m128 x) {
+
+		const __m128 one = _mm_set1_ps(1.0f);
+
+		__m128i bits = _mm_castps_si128(x);
+		__m128i exponent = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+		__m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+
+		__m128 isLarge = _mm_cmpgt_ps(m, _mm_set1_ps(1.41421356f));
+		m = _mm_blendv_ps(m, _mm_mul_ps(m, _mm_set1_ps(0.5f)), isLarge);
+		exponent = _mm_sub_epi32(exponent, _mm_castps_si128(isLarge)); // the mask is -1 where the mantissa was halved
+
+		__m128 t = _mm_div_ps(_mm_sub_ps(m, one), _mm_add_ps(m, one));
+		__m128 t2 = _mm_mul_ps(t, t);
+
+		__m128 series = _mm_add_ps(_mm_set1_ps(1.0f / 7.0f), _mm_mul_ps(t2, _mm_set1_ps(1.0f / 9.0f)));
+		series = _mm_add_ps(_mm_set1_ps(1.0f / 5.0f), _mm_mul_ps(t2, series));
+		series = _mm_add_ps(_mm_set1_ps(1.0f / 3.0f), _mm_mul_ps(t2, series));
+		series = _mm_add_ps(one, _mm_mul_ps(t2, series));
+
+		return _mm_add_ps(_mm_cvtepi32_ps(exponent), _mm_mul_ps(_mm_mul_ps(t, series), _mm_set1_ps(2.0f * 1.44269504f)));
+	}
+
+	PIXEL_CONVERT_TARGET_SSE41 static inline __m128 PixelConvert_Exp2_Sse41(__m128 y) {
+
+		y = _mm_min_ps(_mm_max_ps(y, _mm_set1_ps(-126.0f)), _mm_set1_ps(127.0f));
+
+		__m128 n = _mm_round_ps(y, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		__m128 g = _mm_mul_ps(_mm_sub_ps(y, n), _mm_set1_ps(0.693147181f));
+
+		__m128 p = _mm_add_ps(_mm_set1_ps(1.0f / 720.0f), _mm_mul_ps(g, _mm_set1_ps(1.0f / 5040.0f)));
+		p = _mm_add_ps(_mm_set1_ps(1.0f / 120.0f), _mm_mul_ps(g, p));
+		p = _mm_add_ps(_mm_set1_ps(1.0f / 24.0f), _mm_mul_ps(g, p));
+		p = _mm_add_ps(_mm_set1_ps(1.0f / 6.0f), _mm_mul_ps(g, p));
+		p = _mm_add_ps(_mm_set1_ps(1.0f / 2.0f), _mm_mul_ps(g, p));
+		p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(g, p));
+		p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(g, p));
+
+		__m128i scale = _mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127)), 23);
+		return _mm_mul_ps(p, _mm_castsi128_ps(scale));
+	}
+
+	PIXEL_CONVERT_TARGET_SSE41 static void PixelConvert_LinearToSrgb_Sse41(float* values, size_t count) {
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+
+			__m128 x = _mm_loadu_ps(values + i);
+			__m128 lower = _mm_mul_ps(x, _mm_set1_ps(12.92f));
+			__m128 upper = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(1.055f), PixelConvert_Exp2_Sse41(_mm_mul_ps(PixelConvert_Log2_Sse41(x), _mm_set1_ps(1.0f / 2.4f)))), _mm_set1_ps(0.055f));
+
+			_mm_storeu_ps(values + i, _mm_blendv_ps(lower, upper, _mm_cmpgt_ps(x, _mm_set1_ps(0.0031308f))));
+		}
+
+		PixelConvert_LinearToSrgb_Scalar(values + i, count - i);
+	}
+
+	PIXEL_CONVERT_TARGET_SSE41 static void PixelConvert_SrgbToLinear_Sse41(float* values, size_t count) {
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+
+			__m128 x = _mm_loadu_ps(values + i);
+			__m128 lower = _mm_mul_ps(x, _mm_set1_ps(1.0f / 12.92f));
+			__m128 base = _mm_mul_ps(_mm_add_ps(x, _mm_set1_ps(0.055f)), _mm_set1_ps(1.0f / 1.055f));
+			__m128 upper = PixelConvert_Exp2_Sse41(_mm_mul_ps(PixelConvert_Log2_Sse41(base), _mm_set1_ps(2.4f)));
+
+			_mm_storeu_ps(values + i, _mm_blendv_ps(lower, upper, _mm_cmpgt_ps(x, _mm_set1_ps(0.04045f))));
+		}
+
+		PixelConvert_SrgbToLinear_Scalar(values + i, count - i);
+	}
+
+	PIXEL_CONVERT_TARGET_SSE41 static void PixelConvert_U8ToFloat_Sse41(const uint8_t* src, float* dst, size_t count) {
+
+		const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+
+			__m128i bytes = _mm_loadu_si128((const __m128i*)(src + i));
+
+			_mm_storeu_ps(dst + i + 0,  _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(bytes)), scale));
+			_mm_storeu_ps(dst + i + 4,  _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(bytes, 4))), scale));
+			_mm_storeu_ps(dst + i + 8,  _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(bytes, 8))), scale));
+			_mm_storeu_ps(dst + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(bytes, 12))), scale));
+		}
+
+		PixelConvert_U8ToFloat_Scalar(src + i, dst + i, count - i);
+	}
+
+	PIXEL_CONVERT_TARGET_SSE41 static void PixelConvert_U16ToFloat_Sse41(const uint16_t* src, float* dst, size_t count) {
+
+		const __m128 scale = _mm_set1_ps(1.0f / 65535.0f);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+
+			__m128i words = _mm_loadu_si128((const __m128i*)(src + i));
+
+			_mm_storeu_ps(dst + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu16_epi32(words)), scale));
+			_mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu16_epi32(_mm_srli_si128(words, 8))), scale));
+		}
+
+		PixelConvert_U16ToFloat_Scalar(src + i, dst + i, count - i);
+	}
+
+	// saturate, scale and round to nearest
+	PIXEL_CONVERT_TARGET_SSE41 static inline __m128i PixelConvert_ToUnorm_Sse41(const float* src, const __m128 scale) {
+		__m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+		return _mm_cvtps_epi32(_mm_mul_ps(v, scale));
+	}
+
+	PIXEL_CONVERT_TARGET_SSE41 static void PixelConvert_FloatToU8_Sse41(const float* src, uint8_t* dst, size_t count) {
+
+		const __m128 scale = _mm_set1_ps(255.0f);
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+
+			__m128i low = _mm_packus_epi32(PixelConvert_ToUnorm_Sse41(src + i, scale), PixelConvert_ToUnorm_Sse41(src + i + 4, scale));
+			__m128i high = _mm_packus_epi32(PixelConvert_ToUnorm_Sse41(src + i + 8, scale), PixelConvert_ToUnorm_Sse41(src + i + 12, scale));
+			_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(low, high));
+		}
+
+		PixelConvert_FloatToU8_Scalar(src + i, dst + i, count - i);
+	}
+
+	PIXEL_CONVERT_TARGET_SSE41 static void PixelConvert_FloatToU16_Sse41(const float* src, uint16_t* dst, size_t count) {
+
+		const __m128 scale = _mm_set1_ps(65535.0f);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m128i words = _mm_packus_epi32(PixelConvert_ToUnorm_Sse41(src + i, scale), PixelConvert_ToUnorm_Sse41(src + i + 4, scale));
+			_mm_storeu_si128((__m128i*)(dst + i), words);
+		}
+
+		PixelConvert_FloatToU16_Scalar(src + i, dst + i, count - i);
+	}
+
+	PIXEL_CONVERT_TARGET_SSE41 static void PixelConvert_SwapBytes16_Sse41(uint16_t* values, size_t count) {
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m128i words = _mm_loadu_si128((const __m128i*)(values + i));
+			_mm_storeu_si128((__m128i*)(values + i), _mm_or_si128(_mm_slli_epi16(words, 8), _mm_srli_epi16(words, 8)));
+		}
+
+		PixelConvert_SwapBytes16_Scalar(values + i, count - i);
+	}
+
+	// ===== AVX2 =====
+	// 8 values at a time, polynomials use fma and half floats are converted by f16c
+
+	PIXEL_CONVERT_TARGET_AVX2 static inline __m256 PixelConvert_Log2_Avx2(const __m256 x) {
+
+		const __m256 one = _mm256_set1_ps(1.0f);
+
+		__m256i bits = _mm256_castps_si256(x);
+		__m256i exponent = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127));
+		__m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000)));
+
+		__m256 isLarge = _mm256_cmp_ps(m, _mm256_set1_ps(1.41421356f), _CMP_GT_OQ);
+		m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), isLarge);
+		exponent = _mm256_sub_epi32(exponent, _mm256_castps_si256(isLarge));
+
+		__m256 t = _mm256_div_ps(_mm256_sub_ps(m, one), _mm256_add_ps(m, one));
+		__m256 t2 = _mm256_mul_ps(t, t);
+
+		__m256 series = _mm256_fmadd_ps(t2, _mm256_set1_ps(1.0f / 9.0f), _mm256_set1_ps(1.0f / 7.0f));
+		series = _mm256_fmadd_ps(t2, series, _mm256_set1_ps(1.0f / 5.0f));
+		series = _mm256_fmadd_ps(t2, series, _mm256_set1_ps(1.0f / 3.0f));
+		series = _mm256_fmadd_ps(t2, series, one);
+
+		return _mm256_fmadd_ps(_mm256_mul_ps(t, series), _mm256_set1_ps(2.0f * 1.44269504f), _mm256_cvtepi32_ps(exponent));
+	}
+
+	PIXEL_CONVERT_TARGET_AVX2 static inline __m256 PixelConvert_Exp2_Avx2(__m256 y) {
+
+		y = _mm256_min_ps(_mm256_max_ps(y, _mm256_set1_ps(-126.0f)), _mm256_set1_ps(127.0f));
+
+		__m256 n = _mm256_round_ps(y, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		__m256 g = _mm256_mul_ps(_mm256_sub_ps(y, n), _mm256_set1_ps(0.693147181f));
+
+		__m256 p = _mm256_fmadd_ps(g, _mm256_set1_ps(1.0f / 5040.0f), _mm256_set1_ps(1.0f / 720.0f));
+		p = _mm256_fmadd_ps(g, p, _mm256_set1_ps(1.0f / 120.0f));
+		p = _mm256_fmadd_ps(g, p, _mm256_set1_ps(1.0f / 24.0f));
+		p = _mm256_fmadd_ps(g, p, _mm256_set1_ps(1.0f / 6.0f));
+		p = _mm256_fmadd_ps(g, p, _mm256_set1_ps(1.0f / 2.0f));
+		p = _mm256_fmadd_ps(g, p, _mm256_set1_ps(1.0f));
+		p = _mm256_fmadd_ps(g, p, _mm256_set1_ps(1.0f));
+
+		__m256i scale = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+		return _mm256_mul_ps(p, _mm256_castsi256_ps(scale));
+	}
+
+	PIXEL_CONVERT_TARGET_AVX2 static void PixelConvert_LinearToSrgb_Avx2(float* values, size_t count) {
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+
+			__m256 x = _mm256_loadu_ps(values + i);
+			__m256 lower = _mm256_mul_ps(x, _mm256_set1_ps(12.92f));
+			__m256 upper = _mm256_fmsub_ps(_mm256_set1_ps(1.055f), PixelConvert_Exp2_Avx2(_mm256_mul_ps(PixelConvert_Log2_Avx2(x), _mm256_set1_ps(1.0f / 2.4f))), _mm256_set1_ps(0.055f));
+
+			_mm256_storeu_ps(values + i, _mm256_blendv_ps(lower, upper, _mm256_cmp_ps(x, _mm256_set1_ps(0.0031308f), _CMP_GT_OQ)));
+		}
+
+		PixelConvert_LinearToSrgb_Scalar(values + i, count - i);
+	}
+
+	PIXEL_CONVERT_TARGET_AVX2 static void PixelConvert_SrgbToLinear_Avx2(float* values, size_t count) {
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+
+			__m256 x = _mm256_loadu_ps(values + i);
+			__m256 lower = _mm256_mul_ps(x, _mm256_set1_ps(1.0f / 12.92f));
+			__m256 base = _mm256_mul_ps(_mm256_add_ps(x, _mm256_set1_ps(0.055f)), _mm256_set1_ps(1.0f / 1.055f));
+			__m256 upper = PixelConvert_Exp2_Avx2(_mm256_mul_ps(PixelConvert_Log2_Avx2(base), _mm256_set1_ps(2.4f)));
+
+			_mm256_storeu_ps(values + i, _mm256_blendv_ps(lower, upper, _mm256_cmp_ps(x, _mm256_set1_ps(0.04045f), _CMP_GT_OQ)));
+		}
+
+		PixelConvert_SrgbToLinear_Scalar(values + i, count - i);
+	}
+
+	PIXEL_CONVERT_TARGET_AVX2 static void PixelConvert_HalfToFloat_Avx2(const uint16_t* src, float* dst, size_t count) {
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i))));
+		}
+
+		PixelConvert_HalfToFloat_Scalar(src + i, dst + i, count - i);
+	}
+
+	PIXEL_CONVERT_TARGET_AVX2 static void PixelConvert_FloatToHalf_Avx2(const float* src, uint16_t* dst, size_t count) {
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			_mm_storeu_si128((__m128i*)(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+		}
+
+		PixelConvert_FloatToHalf_Scalar(src + i, dst + i, count - i);
+	}
+
+	PIXEL_CONVERT_TARGET_AVX2 static void PixelConvert_U8ToFloat_Avx2(const uint8_t* src, float* dst, size_t count) {
+
+		const __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256i ints = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + i)));
+			_mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(ints), scale));
+		}
+
+		PixelConvert_U8ToFloat_Scalar(src + i, dst + i, count - i);
+	}
+
+	PIXEL_CONVERT_TARGET_AVX2 static void PixelConvert_U16ToFloat_Avx2(const uint16_t* src, float* dst, size_t count) {
+
+		const __m256 scale = _mm256_set1_ps(1.0f / 65535.0f);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256i ints = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src + i)));
+			_mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(ints), scale));
+		}
+
+		PixelConvert_U16ToFloat_Scalar(src + i, dst + i, count - i);
+	}
+
+	PIXEL_CONVERT_TARGET_AVX2 static inline __m256i PixelConvert_ToUnorm_Avx2(const float* src, const __m256 scale) {
+		__m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src), _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+		return _mm256_cvtps_epi32(_mm256_mul_ps(v, scale));
+	}
+
+	PIXEL_CONVERT_TARGET_AVX2 static void PixelConvert_FloatToU8_Avx2(const float* src, uint8_t* dst, size_t count) {
+
+		const __m256 scale = _mm256_set1_ps(255.0f);
+
+		size_t i = 0;
+		for (; i + 32 <= count; i += 32) {
+
+			// the packs work per 128 bit lane, the permute puts the 4 byte groups back in order
+			__m256i ab = _mm256_packus_epi32(PixelConvert_ToUnorm_Avx2(src + i, scale), PixelConvert_ToUnorm_Avx2(src + i + 8, scale));
+			__m256i cd = _mm256_packus_epi32(PixelConvert_ToUnorm_Avx2(src + i + 16, scale), PixelConvert_ToUnorm_Avx2(src + i + 24, scale));
+			__m256i bytes = _mm256_packus_epi16(ab, cd);
+
+			_mm256_storeu_si256((__m256i*)(dst + i), _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)));
+		}
+
+		PixelConvert_FloatToU8_Sse41(src + i, dst + i, count - i);
+	}
+
+	PIXEL_CONVERT_TARGET_AVX2 static void PixelConvert_FloatToU16_Avx2(const float* src, uint16_t* dst, size_t count) {
+
+		const __m256 scale = _mm256_set1_ps(65535.0f);
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			__m256i words = _mm256_packus_epi32(PixelConvert_ToUnorm_Avx2(src + i, scale), PixelConvert_ToUnorm_Avx2(src + i + 8, scale));
+			_mm256_storeu_si256((__m256i*)(dst + i), _mm256_permute4x64_epi64(words, _MM_SHUFFLE(3, 1, 2, 0)));
+		}
+
+		PixelConvert_FloatToU16_Sse41(src + i, dst + i, count - i);
+	}
+
+	PIXEL_CONVERT_TARGET_AVX2 static void PixelConvert_SwapBytes16_Avx2(uint16_t* values, size_t count) {
+
+		size_t i = 0;
+		for (; i + 16 <= count; i += 16) {
+			__m256i words = _mm256_loadu_si256((const __m256i*)(values + i));
+			_mm256_storeu_si256((__m256i*)(values + i), _mm256_or_si256(_mm256_slli_epi16(words, 8), _mm256_srli_epi16(words, 8)));
+		}
+
+		PixelConvert_SwapBytes16_Scalar(values + i, count - i);
+	}
+
+	static void PixelConvert_Cpuid(const uint32_t leaf, const uint32_t subLeaf, uint32_t outRegisters[4]) {
+
+#if defined(_MSC_VER)
+		int registers[4];
+		__cpuidex(registers, (int)leaf, (int)subLeaf);
+		for (int i = 0; i < 4; i++) {
+			outRegisters[i] = (uint32_t)registers[i];
+		}
+#else
+		__cpuid_count(leaf, subLeaf, outRegisters[0], outRegisters[1], outRegisters[2], outRegisters[3]);
+#endif
+	}
+
+	// true if the os saves the ymm registers on context switches
+	static bool PixelConvert_OsSupportsAvx() {
+
+#if defined(_MSC_VER)
+		return (_xgetbv(0) & 0x6) == 0x6;
+#else
+		uint32_t eax, edx;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return (eax & 0x6) == 0x6;
+#endif
+	}
+
+#endif // PIXEL_CONVERT_USE_SIMD
+
+	static PixelSimdLevel PixelConvert_DetectSimdLevel() {
+
+#ifdef PIXEL_CONVERT_USE_SIMD
+		uint32_t registers[4];
+
+		PixelConvert_Cpuid(0, 0, registers);
+		uint32_t maxLeaf = registers[0];
+		if (maxLeaf < 1)
+			return MNSY_SIMD_SCALAR;
+
+		PixelConvert_Cpuid(1, 0, registers);
+		bool sse41		= (registers[2] & (1u << 19)) != 0;
+		bool fma		= (registers[2] & (1u << 12)) != 0;
+		bool osxsave	= (registers[2] & (1u << 27)) != 0;
+		bool avx		= (registers[2] & (1u << 28)) != 0;
+		bool f16c		= (registers[2] & (1u << 29)) != 0;
+
+		bool avx2 = false;
+		if (maxLeaf >= 7) {
+			PixelConvert_Cpuid(7, 0, registers);
+			avx2 = (registers[1] & (1u << 5)) != 0;
+		}
+
+		if (osxsave && avx && avx2 && fma && f16c && PixelConvert_OsSupportsAvx())
+			return MNSY_SIMD_AVX2;
+
+		if (sse41)
+			return MNSY_SIMD_SSE41;
+#endif // PIXEL_CONVERT_USE_SIMD
+
+		return MNSY_SIMD_SCALAR;
+	}
+
+	static PixelKernels PixelConvert_SelectKernels(const PixelSimdLevel level) {
+
+		PixelKernels kernels;
+		kernels.linearToSrgb	= PixelConvert_LinearToSrgb_Scalar;
+		kernels.srgbToLinear	= PixelConvert_SrgbToLinear_Scalar;
+		kernels.halfToFloat		= PixelConvert_HalfToFloat_Scalar;
+		kernels.floatToHalf		= PixelConvert_FloatToHalf_Scalar;
+		kernels.u8ToFloat		= PixelConvert_U8ToFloat_Scalar;
+		kernels.u16ToFloat		= PixelConvert_U16ToFloat_Scalar;
+		kernels.floatToU8		= PixelConvert_FloatToU8_Scalar;
+		kernels.floatToU16		= PixelConvert_FloatToU16_Scalar;
+		kernels.swapBytes16		= PixelConvert_SwapBytes16_Scalar;
+
+#ifdef PIXEL_CONVERT_USE_SIMD
+		if (level >= MNSY_SIMD_SSE41) {
+			kernels.linearToSrgb	= PixelConvert_LinearToSrgb_Sse41;
+			kernels.srgbToLinear	= PixelConvert_SrgbToLinear_Sse41;
+			kernels.u8ToFloat		= PixelConvert_U8ToFloat_Sse41;
+			kernels.u16ToFloat		= PixelConvert_U16ToFloat_Sse41;
+			kernels.floatToU8		= PixelConvert_FloatToU8_Sse41;
+			kernels.floatToU16		= PixelConvert_FloatToU16_Sse41;
+			kernels.swapBytes16		= PixelConvert_SwapBytes16_Sse41;
+		}
+
+		if (level >= MNSY_SIMD_AVX2) {
+			kernels.linearToSrgb	= PixelConvert_LinearToSrgb_Avx2;
+			kernels.srgbToLinear	= PixelConvert_SrgbToLinear_Avx2;
+			kernels.halfToFloat		= PixelConvert_HalfToFloat_Avx2;
+			kernels.floatToHalf		= PixelConvert_FloatToHalf_Avx2;
+			kernels.u8ToFloat		= PixelConvert_U8ToFloat_Avx2;
+			kernels.u16ToFloat		= PixelConvert_U16ToFloat_Avx2;
+			kernels.floatToU8		= PixelConvert_FloatToU8_Avx2;
+			kernels.floatToU16		= PixelConvert_FloatToU16_Avx2;
+			kernels.swapBytes16		= PixelConvert_SwapBytes16_Avx2;
+		}
+#endif // PIXEL_CONVERT_USE_SIMD
+
+		return kernels;
+	}
+
+	// detected on first use, static initialization is thread safe
+	static const PixelKernels& PixelConvert_GetKernels() {
+
+		static const PixelKernels kernels = PixelConvert_SelectKernels(PixelConvert::GetSimdLevel());
+		return kernels;
+	}
+
+	// ===== Format conversion =====
+
+	// 16 bit half float sample, a type of its own so kernels can tell it apart from 16 bit unsigned normalized
+	struct PixelHalf {
+		uint16_t bits;
+	};
+
+	template<typename T> struct PixelSample;
+
+	template<> struct PixelSample<uint8_t> {
+		static constexpr uint8_t one = 255;
+		static void ToFloat(const PixelKernels& kernels, const uint8_t* src, float* dst, size_t count)	{ kernels.u8ToFloat(src, dst, count); }
+		static void FromFloat(const PixelKernels& kernels, const float* src, uint8_t* dst, size_t count)	{ kernels.floatToU8(src, dst, count); }
+	};
+
+	template<> struct PixelSample<uint16_t> {
+		static constexpr uint16_t one = 65535;
+		static void ToFloat(const PixelKernels& kernels, const uint16_t* src, float* dst, size_t count)	{ kernels.u16ToFloat(src, dst, count); }
+		static void FromFloat(const PixelKernels& kernels, const float* src, uint16_t* dst, size_t count)	{ kernels.floatToU16(src, dst, count); }
+	};
+
+	template<> struct PixelSample<PixelHalf> {
+		static constexpr PixelHalf one = { 0x3c00 };
+		static void ToFloat(const PixelKernels& kernels, const PixelHalf* src, float* dst, size_t count)	{ kernels.halfToFloat((const uint16_t*)src, dst, count); }
+		static void FromFloat(const PixelKernels& kernels, const float* src, PixelHalf* dst, size_t count)	{ kernels.floatToHalf(src, (uint16_t*)dst, count); }
+	};
+
+	template<> struct PixelSample<float> {
+		static constexpr float one = 1.0f;
+		// memmove because src and dst may be the same buffer
+		static void ToFloat(const PixelKernels& /*kernels*/, const float* src, float* dst, size_t count)		{ memmove(dst, src, count * sizeof(float)); }
+		static void FromFloat(const PixelKernels& /*kernels*/, const float* src, float* dst, size_t count)	{ memmove(dst, src, count * sizeof(float)); }
+	};
+
+	// source channel of each destination channel. -1 means alpha of 1, -2 means 0.
+	static void PixelConvert_ChannelMap(const uint8_t srcChannels, const uint8_t dstChannels, int8_t outMap[4]) {
+
+		for (uint8_t c = 0; c < dstChannels; c++) {
+
+			if (c == 3) {
+				outMap[c] = srcChannels == 4 ? 3 : -1;
+			}
+			else if (srcChannels == 1) {
+				outMap[c] = 0; // gray is copied into every color channel
+			}
+			else {
+				outMap[c] = c < srcChannels ? (int8_t)c : -2;
+			}
+		}
+	}
+
+	template<typename T>
+	static void PixelConvert_Remap(const T* src, const uint8_t srcChannels, T* dst, const uint8_t dstChannels, const int8_t map[4], const size_t pixelCount) {
+
+		T zero;
+		memset(&zero, 0, sizeof(T));
+
+		for (size_t p = 0; p < pixelCount; p++) {
+
+			const T* s = src + p * srcChannels;
+			T* d = dst + p * dstChannels;
+
+			for (uint8_t c = 0; c < dstChannels; c++) {
+				d[c] = map[c] >= 0 ? s[map[c]] : (map[c] == -1 ? PixelSample<T>::one : zero);
+			}
+		}
+	}
+
+	template<PixelColorOp Op>
+	static void PixelConvert_ApplyColorOp(const PixelKernels& kernels, float* values, const uint8_t channels, const size_t pixelCount) {
+
+		void (*transfer)(float*, size_t) = Op == MNSY_COLOR_OP_LINEAR_TO_SRGB ? kernels.linearToSrgb : kernels.srgbToLinear;
+
+		if (channels != 4) {
+			transfer(values, pixelCount * channels);
+			return;
+		}
+
+		// alpha is not a color, it is put back after converting everything at once
+		float alpha[PIXEL_CONVERT_BLOCK_PIXELS];
+		for (size_t p = 0; p < pixelCount; p++) {
+			alpha[p] = values[p * 4 + 3];
+		}
+
+		transfer(values, pixelCount * 4);
+
+		for (size_t p = 0; p < pixelCount; p++) {
+			values[p * 4 + 3] = alpha[p];
+		}
+	}
+
+	template<typename S, typename D, PixelColorOp Op>
+	static void PixelConvert_Kernel(const PixelKernels& kernels, const void* src, const uint8_t srcChannels, void* dst, const uint8_t dstChannels, const size_t pixelCount) {
+
+		int8_t map[4] = {};
+		PixelConvert_ChannelMap(srcChannels, dstChannels, map);
+
+		if constexpr (std::is_same_v<S, D> && Op == MNSY_COLOR_OP_NONE) {
+
+			// samples keep their type, nothing to compute
+			if (srcChannels == dstChannels) {
+				memmove(dst, src, pixelCount * srcChannels * sizeof(S));
+			}
+			else {
+				PixelConvert_Remap<S>((const S*)src, srcChannels, (D*)dst, dstChannels, map, pixelCount);
+			}
+		}
+		else {
+
+			float srcValues[PIXEL_CONVERT_BLOCK_PIXELS * 4];
+			float dstValues[PIXEL_CONVERT_BLOCK_PIXELS * 4];
+
+			for (size_t first = 0; first < pixelCount; first += PIXEL_CONVERT_BLOCK_PIXELS) {
+
+				size_t count = std::min((size_t)PIXEL_CONVERT_BLOCK_PIXELS, pixelCount - first);
+
+				PixelSample<S>::ToFloat(kernels, (const S*)src + first * srcChannels, srcValues, count * srcChannels);
+
+				float* values = srcValues;
+				if (srcChannels != dstChannels) {
+					PixelConvert_Remap<float>(srcValues, srcChannels, dstValues, dstChannels, map, count);
+					values = dstValues;
+				}
+
+				if constexpr (Op != MNSY_COLOR_OP_NONE) {
+					PixelConvert_ApplyColorOp<Op>(kernels, values, dstChannels, count);
+				}
+
+				PixelSample<D>::FromFloat(kernels, values, (D*)dst + first * dstChannels, count * dstChannels);
+			}
+		}
+	}
+
+	using PixelConvertKernelFn = void(*)(const PixelKernels&, const void*, const uint8_t, void*, const uint8_t, const size_t);
+
+	template<typename S, typename D>
+	static PixelConvertKernelFn PixelConvert_GetKernel(const PixelColorOp colorOp) {
+
+		switch (colorOp)
+		{
+		case MNSY_COLOR_OP_LINEAR_TO_SRGB:	return PixelConvert_Kernel<S, D, MNSY_COLOR_OP_LINEAR_TO_SRGB>;
+		case MNSY_COLOR_OP_SRGB_TO_LINEAR:	return PixelConvert_Kernel<S, D, MNSY_COLOR_OP_SRGB_TO_LINEAR>;
+		default:							return PixelConvert_Kernel<S, D, MNSY_COLOR_OP_NONE>;
+		}
+	}
+
+	// sample types: 0 = 8 bit, 1 = 16 bit unsigned normalized, 2 = 16 bit half float, 3 = 32 bit float
+	template<typename S>
+	static PixelConvertKernelFn PixelConvert_GetKernel(const int dstType, const PixelColorOp colorOp) {
+
+		switch (dstType)
+		{
+		case 0:		return PixelConvert_GetKernel<S, uint8_t>(colorOp);
+		case 1:		return PixelConvert_GetKernel<S, uint16_t>(colorOp);
+		case 2:		return PixelConvert_GetKernel<S, PixelHalf>(colorOp);
+		default:	return PixelConvert_GetKernel<S, float>(colorOp);
+		}
+	}
+
+	static PixelConvertKernelFn PixelConvert_GetKernel(const int srcType, const int dstType, const PixelColorOp colorOp) {
+
+		switch (srcType)
+		{
+		case 0:		return PixelConvert_GetKernel<uint8_t>(dstType, colorOp);
+		case 1:		return PixelConvert_GetKernel<uint16_t>(dstType, colorOp);
+		case 2:		return PixelConvert_GetKernel<PixelHalf>(dstType, colorOp);
+		default:	return PixelConvert_GetKernel<float>(dstType, colorOp);
+		}
+	}
+
+	static int PixelConvert_GetSampleType(const uint8_t bitsPerChannel, const bool isHalfFloat) {
+
+		if (bitsPerChannel == 8)
+			return 0;
+		if (bitsPerChannel == 16)
+			return isHalfFloat ? 2 : 1;
+		return 3;
+	}
+
+	// public
+
+	void PixelConvert::Convert(const void* src, const TextureFormat srcFormat, const bool srcIsHalfFloat, void* dst, const TextureFormat dstFormat, const bool dstIsHalfFloat, const size_t pixelCount, const PixelColorOp colorOp) {
+
+		uint8_t srcChannels, srcBits, srcBytesPerPixel;
+		uint8_t dstChannels, dstBits, dstBytesPerPixel;
+		TexUtil::get_information_from_textureFormat(srcFormat, srcChannels, srcBits, srcBytesPerPixel);
+		TexUtil::get_information_from_textureFormat(dstFormat, dstChannels, dstBits, dstBytesPerPixel);
+
+		if (srcChannels == 0 || dstChannels == 0 || pixelCount == 0)
+			return;
+
+		PixelConvertKernelFn kernel = PixelConvert_GetKernel(PixelConvert_GetSampleType(srcBits, srcIsHalfFloat), PixelConvert_GetSampleType(dstBits, dstIsHalfFloat), colorOp);
+		kernel(PixelConvert_GetKernels(), src, srcChannels, dst, dstChannels, pixelCount);
+	}
+
+	void PixelConvert::LinearToSrgb(float* values, const size_t count) {
+		PixelConvert_GetKernels().linearToSrgb(values, count);
+	}
+
+	void PixelConvert::SrgbToLinear(float* values, const size_t count) {
+		PixelConvert_GetKernels().srgbToLinear(values, count);
+	}
+
+	void PixelConvert::HalfToFloat(const uint16_t* src, float* dst, const size_t count) {
+		PixelConvert_GetKernels().halfToFloat(src, dst, count);
+	}
+
+	void PixelConvert::FloatToHalf(const float* src, uint16_t* dst, const size_t count) {
+		PixelConvert_GetKernels().floatToHalf(src, dst, count);
+	}
+
+	void PixelConvert::SwapBytes16(uint16_t* values, const size_t count) {
+		PixelConvert_GetKernels().swapBytes16(values, count);
+	}
+
+	float PixelConvert::LinearToSrgb(const float value) {
+		return PixelConvert_LinearToSrgb_Value(value);
+	}
+
+	float PixelConvert::SrgbToLinear(const float value) {
+		return PixelConvert_SrgbToLinear_Value(value);
+	}
+
+	float PixelConvert::HalfToFloat(const uint16_t value) {
+
+		uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+		uint32_t exponent = (value >> 10) & 0x1f;
+		uint32_t mantissa = value & 0x3ff;
+
+		if (exponent == 0) {
+
+			if (mantissa == 0)
+				return PixelConvert_AsFloat(sign);
+
+			// subnormal half, normalize it because it is a regular float
+			exponent = 113;
+			while ((mantissa & 0x400) == 0) {
+				mantissa <<= 1;
+				exponent--;
+			}
+			return PixelConvert_AsFloat(sign | (exponent << 23) | ((mantissa & 0x3ff) << 13));
+		}
+
+		if (exponent == 31) {
+			return PixelConvert_AsFloat(sign | 0x7f800000 | (mantissa << 13)); // inf and nan
+		}
+
+		return PixelConvert_AsFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+	}
+
+	uint16_t PixelConvert::FloatToHalf(const float value) {
+
+		uint32_t bits = PixelConvert_AsBits(value);
+		uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+		uint32_t absBits = bits & 0x7fffffff;
+
+		// inf and nan
+		if (absBits >= 0x7f800000)
+			return sign | 0x7c00 | (absBits > 0x7f800000 ? 0x200 : 0);
+
+		// 65520 and above round to inf
+		if (absBits >= 0x477ff000)
+			return sign | 0x7c00;
+
+		// below the smallest normal half the result is subnormal, values below 2^-25 round to 0
+		if (absBits < 0x38800000) {
+
+			if (absBits <= 0x33000000)
+				return sign;
+
+			uint32_t mantissa = (absBits & 0x007fffff) | 0x00800000;
+			uint32_t shift = 126 - (absBits >> 23);
+			uint32_t result = mantissa >> shift;
+			uint32_t remainder = mantissa & ((1u << shift) - 1);
+			uint32_t halfway = 1u << (shift - 1);
+
+			if (remainder > halfway || (remainder == halfway && (result & 1)))
+				result++;
+
+			return sign | (uint16_t)result;
+		}
+
+		// rebias the exponent from 127 to 15 and round the mantissa to nearest even
+		uint32_t result = (absBits - 0x38000000) >> 13;
+		uint32_t remainder = absBits & 0x1fff;
+
+		if (remainder > 0x1000 || (remainder == 0x1000 && (result & 1)))
+			result++;
+
+		return sign | (uint16_t)result;
+	}
+
+	PixelSimdLevel PixelConvert::GetSimdLevel() {
+
+		static const PixelSimdLevel level = PixelConvert_DetectSimdLevel();
+		return level;
+	}
+
+} // ! namespace mnemosy::graphics
@@ -0,0 +1,192 @@
+#include "Include/Graphics/Utils/ShaderBinaryCache.h"
+
+#include "Include/MnemosyEngine.h"
+#include "Include/Core/Log.h"
+#include "Include/Core/FileDirectories.h"
+
+#include <glad/glad.h>
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <string.h>
+#include <stdio.h>
+
+// bump the version whenever the layout of the file changes, files with another version are ignored and overwritten
+#define SHADER_BINARY_CACHE_MAGIC "MNSYSHB1"
+#define SHADER_BINARY_CACHE_VERSION 1
+
+namespace mnemosy::graphics {
+
+	struct ShaderBinaryCacheHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t binaryFormat;
+		uint64_t key;
+		uint64_t binarySize;
+	};
+
+	static_assert(sizeof(ShaderBinaryCacheHeader) == 32, "Shader binary cache header layout changed");
+
+	// 64 bit FNV-1a
+	static uint64_t ShaderBinaryCache_Hash(uint64_t hash, const void* data, const size_t size) {
+
+		const uint8_t* bytes = (const uint8_t*)data;
+		for (size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	static uint64_t ShaderBinaryCache_HashString(const uint64_t hash, const char* string) {
+
+		// a separator so "ab" + "c" and "a" + "bc" hash differently
+		uint64_t result = string ? ShaderBinaryCache_Hash(hash, string, strlen(string)) : hash;
+		return ShaderBinaryCache_Hash(result, "\0", 1);
+	}
+
+	// without any binary format the driver can not give us binaries at all
+	static bool ShaderBinaryCache_IsSupported() {
+
+		static int formatCount = -1;
+		if (formatCount < 0) {
+			formatCount = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+		}
+		return formatCount > 0;
+	}
+
+	static std::filesystem::path ShaderBinaryCache_GetPath(const uint64_t key) {
+
+		char filename[32];
+		snprintf(filename, sizeof(filename), "%016llx.mnsyshader", (unsigned long long)key);
+
+		return MnemosyEngine::GetInstance().GetFileDirectories().GetDataPath() / std::filesystem::path("ShaderCache") / std::filesystem::path(filename);
+	}
+
+	uint64_t ShaderBinaryCache::MakeKey(const unsigned int stage, const std::string& firstStageSource, const std::string& fragmentSource) {
+
+		uint64_t hash = 14695981039346656037ull;
+
+		hash = ShaderBinaryCache_HashString(hash, (const char*)glGetString(GL_VENDOR));
+		hash = ShaderBinaryCache_HashString(hash, (const char*)glGetString(GL_RENDERER));
+		hash = ShaderBinaryCache_HashString(hash, (const char*)glGetString(GL_VERSION));
+
+		uint32_t stageValue = stage;
+		hash = ShaderBinaryCache_Hash(hash, &stageValue, sizeof(stageValue));
+		hash = ShaderBinaryCache_HashString(hash, firstStageSource.c_str());
+		hash = ShaderBinaryCache_HashString(hash, fragmentSource.c_str());
+
+		return hash;
+	}
+
+	bool ShaderBinaryCache::Load(const unsigned int program, const uint64_t key) {
+
+		if (!ShaderBinaryCache_IsSupported())
+			return false;
+
+		std::filesystem::path path = ShaderBinaryCache_GetPath(key);
+
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			return false;
+
+		ShaderBinaryCacheHeader header;
+		file.read((char*)&header, sizeof(header));
+
+		bool valid = file && memcmp(header.magic, SHADER_BINARY_CACHE_MAGIC, sizeof(header.magic)) == 0 && header.version == SHADER_BINARY_CACHE_VERSION && header.key == key && header.binarySize != 0;
+
+		std::vector<uint8_t> binary;
+		if (valid) {
+			binary.resize((size_t)header.binarySize);
+			file.read((char*)binary.data(), binary.size());
+			valid = (bool)file;
+		}
+		file.close();
+
+		if (valid) {
+
+			glProgramBinary(program, (GLenum)header.binaryFormat, binary.data(), (GLsizei)binary.size());
+
+			int linked = 0;
+			glGetProgramiv(program, GL_LINK_STATUS, &linked);
+			valid = linked != 0;
+		}
+
+		if (!valid) {
+			// most likely written by an older driver, it is replaced once the program is compiled again
+			MNEMOSY_DEBUG("ShaderBinaryCache::Load: Cached shader binary is unusable, compiling from source. \nPath: {}", path.generic_string());
+			std::error_code ec;
+			std::filesystem::remove(path, ec);
+		}
+
+		return valid;
+	}
+
+	void ShaderBinaryCache::PrepareForStore(const unsigned int program) {
+
+		if (ShaderBinaryCache_IsSupported()) {
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+	}
+
+	void ShaderBinaryCache::Store(const unsigned int program, const uint64_t key) {
+
+		namespace fs = std::filesystem;
+
+		if (!ShaderBinaryCache_IsSupported())
+			return;
+
+		int binarySize = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+		if (binarySize <= 0)
+			return;
+
+		std::vector<uint8_t> binary((size_t)binarySize);
+		GLenum binaryFormat = 0;
+		GLsizei writtenSize = 0;
+		glGetProgramBinary(program, binarySize, &writtenSize, &binaryFormat, binary.data());
+		if (writtenSize <= 0)
+			return;
+
+		ShaderBinaryCacheHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, SHADER_BINARY_CACHE_MAGIC, sizeof(header.magic));
+		header.version = SHADER_BINARY_CACHE_VERSION;
+		header.binaryFormat = (uint32_t)binaryFormat;
+		header.key = key;
+		header.binarySize = (uint64_t)writtenSize;
+
+		fs::path path = ShaderBinaryCache_GetPath(key);
+		fs::path tmpPath = path;
+		tmpPath += ".tmp";
+
+		std::error_code ec;
+		fs::create_directories(path.parent_path(), ec);
+
+		{
+			std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+			file.write((const char*)&header, sizeof(header));
+			file.write((const char*)binary.data(), writtenSize);
+			if (!file) {
+				MNEMOSY_WARN("ShaderBinaryCache::Store: Failed to write shader binary \nPath: {}", tmpPath.generic_string());
+				file.close();
+				fs::remove(tmpPath, ec);
+				return;
+			}
+		}
+
+		fs::rename(tmpPath, path, ec);
+		if (ec) {
+			fs::remove(tmpPath, ec);
+		}
+	}
+
+	void ShaderBinaryCache::Remove(const uint64_t key) {
+
+		std::error_code ec;
+		std::filesystem::remove(ShaderBinaryCache_GetPath(key), ec);
+	}
+
+} // !mnemosy::graphics
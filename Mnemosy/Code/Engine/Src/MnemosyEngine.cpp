@@ -8,6 +8,7 @@
 #include "Include/Core/Clock.h"
 #include "Include/Core/FileDirectories.h"
 #include "Include/Core/Utils/DropHandler_Windows.h"
+#include "Include/Core/JobSystem.h"
 
 #include "Include/Systems/Input/InputSystem.h"
 #include "Include/Systems/SkyboxAssetRegistry.h"
@@ -26,10 +27,13 @@
 #include "Include/Graphics/Light.h"
 #include "Include/Graphics/Scene.h"
 #include "Include/Graphics/ThumbnailScene.h"
+#include "Include/Graphics/TextureUploader.h"
+#include "Include/Graphics/Utils/Picture.h"
 
 #include "Include/Gui/UserInterface.h"
 
 #include <GLFW/glfw3.h>
+#include <thread>
 
 namespace mnemosy
 {
@@ -50,7 +54,7 @@ namespace mnemosy
 		return *m_sInstance;
 	}
 
-	void MnemosyEngine::Initialize(const char* WindowTitle) {
+	void MnemosyEngine::Initialize(const char* WindowTitle, const bool hiddenWindow) {
 		
 
 		flcrm_log_assert(!m_isInitialized, "Engine is already initialized");
@@ -61,7 +65,7 @@ namespace mnemosy
 		MNEMOSY_INFO("Starting Mnemosy v{}.{}-{}", MNEMOSY_VERSION_MAJOR, MNEMOSY_VERSION_MINOR,MNEMOSY_VERSION_SUFFIX);
 
 
-		m_arena_persistent.arena_init_allocate_buffer(1648); //1024000 = 1 mb memory block
+		m_arena_persistent.arena_init_allocate_buffer(2560); //1024000 = 1 mb memory block
 
 
 
@@ -82,19 +86,32 @@ namespace mnemosy
 		//MNEMOSY_TRACE("Initializing Subsystems");
 		//  === !!!  order of initialization here matters !!!! ===
 
+		m_pJobSystem = arena_placement_new(core::JobSystem); // needs to come first, loading images may already use it
+		m_pJobSystem->Init();
+
+		// openExr keeps its own pool, it blocks the calling thread while it waits for its tasks so they can not run on our workers
+		graphics::Picture::SetExrThreadCount(m_pJobSystem->GetWorkerCount());
+
+		//MNEMOSY_WARN("Init: JobSystem");
+
 		m_pFileDirectories = arena_placement_new(core::FileDirectories);// need to come before scene and image base lighting renderer
 		m_pFileDirectories->Init();
 
 		//MNEMOSY_WARN("Init: FileDirectories");
 
 		m_pWindow = arena_placement_new(core::Window);
-		m_pWindow->Init(WindowTitle);
+		m_pWindow->Init(WindowTitle, hiddenWindow);
 
 		#ifdef MNEMOSY_CONFIG_DISABLE_VSYNC
 		m_pWindow->EnableVsync(false);
 		#endif
 
 		//MNEMOSY_WARN("Init: Window");
+
+		m_pTextureUploader = arena_placement_new(graphics::TextureUploader); // needs the gl context, before anything that loads textures
+		m_pTextureUploader->Init();
+
+		//MNEMOSY_WARN("Init: TextureUploader");
 		
 		// subsystems
 		// Mnemosy::core
@@ -194,11 +211,13 @@ namespace mnemosy
 
 			m_pInputSystem->Update(m_pClock->GetDeltaSeconds());
 
+			m_pTextureUploader->Update();
+			m_pMaterialLibraryRegistry->Update();
 			m_pThumbnailManager->Update();
 			//m_pScene->Update();
 
 			// Rendering
-			m_pRenderer->HotReloadPbrShader(m_pClock->GetDeltaSeconds());
+			m_pRenderer->HotReloadPbrShader();
 			m_pRenderer->RenderScene(*m_pScene, m_pMaterialLibraryRegistry->GetEntryTypeToRenderWith());
 			m_pUserInterface->Render();
 
@@ -208,6 +227,37 @@ namespace mnemosy
 
 	}
 
+	bool MnemosyEngine::RunThumbnailRegeneration(systems::FolderNode* node) {
+
+		systems::ThumbnailBatchRegenerator& batch = m_pThumbnailManager->GetBatchRegenerator();
+		batch.Start(node);
+
+		double nextProgressTime = 0.0;
+
+		while (batch.IsRunning()) {
+
+			m_pClock->Update();
+			glfwPollEvents();
+
+			m_pTextureUploader->Update();
+
+			uint32_t finishedBefore = batch.GetFinishedCount() + batch.GetFailedCount();
+			batch.Update(0.1);
+
+			if (m_pClock->GetTimeSinceLaunch() >= nextProgressTime) {
+				MNEMOSY_INFO("Thumbnails: {} / {}", batch.GetFinishedCount() + batch.GetFailedCount(), batch.GetTotalCount());
+				nextProgressTime = m_pClock->GetTimeSinceLaunch() + 1.0;
+			}
+
+			// waiting for workers, nothing to do on this thread
+			if (finishedBefore == batch.GetFinishedCount() + batch.GetFailedCount()) {
+				std::this_thread::yield();
+			}
+		}
+
+		return batch.GetFailedCount() == 0;
+	}
+
 	void MnemosyEngine::Shutdown() {	
 		
 		m_pMaterialLibraryRegistry->SaveCurrentSate();
@@ -231,6 +281,8 @@ namespace mnemosy
 		m_pMaterialLibraryRegistry->Shutdown();
 		m_pSkyboxAssetRegistry->Shutdown();
 
+		m_pTextureUploader->Shutdown();
+
 
 		m_pInputSystem->Shutdown();
 		m_pDropHandler->Shutdown();
@@ -240,6 +292,9 @@ namespace mnemosy
 
 		m_pWindow->Shutdown();
 
+		graphics::Picture::SetExrThreadCount(0);
+		m_pJobSystem->Shutdown();
+
 
 		m_arena_persistent.arena_free_all();
 
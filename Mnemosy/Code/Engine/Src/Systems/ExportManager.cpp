@@ -3,6 +3,7 @@
 #include "Include/MnemosyEngine.h"
 #include "Include/Core/Log.h"
 #include "Include/Core/FileDirectories.h"
+#include "Include/Core/JobSystem.h"
 
 #include "Include/Core/Clock.h"
 
@@ -18,6 +19,7 @@
 #include "Include/Graphics/Skybox.h"
 
 #include "Include/Graphics/Utils/Picture.h"
+#include "Include/Graphics/Utils/PixelConvert.h"
 
 #include <glad/glad.h>
 
@@ -31,6 +33,9 @@ namespace mnemosy::systems
 		m_exportNormalFormat = graphics::MNSY_NORMAL_FORMAT_OPENGL;
 		m_exportRoughnessAsSmoothness = false;
 
+		m_pendingWrites = core::JobSystem::CreateGroup();
+		m_deferredWritesDepth = 0;
+
 		// load user settings
 
 		std::filesystem::path p = MnemosyEngine::GetInstance().GetFileDirectories().GetUserSettingsPath() / std::filesystem::path("exportSettings.mnsydata");
@@ -44,6 +49,7 @@ namespace mnemosy::systems
 		bool exportNormalAsOpenGl = settings.ReadBool(success, "export_NormalAsOpenGl", true, true);
 		bool exportRoughnessAsSmoothness = settings.ReadBool(success, "export_RoughnessAsSmoothness", false, true);
 		m_exportFileFormat = (graphics::ImageFileFormat)settings.ReadInt(success, "export_ImageFormat", 1, true);
+		int tiffCompression = settings.ReadInt(success, "storage_TiffCompression", (int)graphics::MNSY_TIFF_COMPRESSION_DEFLATE, true);
 
 		settings.FilePrettyPrintSet(true);
 
@@ -59,10 +65,20 @@ namespace mnemosy::systems
 
 		SetExportRoughnessAsSmoothness(exportRoughnessAsSmoothness);
 
+		if (tiffCompression < 0 || tiffCompression >= (int)graphics::MNSY_TIFF_COMPRESSION_COUNT) {
+			tiffCompression = (int)graphics::MNSY_TIFF_COMPRESSION_DEFLATE;
+		}
+		SetTiffCompression((graphics::TiffCompression)tiffCompression);
+
 	}
 
 	void ExportManager::Shutdown()
 	{
+		// make sure nothing is left half written
+		m_tiffStorageMigrator.Shutdown();
+		MnemosyEngine::GetInstance().GetJobSystem().Wait(m_pendingWrites);
+		m_pendingWrites = nullptr;
+
 		// save user settings
 		std::filesystem::path p = MnemosyEngine::GetInstance().GetFileDirectories().GetUserSettingsPath() / std::filesystem::path("exportSettings.mnsydata");
 
@@ -79,6 +95,7 @@ namespace mnemosy::systems
 		bool exportRoughnessAsSmoothness = m_exportRoughnessAsSmoothness;
 
 		int exportFileImageFormat = (int)m_exportFileFormat;
+		int tiffCompression = (int)GetTiffCompression();
 
 
 		flcrm::JsonSettings settings;
@@ -87,6 +104,7 @@ namespace mnemosy::systems
 		settings.WriteBool(success, "export_NormalAsOpenGl", exportNormalAsOpenGl);
 		settings.WriteBool(success, "export_RoughnessAsSmoothness", exportRoughnessAsSmoothness);
 		settings.WriteInt(success, "export_ImageFormat", exportFileImageFormat);
+		settings.WriteInt(success, "storage_TiffCompression", tiffCompression);
 
 		settings.FilePrettyPrintSet(true);
 		settings.FileClose(success, p);
@@ -98,11 +116,13 @@ namespace mnemosy::systems
 
 		namespace fs = std::filesystem;
 
-		MNEMOSY_INFO("Exporting Material: {}, as {} using {} normal map format \nExport Path: {}", libEntry->name, graphics::TexUtil::get_string_from_imageFileFormat(m_exportFileFormat),  graphics::TexUtil::get_string_from_normalMapFormat(m_exportNormalFormat), exportFolderPath.generic_string());
+		MNEMOSY_INFO("Exporting Material: {}, as {} using {} normal map format \nExport Path: {}", libEntry->name.str(), graphics::TexUtil::get_string_from_imageFileFormat(m_exportFileFormat),  graphics::TexUtil::get_string_from_normalMapFormat(m_exportNormalFormat), exportFolderPath.generic_string());
 
 		std::string fileExtention = graphics::TexUtil::get_string_from_imageFileFormat(m_exportFileFormat);
 
 		std::string entryName = libEntry->name;
+
+		BeginDeferredWrites();
 		
 		// Export Albedo
 		if (exportTypesOrdered[0]) {
@@ -298,6 +318,8 @@ namespace mnemosy::systems
 			}
 		}
 
+		EndDeferredWrites();
+
 		return true;
 	}
 
@@ -307,7 +329,7 @@ namespace mnemosy::systems
 
 		if (unlitMat.TextureIsAssigned()) {
 
-			MNEMOSY_INFO("Exporting Unlit Material: {}, as {} \nExport Path: {}", libEntry->name, graphics::TexUtil::get_string_from_imageFileFormat(m_exportFileFormat), exportFolderPath.generic_string());
+			MNEMOSY_INFO("Exporting Unlit Material: {}, as {} \nExport Path: {}", libEntry->name.str(), graphics::TexUtil::get_string_from_imageFileFormat(m_exportFileFormat), exportFolderPath.generic_string());
 
 			std::string fileExtention = graphics::TexUtil::get_string_from_imageFileFormat(m_exportFileFormat);
 
@@ -324,7 +346,7 @@ namespace mnemosy::systems
 		}
 		else {
 
-			MNEMOSY_WARN("Export Failed, no texture is assigned for Unlit Material: {}", libEntry->name);
+			MNEMOSY_WARN("Export Failed, no texture is assigned for Unlit Material: {}", libEntry->name.str());
 		}
 	}
 
@@ -341,8 +363,8 @@ namespace mnemosy::systems
 			fs::path equirectangularPath = systems::LibProcedures::LibEntry_GetFolderPath(libEntry) / fs::u8path(libEntry->name + texture_skybox_fileSuffix_equirectangular);
 
 			if (!fs::exists(equirectangularPath)) {
-				MNEMOSY_ERROR("Export Failed, Equirectangular texture is missing for Skybox Material: {}, Path: {}", libEntry->name, equirectangularPath.generic_string());
-				MNEMOSY_POPUP("Export Failed!\nEquirectangular texture is missing for Skybox Material: {}, Path: {}", libEntry->name, equirectangularPath.generic_string());
+				MNEMOSY_ERROR("Export Failed, Equirectangular texture is missing for Skybox Material: {}, Path: {}", libEntry->name.str(), equirectangularPath.generic_string());
+				MNEMOSY_POPUP("Export Failed!\nEquirectangular texture is missing for Skybox Material: {}, Path: {}", libEntry->name.str(), equirectangularPath.generic_string());
 				return;
 			}
 			
@@ -350,8 +372,8 @@ namespace mnemosy::systems
 			graphics::PictureError picErr;
 			graphics::PictureInfo picInfo = graphics::Picture::ReadPicture(picErr,equirectangularPath.generic_string().c_str(),true,true,true);
 			if (!picErr.wasSuccessfull) {
-				MNEMOSY_ERROR("Export Failed, Faild to load Equirectangular texture from file for Skybox Material: {}, Path: {}", libEntry->name, equirectangularPath.generic_string());
-				MNEMOSY_POPUP("Export Failed!\nFaild to load Equirectangular texture from file for Skybox Material: {}, Path: {}", libEntry->name, equirectangularPath.generic_string());
+				MNEMOSY_ERROR("Export Failed, Faild to load Equirectangular texture from file for Skybox Material: {}, Path: {}", libEntry->name.str(), equirectangularPath.generic_string());
+				MNEMOSY_POPUP("Export Failed!\nFaild to load Equirectangular texture from file for Skybox Material: {}, Path: {}", libEntry->name.str(), equirectangularPath.generic_string());
 				return;
 			}
 
@@ -384,51 +406,26 @@ namespace mnemosy::systems
 		}
 		else {
 
-			MNEMOSY_WARN("Export Failed, no texture is assigned for Skybox Material: {}", libEntry->name);
-			MNEMOSY_POPUP("No texture is assigned for Skybox Material: {}", libEntry->name);
+			MNEMOSY_WARN("Export Failed, no texture is assigned for Skybox Material: {}", libEntry->name.str());
+			MNEMOSY_POPUP("No texture is assigned for Skybox Material: {}", libEntry->name.str());
 		}
 
 
 
 	}
 
-	void ExportManager::GLTextureExport(const int glTextureID, TextureExportInfo& exportInfo) {
-
-		graphics::TextureFormat format = exportInfo.textureFormat;
-
-		graphics::ImageFileFormat fileFormat = graphics::TexUtil::get_imageFileFormat_from_fileExtentionString(exportInfo.path.extension().generic_string());
-
-		if (fileFormat == graphics::ImageFileFormat::MNSY_FILE_FORMAT_NONE) {
-			MNEMOSY_ERROR("File format {} is not supported",exportInfo.path.extension().generic_string());
-			return;
-		}
-
-
-		// todo this should not be handled here but rather by the specific writer
-		/*if(format == graphics::MNSY_RG8 ||format == graphics::MNSY_RG16 ||format == graphics::MNSY_RG32 ){
-			MNEMOSY_ERROR("ExportManager::GLTextureExport: Export of dual channel textures is not supported");
-			return;
-		}*/
-
-		uint16_t width = exportInfo.width;
-		uint16_t height = exportInfo.height;
-
-
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, glTextureID);
-
+	// the format a file format is written with when format is requested. outIsHalfFloat is set for 16 bit data that has to be half float.
+	static graphics::TextureFormat ExportManager_GetWriteFormat(const graphics::ImageFileFormat fileFormat, graphics::TextureFormat format, bool& outIsHalfFloat) {
 
 		uint8_t numChannels, bitsPerChannel, bytesPerPixel;
 		graphics::TexUtil::get_information_from_textureFormat(format, numChannels, bitsPerChannel, bytesPerPixel);
-		
-		
-		bool isHalfFloat = false;
+
+		outIsHalfFloat = false;
 
 		// Spceial case for exporting EXR images. 8 bit data will be promoted to 16 bit and exr 16 bit is always half float data
 		if (fileFormat == graphics::ImageFileFormat::MNSY_FILE_FORMAT_EXR) {
 
-			isHalfFloat = true;
+			outIsHalfFloat = true;
 			if ((int)format <= 4) { // if its R8,RG8,RGB8 or RGBA8 promote it to 16 bit
 				int form = (int)format + 4;
 
@@ -454,7 +451,40 @@ namespace mnemosy::systems
 
 		}
 
-		// we do this again here because we obviously may have changed format for some of the export cases above
+		return format;
+	}
+
+	void ExportManager::GLTextureExport(const int glTextureID, TextureExportInfo& exportInfo) {
+
+		graphics::TextureFormat format = exportInfo.textureFormat;
+
+		graphics::ImageFileFormat fileFormat = graphics::TexUtil::get_imageFileFormat_from_fileExtentionString(exportInfo.path.extension().generic_string());
+
+		if (fileFormat == graphics::ImageFileFormat::MNSY_FILE_FORMAT_NONE) {
+			MNEMOSY_ERROR("File format {} is not supported",exportInfo.path.extension().generic_string());
+			return;
+		}
+
+
+		// todo this should not be handled here but rather by the specific writer
+		/*if(format == graphics::MNSY_RG8 ||format == graphics::MNSY_RG16 ||format == graphics::MNSY_RG32 ){
+			MNEMOSY_ERROR("ExportManager::GLTextureExport: Export of dual channel textures is not supported");
+			return;
+		}*/
+
+		uint16_t width = exportInfo.width;
+		uint16_t height = exportInfo.height;
+
+
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, glTextureID);
+
+
+		bool isHalfFloat = false;
+		format = ExportManager_GetWriteFormat(fileFormat, format, isHalfFloat);
+
+		uint8_t numChannels, bitsPerChannel, bytesPerPixel;
 		graphics::TexUtil::get_information_from_textureFormat(format, numChannels, bitsPerChannel, bytesPerPixel);
 		
 		// buffer for pixel data
@@ -498,18 +528,120 @@ namespace mnemosy::systems
 
 		graphics::PictureInfo info{ width,height,format,isHalfFloat,pixelBuffer };
 
-		graphics::PictureError errorCheck;
-		graphics::Picture::WritePicture(errorCheck, exportInfo.path.generic_string().c_str(), info,true,exportInfo.converExrAndHdrToLinear);
+		// encoding (especially png and exr) is the slow part, so that runs on the job system. the job owns the pixel buffer from here on.
+		core::JobSystem& jobSystem = MnemosyEngine::GetInstance().GetJobSystem();
+
+		jobSystem.Submit(m_pendingWrites, [info, exportPath = exportInfo.path.generic_string(), convertToLinear = exportInfo.converExrAndHdrToLinear]() {
+
+			graphics::PictureError errorCheck;
+			graphics::Picture::WritePicture(errorCheck, exportPath.c_str(), info, true, convertToLinear);
+
+			if (!errorCheck.wasSuccessfull) {
+
+				std::string exportFormatTxt = graphics::TexUtil::get_string_from_textureFormat(info.textureFormat);
+				MNEMOSY_ERROR("An error occured while exporting. Format: {} {}x{}  to: {} \n Error Message: {}", exportFormatTxt, info.width, info.height, exportPath, errorCheck.what);
+				MNEMOSY_POPUP("An error occured while exporting.\nFormat: {} {}x{}  to: {} \n Error Message: {}", exportFormatTxt, info.width, info.height, exportPath, errorCheck.what);
+			}
+
+			if (info.pixels) {
+				free(info.pixels);
+			}
+
+		}, core::MNSY_JOB_PRIORITY_NORMAL);
+
+		if (m_deferredWritesDepth == 0) {
+			jobSystem.Wait(m_pendingWrites);
+		}
+	}
+
+	void ExportManager::PictureExport(const graphics::PictureInfo& pictureInfo, TextureExportInfo& exportInfo, const std::filesystem::path& sourceFilepath) {
+
+		namespace fs = std::filesystem;
 
-		if (!errorCheck.wasSuccessfull) {
+		graphics::ImageFileFormat fileFormat = graphics::TexUtil::get_imageFileFormat_from_fileExtentionString(exportInfo.path.extension().generic_string());
 
-			std::string exportFormatTxt = graphics::TexUtil::get_string_from_textureFormat(format);
-			MNEMOSY_ERROR("An error occured while exporting. Format: {} {}x{}  to: {} \n Error Message: {}", exportFormatTxt, width, height, exportInfo.path.generic_string(), errorCheck.what);
-			MNEMOSY_POPUP("An error occured while exporting.\nFormat: {} {}x{}  to: {} \n Error Message: {}", exportFormatTxt, width, height, exportInfo.path.generic_string(), errorCheck.what);
+		if (fileFormat == graphics::ImageFileFormat::MNSY_FILE_FORMAT_NONE) {
+			MNEMOSY_ERROR("File format {} is not supported", exportInfo.path.extension().generic_string());
+			return;
 		}
-		
-		if (pixelBuffer) {
-			free(pixelBuffer);
+
+		bool isHalfFloat = false;
+		graphics::TextureFormat format = ExportManager_GetWriteFormat(fileFormat, exportInfo.textureFormat, isHalfFloat);
+
+		// a source tiff that is already stored the way we would write it, including the current compression, is copied as is
+		bool copySource = false;
+		if (fileFormat == graphics::ImageFileFormat::MNSY_FILE_FORMAT_TIF && !sourceFilepath.empty()) {
+			copySource = graphics::TexUtil::get_imageFileFormat_from_fileExtentionString(sourceFilepath.extension().generic_string()) == graphics::ImageFileFormat::MNSY_FILE_FORMAT_TIF;
+		}
+
+		core::JobSystem& jobSystem = MnemosyEngine::GetInstance().GetJobSystem();
+
+		jobSystem.Submit(m_pendingWrites, [pictureInfo, format, isHalfFloat, copySource, sourcePath = sourceFilepath, exportPath = exportInfo.path, convertToLinear = exportInfo.converExrAndHdrToLinear]() {
+
+			if (copySource && graphics::Picture::TiffMatchesFormat(sourcePath.generic_string().c_str(), format, graphics::Picture::GetTiffCompression())) {
+
+				std::error_code ec;
+				fs::copy_file(sourcePath, exportPath, fs::copy_options::overwrite_existing, ec);
+				if (!ec) {
+					// copies can keep the time of the source, caches of the stored file compare against it
+					fs::last_write_time(exportPath, fs::file_time_type::clock::now(), ec);
+					return;
+				}
+				MNEMOSY_WARN("System error copying file, encoding it instead. \nMessage {}", ec.message());
+			}
+
+			// the pixels belong to the caller, a converted copy is made if the file is written in another format
+			graphics::PictureInfo info = pictureInfo;
+			if (format != pictureInfo.textureFormat || isHalfFloat != pictureInfo.isHalfFloat) {
+
+				uint8_t numChannels, bitsPerChannel, bytesPerPixel;
+				graphics::TexUtil::get_information_from_textureFormat(format, numChannels, bitsPerChannel, bytesPerPixel);
+
+				info.textureFormat = format;
+				info.isHalfFloat = isHalfFloat;
+				info.pixels = malloc((size_t)pictureInfo.width * pictureInfo.height * bytesPerPixel);
+
+				if (!info.pixels) {
+					MNEMOSY_ERROR("An error occured while exporting to: {} \n Error Message: failed to allocate memory", exportPath.generic_string());
+					return;
+				}
+
+				graphics::PixelConvert::Convert(pictureInfo.pixels, pictureInfo.textureFormat, pictureInfo.isHalfFloat, info.pixels, format, isHalfFloat, (size_t)pictureInfo.width * pictureInfo.height, graphics::MNSY_COLOR_OP_NONE);
+			}
+
+			graphics::PictureError errorCheck;
+			graphics::Picture::WritePicture(errorCheck, exportPath.generic_string().c_str(), info, true, convertToLinear);
+
+			if (!errorCheck.wasSuccessfull) {
+
+				std::string exportFormatTxt = graphics::TexUtil::get_string_from_textureFormat(info.textureFormat);
+				MNEMOSY_ERROR("An error occured while exporting. Format: {} {}x{}  to: {} \n Error Message: {}", exportFormatTxt, info.width, info.height, exportPath.generic_string(), errorCheck.what);
+				MNEMOSY_POPUP("An error occured while exporting.\nFormat: {} {}x{}  to: {} \n Error Message: {}", exportFormatTxt, info.width, info.height, exportPath.generic_string(), errorCheck.what);
+			}
+
+			if (info.pixels != pictureInfo.pixels) {
+				free(info.pixels);
+			}
+
+		}, core::MNSY_JOB_PRIORITY_NORMAL);
+
+		if (m_deferredWritesDepth == 0) {
+			jobSystem.Wait(m_pendingWrites);
+		}
+	}
+
+	void ExportManager::BeginDeferredWrites() {
+		m_deferredWritesDepth++;
+	}
+
+	void ExportManager::EndDeferredWrites() {
+
+		MNEMOSY_ASSERT(m_deferredWritesDepth > 0, "EndDeferredWrites() called without BeginDeferredWrites()");
+
+		m_deferredWritesDepth--;
+
+		if (m_deferredWritesDepth == 0) {
+			MnemosyEngine::GetInstance().GetJobSystem().Wait(m_pendingWrites);
 		}
 	}
 
@@ -4,12 +4,22 @@
 #include "Include/Core/Utils/StringUtils.h"
 #include "Include/Systems/FolderTreeNode.h"
 #include "Include/Systems/JsonKeys.h"
+#include "Include/Systems/LibraryIndex.h"
+
+#include <bit>
+#include <algorithm>
+
+// the child arrays are compacted once more slots are unused than used, but not for fewer unused ones than this
+#define FOLDER_TREE_COMPACT_MIN_UNUSED_SLOTS 1024
 
 namespace mnemosy::systems {
 
+	// slots owned by a range of count children
+	static size_t FolderTree_ChildCapacity(const size_t count) {
+		return count == 0 ? 0 : std::bit_ceil(count);
+	}
+
 	void FolderTree::Init() {
-		m_runtimeIDCounter = 1;
-		m_runtimeMaterialIDCounter = 1;
 		
 		m_rootNode = CreateNewFolder_Internal(nullptr, "Root");
 
@@ -21,6 +31,17 @@ namespace mnemosy::systems {
 		if (!m_searchResults.empty()) {
 			m_searchResults.clear();
 		}
+
+		m_searchIndex.Clear();
+		m_nameUseCounts.clear();
+		m_nameSuffixCounters.clear();
+
+		m_childNodes = ChildArray<FolderNode>();
+		m_childEntries = ChildArray<LibEntry>();
+		m_namePool.Clear();
+
+		m_libEntryPool.FreeAll();
+		m_folderPool.FreeAll();
 	}
 
 	FolderNode* FolderTree::CreateNewFolder(FolderNode* parentNode, const std::string& name) {
@@ -30,22 +51,17 @@ namespace mnemosy::systems {
 
 	void FolderTree::RenameFolder(FolderNode* node, const std::string& newName) {
 
-		node->name = MakeNameUnique(newName);
+		std::string uniqueName = MakeNameUnique(newName);
+
+		UnregisterName_Internal(node->name);
+		node->name = m_namePool.Intern(uniqueName);
+		RegisterName_Internal(node->name);
 		//RecursivUpdatePathFromRoot(node);
 	}
 
 	bool FolderTree::CollectMaterialsFromSearchKeyword(const std::string& searchKeyword) {
 
-		if (!m_searchResults.empty()) {
-			m_searchResults.clear();
-		}
-
-		std::string keyword = searchKeyword;
-
-		core::StringUtils::MakeStringLowerCase(keyword);
-
-		RecursivCollectMaterialSearch(m_rootNode, keyword);
-
+		m_searchIndex.Search(searchKeyword, m_searchResults);
 
 		if (!m_searchResults.empty()) {
 			return true;
@@ -55,39 +71,13 @@ namespace mnemosy::systems {
 		return false;
 	}
 
-	FolderNode* FolderTree::RecursivGetNodeByID(FolderNode* startNode, const unsigned int id)
-	{
-		if (startNode == nullptr) {
-			return nullptr;
-		}
-
-		if (startNode->runtime_ID == id) {
-			return startNode;
-		}
-
-		if (startNode->IsLeafNode()) {
-			return nullptr;
-		}
-
-		FolderNode* foundNode = nullptr;
-
-		for (size_t i = 0; i < startNode->subNodes.size(); i++) {
-			foundNode = RecursivGetNodeByID(startNode->subNodes[i], id);
-			if (foundNode != nullptr) {
-				break;
-			}
-		}
-
-		return foundNode;
-	}
-
 	void FolderTree::DeleteFolderHierarchy(FolderNode* node){
 
 		// remove node from parents subnodes list
 		FolderNode* parent = node->parent;
 		for (size_t i = 0; i < parent->subNodes.size(); i++) {
 			if (parent->subNodes[i]->runtime_ID == node->runtime_ID) {
-				parent->subNodes.erase(parent->subNodes.begin() + i);
+				RemoveChild_Internal(parent->subNodes, m_childNodes, i);
 				break;
 			}
 		}
@@ -101,19 +91,24 @@ namespace mnemosy::systems {
 
 	void FolderTree::RenameLibEntry(LibEntry* libEntry, const std::string& name) {
 
-		libEntry->name = MakeNameUnique( name);
+		std::string uniqueName = MakeNameUnique(name);
+
+		UnregisterName_Internal(libEntry->name);
+		libEntry->name = m_namePool.Intern(uniqueName);
+		RegisterName_Internal(libEntry->name);
+		m_searchIndex.Rename(libEntry);
 	}
 
 	void FolderTree::MoveLibEntry(LibEntry* libEntry, FolderNode* sourceNode, FolderNode* targetParentNode) {
 
-		targetParentNode->subEntries.push_back(libEntry);
+		AddChild_Internal(targetParentNode->subEntries, m_childEntries, libEntry);
 		libEntry->parent = targetParentNode;
 
 		for (unsigned int i = 0; i < sourceNode->subEntries.size(); i++) {
 
 			if (sourceNode->subEntries[i]->runtime_ID == libEntry->runtime_ID) {
 
-				sourceNode->subEntries.erase(sourceNode->subEntries.begin() + i);
+				RemoveChild_Internal(sourceNode->subEntries, m_childEntries, i);
 				break;
 			}
 		}
@@ -122,9 +117,12 @@ namespace mnemosy::systems {
 	void FolderTree::DeleteLibEntry(FolderNode* parentNode, unsigned int posInVector) {
 
 		LibEntry* mat = parentNode->subEntries[posInVector];
-		parentNode->subEntries.erase(parentNode->subEntries.begin() + posInVector);
+		RemoveChild_Internal(parentNode->subEntries, m_childEntries, posInVector);
 
-		delete mat;
+		m_searchIndex.Remove(mat);
+		UnregisterName_Internal(mat->name);
+		m_libEntrySlots.Remove(mat->runtime_ID);
+		m_libEntryPool.Delete(mat);
 	}
 
 	bool FolderTree::IsLibEntryWithinHierarchy(FolderNode* hierarchyRoot, LibEntry* libEnry) {
@@ -168,17 +166,18 @@ namespace mnemosy::systems {
 
 		// remove from parents children
 		FolderNode* oldParent = sourceNode->parent;
-		for (int i = 0; i < oldParent->subNodes.size(); i++) {
+		for (size_t i = 0; i < oldParent->subNodes.size(); i++) {
 
-			if (oldParent->subNodes[i]->name == sourceNode->name) {
-				oldParent->subNodes.erase(oldParent->subNodes.begin() + i);
+			if (oldParent->subNodes[i]->runtime_ID == sourceNode->runtime_ID) {
+				RemoveChild_Internal(oldParent->subNodes, m_childNodes, i);
+				break;
 			}
 		}
 
 		// set new parent
 		sourceNode->parent = targetParentNode;
 		// add as child of new parent
-		targetParentNode->subNodes.push_back(sourceNode);
+		AddChild_Internal(targetParentNode->subNodes, m_childNodes, sourceNode);
 
 		//RecursivUpdatePathFromRoot(sourceNode);
 	}
@@ -191,35 +190,49 @@ namespace mnemosy::systems {
 
 				RecursivDeleteHierarchy(m_rootNode->subNodes[i]);
 			}
-			m_rootNode->subNodes.clear();
+			ClearChildren_Internal(m_rootNode->subNodes, m_childNodes);
 		}
 
 		if (m_rootNode->HasMaterials()) {
 
 			for (unsigned int i = 0; i < m_rootNode->subEntries.size(); i++) {
 
-				delete m_rootNode->subEntries[i];
+				m_searchIndex.Remove(m_rootNode->subEntries[i]);
+				UnregisterName_Internal(m_rootNode->subEntries[i]->name);
+				m_libEntrySlots.Remove(m_rootNode->subEntries[i]->runtime_ID);
+				m_libEntryPool.Delete(m_rootNode->subEntries[i]);
 			}
 
-			m_rootNode->subEntries.clear();
+			ClearChildren_Internal(m_rootNode->subEntries, m_childEntries);
 		}
+
+		m_nameSuffixCounters.clear();
+
+		// only the root is left, it gets its name back from the new pool
+		m_childNodes = ChildArray<FolderNode>();
+		m_childEntries = ChildArray<LibEntry>();
+
+		std::string rootName = m_rootNode->name;
+		m_namePool.Clear();
+		m_rootNode->name = m_namePool.Intern(rootName);
 	}
 
 	std::string FolderTree::MakeNameUnique(const std::string& name) {
 
 		// ensure that the name is completely unique across all folders and materials
-		std::string baseName = name;
 		std::string lowerBaseName = core::StringUtils::ToLowerCase(name);
-		unsigned int suffixNbr = 0;
 
-		std::string uniqueName = baseName;
-		std::string lowerUniqueName = lowerBaseName;
+		if (m_nameUseCounts.count(lowerBaseName) == 0)
+			return name;
+
+		// continue after the last suffix given out for this name, only names someone picked by hand in between still have to be skipped
+		unsigned int& suffixNbr = m_nameSuffixCounters[lowerBaseName];
 
-		while (RecursivDoesNameExist(m_rootNode, lowerUniqueName)) {
+		std::string uniqueName;
+		do {
 			suffixNbr++;
-			uniqueName = baseName + "_" + std::to_string(suffixNbr);
-			lowerUniqueName = core::StringUtils::ToLowerCase(uniqueName);
-		}
+			uniqueName = name + "_" + std::to_string(suffixNbr);
+		} while (m_nameUseCounts.count(core::StringUtils::ToLowerCase(uniqueName)) != 0);
 
 		return uniqueName;
 	}
@@ -233,6 +246,32 @@ namespace mnemosy::systems {
 		RecursivLoadFromJson(m_rootNode, firstTreeEntryJson);
 	}
 
+	void FolderTree::LoadFromIndex(const LibraryIndex& index) {
+
+		// folders are stored depth first so the parent of each one exists already
+		std::vector<FolderNode*> nodes(index.GetFolderCount(), nullptr);
+		nodes[0] = m_rootNode;
+
+		for (uint32_t i = 0; i < index.GetFolderCount(); i++) {
+
+			const LibraryIndexFolder& folder = index.GetFolder(i);
+
+			if (i != 0) {
+				nodes[i] = CreateNewFolder_Internal(nodes[folder.parent], std::string(index.GetName(folder.nameOffset, folder.nameLength)));
+			}
+
+			FolderNode* node = nodes[i];
+
+			for (uint32_t e = folder.firstEntry; e < folder.firstEntry + folder.entryCount; e++) {
+
+				const LibraryIndexEntry& entry = index.GetEntry(e);
+				CreateMaterial_Internal(node, (LibEntryType)entry.type, std::string(index.GetName(entry.nameOffset, entry.nameLength)));
+			}
+
+			node->SortLibEntries();
+		}
+	}
+
 	nlohmann::json* FolderTree::WriteToJson() {
 
 		nlohmann::json LibraryDirectoriesJson; // top level json object
@@ -276,31 +315,34 @@ namespace mnemosy::systems {
 	LibEntry* FolderTree::CreateMaterial_Internal(FolderNode* node, const LibEntryType type, const std::string name) {
 
 		// adding entry to list of directory node;
-		LibEntry* matInfo = new LibEntry();
+		LibEntry* matInfo = m_libEntryPool.New();
 		matInfo->type = type;
-		matInfo->name = name;
+		matInfo->name = m_namePool.Intern(name);
 		matInfo->parent = node;
-		matInfo->runtime_ID = m_runtimeMaterialIDCounter;
-		m_runtimeMaterialIDCounter++;
+		matInfo->runtime_ID = m_libEntrySlots.Insert(matInfo);
 		matInfo->selected = false;
 		matInfo->thumbnailTexure_ID = 0;
+		matInfo->thumbnailAtlasTile = 0;
 		matInfo->thumbnailLoaded = false;
 
-		node->subEntries.push_back(matInfo);
+		AddChild_Internal(node->subEntries, m_childEntries, matInfo);
+		m_searchIndex.Add(matInfo);
+		RegisterName_Internal(name);
 
 		return matInfo;
 	}
 
 	FolderNode* FolderTree::CreateNewFolder_Internal(FolderNode* parentNode, const std::string& name) {
-		FolderNode* node = new FolderNode();
-		node->name = name;
+		FolderNode* node = m_folderPool.New();
+		node->name = m_namePool.Intern(name);
 		node->parent = parentNode;
-		node->runtime_ID = m_runtimeIDCounter;
-		m_runtimeIDCounter++;
+		node->runtime_ID = m_folderSlots.Insert(node);
+
+		RegisterName_Internal(name);
 
 		if (parentNode != nullptr) { // if the new node is not the root node
 
-			parentNode->subNodes.push_back(node);
+			AddChild_Internal(parentNode->subNodes, m_childNodes, node);
 
 			/*if (parentNode->IsRoot()) {
 				node->pathFromRoot = std::filesystem::path(node->name);
@@ -319,98 +361,44 @@ namespace mnemosy::systems {
 			for (FolderNode* subNode : node->subNodes) {
 				RecursivDeleteHierarchy(subNode);
 			}
-			node->subNodes.clear();
+			ClearChildren_Internal(node->subNodes, m_childNodes);
 		}
 
 		if (node->HasMaterials()) {
 
 			for (int i = 0; i < node->subEntries.size(); i++) {
-				delete node->subEntries[i];
+				m_searchIndex.Remove(node->subEntries[i]);
+				UnregisterName_Internal(node->subEntries[i]->name);
+				m_libEntrySlots.Remove(node->subEntries[i]->runtime_ID);
+				m_libEntryPool.Delete(node->subEntries[i]);
 			}
-			node->subEntries.clear();
+			ClearChildren_Internal(node->subEntries, m_childEntries);
 		}
 
-		delete node;
+		UnregisterName_Internal(node->name);
+		m_folderSlots.Remove(node->runtime_ID);
+		m_folderPool.Delete(node);
 		node = nullptr;
 	}
 
 
-	bool FolderTree::RecursivDoesNameExist(FolderNode* node, const std::string& name) {
-
-		// recursivly walk through the entire tree and check if the name already exists somewhere either as a folder or as a material
-		// returns true if the name exists
-		// input name is assumed to be lower case to avoid doing this computation multiple times
-
-		std::string lowerName = name; //core::StringUtils::ToLowerCase(name); // we pass always a lower case already
-		std::string currentNodeName = core::StringUtils::ToLowerCase(node->name);
-
-		// Check current node
-		if (currentNodeName == lowerName) {
-			return true;
-		}
-
-
-		// check sub entries names
-		if (node->HasMaterials()) {
-
-			for (int i = 0; i < node->subEntries.size(); i++) {
-
-				if (core::StringUtils::ToLowerCase(node->subEntries[i]->name) == lowerName) {
-					return true;
-				}
-			}
-		}
-
-		// check sub folders
-		if (!node->IsLeafNode()) {
-
-			for (FolderNode* subnode : node->subNodes) {
-
-				if (RecursivDoesNameExist(subnode, lowerName)) {
-					return true;
-				}
-			}
-		}
+	void FolderTree::RegisterName_Internal(const std::string& name) {
 
-		return false;
+		m_nameUseCounts[core::StringUtils::ToLowerCase(name)]++;
 	}
 
-	void FolderTree::RecursivCollectMaterialSearch(FolderNode* node, const std::string& searchKeyword) {
-
-
-		if (node->HasMaterials()) {
-
-			// collect suitable materials
-
-			for (int i = 0; i < node->subEntries.size(); i++) {
-
-				std::string matName = node->subEntries[i]->name;
-				core::StringUtils::MakeStringLowerCase(matName);
-
-				if (matName.find(searchKeyword) != std::string::npos) {
-
-					// Found a material that contains the keyword in its name
-
-					m_searchResults.push_back(node->subEntries[i]);
-
-				}
-			}
-		}
-
+	void FolderTree::UnregisterName_Internal(const std::string& name) {
 
-		if (!node->IsLeafNode()) {
-
-
-			for (int i = 0; i < node->subNodes.size(); i++) {
-
-				RecursivCollectMaterialSearch(node->subNodes[i], searchKeyword);
-			}
+		auto it = m_nameUseCounts.find(core::StringUtils::ToLowerCase(name));
+		if (it == m_nameUseCounts.end())
+			return;
 
+		it->second--;
+		if (it->second == 0) {
+			m_nameUseCounts.erase(it);
 		}
-
 	}
 
-
 	nlohmann::json FolderTree::RecursivWriteToJson(FolderNode* node) {
 
 		nlohmann::json nodeJson;	
@@ -485,7 +473,7 @@ namespace mnemosy::systems {
 			nlohmann::json subNodes;
 			for (unsigned int i = 0; i < node->subNodes.size(); i++) {
 
-				subNodes[node->subNodes[i]->name] = RecursivWriteToJson(node->subNodes[i]);
+				subNodes[node->subNodes[i]->name.str()] = RecursivWriteToJson(node->subNodes[i]);
 			}
 
 			nodeJson[jsonLibKey_subFolders] = subNodes;
@@ -537,4 +525,105 @@ namespace mnemosy::systems {
 
 	}
 
+	template<typename T>
+	void FolderTree::AddChild_Internal(FolderChildRange<T>& range, ChildArray<T>& array, T* child) {
+
+		size_t capacity = FolderTree_ChildCapacity(range.m_count);
+
+		if (range.m_count == capacity) {
+
+			size_t newCapacity = capacity == 0 ? 1 : capacity * 2;
+
+			if (range.m_count != 0 && range.m_first + capacity == array.slots.size()) {
+				// last range of the array, grows in place
+				array.slots.resize(array.slots.size() + newCapacity - capacity);
+			}
+			else {
+				size_t newFirst = array.slots.size();
+				array.slots.resize(newFirst + newCapacity);
+
+				for (uint32_t i = 0; i < range.m_count; i++) {
+					array.slots[newFirst + i] = array.slots[range.m_first + i];
+				}
+
+				range.m_first = (uint32_t)newFirst;
+				range.m_storage = &array.slots;
+			}
+
+			array.usedSlots += newCapacity - capacity;
+		}
+
+		array.slots[range.m_first + range.m_count] = child;
+		range.m_count++;
+
+		if (array.slots.size() - array.usedSlots > std::max<size_t>(FOLDER_TREE_COMPACT_MIN_UNUSED_SLOTS, array.usedSlots)) {
+			CompactChildArrays_Internal();
+		}
+	}
+
+	template<typename T>
+	void FolderTree::RemoveChild_Internal(FolderChildRange<T>& range, ChildArray<T>& array, const size_t position) {
+
+		MNEMOSY_ASSERT(position < range.m_count, "Child position is out of range");
+
+		for (size_t i = range.m_first + position; i + 1 < range.m_first + range.m_count; i++) {
+			array.slots[i] = array.slots[i + 1];
+		}
+
+		array.usedSlots -= FolderTree_ChildCapacity(range.m_count) - FolderTree_ChildCapacity(range.m_count - 1);
+		range.m_count--;
+	}
+
+	template<typename T>
+	void FolderTree::ClearChildren_Internal(FolderChildRange<T>& range, ChildArray<T>& array) {
+
+		array.usedSlots -= FolderTree_ChildCapacity(range.m_count);
+
+		range.m_storage = nullptr;
+		range.m_first = 0;
+		range.m_count = 0;
+	}
+
+	void FolderTree::CompactChildArrays_Internal() {
+
+		std::vector<FolderNode*> nodeSlots;
+		std::vector<LibEntry*> entrySlots;
+		nodeSlots.reserve(m_childNodes.usedSlots);
+		entrySlots.reserve(m_childEntries.usedSlots);
+
+		// depth first so the folders of a hierarchy end up close to each other, children are read from the new arrays once their range moved
+		std::vector<FolderNode*> stack;
+		stack.push_back(m_rootNode);
+
+		while (!stack.empty()) {
+
+			FolderNode* node = stack.back();
+			stack.pop_back();
+
+			if (!node->subEntries.empty()) {
+				size_t first = entrySlots.size();
+				entrySlots.resize(first + FolderTree_ChildCapacity(node->subEntries.m_count));
+				std::copy(node->subEntries.begin(), node->subEntries.end(), entrySlots.begin() + first);
+				node->subEntries.m_first = (uint32_t)first;
+			}
+
+			if (!node->subNodes.empty()) {
+				size_t first = nodeSlots.size();
+				nodeSlots.resize(first + FolderTree_ChildCapacity(node->subNodes.m_count));
+				std::copy(node->subNodes.begin(), node->subNodes.end(), nodeSlots.begin() + first);
+				node->subNodes.m_first = (uint32_t)first;
+
+				for (size_t i = node->subNodes.m_count; i > 0; i--) {
+					stack.push_back(nodeSlots[first + i - 1]);
+				}
+			}
+		}
+
+		// swapping keeps the vectors the ranges point to
+		m_childNodes.slots.swap(nodeSlots);
+		m_childNodes.usedSlots = m_childNodes.slots.size();
+		m_childEntries.slots.swap(entrySlots);
+		m_childEntries.usedSlots = m_childEntries.slots.size();
+	}
+
 } // namespace mnemosy::systems
\ No newline at end of file
@@ -1,12 +1,14 @@
 #include "Include/Systems/FolderTreeNode.h"
 
+#include <algorithm>
+
 
 namespace mnemosy::systems
 {
 	std::filesystem::path LibEntry::GetPathFromRoot()
 	{
 		namespace fs = std::filesystem;
-		return parent->GetPathFromRoot() / fs::u8path(name);
+		return parent->GetPathFromRoot() / fs::u8path(name.str());
 	}
 
 
@@ -34,13 +36,13 @@ namespace mnemosy::systems
 			return fs::path();
 		}
 
-		fs::path rootPath = fs::u8path(this->name);
+		fs::path rootPath = fs::u8path(this->name.str());
 
 		FolderNode* currParent = this->parent;
 
 		while (!currParent->IsRoot()) {
 
-			rootPath = fs::u8path(currParent->name) / rootPath;
+			rootPath = fs::u8path(currParent->name.str()) / rootPath;
 
 			currParent = currParent->parent;
 		}
@@ -57,7 +59,9 @@ namespace mnemosy::systems
 		// sort alphabetically
 		if (!subEntries.empty()) {
 
-			std::sort(subEntries.begin(), subEntries.end(), [](const LibEntry* a, const LibEntry* b) {
+			LibEntry** first = subEntries.m_storage->data() + subEntries.m_first;
+
+			std::sort(first, first + subEntries.m_count, [](const LibEntry* a, const LibEntry* b) {
 				return a->name < b->name;
 			});
 		}
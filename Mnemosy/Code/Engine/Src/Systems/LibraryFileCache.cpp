@@ -0,0 +1,188 @@
+#include "Include/Systems/LibraryFileCache.h"
+
+#include "Include/MnemosyEngine.h"
+#include "Include/Core/JobSystem.h"
+
+#include <algorithm>
+
+// entry folders are small, a job lists a batch of them so the queue does not fill up with tiny jobs on large libraries
+#define LIBRARY_FILE_CACHE_FOLDERS_PER_JOB 64
+
+namespace mnemosy::systems {
+
+	static bool LibraryFileCache_GetFolderTime(const std::filesystem::path& folderPath, int64_t& outTime) {
+
+		std::error_code ec;
+		std::filesystem::file_time_type time = std::filesystem::last_write_time(folderPath, ec);
+		if (ec)
+			return false;
+
+		outTime = (int64_t)time.time_since_epoch().count();
+		return true;
+	}
+
+	static std::filesystem::path::string_type LibraryFileCache_GetKey(const std::filesystem::path& folderPath) {
+
+		return folderPath.lexically_normal().native();
+	}
+
+	void LibraryFileCache::Prewarm(const std::vector<std::filesystem::path>& folderPaths) {
+
+		namespace fs = std::filesystem;
+
+		if (folderPaths.empty())
+			return;
+
+		core::JobSystem& jobSystem = MnemosyEngine::GetInstance().GetJobSystem();
+
+		if (!m_prewarmJobs) {
+			m_prewarmJobs = core::JobSystem::CreateGroup();
+		}
+
+		for (size_t first = 0; first < folderPaths.size(); first += LIBRARY_FILE_CACHE_FOLDERS_PER_JOB) {
+
+			size_t last = std::min(first + LIBRARY_FILE_CACHE_FOLDERS_PER_JOB, folderPaths.size());
+			std::vector<fs::path> batch(folderPaths.begin() + first, folderPaths.begin() + last);
+
+			std::shared_ptr<core::JobGroup> group = m_prewarmJobs;
+			jobSystem.Submit(group, [this, group, batch = std::move(batch)]() {
+
+				for (const fs::path& folderPath : batch) {
+
+					if (group->IsCancelled())
+						return;
+
+					fs::path::string_type key = LibraryFileCache_GetKey(folderPath);
+					{
+						std::lock_guard<std::mutex> lock(m_mutex);
+						if (m_folders.count(key) != 0)
+							continue;
+					}
+
+					CachedFolder folder;
+					ListFolder_Internal(folderPath, folder);
+
+					// the main thread may have listed it in the meantime, its listing is at least as new
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_folders.try_emplace(std::move(key), std::move(folder));
+				}
+			}, core::MNSY_JOB_PRIORITY_LOW);
+		}
+	}
+
+	void LibraryFileCache::Clear() {
+
+		if (m_prewarmJobs) {
+			m_prewarmJobs->Cancel();
+			MnemosyEngine::GetInstance().GetJobSystem().Wait(m_prewarmJobs);
+			m_prewarmJobs = nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_folders.clear();
+	}
+
+	void LibraryFileCache::Update() {
+
+		m_frame++;
+
+		if (m_prewarmJobs && m_prewarmJobs->IsDone()) {
+			m_prewarmJobs = nullptr;
+		}
+	}
+
+	bool LibraryFileCache::Exists(const std::filesystem::path& filePath) {
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		CachedFolder& folder = GetValidFolder_Internal(lock, filePath.parent_path());
+
+		return folder.files.count(filePath.filename().native()) != 0;
+	}
+
+	bool LibraryFileCache::GetFileInfo(const std::filesystem::path& filePath, CachedFileInfo& outInfo) {
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		CachedFolder& folder = GetValidFolder_Internal(lock, filePath.parent_path());
+
+		auto it = folder.files.find(filePath.filename().native());
+		if (it == folder.files.end())
+			return false;
+
+		outInfo = it->second;
+		return true;
+	}
+
+	void LibraryFileCache::InvalidateFolder(const std::filesystem::path& folderPath) {
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_folders.erase(LibraryFileCache_GetKey(folderPath));
+	}
+
+	// private
+
+	void LibraryFileCache::ListFolder_Internal(const std::filesystem::path& folderPath, CachedFolder& outFolder) {
+
+		namespace fs = std::filesystem;
+
+		outFolder.files.clear();
+
+		// the time is taken before listing so a change made while listing shows up as a newer folder time on the next check
+		outFolder.exists = LibraryFileCache_GetFolderTime(folderPath, outFolder.time);
+		if (!outFolder.exists)
+			return;
+
+		// directory entries carry the size and write time the listing returned, reading them does not touch the disk again on windows
+		std::error_code ec;
+		for (fs::directory_iterator it(folderPath, ec), end; !ec && it != end; it.increment(ec)) {
+
+			const fs::directory_entry& entry = *it;
+
+			std::error_code entryEc;
+			if (!entry.is_regular_file(entryEc))
+				continue;
+
+			CachedFileInfo info;
+			info.size = (uint64_t)entry.file_size(entryEc);
+			if (entryEc)
+				continue;
+
+			fs::file_time_type time = entry.last_write_time(entryEc);
+			if (entryEc)
+				continue;
+
+			info.time = (int64_t)time.time_since_epoch().count();
+			outFolder.files.emplace(entry.path().filename().native(), info);
+		}
+	}
+
+	LibraryFileCache::CachedFolder& LibraryFileCache::GetValidFolder_Internal(std::unique_lock<std::mutex>& lock, const std::filesystem::path& folderPath) {
+
+		std::filesystem::path::string_type key = LibraryFileCache_GetKey(folderPath);
+
+		auto it = m_folders.find(key);
+		if (it != m_folders.end() && it->second.validatedFrame == m_frame)
+			return it->second;
+
+		lock.unlock();
+		int64_t time = 0;
+		bool exists = LibraryFileCache_GetFolderTime(folderPath, time);
+		lock.lock();
+
+		it = m_folders.find(key);
+		if (it != m_folders.end() && it->second.exists == exists && (!exists || it->second.time == time)) {
+			it->second.validatedFrame = m_frame;
+			return it->second;
+		}
+
+		lock.unlock();
+		CachedFolder folder;
+		ListFolder_Internal(folderPath, folder);
+		folder.validatedFrame = m_frame;
+		lock.lock();
+
+		CachedFolder& cached = m_folders[key];
+		cached = std::move(folder);
+		return cached;
+	}
+
+} // !mnemosy::systems
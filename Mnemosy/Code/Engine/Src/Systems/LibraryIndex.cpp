@@ -0,0 +1,276 @@
+#include "Include/Systems/LibraryIndex.h"
+
+#include "Include/Core/Log.h"
+#include "Include/Systems/FolderTreeNode.h"
+
+#include <fstream>
+#include <algorithm>
+#include <string.h>
+
+// bump the version whenever the layout of the file changes, indices with another version are ignored and rewritten
+#define LIBRARY_INDEX_MAGIC "MNSYLIX1"
+#define LIBRARY_INDEX_VERSION 1
+
+namespace mnemosy::systems {
+
+	struct LibraryIndexHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t folderCount;
+		uint32_t entryCount;
+		uint32_t namesSize;
+		uint64_t dataFileSize;
+		int64_t dataFileTime;
+		uint64_t journalSequence;
+		uint64_t checksum;		// of everything after the header
+	};
+
+	static_assert(sizeof(LibraryIndexHeader) == 56, "Library index header layout changed");
+	static_assert(sizeof(LibraryIndexFolder) == 20, "Library index folder layout changed");
+	static_assert(sizeof(LibraryIndexEntry) == 12, "Library index entry layout changed");
+
+	// 64 bit FNV-1a
+	static uint64_t LibraryIndex_Checksum(const uint8_t* data, const size_t size) {
+
+		uint64_t hash = 14695981039346656037ull;
+		for (size_t i = 0; i < size; i++) {
+			hash ^= data[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	static bool LibraryIndex_GetDataFileStamp(const std::filesystem::path& dataFilePath, uint64_t& outSize, int64_t& outTime) {
+
+		namespace fs = std::filesystem;
+
+		std::error_code ec;
+		uintmax_t size = fs::file_size(dataFilePath, ec);
+		if (ec)
+			return false;
+
+		fs::file_time_type time = fs::last_write_time(dataFilePath, ec);
+		if (ec)
+			return false;
+
+		outSize = (uint64_t)size;
+		outTime = (int64_t)time.time_since_epoch().count();
+		return true;
+	}
+
+	static uint32_t LibraryIndex_AddName(const std::string& name, std::vector<char>& names) {
+
+		uint32_t offset = (uint32_t)names.size();
+		names.insert(names.end(), name.begin(), name.end());
+		return offset;
+	}
+
+	// subfolders in alphabetical order, the order the json loader creates them in
+	static void LibraryIndex_CollectFolders(FolderNode* node, const uint32_t parentIndex, std::vector<LibraryIndexFolder>& folders, std::vector<LibraryIndexEntry>& entries, std::vector<char>& names) {
+
+		LibraryIndexFolder folder;
+		folder.parent = parentIndex;
+		folder.nameOffset = LibraryIndex_AddName(node->name, names);
+		folder.nameLength = (uint32_t)node->name.size();
+		folder.firstEntry = (uint32_t)entries.size();
+		folder.entryCount = (uint32_t)node->subEntries.size();
+
+		uint32_t folderIndex = (uint32_t)folders.size();
+		folders.push_back(folder);
+
+		for (LibEntry* libEntry : node->subEntries) {
+
+			LibraryIndexEntry entry;
+			entry.nameOffset = LibraryIndex_AddName(libEntry->name, names);
+			entry.nameLength = (uint32_t)libEntry->name.size();
+			entry.type = (uint32_t)libEntry->type;
+			entries.push_back(entry);
+		}
+
+		std::vector<FolderNode*> subNodes(node->subNodes.begin(), node->subNodes.end());
+		std::sort(subNodes.begin(), subNodes.end(), [](const FolderNode* a, const FolderNode* b) {
+			return a->name < b->name;
+		});
+
+		for (FolderNode* subNode : subNodes) {
+			LibraryIndex_CollectFolders(subNode, folderIndex, folders, entries, names);
+		}
+	}
+
+	std::filesystem::path LibraryIndex::GetPathForDataFile(const std::filesystem::path& dataFilePath) {
+
+		std::filesystem::path indexPath = dataFilePath;
+		indexPath.replace_extension(".mnsyindex");
+		return indexPath;
+	}
+
+	void LibraryIndex::Build(FolderNode* rootNode, const uint64_t journalSequence, std::vector<uint8_t>& outBuffer) {
+
+		std::vector<LibraryIndexFolder> folders;
+		std::vector<LibraryIndexEntry> entries;
+		std::vector<char> names;
+
+		LibraryIndex_CollectFolders(rootNode, 0, folders, entries, names);
+
+		LibraryIndexHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, LIBRARY_INDEX_MAGIC, sizeof(header.magic));
+		header.version = LIBRARY_INDEX_VERSION;
+		header.folderCount = (uint32_t)folders.size();
+		header.entryCount = (uint32_t)entries.size();
+		header.namesSize = (uint32_t)names.size();
+		header.journalSequence = journalSequence;
+
+		size_t foldersSize = folders.size() * sizeof(LibraryIndexFolder);
+		size_t entriesSize = entries.size() * sizeof(LibraryIndexEntry);
+
+		outBuffer.resize(sizeof(header) + foldersSize + entriesSize + names.size());
+
+		uint8_t* dst = outBuffer.data();
+		memcpy(dst, &header, sizeof(header));
+		dst += sizeof(header);
+		if (foldersSize) {
+			memcpy(dst, folders.data(), foldersSize);
+			dst += foldersSize;
+		}
+		if (entriesSize) {
+			memcpy(dst, entries.data(), entriesSize);
+			dst += entriesSize;
+		}
+		if (!names.empty()) {
+			memcpy(dst, names.data(), names.size());
+		}
+
+		LibraryIndexHeader* bufferHeader = (LibraryIndexHeader*)outBuffer.data();
+		bufferHeader->checksum = LibraryIndex_Checksum(outBuffer.data() + sizeof(header), outBuffer.size() - sizeof(header));
+	}
+
+	bool LibraryIndex::Write(const std::filesystem::path& dataFilePath, std::vector<uint8_t>& buffer) {
+
+		namespace fs = std::filesystem;
+
+		if (buffer.size() < sizeof(LibraryIndexHeader))
+			return false;
+
+		LibraryIndexHeader* header = (LibraryIndexHeader*)buffer.data();
+		if (!LibraryIndex_GetDataFileStamp(dataFilePath, header->dataFileSize, header->dataFileTime))
+			return false;
+
+		fs::path indexPath = GetPathForDataFile(dataFilePath);
+		fs::path tmpPath = indexPath;
+		tmpPath += ".tmp";
+
+		{
+			std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+			file.write((const char*)buffer.data(), buffer.size());
+			if (!file) {
+				MNEMOSY_WARN("LibraryIndex::Write: Failed to write library index \nPath: {}", tmpPath.generic_string());
+				file.close();
+				std::error_code ec;
+				fs::remove(tmpPath, ec);
+				return false;
+			}
+		}
+
+		std::error_code ec;
+		fs::rename(tmpPath, indexPath, ec);
+		if (ec) {
+			MNEMOSY_WARN("LibraryIndex::Write: Failed to replace library index \nPath: {}", indexPath.generic_string());
+			fs::remove(tmpPath, ec);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool LibraryIndex::Open(const std::filesystem::path& dataFilePath) {
+
+		Close();
+
+		std::filesystem::path indexPath = GetPathForDataFile(dataFilePath);
+
+		std::error_code ec;
+		if (!std::filesystem::exists(indexPath, ec))
+			return false;
+
+		if (!m_file.Open(indexPath) || !Validate_Internal(dataFilePath)) {
+			MNEMOSY_WARN("LibraryIndex::Open: Library index is outdated or damaged, the data file is parsed instead. \nPath: {}", indexPath.generic_string());
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void LibraryIndex::Close() {
+
+		m_file.Close();
+		m_folders = nullptr;
+		m_entries = nullptr;
+		m_names = nullptr;
+		m_folderCount = 0;
+		m_entryCount = 0;
+	}
+
+	uint64_t LibraryIndex::GetJournalSequence() const {
+
+		return ((const LibraryIndexHeader*)m_file.GetData())->journalSequence;
+	}
+
+	// private
+
+	bool LibraryIndex::Validate_Internal(const std::filesystem::path& dataFilePath) {
+
+		const uint8_t* data = m_file.GetData();
+		size_t size = m_file.GetSize();
+
+		if (data == nullptr || size < sizeof(LibraryIndexHeader))
+			return false;
+
+		const LibraryIndexHeader* header = (const LibraryIndexHeader*)data;
+
+		if (memcmp(header->magic, LIBRARY_INDEX_MAGIC, sizeof(header->magic)) != 0 || header->version != LIBRARY_INDEX_VERSION)
+			return false;
+
+		uint64_t dataFileSize = 0;
+		int64_t dataFileTime = 0;
+		if (!LibraryIndex_GetDataFileStamp(dataFilePath, dataFileSize, dataFileTime))
+			return false;
+
+		if (header->dataFileSize != dataFileSize || header->dataFileTime != dataFileTime)
+			return false;
+
+		uint64_t expectedSize = sizeof(LibraryIndexHeader) + (uint64_t)header->folderCount * sizeof(LibraryIndexFolder) + (uint64_t)header->entryCount * sizeof(LibraryIndexEntry) + header->namesSize;
+		if (header->folderCount == 0 || expectedSize != size)
+			return false;
+
+		if (header->checksum != LibraryIndex_Checksum(data + sizeof(LibraryIndexHeader), size - sizeof(LibraryIndexHeader)))
+			return false;
+
+		m_folderCount = header->folderCount;
+		m_entryCount = header->entryCount;
+		m_folders = (const LibraryIndexFolder*)(data + sizeof(LibraryIndexHeader));
+		m_entries = (const LibraryIndexEntry*)((const uint8_t*)m_folders + (size_t)m_folderCount * sizeof(LibraryIndexFolder));
+		m_names = (const char*)((const uint8_t*)m_entries + (size_t)m_entryCount * sizeof(LibraryIndexEntry));
+
+		// the checksum only catches damage, the records are still checked so a bad writer can not make the loader read out of bounds
+		for (uint32_t i = 0; i < m_folderCount; i++) {
+
+			const LibraryIndexFolder& folder = m_folders[i];
+
+			if ((i != 0 && folder.parent >= i) || (uint64_t)folder.nameOffset + folder.nameLength > header->namesSize || (uint64_t)folder.firstEntry + folder.entryCount > m_entryCount)
+				return false;
+		}
+
+		for (uint32_t i = 0; i < m_entryCount; i++) {
+
+			const LibraryIndexEntry& entry = m_entries[i];
+
+			if ((uint64_t)entry.nameOffset + entry.nameLength > header->namesSize || entry.type >= (uint32_t)LibEntryType::MNSY_ETRY_TYPE_COUNT)
+				return false;
+		}
+
+		return true;
+	}
+
+} // !mnemosy::systems
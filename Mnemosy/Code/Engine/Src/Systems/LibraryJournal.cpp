@@ -0,0 +1,507 @@
+#include "Include/Systems/LibraryJournal.h"
+
+#include "Include/MnemosyEngine.h"
+#include "Include/Core/Log.h"
+#include "Include/Core/JobSystem.h"
+#include "Include/Core/Utils/StringUtils.h"
+#include "Include/Systems/JsonKeys.h"
+#include "Include/Systems/FolderTree.h"
+#include "Include/Systems/FolderTreeNode.h"
+#include "Include/Systems/LibraryIndex.h"
+
+#include <atomic>
+#include <algorithm>
+
+// number of journaled operations after which the tree is written to the data file in the background
+#define LIBRARY_JOURNAL_COMPACT_AFTER_OPERATIONS 256
+
+namespace mnemosy::systems {
+
+	struct LibraryJournal::Compaction {
+		std::unique_ptr<nlohmann::json> snapshot;
+		std::vector<uint8_t> index; // binary copy of the snapshot, written next to the data file once that is replaced
+		uint64_t sequence = 0;
+		std::filesystem::path dataFilePath;
+		std::shared_ptr<core::JobGroup> jobs; // nullptr if the compaction ran on the main thread
+		std::atomic<bool> succeeded = false;
+	};
+
+	// writes to a temporary file next to the target and renames it over the target, so the target is never half written
+	static bool LibraryJournal_WriteFileAtomic(const std::filesystem::path& filePath, const std::string& contents) {
+
+		namespace fs = std::filesystem;
+
+		fs::path tmpPath = filePath;
+		tmpPath += ".tmp";
+
+		{
+			std::ofstream tmpStream(tmpPath, std::ios::binary | std::ios::trunc);
+			tmpStream.write(contents.data(), contents.size());
+			tmpStream.flush();
+
+			if (!tmpStream.good()) {
+				MNEMOSY_ERROR("Failed to write file: {}", tmpPath.generic_string());
+				tmpStream.close();
+				std::error_code ec;
+				fs::remove(tmpPath, ec);
+				return false;
+			}
+		}
+
+		std::error_code ec;
+		fs::rename(tmpPath, filePath, ec);
+		if (ec) {
+			MNEMOSY_ERROR("Failed to replace file: {} \nError message: {}", filePath.generic_string(), ec.message());
+			fs::remove(tmpPath, ec);
+			return false;
+		}
+
+		return true;
+	}
+
+	// names of the folders from root down to the node, the root itself is not included
+	static nlohmann::json LibraryJournal_FolderPath(FolderNode* node) {
+
+		std::vector<std::string> names;
+		for (FolderNode* curr = node; !curr->IsRoot(); curr = curr->parent) {
+			names.push_back(core::StringUtils::string_fix_u8Encoding(curr->name));
+		}
+		std::reverse(names.begin(), names.end());
+
+		return names;
+	}
+
+	static FolderNode* LibraryJournal_FindSubFolder(FolderNode* node, const std::string& name) {
+
+		for (FolderNode* subNode : node->subNodes) {
+			if (subNode->name == name) {
+				return subNode;
+			}
+		}
+		return nullptr;
+	}
+
+	static FolderNode* LibraryJournal_ResolveFolderPath(FolderTree& folderTree, const nlohmann::json& pathJson) {
+
+		FolderNode* node = folderTree.GetRootPtr();
+
+		for (const nlohmann::json& name : pathJson) {
+
+			node = LibraryJournal_FindSubFolder(node, name.get<std::string>());
+			if (node == nullptr)
+				return nullptr;
+		}
+		return node;
+	}
+
+	static int LibraryJournal_FindLibEntry(FolderNode* node, const std::string& name) {
+
+		for (size_t i = 0; i < node->subEntries.size(); i++) {
+			if (node->subEntries[i]->name == name) {
+				return (int)i;
+			}
+		}
+		return -1;
+	}
+
+	// applies one journaled operation to the tree, false if the folders or entries it refers to do not exist
+	static bool LibraryJournal_Apply(FolderTree& folderTree, const nlohmann::json& operation) {
+
+		try {
+			LibraryJournalOperation op = (LibraryJournalOperation)operation[jsonJournalKey_operation].get<int>();
+			std::string name = operation[jsonJournalKey_name].get<std::string>();
+
+			FolderNode* folder = LibraryJournal_ResolveFolderPath(folderTree, operation[jsonJournalKey_folder]);
+			if (folder == nullptr)
+				return false;
+
+			switch (op) {
+
+			case MNSY_JOURNAL_OP_FOLDER_CREATE: {
+				folderTree.CreateNewFolder(folder, name);
+				return true;
+			}
+			case MNSY_JOURNAL_OP_FOLDER_RENAME: {
+				FolderNode* node = LibraryJournal_FindSubFolder(folder, name);
+				if (node == nullptr)
+					return false;
+
+				folderTree.RenameFolder(node, operation[jsonJournalKey_newName].get<std::string>());
+				return true;
+			}
+			case MNSY_JOURNAL_OP_FOLDER_MOVE: {
+				FolderNode* node = LibraryJournal_FindSubFolder(folder, name);
+				FolderNode* target = LibraryJournal_ResolveFolderPath(folderTree, operation[jsonJournalKey_target]);
+				if (node == nullptr || target == nullptr)
+					return false;
+
+				folderTree.MoveFolder(node, target);
+				return true;
+			}
+			case MNSY_JOURNAL_OP_FOLDER_DELETE: {
+				FolderNode* node = LibraryJournal_FindSubFolder(folder, name);
+				if (node == nullptr)
+					return false;
+
+				folderTree.DeleteFolderHierarchy(node);
+				return true;
+			}
+			case MNSY_JOURNAL_OP_ENTRY_CREATE: {
+				folderTree.CreateNewLibEntry(folder, (LibEntryType)operation[jsonJournalKey_entryType].get<int>(), name);
+				return true;
+			}
+			case MNSY_JOURNAL_OP_ENTRY_RENAME: {
+				int position = LibraryJournal_FindLibEntry(folder, name);
+				if (position == -1)
+					return false;
+
+				folderTree.RenameLibEntry(folder->subEntries[position], operation[jsonJournalKey_newName].get<std::string>());
+				return true;
+			}
+			case MNSY_JOURNAL_OP_ENTRY_MOVE: {
+				int position = LibraryJournal_FindLibEntry(folder, name);
+				FolderNode* target = LibraryJournal_ResolveFolderPath(folderTree, operation[jsonJournalKey_target]);
+				if (position == -1 || target == nullptr)
+					return false;
+
+				folderTree.MoveLibEntry(folder->subEntries[position], folder, target);
+				return true;
+			}
+			case MNSY_JOURNAL_OP_ENTRY_DELETE: {
+				int position = LibraryJournal_FindLibEntry(folder, name);
+				if (position == -1)
+					return false;
+
+				folderTree.DeleteLibEntry(folder, (unsigned int)position);
+				return true;
+			}
+			default:
+				break;
+			}
+		}
+		catch (nlohmann::json::exception err) {
+			MNEMOSY_WARN("Invalid library journal operation. Message: {}", err.what());
+		}
+
+		return false;
+	}
+
+	void LibraryJournal::Open(const std::filesystem::path& dataFilePath, FolderTree& folderTree, const uint64_t dataFileSequence) {
+
+		namespace fs = std::filesystem;
+
+		Close();
+
+		m_dataFilePath = dataFilePath;
+		m_journalFilePath = dataFilePath;
+		m_journalFilePath.replace_extension(".mnsyjournal");
+
+		m_sequence = dataFileSequence;
+		m_compactAfterOperations = LIBRARY_JOURNAL_COMPACT_AFTER_OPERATIONS;
+
+		unsigned int replayedCount = 0;
+		unsigned int skippedCount = 0;
+
+		if (fs::exists(m_journalFilePath)) {
+
+			std::ifstream journalStream(m_journalFilePath, std::ios::binary);
+
+			std::string line;
+			while (std::getline(journalStream, line)) {
+
+				if (line.empty())
+					continue;
+
+				// a line that was cut off by a crash does not parse, later lines were appended after a restart and are still valid
+				nlohmann::json operation = nlohmann::json::parse(line, nullptr, false);
+				if (operation.is_discarded() || !operation.contains(jsonJournalKey_sequence) || !operation[jsonJournalKey_sequence].is_number_unsigned()) {
+					skippedCount++;
+					continue;
+				}
+
+				uint64_t sequence = operation[jsonJournalKey_sequence].get<uint64_t>();
+				if (sequence <= dataFileSequence)
+					continue; // already contained in the data file
+
+				m_sequence = std::max(m_sequence, sequence);
+
+				if (!LibraryJournal_Apply(folderTree, operation)) {
+					skippedCount++;
+					continue;
+				}
+
+				m_pendingOperations.push_back({ sequence, line });
+				replayedCount++;
+			}
+		}
+
+		if (replayedCount > 0) {
+			MNEMOSY_INFO("Replayed {} library changes from journal: {}", replayedCount, m_journalFilePath.generic_string());
+		}
+		if (skippedCount > 0) {
+			MNEMOSY_WARN("Skipped {} unreadable or outdated library changes in journal: {}", skippedCount, m_journalFilePath.generic_string());
+		}
+
+		// drops operations the data file already contains and lines that could not be replayed
+		RewriteJournalFile_Internal();
+	}
+
+	void LibraryJournal::Close() {
+
+		FinishCompaction_Internal();
+
+		if (m_journalStream.is_open()) {
+			m_journalStream.close();
+		}
+
+		m_dataFilePath.clear();
+		m_journalFilePath.clear();
+		m_pendingOperations.clear();
+		m_sequence = 0;
+	}
+
+	void LibraryJournal::Update(FolderTree& folderTree) {
+
+		if (!IsOpen())
+			return;
+
+		if (m_compaction) {
+
+			if (m_compaction->jobs->IsDone()) {
+				FinishCompaction_Internal();
+			}
+			return;
+		}
+
+		if (!m_pendingOperations.empty() && m_pendingOperations.size() >= m_compactAfterOperations) {
+			StartCompaction_Internal(folderTree, false);
+		}
+	}
+
+	bool LibraryJournal::Compact(FolderTree& folderTree) {
+
+		if (!IsOpen())
+			return false;
+
+		FinishCompaction_Internal();
+
+		// the data file is up to date already
+		if (m_pendingOperations.empty() && std::filesystem::exists(m_dataFilePath))
+			return true;
+
+		StartCompaction_Internal(folderTree, true);
+		return FinishCompaction_Internal();
+	}
+
+	void LibraryJournal::FolderCreated(FolderNode* node) {
+
+		nlohmann::json operation;
+		operation[jsonJournalKey_operation] = (int)MNSY_JOURNAL_OP_FOLDER_CREATE;
+		operation[jsonJournalKey_folder] = LibraryJournal_FolderPath(node->parent);
+		operation[jsonJournalKey_name] = core::StringUtils::string_fix_u8Encoding(node->name);
+		Append_Internal(operation);
+	}
+
+	void LibraryJournal::FolderRenamed(FolderNode* node, const std::string& oldName) {
+
+		std::string name = oldName;
+
+		nlohmann::json operation;
+		operation[jsonJournalKey_operation] = (int)MNSY_JOURNAL_OP_FOLDER_RENAME;
+		operation[jsonJournalKey_folder] = LibraryJournal_FolderPath(node->parent);
+		operation[jsonJournalKey_name] = core::StringUtils::string_fix_u8Encoding(name);
+		operation[jsonJournalKey_newName] = core::StringUtils::string_fix_u8Encoding(node->name);
+		Append_Internal(operation);
+	}
+
+	void LibraryJournal::FolderMoved(FolderNode* node, FolderNode* oldParent) {
+
+		nlohmann::json operation;
+		operation[jsonJournalKey_operation] = (int)MNSY_JOURNAL_OP_FOLDER_MOVE;
+		operation[jsonJournalKey_folder] = LibraryJournal_FolderPath(oldParent);
+		operation[jsonJournalKey_name] = core::StringUtils::string_fix_u8Encoding(node->name);
+		operation[jsonJournalKey_target] = LibraryJournal_FolderPath(node->parent);
+		Append_Internal(operation);
+	}
+
+	void LibraryJournal::FolderDeleted(FolderNode* node) {
+
+		nlohmann::json operation;
+		operation[jsonJournalKey_operation] = (int)MNSY_JOURNAL_OP_FOLDER_DELETE;
+		operation[jsonJournalKey_folder] = LibraryJournal_FolderPath(node->parent);
+		operation[jsonJournalKey_name] = core::StringUtils::string_fix_u8Encoding(node->name);
+		Append_Internal(operation);
+	}
+
+	void LibraryJournal::LibEntryCreated(LibEntry* libEntry) {
+
+		nlohmann::json operation;
+		operation[jsonJournalKey_operation] = (int)MNSY_JOURNAL_OP_ENTRY_CREATE;
+		operation[jsonJournalKey_folder] = LibraryJournal_FolderPath(libEntry->parent);
+		operation[jsonJournalKey_name] = core::StringUtils::string_fix_u8Encoding(libEntry->name);
+		operation[jsonJournalKey_entryType] = (int)libEntry->type;
+		Append_Internal(operation);
+	}
+
+	void LibraryJournal::LibEntryRenamed(LibEntry* libEntry, const std::string& oldName) {
+
+		std::string name = oldName;
+
+		nlohmann::json operation;
+		operation[jsonJournalKey_operation] = (int)MNSY_JOURNAL_OP_ENTRY_RENAME;
+		operation[jsonJournalKey_folder] = LibraryJournal_FolderPath(libEntry->parent);
+		operation[jsonJournalKey_name] = core::StringUtils::string_fix_u8Encoding(name);
+		operation[jsonJournalKey_newName] = core::StringUtils::string_fix_u8Encoding(libEntry->name);
+		Append_Internal(operation);
+	}
+
+	void LibraryJournal::LibEntryMoved(LibEntry* libEntry, FolderNode* oldParent) {
+
+		nlohmann::json operation;
+		operation[jsonJournalKey_operation] = (int)MNSY_JOURNAL_OP_ENTRY_MOVE;
+		operation[jsonJournalKey_folder] = LibraryJournal_FolderPath(oldParent);
+		operation[jsonJournalKey_name] = core::StringUtils::string_fix_u8Encoding(libEntry->name);
+		operation[jsonJournalKey_target] = LibraryJournal_FolderPath(libEntry->parent);
+		Append_Internal(operation);
+	}
+
+	void LibraryJournal::LibEntryDeleted(LibEntry* libEntry) {
+
+		nlohmann::json operation;
+		operation[jsonJournalKey_operation] = (int)MNSY_JOURNAL_OP_ENTRY_DELETE;
+		operation[jsonJournalKey_folder] = LibraryJournal_FolderPath(libEntry->parent);
+		operation[jsonJournalKey_name] = core::StringUtils::string_fix_u8Encoding(libEntry->name);
+		Append_Internal(operation);
+	}
+
+	// private
+
+	void LibraryJournal::Append_Internal(nlohmann::json& operation) {
+
+		if (!IsOpen())
+			return;
+
+		operation[jsonJournalKey_sequence] = m_sequence + 1;
+
+		std::string line;
+		try {
+			line = operation.dump(-1);
+		}
+		catch (nlohmann::json::type_error err) {
+			MNEMOSY_ERROR("Failed to journal library change. Message: {}", err.what());
+			return;
+		}
+
+		m_sequence++;
+		m_pendingOperations.push_back({ m_sequence, line });
+
+		m_journalStream << line << '\n';
+		m_journalStream.flush();
+
+		if (!m_journalStream.good()) {
+			// the change is still in memory, get it into the data file as soon as possible
+			MNEMOSY_ERROR("Failed to write library journal: {}", m_journalFilePath.generic_string());
+			m_compactAfterOperations = m_pendingOperations.size();
+		}
+	}
+
+	void LibraryJournal::StartCompaction_Internal(FolderTree& folderTree, const bool runOnThisThread) {
+
+		std::shared_ptr<Compaction> compaction = std::make_shared<Compaction>();
+		compaction->snapshot.reset(folderTree.WriteToJson());
+		(*compaction->snapshot)[jsonLibKey_JournalSequence] = m_sequence;
+		LibraryIndex::Build(folderTree.GetRootPtr(), m_sequence, compaction->index);
+		compaction->sequence = m_sequence;
+		compaction->dataFilePath = m_dataFilePath;
+
+		m_compaction = compaction;
+
+		if (runOnThisThread) {
+			WriteSnapshot_Internal(*compaction);
+			return;
+		}
+
+		compaction->jobs = core::JobSystem::CreateGroup();
+		MnemosyEngine::GetInstance().GetJobSystem().Submit(compaction->jobs, [compaction]() {
+
+			WriteSnapshot_Internal(*compaction);
+
+		}, core::MNSY_JOB_PRIORITY_LOW);
+	}
+
+	bool LibraryJournal::FinishCompaction_Internal() {
+
+		if (!m_compaction)
+			return true;
+
+		if (m_compaction->jobs) {
+			MnemosyEngine::GetInstance().GetJobSystem().Wait(m_compaction->jobs);
+		}
+
+		bool succeeded = m_compaction->succeeded;
+		uint64_t sequence = m_compaction->sequence;
+		m_compaction = nullptr;
+
+		if (!succeeded) {
+			// the operations stay in the journal, try again after some more
+			m_compactAfterOperations = m_pendingOperations.size() + LIBRARY_JOURNAL_COMPACT_AFTER_OPERATIONS;
+			return false;
+		}
+
+		m_compactAfterOperations = LIBRARY_JOURNAL_COMPACT_AFTER_OPERATIONS;
+
+		// operations made while the snapshot was written are newer than it and have to stay
+		m_pendingOperations.erase(std::remove_if(m_pendingOperations.begin(), m_pendingOperations.end(), [sequence](const PendingOperation& op) { return op.sequence <= sequence; }), m_pendingOperations.end());
+
+		RewriteJournalFile_Internal();
+		return true;
+	}
+
+	bool LibraryJournal::RewriteJournalFile_Internal() {
+
+		if (m_journalStream.is_open()) {
+			m_journalStream.close();
+		}
+
+		std::string contents;
+		for (const PendingOperation& op : m_pendingOperations) {
+			contents += op.line;
+			contents += '\n';
+		}
+
+		// if this fails the old journal stays, its outdated operations are skipped on the next load
+		bool success = LibraryJournal_WriteFileAtomic(m_journalFilePath, contents);
+
+		m_journalStream.open(m_journalFilePath, std::ios::binary | std::ios::app);
+		if (!m_journalStream.is_open()) {
+			MNEMOSY_ERROR("Failed to open library journal: {}", m_journalFilePath.generic_string());
+			m_compactAfterOperations = 0;
+		}
+
+		return success;
+	}
+
+	void LibraryJournal::WriteSnapshot_Internal(Compaction& compaction) {
+
+		std::string contents;
+		try {
+			contents = compaction.snapshot->dump(-1);
+		}
+		catch (nlohmann::json::type_error err) {
+			MNEMOSY_ERROR("Failed to save Library data file correctly. Message: {}", err.what());
+			compaction.snapshot = nullptr;
+			return;
+		}
+		compaction.snapshot = nullptr;
+
+		compaction.succeeded = LibraryJournal_WriteFileAtomic(compaction.dataFilePath, contents);
+
+		// without an index the next load parses the data file and writes a new one
+		if (compaction.succeeded) {
+			LibraryIndex::Write(compaction.dataFilePath, compaction.index);
+		}
+		compaction.index.clear();
+		compaction.index.shrink_to_fit();
+	}
+
+} // !mnemosy::systems
@@ -4,6 +4,7 @@
 #include "Include/Core/Log.h"
 #include "Include/Core/FileDirectories.h"
 #include "Include/Core/Utils/StringUtils.h"
+#include "Include/Core/JobSystem.h"
 
 #include "Include/Graphics/Utils/Picture.h"
 #include "Include/Graphics/Utils/KtxImage.h"
@@ -12,6 +13,7 @@
 #include "Include/Graphics/Material.h"
 #include "Include/Graphics/Skybox.h"
 #include "Include/Graphics/Cubemap.h"
+#include "Include/Graphics/TextureUploader.h"
 
 #include "Include/Systems/MaterialLibraryRegistry.h"
 #include "Include/Systems/FolderTreeNode.h"
@@ -19,7 +21,14 @@
 
 #include <json.hpp>
 #include <fstream>
-#include <thread>
+#include <algorithm>
+#include <stdio.h>
+
+// longest side of the preview level that is uploaded first while a texture streams in
+#define LIBPROCEDURES_STREAMING_PREVIEW_SIZE 512
+// the source stamp of the mip chain cache hashes this many blocks spread over the texture file, files up to their total size are hashed completely
+#define LIBPROCEDURES_STAMP_HASH_BLOCK_COUNT 16
+#define LIBPROCEDURES_STAMP_HASH_BLOCK_SIZE 4096
 
 
 namespace mnemosy::systems {
@@ -214,7 +223,7 @@ void LibProcedures::LibEntry_SkyboxMaterial_CreateNewDataFile( systems::LibEntry
 	file.FileClose(success, dataFilePath);
 }
 
-void LibProcedures::LibEntry_PbrMaterial_SaveToFile( systems::LibEntry* libEntry, graphics::PbrMaterial* pbrMat, bool prettyPrint)
+void LibProcedures::LibEntry_PbrMaterial_SaveToFile( systems::LibEntry* libEntry, graphics::PbrMaterial* pbrMat, const PbrMaterialLoadState* loadState, bool prettyPrint)
 {
 	namespace fs = std::filesystem;
 
@@ -278,6 +287,11 @@ void LibProcedures::LibEntry_PbrMaterial_SaveToFile( systems::LibEntry* libEntry
 
 		bool textureTypeIsAssigned = pbrMat->IsTextureTypeAssigned(currentTextureType);
 
+		// a texture that is still loading is not assigned to the material yet but it is on disk
+		if (loadState && loadState->pending[i]) {
+			textureTypeIsAssigned = true;
+		}
+
 		std::string jsonMatKey_path_ofTextureType = graphics::TexUtil::get_JsonMatKey_path_from_PBRTextureType(currentTextureType);
 		std::string jsonMatKey_assigned_ofTextureType = graphics::TexUtil::get_JsonMatKey_assigned_from_PBRTextureType(currentTextureType);
 
@@ -733,229 +747,469 @@ void LibProcedures::LibEntry_SkyboxMaterial_RenameFiles(LibEntry* libEntry, std:
 }
 
 
-graphics::PbrMaterial* LibProcedures::LibEntry_PbrMaterial_LoadFromFile_Multithreaded(systems::LibEntry* libEntry, bool prettyPrint)
-{
-	namespace fs = std::filesystem;
+PbrMaterialLoadState::~PbrMaterialLoadState() {
 
+	graphics::TextureUploader& uploader = MnemosyEngine::GetInstance().GetTextureUploader();
 
-	// load json file
-	fs::path materialDir = LibProcedures::LibEntry_GetFolderPath(libEntry);
-	fs::path dataFile = LibProcedures::LibEntry_GetDataFilePath(libEntry);
-	std::string entryName = libEntry->name;
+	// free what was decoded but never uploaded, e.g. when the load got cancelled
+	for (int i = 0; i < graphics::PBRTextureType::MNSY_TEXTURE_COUNT; i++) {
+		uploader.ReleaseStaging(uploads[i].staging);
+		if (uploads[i].info.pixels) {
+			free(uploads[i].info.pixels);
+			uploads[i].info.pixels = nullptr;
+		}
+		if (previews[i].pixels) {
+			free(previews[i].pixels);
+			previews[i].pixels = nullptr;
+		}
+	}
+}
 
-	bool success = false;
+// 64 bit FNV-1a
+static uint64_t PbrMaterialLoadState_Hash(uint64_t hash, const void* data, const size_t size) {
 
-	flcrm::JsonSettings matFile;
-	matFile.FileOpen(success, dataFile, jsonKey_header, jsonMatKey_description);
-	if (!success) {
-		MNEMOSY_WARN("Error opening data file: {} \nMessage: {}", dataFile.generic_string(), matFile.ErrorStringLastGet());
+	const uint8_t* bytes = (const uint8_t*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
 	}
+	return hash;
+}
 
+// Hashes blocks spread evenly over the file, the first and the last one included. Reading all of a large texture would cost about as much as decoding it,
+// the blocks are enough to tell apart a file that was replaced while keeping its size and write time, e.g. by a copy tool or a checkout.
+static bool PbrMaterialLoadState_ContentHash(const std::filesystem::path& path, const uintmax_t fileSize, uint64_t& outHash) {
 
-	// Check if all channelpacked textures still exist at their location. if not update the material file
-	{
-		bool hasChannelPacked = matFile.ReadBool(success, jsonMatKey_hasChannelPacked, false, false);
-		if (hasChannelPacked) {
-			std::vector<std::string> packSuffixes = matFile.ReadVectorString(success, jsonMatKey_packedSuffixes, std::vector<std::string>(), false);
-			if (!packSuffixes.empty()) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
 
-				std::vector<std::string> packSuffixesCopy;
-				for (int i = 0; i < packSuffixes.size(); i++) {
+	uint64_t hash = 14695981039346656037ull;
 
-					fs::path packedTexPath = materialDir / fs::u8path(libEntry->name + packSuffixes[i] + ".tif");
+	const uint64_t blockSize = LIBPROCEDURES_STAMP_HASH_BLOCK_SIZE;
+	const uint64_t blockCount = LIBPROCEDURES_STAMP_HASH_BLOCK_COUNT;
 
-					if (fs::exists(packedTexPath)) {
+	if (fileSize <= blockSize * blockCount) {
 
-						packSuffixesCopy.push_back(packSuffixes[i]);
-					}
-				}
+		std::vector<char> content((size_t)fileSize);
+		file.read(content.data(), content.size());
+		if (!file)
+			return false;
 
-				if (!packSuffixesCopy.empty()) {
-					matFile.WriteVectorString(success, jsonMatKey_packedSuffixes, packSuffixesCopy);
+		hash = PbrMaterialLoadState_Hash(hash, content.data(), content.size());
+	}
+	else {
 
-					packSuffixesCopy.clear();
-				}
-				else {
-					matFile.WriteBool(success, jsonMatKey_hasChannelPacked, false);
-					matFile.EntryErase(success, jsonMatKey_packedSuffixes);
-				}
+		std::vector<char> block((size_t)blockSize);
 
-			}
-			else {
-				matFile.WriteBool(success, jsonMatKey_hasChannelPacked, false);
-			}
+		for (uint64_t i = 0; i < blockCount; i++) {
 
-			packSuffixes.clear();
+			file.seekg((std::streamoff)((fileSize - blockSize) * i / (blockCount - 1)));
+			file.read(block.data(), block.size());
+			if (!file)
+				return false;
+
+			hash = PbrMaterialLoadState_Hash(hash, block.data(), block.size());
 		}
 	}
 
-	// First kick off a thread for each assigned texture to load
+	outHash = hash;
+	return true;
+}
 
-	// Start a thread for each assigned texture to load it into memory of PictureInfo struct.
-	// Then join threads upload to openGl on the main thread.
-	// openGl calls must all be from the main thread so we have to do it like this
-	// also check if the textture files actually exist and update acordingly.
+// Every part is written as 16 hex digits so all stamps have the same length.
+std::string LibProcedures::PbrMaterial_GetTextureSourceStamp(const std::filesystem::path& path) {
 
-	// Albedo Map
-	bool albedoAssigned = matFile.ReadBool(success, jsonMatKey_albedoAssigned, false, false);
+	namespace fs = std::filesystem;
 
-	std::thread thread_load_albedo;
-	graphics::PictureError albedo_picErr;
-	graphics::PictureInfo albedo_picInfo;
-	if (albedoAssigned) {
+	std::error_code ec;
 
-		fs::path path = materialDir / fs::u8path(entryName + texture_fileSuffix_albedo);
+	uintmax_t fileSize = fs::file_size(path, ec);
+	if (ec)
+		return std::string();
 
-		if (!fs::exists(path)) {
-			matFile.WriteString(success, jsonMatKey_albedoPath, jsonKey_pathNotAssigned);
-			matFile.WriteBool(success, jsonMatKey_albedoAssigned, false);
-			albedoAssigned = false;
-		}
-		else {
-			thread_load_albedo = std::thread(&graphics::Picture::ReadPicture_PbrThreaded, std::ref(albedo_picErr), std::ref(albedo_picInfo), path.generic_string(), true, graphics::PBRTextureType::MNSY_TEXTURE_ALBEDO);
-		}
-	}
+	fs::file_time_type writeTime = fs::last_write_time(path, ec);
+	if (ec)
+		return std::string();
 
+	uint64_t contentHash = 0;
+	if (!PbrMaterialLoadState_ContentHash(path, fileSize, contentHash))
+		return std::string();
 
-	// Roughness Map
-	bool roughnessAssigned = matFile.ReadBool(success, jsonMatKey_roughAssigned, false, false);
-	graphics::PictureError roughness_picErr;
-	graphics::PictureInfo roughness_picInfo;
-	std::thread thread_load_roughness;
+	char stamp[64];
+	snprintf(stamp, sizeof(stamp), "v2_%016llx_%016llx_%016llx", (unsigned long long)fileSize, (unsigned long long)writeTime.time_since_epoch().count(), (unsigned long long)contentHash);
 
-	if (roughnessAssigned) {
+	return std::string(stamp);
+}
 
-		fs::path path = materialDir / fs::u8path(entryName + texture_fileSuffix_roughness);
+// returns info followed by all its mip levels down to 1x1. Empty if we ran out of memory.
+std::vector<graphics::PictureInfo> PbrMaterialLoadState_BuildMipChain(const graphics::PictureInfo& info) {
 
-		if (!fs::exists(path)) {
-			matFile.WriteString(success, jsonMatKey_roughPath, jsonKey_pathNotAssigned);
-			matFile.WriteBool(success, jsonMatKey_roughAssigned, false);
-			roughnessAssigned = false;
-		}
-		else {
-			thread_load_roughness = std::thread(&graphics::Picture::ReadPicture_PbrThreaded, std::ref(roughness_picErr), std::ref(roughness_picInfo), path.generic_string(), true, graphics::PBRTextureType::MNSY_TEXTURE_ROUGHNESS);
+	std::vector<graphics::PictureInfo> levels;
+	levels.push_back(info);
+
+	while (levels.back().width > 1 || levels.back().height > 1) {
+
+		graphics::PictureError mipErr;
+		graphics::PictureInfo level = graphics::Picture::pic_util_next_mip_level(mipErr, levels.back());
+		if (!mipErr.wasSuccessfull) {
+
+			for (size_t i = 1; i < levels.size(); i++) {
+				free(levels[i].pixels);
+			}
+			return std::vector<graphics::PictureInfo>();
 		}
+
+		levels.push_back(level);
 	}
 
-	// Metallic Map
-	bool metallicAssigned = matFile.ReadBool(success, jsonMatKey_metalAssigned, false, false);
-	graphics::PictureError metallic_picErr;
-	graphics::PictureInfo  metallic_picInfo;
-	std::thread thread_load_metallic;
-	if (metallicAssigned) {
+	return levels;
+}
+
+// runs on a job thread. loads the mip chain of one slot from the cache or decodes the texture file and builds it, applies the resolution limit,
+// extracts the preview level and stages the pixels for upload.
+void PbrMaterialLoadState_DecodeSlot(PbrMaterialLoadState& state, const int slot, const std::filesystem::path& path, const std::filesystem::path& cachePath) {
+
+	graphics::PBRTextureType type = (graphics::PBRTextureType)slot;
+	graphics::TextureUpload& upload = state.uploads[slot];
+	graphics::PictureInfo& info = upload.info;
+
+	std::string sourceStamp = LibProcedures::PbrMaterial_GetTextureSourceStamp(path);
 
-		fs::path path = materialDir / fs::u8path(entryName + texture_fileSuffix_metallic);
+	graphics::TextureUploader& uploader = MnemosyEngine::GetInstance().GetTextureUploader();
 
-		if (!fs::exists(path)) {
-			matFile.WriteString(success, jsonMatKey_metalPath, jsonKey_pathNotAssigned);
-			matFile.WriteBool(success, jsonMatKey_metalAssigned, false);
-			metallicAssigned = false;
+	// levels built from the texture file, kept until the function returns so the preview can be taken from them
+	std::shared_ptr<std::vector<graphics::PictureInfo>> builtLevels;
+	size_t builtFirstLevel = 0;
+
+	// the cached levels are read straight into the upload ring if it has space
+	graphics::KtxImage cache;
+	bool isCached = false;
+
+	if (!sourceStamp.empty() && cache.OpenMipChain(cachePath.generic_string().c_str(), sourceStamp, state.maxResolution, info, upload.mipLevels)) {
+
+		size_t chainSize = graphics::Picture::pic_util_mip_chain_size(info, upload.mipLevels);
+
+		if (uploader.TryAllocateStaging(chainSize, upload.staging)) {
+
+			isCached = cache.ReadMipLevels(upload.staging.data, 0, upload.mipLevels);
+			if (!isCached) {
+				uploader.ReleaseStaging(upload.staging);
+			}
 		}
 		else {
-			thread_load_metallic = std::thread(&graphics::Picture::ReadPicture_PbrThreaded, std::ref(metallic_picErr), std::ref(metallic_picInfo), path.generic_string(), true, graphics::PBRTextureType::MNSY_TEXTURE_METALLIC);
+
+			info.pixels = malloc(chainSize);
+			isCached = info.pixels && cache.ReadMipLevels(info.pixels, 0, upload.mipLevels);
+			if (!isCached) {
+				free(info.pixels);
+				info.pixels = nullptr;
+			}
 		}
 	}
 
-	// Emissive Map
-	bool emissiveAssigned = matFile.ReadBool(success, jsonMatKey_emissionAssigned, false, false);
-	graphics::PictureError emissive_picErr;
-	graphics::PictureInfo  emissive_picInfo;
-	std::thread thread_load_emissive;
-	if (emissiveAssigned) {
+	if (isCached) {
 
-		fs::path path = materialDir / fs::u8path(entryName + texture_fileSuffix_emissive);
+		state.errors[slot] = graphics::PictureError(true, "");
+		state.sourceWidth[slot] = cache.width;
+		state.sourceHeight[slot] = cache.height;
+	}
+	else {
+
+		upload.mipLevels = 1;
+
+		// files that store a reduced level next to the full resolution give the preview without decoding everything first.
+		// For all others the preview is taken from the mip chain or downscaled further down.
+		{
+			bool convertGrayToRGB = type == graphics::PBRTextureType::MNSY_TEXTURE_ALBEDO || type == graphics::PBRTextureType::MNSY_TEXTURE_EMISSION;
+
+			graphics::PictureError previewErr;
+			uint16_t fullWidth = 0;
+			uint16_t fullHeight = 0;
+			graphics::PictureInfo preview = graphics::Picture::ReadPictureReduced(previewErr, path.generic_string().c_str(), true, convertGrayToRGB, false, LIBPROCEDURES_STREAMING_PREVIEW_SIZE, fullWidth, fullHeight);
 
-		if (!fs::exists(path)) {
-			matFile.WriteString(success, jsonMatKey_emissionPath, jsonKey_pathNotAssigned);
-			matFile.WriteBool(success, jsonMatKey_emissionAssigned, false);
-			emissiveAssigned = false;
+			if (previewErr.wasSuccessfull) {
+
+				if (std::max(fullWidth, fullHeight) > LIBPROCEDURES_STREAMING_PREVIEW_SIZE) {
+					state.previews[slot] = preview;
+					state.sourceWidth[slot] = fullWidth;
+					state.sourceHeight[slot] = fullHeight;
+					state.previewDecoded[slot] = true;
+				}
+				else {
+					free(preview.pixels);
+				}
+			}
 		}
-		else {
-			thread_load_emissive = std::thread(&graphics::Picture::ReadPicture_PbrThreaded, std::ref(emissive_picErr), std::ref(emissive_picInfo), path.generic_string(), true, graphics::PBRTextureType::MNSY_TEXTURE_EMISSION);
+
+		graphics::Picture::ReadPicture_PbrThreaded(state.errors[slot], info, path.generic_string(), true, type);
+		if (!state.errors[slot].wasSuccessfull) {
+			state.decoded[slot] = true;
+			return;
 		}
 
-	}
+		// the main thread may already read them for the preview
+		if (!state.previewDecoded[slot]) {
+			state.sourceWidth[slot] = info.width;
+			state.sourceHeight[slot] = info.height;
+		}
 
-	// Normal Map
-	bool normalAssigned = matFile.ReadBool(success, jsonMatKey_normalAssigned, false, false);
-	graphics::PictureError normal_picErr;
-	graphics::PictureInfo  normal_picInfo;
+		std::vector<graphics::PictureInfo> levels = PbrMaterialLoadState_BuildMipChain(info);
+		if (levels.empty()) {
 
-	std::thread thread_load_normal;
-	if (normalAssigned) {
-		
-		fs::path path = materialDir / fs::u8path(entryName + texture_fileSuffix_normal);
+			// not enough memory for the mip chain, upload the picture on its own and let the gpu build the levels
+			if (state.maxResolution != 0 && std::max(info.width, info.height) > state.maxResolution) {
 
-		if (!fs::exists(path)) {
-			matFile.WriteString(success, jsonMatKey_normalPath, jsonKey_pathNotAssigned);
-			matFile.WriteBool(success, jsonMatKey_normalAssigned, false);
-			normalAssigned = false;
+				graphics::PictureError downscaleErr;
+				graphics::PictureInfo downscaled = graphics::Picture::pic_util_downscale(downscaleErr, info, state.maxResolution);
+				if (downscaleErr.wasSuccessfull) {
+					free(info.pixels);
+					info = downscaled;
+				}
+			}
 		}
 		else {
-			thread_load_normal = std::thread(&graphics::Picture::ReadPicture_PbrThreaded, std::ref(normal_picErr), std::ref(normal_picInfo), path.generic_string(), true, graphics::PBRTextureType::MNSY_TEXTURE_NORMAL);
-		}
 
+			size_t firstLevel = 0;
+			while (state.maxResolution != 0 && std::max(levels[firstLevel].width, levels[firstLevel].height) > state.maxResolution && firstLevel + 1 < levels.size()) {
+				firstLevel++;
+			}
+
+			uint32_t mipLevels = (uint32_t)(levels.size() - firstLevel);
+			size_t chainSize = graphics::Picture::pic_util_mip_chain_size(levels[firstLevel], mipLevels);
+
+			// the chain is put together straight in the upload ring if it has space
+			uint8_t* chain = nullptr;
+			if (uploader.TryAllocateStaging(chainSize, upload.staging)) {
+				chain = (uint8_t*)upload.staging.data;
+			}
+			else {
+				chain = (uint8_t*)malloc(chainSize);
+			}
+
+			if (chain) {
+
+				size_t offset = 0;
+				for (size_t i = firstLevel; i < levels.size(); i++) {
+
+					size_t levelSize = graphics::Picture::pic_util_mip_chain_size(levels[i], 1);
+					memcpy(chain + offset, levels[i].pixels, levelSize);
+					offset += levelSize;
+				}
+
+				info = levels[firstLevel];
+				info.pixels = upload.staging.IsValid() ? nullptr : chain;
+				upload.mipLevels = mipLevels;
+				builtFirstLevel = firstLevel;
+			}
+			else {
+				state.errors[slot] = graphics::PictureError(false, "Not enough memory to load texture.");
+				info = graphics::PictureInfo();
+			}
+
+			// the cache is not needed to show the material, a background job writes it and frees the levels afterwards
+			std::shared_ptr<std::vector<graphics::PictureInfo>> cacheLevels(new std::vector<graphics::PictureInfo>(std::move(levels)), [](std::vector<graphics::PictureInfo>* levels) {
+				for (graphics::PictureInfo& level : *levels) {
+					free(level.pixels);
+				}
+				delete levels;
+			});
+			builtLevels = cacheLevels;
+
+			if (!sourceStamp.empty()) {
+
+				MnemosyEngine::GetInstance().GetJobSystem().Submit([cacheLevels, cachePath, sourceStamp]() {
+
+					std::error_code ec;
+					std::filesystem::create_directories(cachePath.parent_path(), ec);
+
+					graphics::KtxImage cacheFile;
+					cacheFile.SaveMipChain(cachePath.generic_string().c_str(), *cacheLevels, sourceStamp);
+
+				}, core::MNSY_JOB_PRIORITY_LOW);
+			}
+
+			if (!state.errors[slot].wasSuccessfull) {
+				state.decoded[slot] = true;
+				return;
+			}
+		}
 	}
 
-	// AO map
-	bool aoAssigned = matFile.ReadBool(success, jsonMatKey_aoAssigned, false, false);
-	graphics::PictureError ao_picErr;
-	graphics::PictureInfo  ao_picInfo;
-	std::thread thread_load_ao;
-	if (aoAssigned) {
+	if (!state.previewDecoded[slot] && std::max(info.width, info.height) > LIBPROCEDURES_STREAMING_PREVIEW_SIZE) {
+
+		if (upload.mipLevels > 1) {
+
+			// the preview is just the first level of the chain that is small enough
+			graphics::PictureInfo level = info;
+			size_t offset = 0;
+			uint32_t previewLevel = 0;
+
+			for (uint32_t i = 1; i < upload.mipLevels && std::max(level.width, level.height) > LIBPROCEDURES_STREAMING_PREVIEW_SIZE; i++) {
+				offset += graphics::Picture::pic_util_mip_chain_size(level, 1);
+				level.width = (uint16_t)std::max(level.width / 2, 1);
+				level.height = (uint16_t)std::max(level.height / 2, 1);
+				previewLevel = i;
+			}
 
-		fs::path path = materialDir / fs::u8path(entryName + texture_fileSuffix_ambientOcclusion);
+			size_t levelSize = graphics::Picture::pic_util_mip_chain_size(level, 1);
+			level.pixels = malloc(levelSize);
+			if (level.pixels) {
 
-		if (!fs::exists(path)) {
-			matFile.WriteString(success, jsonMatKey_aoPath, jsonKey_pathNotAssigned);
-			matFile.WriteBool(success, jsonMatKey_aoAssigned, false);
-			aoAssigned = false;
+				// the upload ring is mapped write only, staged levels are taken from where they were staged from instead
+				bool copied = true;
+				if (info.pixels) {
+					memcpy(level.pixels, (uint8_t*)info.pixels + offset, levelSize);
+				}
+				else if (isCached) {
+					copied = cache.ReadMipLevels(level.pixels, previewLevel, 1);
+				}
+				else {
+					memcpy(level.pixels, (*builtLevels)[builtFirstLevel + previewLevel].pixels, levelSize);
+				}
+
+				if (copied) {
+					state.previews[slot] = level;
+				}
+				else {
+					free(level.pixels);
+				}
+			}
 		}
-		else {
-			thread_load_ao = std::thread(&graphics::Picture::ReadPicture_PbrThreaded, std::ref(ao_picErr), std::ref(ao_picInfo), path.generic_string(), true, graphics::PBRTextureType::MNSY_TEXTURE_AMBIENTOCCLUSION);
+		else if (info.pixels) {
+
+			// if this fails the slot just skips the preview step
+			graphics::PictureError previewErr;
+			state.previews[slot] = graphics::Picture::pic_util_downscale(previewErr, info, LIBPROCEDURES_STREAMING_PREVIEW_SIZE);
 		}
 	}
 
-	// Height map
-	bool heightAssigned = matFile.ReadBool(success, jsonMatKey_heightAssigned, false, false);
-	graphics::PictureError height_picErr;
-	graphics::PictureInfo  height_picInfo;
-	std::thread thread_load_height;
-	if (heightAssigned) {
+	// Pictures the decoders returned on their own are copied into the upload ring while still off the main thread.
+	// If it has no space the pixels are copied over in bands during upload instead.
+	graphics::StagingBuffer& staging = upload.staging;
+	if (!staging.IsValid()) {
 
-		fs::path path = materialDir / fs::u8path(entryName + texture_fileSuffix_height);
+		size_t pictureSize = graphics::Picture::pic_util_mip_chain_size(info, upload.mipLevels);
 
-		if (!fs::exists(path)) {
-			matFile.WriteString(success, jsonMatKey_heightPath, jsonKey_pathNotAssigned);
-			matFile.WriteBool(success, jsonMatKey_heightAssigned, false);
-			heightAssigned = false;
-		}
-		else {
-			thread_load_height = std::thread(&graphics::Picture::ReadPicture_PbrThreaded, std::ref(height_picErr), std::ref(height_picInfo), path.generic_string(), true, graphics::PBRTextureType::MNSY_TEXTURE_HEIGHT);
+		if (uploader.TryAllocateStaging(pictureSize, staging)) {
+			memcpy(staging.data, info.pixels, pictureSize);
+			free(info.pixels);
+			info.pixels = nullptr;
 		}
 	}
 
-	// Opacity Map
-	bool opacityAssigned = matFile.ReadBool(success, jsonMatKey_opacityAssigned, false, false);
-	graphics::PictureError opacity_picErr;
-	graphics::PictureInfo  opacity_picInfo;
-	std::thread thread_load_opacity;
-	if (opacityAssigned) {
-		
-		fs::path path = materialDir / fs::u8path(entryName + texture_fileSuffix_opacity);
+	state.decoded[slot] = true;
+}
+
+graphics::PbrMaterial* LibProcedures::LibEntry_PbrMaterial_LoadFromFile_Multithreaded(systems::LibEntry* libEntry, bool prettyPrint, const uint16_t maxResolution)
+{
+	std::shared_ptr<PbrMaterialLoadState> loadState;
+	graphics::PbrMaterial* mat = LibEntry_PbrMaterial_LoadFromFile_Async(libEntry, prettyPrint, maxResolution, loadState);
+
+	// == wait for load jobs, the main thread helps with any that did not start yet
+	MnemosyEngine::GetInstance().GetJobSystem().Wait(loadState->jobs);
+
+	LibEntry_PbrMaterial_UploadDecodedTextures(*mat, *loadState, SIZE_MAX);
 
-		if (!fs::exists(path)) {
-			matFile.WriteString(success, jsonMatKey_opacityPath, jsonKey_pathNotAssigned);
-			matFile.WriteBool(success, jsonMatKey_opacityAssigned, false);
-			opacityAssigned = false;
+	return mat;
+}
+
+graphics::PbrMaterial* LibProcedures::LibEntry_PbrMaterial_LoadFromFile_Async(systems::LibEntry* libEntry, bool prettyPrint, const uint16_t maxResolution, std::shared_ptr<PbrMaterialLoadState>& outLoadState, const bool background)
+{
+	namespace fs = std::filesystem;
+
+
+	// load json file
+	fs::path materialDir = LibProcedures::LibEntry_GetFolderPath(libEntry);
+	fs::path dataFile = LibProcedures::LibEntry_GetDataFilePath(libEntry);
+	std::string entryName = libEntry->name;
+
+	// all files of the entry are looked up in one listing of its folder
+	LibraryFileCache& fileCache = MnemosyEngine::GetInstance().GetMaterialLibraryRegistry().GetFileCache();
+
+	bool success = false;
+
+	flcrm::JsonSettings matFile;
+	matFile.FileOpen(success, dataFile, jsonKey_header, jsonMatKey_description);
+	if (!success) {
+		MNEMOSY_WARN("Error opening data file: {} \nMessage: {}", dataFile.generic_string(), matFile.ErrorStringLastGet());
+	}
+
+
+	// Check if all channelpacked textures still exist at their location. if not update the material file
+	{
+		bool hasChannelPacked = matFile.ReadBool(success, jsonMatKey_hasChannelPacked, false, false);
+		if (hasChannelPacked) {
+			std::vector<std::string> packSuffixes = matFile.ReadVectorString(success, jsonMatKey_packedSuffixes, std::vector<std::string>(), false);
+			if (!packSuffixes.empty()) {
+
+				std::vector<std::string> packSuffixesCopy;
+				for (int i = 0; i < packSuffixes.size(); i++) {
+
+					fs::path packedTexPath = materialDir / fs::u8path(libEntry->name + packSuffixes[i] + ".tif");
+
+					if (fileCache.Exists(packedTexPath)) {
+
+						packSuffixesCopy.push_back(packSuffixes[i]);
+					}
+				}
+
+				if (!packSuffixesCopy.empty()) {
+					matFile.WriteVectorString(success, jsonMatKey_packedSuffixes, packSuffixesCopy);
+
+					packSuffixesCopy.clear();
+				}
+				else {
+					matFile.WriteBool(success, jsonMatKey_hasChannelPacked, false);
+					matFile.EntryErase(success, jsonMatKey_packedSuffixes);
+				}
+
+			}
+			else {
+				matFile.WriteBool(success, jsonMatKey_hasChannelPacked, false);
+			}
+
+			packSuffixes.clear();
 		}
-		else {
-			thread_load_opacity = std::thread(&graphics::Picture::ReadPicture_PbrThreaded, std::ref(opacity_picErr), std::ref(opacity_picInfo), path.generic_string(), true, graphics::PBRTextureType::MNSY_TEXTURE_OPACITY);
+	}
+
+	// Submit a job to the engine job system for each assigned texture to load it into memory of the PictureInfo struct in the load state.
+	// openGl calls must all be from the main thread so uploading happens later in LibEntry_PbrMaterial_UploadDecodedTextures()
+	// also check if the textture files actually exist and update acordingly.
+
+	core::JobSystem& jobSystem = MnemosyEngine::GetInstance().GetJobSystem();
+	core::JobPriority priority = background ? core::MNSY_JOB_PRIORITY_LOW : core::MNSY_JOB_PRIORITY_HIGH;
+
+	outLoadState = std::make_shared<PbrMaterialLoadState>();
+	outLoadState->jobs = core::JobSystem::CreateGroup();
+	outLoadState->maxResolution = maxResolution;
+
+	for (int i = 0; i < graphics::PBRTextureType::MNSY_TEXTURE_COUNT; i++) {
+
+		graphics::PBRTextureType type = (graphics::PBRTextureType)i;
+		std::string assignedKey = graphics::TexUtil::get_JsonMatKey_assigned_from_PBRTextureType(type);
+
+		bool assigned = matFile.ReadBool(success, assignedKey, false, false);
+		if (!assigned)
+			continue;
+
+		fs::path path = materialDir / fs::u8path(graphics::TexUtil::get_filename_from_PBRTextureType(entryName, type));
+		fs::path cachePath = materialDir / fs::path(texture_cacheFolder) / fs::path(graphics::TexUtil::get_cacheFilename_from_PBRTextureType(type));
+
+		if (!fileCache.Exists(path)) {
+			matFile.WriteString(success, graphics::TexUtil::get_JsonMatKey_path_from_PBRTextureType(type), jsonKey_pathNotAssigned);
+			matFile.WriteBool(success, assignedKey, false);
+			continue;
 		}
+
+		outLoadState->pending[i] = true;
+
+		std::shared_ptr<PbrMaterialLoadState> state = outLoadState;
+		jobSystem.Submit(state->jobs, [state, i, path, cachePath]() { PbrMaterialLoadState_DecodeSlot(*state, i, path, cachePath); }, priority);
 	}
 
 	graphics::PbrMaterial* mat = new graphics::PbrMaterial();
-	// Once all threads are going we let the main thread do the rest of the work
+	// Once all jobs are going we let the main thread do the rest of the work
 	{
 		//mat->Name = matFile.ReadString(success, jsonMatKey_name, libEntry->name, true);
 
@@ -1003,119 +1257,199 @@ graphics::PbrMaterial* LibProcedures::LibEntry_PbrMaterial_LoadFromFile_Multithr
 		matFile.FileClose(success, dataFile);
 	}
 
-	// == join threads
-	if (albedoAssigned) {
-		thread_load_albedo.join();
+	return mat;
+}
 
-		if (albedo_picErr.wasSuccessfull) {
+// shows the preview of a slot until its full texture is uploaded
+void PbrMaterialLoadState_UploadPreview(graphics::PbrMaterial& pbrMat, PbrMaterialLoadState& loadState, const int slot) {
 
-			graphics::Texture* albedoTex = new graphics::Texture();
-			albedoTex->GenerateOpenGlTexture(albedo_picInfo, true);
-			mat->assignTexture(graphics::PBRTextureType::MNSY_TEXTURE_ALBEDO, albedoTex);
-			free(albedo_picInfo.pixels);
-		}
-		else {
-			MNEMOSY_ERROR("Error loading albedo Texture \nMessage: {}", albedo_picErr.what);
-		}
-	}
+	if (!loadState.previews[slot].pixels || loadState.previewUploaded[slot])
+		return;
 
-	if (roughnessAssigned) {
-		thread_load_roughness.join();
-		if (roughness_picErr.wasSuccessfull) {
-			graphics::Texture* roughnessTex = new graphics::Texture();
-			roughnessTex->GenerateOpenGlTexture(roughness_picInfo, true);
-			mat->assignTexture(graphics::PBRTextureType::MNSY_TEXTURE_ROUGHNESS, roughnessTex);
-			free(roughness_picInfo.pixels);
-		}
-		else {
-			MNEMOSY_ERROR("Error loading roughness Texture \nMessage: {}", roughness_picErr.what);
-		}
-	}
+	graphics::Texture* previewTex = new graphics::Texture();
+	previewTex->GenerateOpenGlTexture(loadState.previews[slot], true);
+	previewTex->SetSourceResolution(loadState.sourceWidth[slot], loadState.sourceHeight[slot]);
+	pbrMat.assignTexture((graphics::PBRTextureType)slot, previewTex);
+	loadState.previewUploaded[slot] = true;
+}
 
+bool LibProcedures::LibEntry_PbrMaterial_UploadDecodedTextures(graphics::PbrMaterial& pbrMat, PbrMaterialLoadState& loadState, const size_t maxUploadBytes) {
 
-	if (metallicAssigned) {
-		thread_load_metallic.join();
-		if (metallic_picErr.wasSuccessfull) {
-			graphics::Texture* metallicTex = new graphics::Texture();
-			metallicTex->GenerateOpenGlTexture(metallic_picInfo, true);
-			mat->assignTexture(graphics::PBRTextureType::MNSY_TEXTURE_METALLIC, metallicTex);
-			free(metallic_picInfo.pixels);
-		}
-		else {
-			MNEMOSY_ERROR("Error loading Metallic Texture \nMessage: {}", metallic_picErr.what);
-		}
-	}
+	graphics::TextureUploader& uploader = MnemosyEngine::GetInstance().GetTextureUploader();
 
-	if (emissiveAssigned) {
-		thread_load_emissive.join();
-		if (emissive_picErr.wasSuccessfull) {
-			graphics::Texture* emissionTex = new graphics::Texture();
-			emissionTex->GenerateOpenGlTexture(emissive_picInfo, true);
-			mat->assignTexture(graphics::PBRTextureType::MNSY_TEXTURE_EMISSION, emissionTex);
-			free(emissive_picInfo.pixels);
-		}
-		else {
-			MNEMOSY_ERROR("Error loading Emission Texture \nMessage: {}", emissive_picErr.what);
+	bool allUploaded = true;
+	size_t usedBytes = 0;
+
+	// staged textures first, they only need the copy from the ring and free their ring memory again for the others
+	for (int pass = 0; pass < 2; pass++) {
+
+		for (int i = 0; i < graphics::PBRTextureType::MNSY_TEXTURE_COUNT; i++) {
+
+			if (!loadState.pending[i])
+				continue;
+
+			if (!loadState.decoded[i]) {
+
+				// reduced levels some files store are ready before the full picture is decoded
+				if (pass == 0 && loadState.previewDecoded[i]) {
+					PbrMaterialLoadState_UploadPreview(pbrMat, loadState, i);
+				}
+
+				allUploaded = false;
+				continue;
+			}
+
+			graphics::PBRTextureType type = (graphics::PBRTextureType)i;
+
+			if (!loadState.errors[i].wasSuccessfull) {
+				loadState.pending[i] = false;
+				MNEMOSY_ERROR("Error loading {} Texture \nMessage: {}", graphics::TexUtil::get_string_from_PBRTextureType(type), loadState.errors[i].what);
+				continue;
+			}
+
+			graphics::TextureUpload& upload = loadState.uploads[i];
+
+			bool isStaged = upload.staging.IsValid();
+			if ((pass == 0) != isStaged)
+				continue;
+
+			// uploading large textures is expensive so only so many bytes are uploaded per call, the others show their preview until then
+			if (usedBytes < maxUploadBytes) {
+
+				uint8_t numChannels, bitsPerChannel, bytesPerPixel;
+				graphics::TexUtil::get_information_from_textureFormat(upload.info.textureFormat, numChannels, bitsPerChannel, bytesPerPixel);
+				size_t rowSize = (size_t)upload.info.width * bytesPerPixel;
+
+				uint32_t rowsBefore = upload.rowsUploaded;
+
+				if (maxUploadBytes == SIZE_MAX) {
+					uploader.FinishUpload(upload);
+				}
+				else {
+					uploader.ContinueUpload(upload, maxUploadBytes - usedBytes);
+				}
+
+				usedBytes += (upload.rowsUploaded - rowsBefore) * rowSize;
+			}
+
+			if (upload.IsDone()) {
+
+				graphics::Texture* tex = upload.texture;
+				upload.texture = nullptr;
+				tex->SetSourceResolution(loadState.sourceWidth[i], loadState.sourceHeight[i]);
+				pbrMat.assignTexture(type, tex);
+
+				if (loadState.previews[i].pixels) {
+					free(loadState.previews[i].pixels);
+					loadState.previews[i].pixels = nullptr;
+				}
+
+				loadState.pending[i] = false;
+				continue;
+			}
+
+			allUploaded = false;
+
+			PbrMaterialLoadState_UploadPreview(pbrMat, loadState, i);
 		}
 	}
 
-	if (normalAssigned) {
-		thread_load_normal.join();
-		if (emissive_picErr.wasSuccessfull) {
-			graphics::Texture* normalTex = new graphics::Texture();
-			normalTex->GenerateOpenGlTexture(normal_picInfo, true);
-			mat->assignTexture(graphics::PBRTextureType::MNSY_TEXTURE_NORMAL, normalTex);
-			free(normal_picInfo.pixels);
-		}
-		else {
-			MNEMOSY_ERROR("Error loading Normal Texture \nMessage: {}", normal_picErr.what);
+	return allUploaded;
+}
+
+void LibProcedures::LibEntry_PbrMaterial_CancelUploads(PbrMaterialLoadState& loadState) {
+
+	graphics::TextureUploader& uploader = MnemosyEngine::GetInstance().GetTextureUploader();
+
+	for (int i = 0; i < graphics::PBRTextureType::MNSY_TEXTURE_COUNT; i++) {
+
+		// slots that are still decoding never started an upload
+		if (loadState.pending[i] && loadState.decoded[i]) {
+			uploader.CancelUpload(loadState.uploads[i]);
+			loadState.pending[i] = false;
 		}
 	}
+}
 
-	if (aoAssigned) {
-		thread_load_ao.join();
-		if (ao_picErr.wasSuccessfull) {
-			graphics::Texture* aoTex = new graphics::Texture();
-			aoTex->GenerateOpenGlTexture(ao_picInfo, true);
-			mat->assignTexture(graphics::PBRTextureType::MNSY_TEXTURE_AMBIENTOCCLUSION, aoTex);
-			free(ao_picInfo.pixels);
-		}
-		else {
-			MNEMOSY_ERROR("Error loading AmbientOcclusion Texture \nMessage: {}", ao_picErr.what);
-		}
+void LibProcedures::LibEntry_PbrMaterial_LoadFullResolutionTextures(systems::LibEntry* libEntry, graphics::PbrMaterial& pbrMat) {
+
+	namespace fs = std::filesystem;
+
+	fs::path materialDir = LibProcedures::LibEntry_GetFolderPath(libEntry);
+	std::string entryName = libEntry->name;
+
+	core::JobSystem& jobSystem = MnemosyEngine::GetInstance().GetJobSystem();
+
+	std::shared_ptr<PbrMaterialLoadState> loadState = std::make_shared<PbrMaterialLoadState>();
+	loadState->jobs = core::JobSystem::CreateGroup();
+	loadState->maxResolution = 0;
+
+	for (int i = 0; i < graphics::PBRTextureType::MNSY_TEXTURE_COUNT; i++) {
+
+		graphics::Texture* tex = pbrMat.GetTextureFromPBRTextureType((graphics::PBRTextureType)i);
+		if (!tex || !tex->IsDownscaled())
+			continue;
+
+		fs::path path = materialDir / fs::u8path(graphics::TexUtil::get_filename_from_PBRTextureType(entryName, (graphics::PBRTextureType)i));
+		fs::path cachePath = materialDir / fs::path(texture_cacheFolder) / fs::path(graphics::TexUtil::get_cacheFilename_from_PBRTextureType((graphics::PBRTextureType)i));
+
+		loadState->pending[i] = true;
+
+		std::shared_ptr<PbrMaterialLoadState> state = loadState;
+		jobSystem.Submit(state->jobs, [state, i, path, cachePath]() { PbrMaterialLoadState_DecodeSlot(*state, i, path, cachePath); }, core::MNSY_JOB_PRIORITY_HIGH);
 	}
 
-	if (heightAssigned) {
-		thread_load_height.join();
-		if (height_picErr.wasSuccessfull) {
-			graphics::Texture* heightTex = new graphics::Texture();
-			heightTex->GenerateOpenGlTexture(height_picInfo, true);
-			mat->assignTexture(graphics::PBRTextureType::MNSY_TEXTURE_HEIGHT, heightTex);
-			free(height_picInfo.pixels);
-		}
-		else {
-			MNEMOSY_ERROR("Error loading Height Texture \nMessage: {}", height_picErr.what);
-		}
+	jobSystem.Wait(loadState->jobs);
+
+	LibEntry_PbrMaterial_UploadDecodedTextures(pbrMat, *loadState, SIZE_MAX);
+}
+
+
+void LibProcedures::PbrMaterial_ReadTexture(graphics::PictureError& outPictureError, graphics::PictureInfo& outPicInfo, const std::filesystem::path& materialDir, const std::string& entryName, const graphics::PBRTextureType type) {
+
+	namespace fs = std::filesystem;
+
+	std::string name = entryName;
+	fs::path path = materialDir / fs::u8path(graphics::TexUtil::get_filename_from_PBRTextureType(name, type));
+	fs::path cachePath = materialDir / fs::path(texture_cacheFolder) / fs::path(graphics::TexUtil::get_cacheFilename_from_PBRTextureType(type));
+
+	std::string sourceStamp = PbrMaterial_GetTextureSourceStamp(path);
+
+	// the smaller mip levels follow the first one in the same buffer, they are simply not used
+	graphics::KtxImage cache;
+	uint32_t mipLevels = 0;
+	if (!sourceStamp.empty() && cache.LoadMipChain(cachePath.generic_string().c_str(), sourceStamp, 0, outPicInfo, mipLevels)) {
+		outPictureError = graphics::PictureError(true, "");
+		return;
 	}
 
-	if (opacityAssigned) {
-		thread_load_opacity.join();
+	graphics::Picture::ReadPicture_PbrThreaded(outPictureError, outPicInfo, path.generic_string(), true, type);
+}
 
-		if (opacity_picErr.wasSuccessfull) {
-			graphics::Texture* opacityTex = new graphics::Texture();
-			opacityTex->GenerateOpenGlTexture(opacity_picInfo, true);
-			mat->assignTexture(graphics::PBRTextureType::MNSY_TEXTURE_OPACITY, opacityTex);
-			free(opacity_picInfo.pixels);
-		}
-		else {
-			MNEMOSY_ERROR("Error loading Opacity Texture \nMessage: {}", opacity_picErr.what);
+uint32_t LibProcedures::PbrMaterial_RestampTextureCaches(const std::filesystem::path& materialDir, const std::string& oldStamp, const std::string& newStamp) {
+
+	namespace fs = std::filesystem;
+
+	if (oldStamp.empty() || newStamp.empty())
+		return 0;
+
+	// the cache file names do not say which texture file they belong to, the stamp does
+	uint32_t restamped = 0;
+	std::error_code ec;
+	for (const fs::directory_entry& file : fs::directory_iterator(materialDir / fs::path(texture_cacheFolder), ec)) {
+
+		if (!file.is_regular_file() || file.path().extension() != texture_fileExtentionKtx2)
+			continue;
+
+		graphics::KtxImage cache;
+		if (cache.RestampMipChain(file.path().generic_string().c_str(), oldStamp, newStamp)) {
+			restamped++;
 		}
 	}
 
-	return mat;
+	return restamped;
 }
 
-
 graphics::UnlitMaterial* LibProcedures::LibEntry_UnlitMaterial_LoadFromFile(systems::LibEntry* libEntry, bool prettyPrint) {
 
 	namespace fs = std::filesystem;
@@ -1158,12 +1492,12 @@ graphics::UnlitMaterial* LibProcedures::LibEntry_UnlitMaterial_LoadFromFile(syst
 		fs::path texturePath = LibEntry_GetFolderPath(libEntry) / fs::u8path(textureFilename);
 
 
-		if (fs::exists(texturePath)) {
+		if (MnemosyEngine::GetInstance().GetMaterialLibraryRegistry().GetFileCache().Exists(texturePath)) {
 
 			picInfo = graphics::Picture::ReadPicture(picError, texturePath.generic_string().c_str(), true,true,true);
 			if (!picError.wasSuccessfull) {
 
-				MNEMOSY_WARN("Error reading texture file of unlit material {} \nMessage {}", libEntry->name, picError.what);
+				MNEMOSY_WARN("Error reading texture file of unlit material {} \nMessage {}", libEntry->name.str(), picError.what);
 
 			}
 			else {
@@ -1193,7 +1527,7 @@ graphics::UnlitMaterial* LibProcedures::LibEntry_UnlitMaterial_LoadFromFile(syst
 	return unlitMat;
 }
 
-graphics::Skybox* LibProcedures::LibEntry_SkyboxMaterial_LoadFromFile(std::filesystem::path& folderPath, std::string& name, bool prettyPrint)
+graphics::Skybox* LibProcedures::LibEntry_SkyboxMaterial_LoadFromFile(std::filesystem::path& folderPath, const std::string& name, bool prettyPrint)
 {
 	namespace fs = std::filesystem;
 
@@ -5,6 +5,7 @@
 #include "Include/Core/Log.h"
 #include "Include/Core/Clock.h"
 #include "Include/Core/FileDirectories.h"
+#include "Include/Core/JobSystem.h"
 #include "Include/Core/Utils/StringUtils.h"
 #include <json.hpp>
 
@@ -24,6 +25,7 @@
 #include "Include/Systems/ExportManager.h"
 #include "Include/Systems/FolderTreeNode.h"
 #include "Include/Systems/FolderTree.h"
+#include "Include/Systems/LibraryIndex.h"
 #include "Include/Systems/TextureGenerationManager.h"
 #include "Include/Systems/ThumbnailManager.h"
 
@@ -31,9 +33,13 @@
 #include <glad/glad.h>
 #include <fstream>
 #include <thread>
+#include <algorithm>
 
 #include <FulcrumUtils/Flcrm_Log.hpp>
 
+// bytes of full resolution texture data copied to the gpu per frame while a material streams in
+#define MATLIB_TEXTURE_UPLOAD_BYTES_PER_FRAME 33554432 // 32 mb
+
 
 namespace mnemosy::systems {
 	// == public methods
@@ -70,7 +76,12 @@ namespace mnemosy::systems {
 
 	void MaterialLibraryRegistry::Shutdown() {
 
+		ActiveLibEntry_CancelLoading();
+
 		ActiveLibCollection_SaveToFile();
+		m_journal.Close();
+		m_libraryWatcher.Clear();
+		m_fileCache.Clear();
 
 		if (m_folderTree) {
 			m_folderTree->Shutdown();
@@ -78,6 +89,31 @@ namespace mnemosy::systems {
 		}
 	}
 
+	void MaterialLibraryRegistry::Update() {
+
+		if (m_folderTree) {
+			m_journal.Update(*m_folderTree);
+			ActiveLibCollection_ProcessFileChanges();
+		}
+
+		m_fileCache.Update();
+
+		// forget cancelled loads once none of their jobs is running anymore
+		m_cancelledLoadJobs.erase(std::remove_if(m_cancelledLoadJobs.begin(), m_cancelledLoadJobs.end(), [](const std::shared_ptr<core::JobGroup>& jobs) { return jobs->IsDone(); }), m_cancelledLoadJobs.end());
+
+		if (!m_activePbrMatLoad)
+			return;
+
+		graphics::PbrMaterial& activeMat = MnemosyEngine::GetInstance().GetScene().GetPbrMaterial();
+
+		// previews are cheap, full textures are uploaded with a per frame byte budget
+		if (LibProcedures::LibEntry_PbrMaterial_UploadDecodedTextures(activeMat, *m_activePbrMatLoad, MATLIB_TEXTURE_UPLOAD_BYTES_PER_FRAME)) {
+
+			m_activePbrMatLoad = nullptr;
+			MNEMOSY_TRACE("Finished loading textures of: {}", m_activeLibEntry->name.str());
+		}
+	}
+
 
 	const bool MaterialLibraryRegistry::LibCollection_LoadIntoActiveTree(std::filesystem::path& folderPath) {
 
@@ -98,6 +134,31 @@ namespace mnemosy::systems {
 			return false;
 		}		
 
+		// the binary index of the data file builds the tree without parsing any json
+		{
+			LibraryIndex index;
+			if (index.Open(dataFilePath)) {
+
+				if (m_folderTree) {
+					m_folderTree->Shutdown();
+					delete m_folderTree;
+					m_folderTree = nullptr;
+				}
+
+				m_folderTree = new FolderTree();
+
+				m_folderTree->Init();
+				m_folderTree->LoadFromIndex(index);
+
+				uint64_t dataFileSequence = index.GetJournalSequence();
+				index.Close();
+
+				m_journal.Open(dataFilePath, *m_folderTree, dataFileSequence);
+
+				return true;
+			}
+		}
+
 
 		std::ifstream dataFileStream;
 		dataFileStream.open(dataFilePath);
@@ -134,56 +195,33 @@ namespace mnemosy::systems {
 		m_folderTree->Init();
 		m_folderTree->LoadFromJson(readFile);
 
+		uint64_t dataFileSequence = 0;
+		if (readFile.contains(jsonLibKey_JournalSequence) && readFile[jsonLibKey_JournalSequence].is_number_unsigned()) {
+			dataFileSequence = readFile[jsonLibKey_JournalSequence].get<uint64_t>();
+		}
+
+		// next time this collection is opened it can skip the json
+		{
+			std::vector<uint8_t> indexBuffer;
+			LibraryIndex::Build(m_folderTree->GetRootPtr(), dataFileSequence, indexBuffer);
+			LibraryIndex::Write(dataFilePath, indexBuffer);
+		}
+
+		m_journal.Open(dataFilePath, *m_folderTree, dataFileSequence);
+
 		return true;
 
 	}
 
   	void MaterialLibraryRegistry::ActiveLibCollection_SaveToFile() {
-		namespace fs = std::filesystem;
-
 
 		if (!LibCollections_IsAnyActive()) {
 			return;
 		}
 
-		fs::path dataFile = ActiveLibCollection_GetDataFilePath();
-
-		LibProcedures::CheckDataFile(dataFile);
-
-		nlohmann::json* LibraryDirectoriesJson = m_folderTree->WriteToJson();
-
-		std::ofstream dataFileStream;
-		dataFileStream.open(dataFile);
-
-
-		bool savingSuccess = true;
-
-		try {
-
-			dataFileStream << LibraryDirectoriesJson->dump(-1);
-			//if (prettyPrintDataFile) {
-			//	dataFileStream << LibraryDirectoriesJson->dump(4);
-			//}
-			//else {
-			//}
-
-		}
-		catch (nlohmann::json::type_error jErr) {
-
-			MNEMOSY_ERROR("Failed to save Library data file correctly. Message: {}", jErr.what());
-			savingSuccess = false;
-		}
-		
-		
-		dataFileStream.close();
-
-		delete LibraryDirectoriesJson;
-
-		if (savingSuccess) {
-
-			// copy and make a backup file.			
-			fs::path copyLocation = dataFile.parent_path() / fs::path("MnemosyMaterialLibraryData_BACKUP_COPY.mnsydata");
-			fs::copy_file(dataFile, copyLocation, fs::copy_options::overwrite_existing);
+		// writes the tree to a temporary file that replaces the data file, changes since the last write are in the journal until then
+		if (!m_journal.Compact(*m_folderTree)) {
+			MNEMOSY_ERROR("Failed to save Library data file of collection: {}", ActiveLibCollection_GetName());
 		}
   	}
 
@@ -201,8 +239,7 @@ namespace mnemosy::systems {
 
 		LibProcedures::CreateDirectoryForFolderNode(node);
 
-		// we can NOT Call SaveUserDirectoriesData() here because
-		// we call this function when initialising and reading from the file..
+		m_journal.FolderCreated(node);
 		return node;
 	}
 
@@ -217,6 +254,8 @@ namespace mnemosy::systems {
 			return;
 		}
 
+		ActiveLibEntry_FinishLoading(false);
+
 		// store old path because pathFromRoot is upadeted inside RenameFolder() method
 		fs::path libraryDir = ActiveLibCollection_GetFolderPath();
 
@@ -240,13 +279,18 @@ namespace mnemosy::systems {
 
 			// revert name if system can't rename the file on disk
 			m_folderTree->RenameFolder(node, oldName);
+			return;
 		}
+
+		m_journal.FolderRenamed(node, oldName);
 	}
 
 	void MaterialLibraryRegistry::MoveFolder(FolderNode* dragSource, FolderNode* dragTarget) {
 
 		namespace fs = std::filesystem;
 
+		ActiveLibEntry_FinishLoading(false);
+
 		fs::path libraryDir = ActiveLibCollection_GetFolderPath();
 		fs::path fromPath = libraryDir / dragSource->GetPathFromRoot();
 		fs::path toPath = libraryDir / dragTarget->GetPathFromRoot();
@@ -280,11 +324,10 @@ namespace mnemosy::systems {
 		}
 
 		// Updating Internal Data
+		FolderNode* oldParent = dragSource->parent;
 		m_folderTree->MoveFolder(dragSource, dragTarget);
 
-
-		// should prob save to data file here
-		ActiveLibCollection_SaveToFile();
+		m_journal.FolderMoved(dragSource, oldParent);
 	}
 
 	void MaterialLibraryRegistry::DeleteAndKeepChildren(FolderNode* node) {
@@ -298,7 +341,7 @@ namespace mnemosy::systems {
 
 		//1. move all sub nodes and materials into parent
 		if (node->HasMaterials()) {
-			std::vector<LibEntry*> entriesCopy = node->subEntries;
+			std::vector<LibEntry*> entriesCopy(node->subEntries.begin(), node->subEntries.end());
 
 			for (size_t i = 0; i < entriesCopy.size(); i++) {
 
@@ -309,7 +352,7 @@ namespace mnemosy::systems {
 
 		if (!node->IsLeafNode()) {
 
-			std::vector<FolderNode*> subFolderCopy = node->subNodes;
+			std::vector<FolderNode*> subFolderCopy(node->subNodes.begin(), node->subNodes.end());
 			for (size_t i = 0; i < subFolderCopy.size(); i++) {
 
 				MoveFolder(subFolderCopy[i], node->parent);
@@ -349,6 +392,8 @@ namespace mnemosy::systems {
 			}
 		}
 
+		ActiveLibEntry_FinishLoading(false);
+
 		{ // delete directories from disk
 
 			fs::path folderPath = Folder_GetFullPath(node);
@@ -363,6 +408,7 @@ namespace mnemosy::systems {
 			}
 		}
 
+		m_journal.FolderDeleted(node);
 		m_folderTree->DeleteFolderHierarchy(node);
 	}
 		
@@ -467,15 +513,8 @@ namespace mnemosy::systems {
 			LibProcedures::LibEntry_SkyboxMaterial_CreateNewDataFile(libEntry, prettyPrintMaterialFiles);
 		}
 
-		// check if it was created in the currently opend folder
-		if (node == m_selectedFolderNode) {
-			// make sure it gets loaded
-
-			MnemosyEngine::GetInstance().GetThumbnailManager().AddLibEntryToActiveThumbnails(libEntry);
-		}
-
-
-		ActiveLibCollection_SaveToFile();
+		// the thumbnail manager picks the entry up once the gui shows it
+		m_journal.LibEntryCreated(libEntry);
 
 
 		LibEntry_Load(libEntry);
@@ -485,12 +524,14 @@ namespace mnemosy::systems {
 		namespace fs = std::filesystem;
 
 		std::string oldName = libEntry->name;
-		unsigned int matID = libEntry->runtime_ID;
+		uint32_t matID = libEntry->runtime_ID;
 
 		if (libEntry->name == newName)
 			return;
 
 
+		ActiveLibEntry_FinishLoading(false);
+
 		fs::path entryFolderPathOld = LibEntry_GetFolderPath(libEntry);
 
 		// rename entry internally
@@ -523,19 +564,15 @@ namespace mnemosy::systems {
 			}
 		}
 
-		// save library data file;
-		ActiveLibCollection_SaveToFile();
+		m_journal.LibEntryRenamed(libEntry, oldName);
 	}
 		
 	void MaterialLibraryRegistry::LibEntry_Delete(systems::LibEntry* libEntry, unsigned int positionInVector) {
 
 		namespace fs = std::filesystem;
 
-		// check if entry is part of the opend folder
-		if (libEntry->parent == m_selectedFolderNode) {
-			// unload thumbnail
-			MnemosyEngine::GetInstance().GetThumbnailManager().RemoveLibEntryFromActiveThumbnails(libEntry);
-		}
+		// unload thumbnail, search results outside the opend folder may show it as well
+		MnemosyEngine::GetInstance().GetThumbnailManager().RemoveLibEntryFromActiveThumbnails(libEntry);
 
 		// Set default material if we are deleting the currently selected entry
 		// this has to happen before we delete it in memory ofc
@@ -547,6 +584,8 @@ namespace mnemosy::systems {
 			}		
 		}
 
+		ActiveLibEntry_FinishLoading(false);
+
 		// delete files
 		fs::path libEntryFolderPath  = LibEntry_GetFolderPath(libEntry);
 		try {
@@ -558,17 +597,16 @@ namespace mnemosy::systems {
 		}
 		
 		// deleting from memory
+		m_journal.LibEntryDeleted(libEntry);
 		m_folderTree->DeleteLibEntry(libEntry->parent, positionInVector);
-
-
-		// save
-		ActiveLibCollection_SaveToFile();
 	}
 
 	void MaterialLibraryRegistry::LibEntry_Move(FolderNode* sourceNode, FolderNode* targetNode, systems::LibEntry* libEntry) {
 
 		namespace fs = std::filesystem;
 
+		ActiveLibEntry_FinishLoading(false);
+
 		// move material folder / copy dir and remove dir
 		std::string entryName = libEntry->name; // temporary storing name here
 		fs::path libraryDir = ActiveLibCollection_GetFolderPath();
@@ -597,21 +635,13 @@ namespace mnemosy::systems {
 			return;
 		}
 
-		// unload thumbnail
-		if (sourceNode == m_selectedFolderNode) {
-			MnemosyEngine::GetInstance().GetThumbnailManager().RemoveLibEntryFromActiveThumbnails(libEntry);
-		}
+		// unload thumbnail, it is loaded again once the gui shows the entry in its new folder
+		MnemosyEngine::GetInstance().GetThumbnailManager().RemoveLibEntryFromActiveThumbnails(libEntry);
 
 		// move in internal tree
 		m_folderTree->MoveLibEntry(libEntry, sourceNode, targetNode);
 
-		// make sure thumbnail gets loaded
-		if (targetNode == m_selectedFolderNode) {
-			MnemosyEngine::GetInstance().GetThumbnailManager().AddLibEntryToActiveThumbnails(targetNode->subEntries.back());
-		}
-
-		// save
-		ActiveLibCollection_SaveToFile();
+		m_journal.LibEntryMoved(libEntry, sourceNode);
 	}
 	
 	void MaterialLibraryRegistry::LibEntry_Load(systems::LibEntry* libEntry) {
@@ -620,17 +650,24 @@ namespace mnemosy::systems {
 
 		ActiveLibEntry_SaveToFile(); // save current selected entry first before switching
 
+		// textures of the previous entry that are still decoding are not needed anymore
+		ActiveLibEntry_CancelLoading();
+
 		systems::LibEntryType type = libEntry->type;
 
 
 		if (type == systems::LibEntryType::MNSY_ENTRY_TYPE_PBRMAT) {			
 
-			graphics::PbrMaterial* mat = LibProcedures::LibEntry_PbrMaterial_LoadFromFile_Multithreaded(libEntry,prettyPrintMaterialFiles);
+			// the material is shown right away with its values, textures are swapped in by Update() as they finish decoding
+			graphics::Renderer& renderer = MnemosyEngine::GetInstance().GetRenderer();
+			uint16_t maxResolution = renderer.GetPreviewTextureResolutionValue(renderer.GetPreviewTextureResolutionEnum());
+
+			graphics::PbrMaterial* mat = LibProcedures::LibEntry_PbrMaterial_LoadFromFile_Async(libEntry, prettyPrintMaterialFiles, maxResolution, m_activePbrMatLoad);
 			MNEMOSY_ASSERT(mat != nullptr, "This should not happen");
 
 			MnemosyEngine::GetInstance().GetScene().SetPbrMaterial(mat);
 
-			MNEMOSY_DEBUG("Loaded PBR Material: {}", libEntry->name);
+			MNEMOSY_DEBUG("Loaded PBR Material: {}", libEntry->name.str());
 		}
 		else if (type == systems::LibEntryType::MNSY_ENTRY_TYPE_UNLITMAT) {
 
@@ -638,7 +675,7 @@ namespace mnemosy::systems {
 
 			MnemosyEngine::GetInstance().GetScene().SetUnlitMaterial(unlitMat);
 
-			MNEMOSY_DEBUG("Loaded Unlit Material: {}", libEntry->name);
+			MNEMOSY_DEBUG("Loaded Unlit Material: {}", libEntry->name.str());
 		}
 		else if (type == systems::LibEntryType::MNSY_ENTRY_TYPE_SKYBOX) {
 
@@ -652,7 +689,7 @@ namespace mnemosy::systems {
 
 			MnemosyEngine::GetInstance().GetRenderer().SetShaderSkyboxUniforms(scene.userSceneSettings,*sky);
 
-			MNEMOSY_DEBUG("Loaded Skybox Material: {}", libEntry->name);
+			MNEMOSY_DEBUG("Loaded Skybox Material: {}", libEntry->name.str());
 		}
 
 
@@ -691,7 +728,8 @@ namespace mnemosy::systems {
 
 		fs::path entryFolderPath = LibEntry_GetFolderPath(m_activeLibEntry);
 
-		{ // Render thumbnail of active material
+		// Render thumbnail of active material, unless textures are still loading. Then the existing thumbnail is better than an incomplete one.
+		if (!m_activePbrMatLoad) {
 			//fs::path thumbnailAbsolutePath = entryFolderPath / thumbnailPath;
 			MnemosyEngine::GetInstance().GetThumbnailManager().RenderThumbnailForActiveLibEntry(m_activeLibEntry);
 		}
@@ -700,7 +738,7 @@ namespace mnemosy::systems {
 		switch (m_activeLibEntry->type)
 		{
 		case systems::LibEntryType::MNSY_ENTRY_TYPE_PBRMAT:
-			LibProcedures::LibEntry_PbrMaterial_SaveToFile(m_activeLibEntry, &MnemosyEngine::GetInstance().GetScene().GetPbrMaterial(), prettyPrintMaterialFiles);
+			LibProcedures::LibEntry_PbrMaterial_SaveToFile(m_activeLibEntry, &MnemosyEngine::GetInstance().GetScene().GetPbrMaterial(), m_activePbrMatLoad.get(), prettyPrintMaterialFiles);
 			break;
 		case systems::LibEntryType::MNSY_ENTRY_TYPE_UNLITMAT:
 
@@ -716,10 +754,51 @@ namespace mnemosy::systems {
 
 	}
 
+	void MaterialLibraryRegistry::ActiveLibEntry_FinishLoading(const bool fullResolution) {
+
+		core::JobSystem& jobSystem = MnemosyEngine::GetInstance().GetJobSystem();
+
+		// jobs of cancelled loads that already started may still have their files open
+		for (std::shared_ptr<core::JobGroup>& jobs : m_cancelledLoadJobs) {
+			jobSystem.Wait(jobs);
+		}
+		m_cancelledLoadJobs.clear();
+
+		graphics::PbrMaterial& activeMat = MnemosyEngine::GetInstance().GetScene().GetPbrMaterial();
+
+		if (m_activePbrMatLoad) {
+
+			jobSystem.Wait(m_activePbrMatLoad->jobs);
+
+			LibProcedures::LibEntry_PbrMaterial_UploadDecodedTextures(activeMat, *m_activePbrMatLoad, SIZE_MAX);
+			m_activePbrMatLoad = nullptr;
+		}
+
+		// textures of the preview may be downscaled, replace them with the full resolution ones
+		if (fullResolution && UserEntrySelected() && m_activeLibEntry->type == systems::LibEntryType::MNSY_ENTRY_TYPE_PBRMAT) {
+
+			LibProcedures::LibEntry_PbrMaterial_LoadFullResolutionTextures(m_activeLibEntry, activeMat);
+		}
+	}
+
+	void MaterialLibraryRegistry::ActiveLibEntry_CancelLoading() {
+
+		if (!m_activePbrMatLoad)
+			return;
+
+		// jobs that did not start yet are skipped, decoded pictures are freed together with the load state
+		m_activePbrMatLoad->jobs->Cancel();
+		LibProcedures::LibEntry_PbrMaterial_CancelUploads(*m_activePbrMatLoad);
+		m_cancelledLoadJobs.push_back(m_activePbrMatLoad->jobs);
+		m_activePbrMatLoad = nullptr;
+	}
+
 	void MaterialLibraryRegistry::ActiveLibEntry_PbrMat_GenerateOpacityFromAlbedoAlpha(LibEntry* libEntry, graphics::PbrMaterial& activePbrMat) {
 
 		namespace fs = std::filesystem;
 
+		ActiveLibEntry_FinishLoading(true);
+
 		fs::path opacityMapPath = LibEntry_GetFolderPath(m_activeLibEntry) / fs::u8path(libEntry->name + texture_fileSuffix_opacity);
 
 		//Generate opacity Texture
@@ -757,6 +836,8 @@ namespace mnemosy::systems {
 
 	void MaterialLibraryRegistry::ActiveLibEntry_PbrMat_GenerateChannelPackedTexture(LibEntry* libEntry, graphics::PbrMaterial& activeMat, std::string& suffix, graphics::ChannelPackType packType, graphics::ChannelPackComponent packComponent_R, graphics::ChannelPackComponent packComponent_G, graphics::ChannelPackComponent packComponent_B, graphics::ChannelPackComponent packComponent_A, unsigned int width, unsigned int height, uint8_t bitDepth) {
 
+		ActiveLibEntry_FinishLoading(true);
+
 		// check if the file extention is valid
 
 		// check against suffixes already taken by mnemosy
@@ -788,7 +869,14 @@ namespace mnemosy::systems {
 		std::string filename = libEntry->name + suffix + texture_fileExtentionTiff;
 		std::filesystem::path channelPackedExportPath = LibEntry_GetFolderPath(m_activeLibEntry) / std::filesystem::u8path(filename);
 
-		MnemosyEngine::GetInstance().GetTextureGenerationManager().GenerateChannelPackedTexture(activeMat, channelPackedExportPath.generic_string().c_str(),true,packType,packComponent_R,packComponent_G,packComponent_B,packComponent_A, width,height,bitDepth);
+		TextureGenerationManager& textureGenerator = MnemosyEngine::GetInstance().GetTextureGenerationManager();
+
+		// packing on the cpu reads the texture files at full resolution, the gpu is only used if that fails
+		if (!textureGenerator.GenerateChannelPackedTexture_Cpu(activeMat, LibEntry_GetFolderPath(m_activeLibEntry), libEntry->name, channelPackedExportPath.generic_string().c_str(), packType, packComponent_R, packComponent_G, packComponent_B, packComponent_A, width, height, bitDepth)) {
+
+			MNEMOSY_WARN("Channel packing on the cpu failed, packing on the gpu instead");
+			textureGenerator.GenerateChannelPackedTexture(activeMat, channelPackedExportPath.generic_string().c_str(),true,packType,packComponent_R,packComponent_G,packComponent_B,packComponent_A, width,height,bitDepth);
+		}
 
 		// Enlist into suffixes of active mat
 		activeMat.HasPackedTextures = true;
@@ -805,6 +893,8 @@ namespace mnemosy::systems {
 
 		namespace fs = std::filesystem;
 
+		ActiveLibEntry_FinishLoading(false);
+
 		MNEMOSY_ASSERT(activeMat.HasPackedTextures, "This function should not be called if the material does not contain any channel packed textures");
 		MNEMOSY_ASSERT(!activeMat.PackedTexturesSuffixes.empty(), "This function should not be called if the material does not contain any channel packed textures, this assert should never happen because we already checked if the texture has packed textures, there must be a bug somewhere when loading or saving the material");
 
@@ -848,6 +938,7 @@ namespace mnemosy::systems {
 	void MaterialLibraryRegistry::SetDefaultMaterial() {
 
 		ActiveLibEntry_SaveToFile();
+		ActiveLibEntry_CancelLoading();
 
 		if (m_activeLibEntry) {
 
@@ -885,6 +976,9 @@ namespace mnemosy::systems {
 
 		namespace fs = std::filesystem;
 
+		// a pending decode of the same slot must not replace the new texture later
+		ActiveLibEntry_FinishLoading(false);
+
 		graphics::PictureError err;
 		
 
@@ -895,12 +989,6 @@ namespace mnemosy::systems {
 			return;
 		}
 
-		graphics::Texture* tex = new graphics::Texture();
-		tex->GenerateOpenGlTexture(picInfo,true);
-
-		if (picInfo.pixels)
-			free(picInfo.pixels);
-
 		graphics::PbrMaterial& activeMat = MnemosyEngine::GetInstance().GetScene().GetPbrMaterial();
 		systems::ExportManager& exportManager = MnemosyEngine::GetInstance().GetExportManager();
 
@@ -973,8 +1061,14 @@ namespace mnemosy::systems {
 			}
 		}
 
-		systems::TextureExportInfo exportInfo = systems::TextureExportInfo(exportPath,tex->GetWidth(), tex->GetHeight(), format, picInfo.isHalfFloat);
-		exportManager.GLTextureExport(tex->GetID(),exportInfo);
+		// the texture file is written from the decoded pixels on the job system while we upload them for display and update the data file here
+		exportManager.BeginDeferredWrites();
+
+		systems::TextureExportInfo exportInfo = systems::TextureExportInfo(exportPath, picInfo.width, picInfo.height, format, picInfo.isHalfFloat);
+		exportManager.PictureExport(picInfo, exportInfo, filepath);
+
+		graphics::Texture* tex = new graphics::Texture();
+		tex->GenerateOpenGlTexture(picInfo,true);
 
 
 		// update Material Meta data file.
@@ -986,6 +1080,8 @@ namespace mnemosy::systems {
 		matFile.FileOpen(success, dataFilePath, jsonKey_header, jsonMatKey_description);
 		if(!success){
 			MNEMOSY_ERROR("Error Opening Data File. Message: {}", matFile.ErrorStringLastGet());
+			exportManager.EndDeferredWrites();
+			free(picInfo.pixels);
 		 	delete tex;
 			return;
 		}
@@ -1004,6 +1100,11 @@ namespace mnemosy::systems {
 
 		matFile.FileClose(success, dataFilePath);
 
+		exportManager.EndDeferredWrites();
+
+		// the written file was encoded from these
+		free(picInfo.pixels);
+
 		// load texture to material
 		activeMat.assignTexture(textureType, tex);
 
@@ -1016,6 +1117,8 @@ namespace mnemosy::systems {
 
   		namespace fs = std::filesystem;
 
+		ActiveLibEntry_FinishLoading(false);
+
 		graphics::PbrMaterial& activeMat = MnemosyEngine::GetInstance().GetScene().GetPbrMaterial();
 
 		if (!UserEntrySelected()) { // if its default material // should not be possible using the gui bc default material is not editable 
@@ -1048,6 +1151,10 @@ namespace mnemosy::systems {
 				MNEMOSY_ERROR("System error deleting file.\nError message: {}", e.what()); 
 			}
 
+			// decoded mip chain of the texture, it would be invalid anyway
+			std::error_code ec;
+			fs::remove(materialDir / fs::path(texture_cacheFolder) / fs::path(graphics::TexUtil::get_cacheFilename_from_PBRTextureType(textureType)), ec);
+
 			std::string jsonMatKey_assigned_ofTextureType = graphics::TexUtil::get_JsonMatKey_assigned_from_PBRTextureType(textureType);
 
 			matFile.WriteBool(success,jsonMatKey_assigned_ofTextureType,false);
@@ -1092,24 +1199,25 @@ namespace mnemosy::systems {
 			return;
 		}
 
-		// create openGl texture
-		graphics::Texture* tex = new graphics::Texture();
-		tex->GenerateOpenGlTexture(picInfo, true);
-		
-		// free image data from main memory
-		if (picInfo.pixels)
-			free(picInfo.pixels);
-
-
-
 		fs::path materialDir = LibEntry_GetFolderPath(m_activeLibEntry);
 		std::string filename = std::string(m_activeLibEntry->name + texture_unlit_fileSuffix);			
 		fs::path exportPath = materialDir / fs::u8path(filename);
 
-		// export texture to entry folder
+		// export texture to entry folder on the job system while it is uploaded for display
 		systems::ExportManager& exportManager = MnemosyEngine::GetInstance().GetExportManager();
-		systems::TextureExportInfo exportInfo = systems::TextureExportInfo(exportPath, tex->GetWidth(), tex->GetHeight(), picInfo.textureFormat, picInfo.isHalfFloat);
-		exportManager.GLTextureExport(tex->GetID(), exportInfo);
+		exportManager.BeginDeferredWrites();
+
+		systems::TextureExportInfo exportInfo = systems::TextureExportInfo(exportPath, picInfo.width, picInfo.height, picInfo.textureFormat, picInfo.isHalfFloat);
+		exportManager.PictureExport(picInfo, exportInfo, filepath);
+
+		// create openGl texture
+		graphics::Texture* tex = new graphics::Texture();
+		tex->GenerateOpenGlTexture(picInfo, true);
+
+		exportManager.EndDeferredWrites();
+
+		// free image data from main memory
+		free(picInfo.pixels);
 
 
 		// update entry Meta data file.
@@ -1242,17 +1350,15 @@ namespace mnemosy::systems {
 			return;
 		}
 
-		graphics::Texture* equirectangularTex = new graphics::Texture();
-
-		equirectangularTex->GenerateOpenGlTexture(picInfo,true);
-
-		if (picInfo.pixels) {
-			free(picInfo.pixels);
-		}
-
 		std::string entryName = m_activeLibEntry->name;
 		fs::path entryFolder = LibEntry_GetFolderPath(m_activeLibEntry);
 
+		graphics::Texture* equirectangularTex = new graphics::Texture();
+
+		// the equirectangular file is written while the cubemaps are generated
+		systems::ExportManager& exportManager = MnemosyEngine::GetInstance().GetExportManager();
+		exportManager.BeginDeferredWrites();
+
 		// export or copy equirectangular to new location as hdr
 		{
 			fs::path equirectangularFilePath = entryFolder / fs::u8path(entryName + texture_skybox_fileSuffix_equirectangular);
@@ -1260,26 +1366,25 @@ namespace mnemosy::systems {
 			//if its an hdr we are loading we might aswell just copy the file, this is a common case and improves performance significantly for bigger files
 			graphics::ImageFileFormat fileFormat = graphics::TexUtil::get_imageFileFormat_from_fileExtentionString(filepath.extension().generic_string());
 
+			bool copied = false;
 			if (fileFormat == graphics::ImageFileFormat::MNSY_FILE_FORMAT_HDR) {
 				try {
 					fs::copy_file(filepath, equirectangularFilePath,fs::copy_options::overwrite_existing);
+					copied = true;
 				}
 				catch (fs::filesystem_error e) {
-					MNEMOSY_WARN("System error copying file. \nMessage {}", e.what());
-
 					// if copy fails we fallback to generating it manually
-					systems::ExportManager& exportManager = MnemosyEngine::GetInstance().GetExportManager();
-
-					systems::TextureExportInfo exportInfo = systems::TextureExportInfo(equirectangularFilePath, equirectangularTex->GetWidth(), equirectangularTex->GetHeight(), picInfo.textureFormat, picInfo.isHalfFloat, false);
-
-					exportManager.GLTextureExport(equirectangularTex->GetID(), exportInfo);
+					MNEMOSY_WARN("System error copying file. \nMessage {}", e.what());
 				}
 			}
-			else { // otherwise export it from the gl texture
-				systems::ExportManager& exportManager = MnemosyEngine::GetInstance().GetExportManager();
-				systems::TextureExportInfo exportInfo = systems::TextureExportInfo(equirectangularFilePath, equirectangularTex->GetWidth(), equirectangularTex->GetHeight(), picInfo.textureFormat, picInfo.isHalfFloat, false);
-				exportManager.GLTextureExport(equirectangularTex->GetID(), exportInfo);
+
+			// otherwise write it from the decoded pixels on the job system while they are uploaded
+			if (!copied) {
+				systems::TextureExportInfo exportInfo = systems::TextureExportInfo(equirectangularFilePath, picInfo.width, picInfo.height, picInfo.textureFormat, picInfo.isHalfFloat, false);
+				exportManager.PictureExport(picInfo, exportInfo, filepath);
 			}
+
+			equirectangularTex->GenerateOpenGlTexture(picInfo, true);
 		}
 
 		graphics::Skybox& skybox = MnemosyEngine::GetInstance().GetScene().GetSkybox();
@@ -1315,6 +1420,9 @@ namespace mnemosy::systems {
 
 		}
 
+		exportManager.EndDeferredWrites();
+		free(picInfo.pixels);
+
 		// update data file
 		{
 			fs::path dataFilePath = LibEntry_GetDataFilePath(m_activeLibEntry);
@@ -1431,17 +1539,8 @@ namespace mnemosy::systems {
 
 		m_selectedFolderNode = node;
 
-		systems::ThumbnailManager& thumbnailManager = MnemosyEngine::GetInstance().GetThumbnailManager();
-
-		// unload all currently loaded thumbnails
-		thumbnailManager.UnloadAllThumbnails();
-
-		if (m_selectedFolderNode->HasMaterials()) {
-
-			for (int i = 0; i < m_selectedFolderNode->subEntries.size(); i++) {
-				thumbnailManager.AddLibEntryToActiveThumbnails(m_selectedFolderNode->subEntries[i]);
-			}
-		}
+		// unload all currently loaded thumbnails, the entries of the new folder are registered as the gui shows them
+		MnemosyEngine::GetInstance().GetThumbnailManager().UnloadAllThumbnails();
 	}
 
 	// ======== Getters ========
@@ -1453,10 +1552,16 @@ namespace mnemosy::systems {
 		return m_folderTree->GetRootPtr();
 	}
 
-	FolderNode* MaterialLibraryRegistry::GetFolderByID(FolderNode* node, const unsigned int id) {
+	FolderNode* MaterialLibraryRegistry::GetFolderByID(const uint32_t id) {
 
 		MNEMOSY_ASSERT(m_folderTree != nullptr, "This should not be called if no collection is active");
-		return m_folderTree->RecursivGetNodeByID(node,id);
+		return m_folderTree->GetNodeByID(id);
+	}
+
+	LibEntry* MaterialLibraryRegistry::GetLibEntryByID(const uint32_t id) {
+
+		MNEMOSY_ASSERT(m_folderTree != nullptr, "This should not be called if no collection is active");
+		return m_folderTree->GetLibEntryByID(id);
 	}
 
 	std::filesystem::path MaterialLibraryRegistry::Folder_GetFullPath(FolderNode* node)
@@ -1628,7 +1733,7 @@ namespace mnemosy::systems {
 		return systems::LibEntryType::MNSY_ENTRY_TYPE_PBRMAT;
 	}
 
-	bool MaterialLibraryRegistry::IsActiveEntry(uint16_t runtimeID) {
+	bool MaterialLibraryRegistry::IsActiveEntry(uint32_t runtimeID) {
 		if (UserEntrySelected()) {
 			if (m_activeLibEntry->runtime_ID == runtimeID) {
 				return true;
@@ -1933,6 +2038,8 @@ namespace mnemosy::systems {
 		}
 		else {
 			m_libCollection_currentSlected_id = index;
+			ActiveLibCollection_PrewarmFileCache();
+			m_libraryWatcher.RegisterDirectory(ActiveLibCollection_GetFolderPath(), true);
 			OpenFolderNode(m_folderTree->GetRootPtr());
 		}
 
@@ -1983,12 +2090,17 @@ namespace mnemosy::systems {
 		}
 
 		SetDefaultMaterial();
+		ActiveLibEntry_FinishLoading(false);
 
 		ActiveLibCollection_SaveToFile();
+		m_journal.Close();
+		m_libraryWatcher.Clear();
+		m_fileCache.Clear();
 
 		if (m_selectedFolderNode != nullptr) {
 			MnemosyEngine::GetInstance().GetThumbnailManager().UnloadAllThumbnails();
 		}
+		MnemosyEngine::GetInstance().GetThumbnailManager().CloseThumbnailPack();
 
 		m_selectedFolderNode = nullptr;
 
@@ -2001,6 +2113,81 @@ namespace mnemosy::systems {
 		m_libCollection_currentSlected_id = -1;
 	}
 
+	// lists every entry folder of the collection in the background so opening materials and thumbnails does not have to stat each of their files
+	void MaterialLibraryRegistry::ActiveLibCollection_PrewarmFileCache() {
+
+		std::vector<std::filesystem::path> entryFolders;
+		std::vector<FolderNode*> nodes = { m_folderTree->GetRootPtr() };
+
+		while (!nodes.empty()) {
+
+			FolderNode* node = nodes.back();
+			nodes.pop_back();
+
+			for (LibEntry* libEntry : node->subEntries) {
+				entryFolders.push_back(LibProcedures::LibEntry_GetFolderPath(libEntry));
+			}
+
+			nodes.insert(nodes.end(), node->subNodes.begin(), node->subNodes.end());
+		}
+
+		m_fileCache.Prewarm(entryFolders);
+	}
+
+	// Changes we made ourselves come through here as well, handling them again has to be harmless.
+	void MaterialLibraryRegistry::ActiveLibCollection_ProcessFileChanges() {
+
+		namespace fs = std::filesystem;
+
+		std::vector<fs::path> changedPaths;
+		m_libraryWatcher.PopChangedPaths(changedPaths);
+		if (changedPaths.empty())
+			return;
+
+		fs::path selectedFolderPath;
+		if (m_selectedFolderNode != nullptr && !inSearchMode) {
+			selectedFolderPath = Folder_GetFullPath(m_selectedFolderNode).lexically_normal();
+		}
+
+		ThumbnailManager& thumbnailManager = MnemosyEngine::GetInstance().GetThumbnailManager();
+		TiffStorageMigrator& tiffMigrator = MnemosyEngine::GetInstance().GetExportManager().GetTiffStorageMigrator();
+
+		for (const fs::path& path : changedPaths) {
+
+			fs::path folderPath = path.parent_path();
+
+			// the path may be a file or a whole folder
+			m_fileCache.InvalidateFolder(folderPath);
+			m_fileCache.InvalidateFolder(path);
+
+			// only entries in the open folder show a thumbnail, the others are checked against their files when they are shown the next time
+			if (selectedFolderPath.empty() || folderPath.parent_path() != selectedFolderPath)
+				continue;
+
+			LibEntry* libEntry = nullptr;
+			for (LibEntry* subEntry : m_selectedFolderNode->subEntries) {
+				if (fs::u8path(subEntry->name.str()) == folderPath.filename()) {
+					libEntry = subEntry;
+					break;
+				}
+			}
+
+			if (libEntry == nullptr)
+				continue;
+
+			fs::path fileName = path.filename();
+			if (fileName == fs::u8path(libEntry->name + "_thumbnail.ktx2")) {
+				thumbnailManager.RefreshThumbnail(libEntry);
+			}
+			// a texture was edited, the thumbnail of the active entry is rendered by the material editor already.
+			// Textures the tiff migration recompressed still look the same.
+			else if (fileName.extension() != fs::path(".mnsydata") && fileName.extension() != fs::path(".tmp") && libEntry != m_activeLibEntry
+				&& !tiffMigrator.WasRewrittenByMigration(path)) {
+				thumbnailManager.QueueThumbnailRender(libEntry);
+			}
+		}
+	}
+
 	std::string MaterialLibraryRegistry::LibCollections_MakeNameUnique(const std::string& name) {
 
 
@@ -0,0 +1,211 @@
+#include "Include/Systems/SearchIndex.h"
+
+#include "Include/Core/Log.h"
+#include "Include/Core/Utils/StringUtils.h"
+#include "Include/Systems/FolderTreeNode.h"
+
+#include <algorithm>
+
+// stale ids are only dropped once there are more of them than live ones and at least this many
+#define SEARCH_INDEX_MIN_STALE_POSTINGS 4096
+
+namespace mnemosy::systems {
+
+	// unique trigrams of a lower case name, three bytes packed into one key
+	static void SearchIndex_CollectTrigrams(const std::string& lowerName, std::vector<uint32_t>& outTrigrams) {
+
+		outTrigrams.clear();
+
+		if (lowerName.size() < 3)
+			return;
+
+		for (size_t i = 0; i + 3 <= lowerName.size(); i++) {
+
+			uint32_t trigram = (uint32_t)(uint8_t)lowerName[i] | ((uint32_t)(uint8_t)lowerName[i + 1] << 8) | ((uint32_t)(uint8_t)lowerName[i + 2] << 16);
+			outTrigrams.push_back(trigram);
+		}
+
+		std::sort(outTrigrams.begin(), outTrigrams.end());
+		outTrigrams.erase(std::unique(outTrigrams.begin(), outTrigrams.end()), outTrigrams.end());
+	}
+
+	void SearchIndex::Add(LibEntry* libEntry) {
+
+		MNEMOSY_ASSERT(libEntry != nullptr, "Cannot index a nullptr");
+
+		if (m_slotOfEntry.count(libEntry) != 0)
+			return;
+
+		uint32_t slot;
+		if (!m_freeSlots.empty()) {
+			slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else {
+			slot = (uint32_t)m_slots.size();
+			m_slots.emplace_back();
+		}
+
+		m_slots[slot].libEntry = libEntry;
+		m_slots[slot].lowerName = core::StringUtils::ToLowerCase(libEntry->name);
+		m_slotOfEntry[libEntry] = slot;
+
+		AddPostings_Internal(slot);
+		m_version++;
+	}
+
+	void SearchIndex::Remove(LibEntry* libEntry) {
+
+		auto it = m_slotOfEntry.find(libEntry);
+		if (it == m_slotOfEntry.end())
+			return;
+
+		Slot& slot = m_slots[it->second];
+
+		// the ids stay in the trigram lists until the next rebuild
+		std::vector<uint32_t> trigrams;
+		SearchIndex_CollectTrigrams(slot.lowerName, trigrams);
+		m_livePostingsCount -= trigrams.size();
+		m_stalePostingsCount += trigrams.size();
+
+		slot.libEntry = nullptr;
+		slot.lowerName.clear();
+		m_freeSlots.push_back(it->second);
+		m_slotOfEntry.erase(it);
+
+		m_version++;
+
+		if (m_stalePostingsCount > SEARCH_INDEX_MIN_STALE_POSTINGS && m_stalePostingsCount > m_livePostingsCount) {
+			RebuildPostings_Internal();
+		}
+	}
+
+	void SearchIndex::Rename(LibEntry* libEntry) {
+
+		Remove(libEntry);
+		Add(libEntry);
+	}
+
+	void SearchIndex::Clear() {
+
+		m_slots.clear();
+		m_freeSlots.clear();
+		m_slotOfEntry.clear();
+		m_postings.clear();
+		m_livePostingsCount = 0;
+		m_stalePostingsCount = 0;
+
+		m_version++;
+		m_lastKeyword.clear();
+		m_lastResultSlots.clear();
+	}
+
+	void SearchIndex::Search(const std::string& keyword, std::vector<LibEntry*>& outResults) {
+
+		outResults.clear();
+
+		std::string lowerKeyword = core::StringUtils::ToLowerCase(keyword);
+
+		// stamps of all slots are reset when the counter wraps around
+		m_searchStamp++;
+		if (m_searchStamp == 0) {
+			for (Slot& slot : m_slots) {
+				slot.searchStamp = 0;
+			}
+			m_searchStamp = 1;
+		}
+
+		// candidates are the smallest of: the previous results if the keyword extends the previous one, the entries of the rarest trigram, all entries
+		const std::vector<uint32_t>* candidates = nullptr;
+
+		bool canNarrow = m_lastSearchVersion == m_version && !m_lastKeyword.empty() && lowerKeyword.find(m_lastKeyword) != std::string::npos;
+		if (canNarrow) {
+			candidates = &m_lastResultSlots;
+		}
+
+		static const std::vector<uint32_t> noCandidates;
+
+		std::vector<uint32_t> trigrams;
+		SearchIndex_CollectTrigrams(lowerKeyword, trigrams);
+
+		for (uint32_t trigram : trigrams) {
+
+			auto it = m_postings.find(trigram);
+			if (it == m_postings.end()) {
+				candidates = &noCandidates; // no entry contains this trigram
+				break;
+			}
+
+			if (candidates == nullptr || it->second.size() < candidates->size()) {
+				candidates = &it->second;
+			}
+		}
+
+		std::vector<uint32_t> resultSlots;
+
+		if (candidates) {
+			for (uint32_t slot : *candidates) {
+				if (MatchSlot_Internal(slot, lowerKeyword)) {
+					resultSlots.push_back(slot);
+				}
+			}
+		}
+		else {
+			for (uint32_t slot = 0; slot < m_slots.size(); slot++) {
+				if (MatchSlot_Internal(slot, lowerKeyword)) {
+					resultSlots.push_back(slot);
+				}
+			}
+		}
+
+		outResults.reserve(resultSlots.size());
+		for (uint32_t slot : resultSlots) {
+			outResults.push_back(m_slots[slot].libEntry);
+		}
+
+		m_lastSearchVersion = m_version;
+		m_lastKeyword = lowerKeyword;
+		m_lastResultSlots = std::move(resultSlots);
+	}
+
+	// private
+
+	bool SearchIndex::MatchSlot_Internal(const uint32_t slot, const std::string& lowerKeyword) {
+
+		Slot& s = m_slots[slot];
+
+		if (s.libEntry == nullptr || s.searchStamp == m_searchStamp)
+			return false;
+
+		s.searchStamp = m_searchStamp;
+
+		return s.lowerName.find(lowerKeyword) != std::string::npos;
+	}
+
+	void SearchIndex::AddPostings_Internal(const uint32_t slot) {
+
+		std::vector<uint32_t> trigrams;
+		SearchIndex_CollectTrigrams(m_slots[slot].lowerName, trigrams);
+
+		for (uint32_t trigram : trigrams) {
+			m_postings[trigram].push_back(slot);
+		}
+
+		m_livePostingsCount += trigrams.size();
+	}
+
+	void SearchIndex::RebuildPostings_Internal() {
+
+		m_postings.clear();
+		m_livePostingsCount = 0;
+		m_stalePostingsCount = 0;
+
+		for (uint32_t slot = 0; slot < m_slots.size(); slot++) {
+
+			if (m_slots[slot].libEntry) {
+				AddPostings_Internal(slot);
+			}
+		}
+	}
+
+} // !mnemosy::systems
@@ -3,12 +3,15 @@
 #include "Include/MnemosyEngine.h"
 #include "Include/Core/FileDirectories.h"
 #include "Include/Core/Log.h"
+#include "Include/Core/JobSystem.h"
 
 #include "Include/Systems/ExportManager.h"
+#include "Include/Systems/LibraryProcedures.h"
 
 #include "Include/Systems/MeshRegistry.h"
 #include "Include/Graphics/TextureDefinitions.h"
 #include "Include/Graphics/Utils/KtxImage.h"
+#include "Include/Graphics/Utils/ChannelPacker.h"
 #include "Include/Graphics/Texture.h"
 #include "Include/Graphics/Material.h"
 #include "Include/Graphics/Shader.h"
@@ -277,11 +280,6 @@ namespace mnemosy::systems
 		{
 			// sampler R channel
 			bool channel_r_assignSampler = true;
-			bool channel_r_isSingleChannel = true;
-
-			if ((int)packComponent_R < 10) {
-				channel_r_isSingleChannel = false;
-			}
 
 			graphics::Texture* channel_r_tex = material.GetTextureFromPackComponent(packComponent_R);
 
@@ -294,7 +292,7 @@ namespace mnemosy::systems
 			}
 
 			m_pTextureGenShader->SetUniformBool("_channel_r_isAssigned", channel_r_assignSampler);
-			m_pTextureGenShader->SetUniformBool("_channel_r_isSingleChannel", channel_r_isSingleChannel);
+			m_pTextureGenShader->SetUniformInt("_channel_r_sourceChannel", (int)graphics::TexUtil::get_sourceChannel_from_channelPackComponent(packComponent_R));
 
 			if (channel_r_assignSampler) {
 				channel_r_tex->BindToLocation(1);
@@ -316,11 +314,6 @@ namespace mnemosy::systems
 
 			// sampler G channel
 			bool channel_g_assignSampler = true;
-			bool channel_g_isSingleChannel = true;
-
-			if ((int)packComponent_G < 10) {
-				channel_g_isSingleChannel = false;
-			}
 
 			graphics::Texture* channel_g_tex = material.GetTextureFromPackComponent(packComponent_G);
 
@@ -332,7 +325,7 @@ namespace mnemosy::systems
 			}
 
 			m_pTextureGenShader->SetUniformBool("_channel_g_isAssigned", channel_g_assignSampler);
-			m_pTextureGenShader->SetUniformBool("_channel_g_isSingleChannel", channel_g_isSingleChannel);
+			m_pTextureGenShader->SetUniformInt("_channel_g_sourceChannel", (int)graphics::TexUtil::get_sourceChannel_from_channelPackComponent(packComponent_G));
 
 			if (channel_g_assignSampler) {
 				channel_g_tex->BindToLocation(2);
@@ -354,11 +347,6 @@ namespace mnemosy::systems
 
 			// sampler B channel
 			bool channel_b_assignSampler = true;
-			bool channel_b_isSingleChannel = true;
-
-			if ((int)packComponent_B < 10) {
-				channel_b_isSingleChannel = false;
-			}
 
 			graphics::Texture* channel_b_tex = material.GetTextureFromPackComponent(packComponent_B);
 
@@ -370,7 +358,7 @@ namespace mnemosy::systems
 			}
 
 			m_pTextureGenShader->SetUniformBool("_channel_b_isAssigned", channel_b_assignSampler);
-			m_pTextureGenShader->SetUniformBool("_channel_b_isSingleChannel", channel_b_isSingleChannel);
+			m_pTextureGenShader->SetUniformInt("_channel_b_sourceChannel", (int)graphics::TexUtil::get_sourceChannel_from_channelPackComponent(packComponent_B));
 
 			if (channel_b_assignSampler) {
 				channel_b_tex->BindToLocation(3);
@@ -393,11 +381,6 @@ namespace mnemosy::systems
 			if (packType == graphics::MNSY_PACKTYPE_RGBA) {
 			
 				bool channel_a_assignSampler = true;
-				bool channel_a_isSingleChannel = true;
-
-				if ((int)packComponent_A < 10) {
-					channel_a_isSingleChannel = false;
-				}
 
 				graphics::Texture* channel_a_tex = material.GetTextureFromPackComponent(packComponent_A);
 
@@ -409,7 +392,7 @@ namespace mnemosy::systems
 				}
 
 				m_pTextureGenShader->SetUniformBool("_channel_a_isAssigned", channel_a_assignSampler);
-				m_pTextureGenShader->SetUniformBool("_channel_a_isSingleChannel", channel_a_isSingleChannel);
+				m_pTextureGenShader->SetUniformInt("_channel_a_sourceChannel", (int)graphics::TexUtil::get_sourceChannel_from_channelPackComponent(packComponent_A));
 
 				if (channel_a_assignSampler) {
 					channel_a_tex->BindToLocation(4);
@@ -480,6 +463,101 @@ namespace mnemosy::systems
 		return true; // everything succeeded
 	}
 
+	bool TextureGenerationManager::GenerateChannelPackedTexture_Cpu(graphics::PbrMaterial& material, const fs::path& materialDir, const std::string& entryName, const char* exportPath, graphics::ChannelPackType packType, graphics::ChannelPackComponent packComponent_R, graphics::ChannelPackComponent packComponent_G, graphics::ChannelPackComponent packComponent_B, graphics::ChannelPackComponent packComponent_A, unsigned int width, unsigned int height, uint8_t bitDepth)
+	{
+		if (width == 0 || height == 0 || width > UINT16_MAX || height > UINT16_MAX) {
+			MNEMOSY_ERROR("ChannelPacking: Resolution {}x{} is not supported", width, height);
+			return false;
+		}
+
+		graphics::ChannelPackComponent components[4] = { packComponent_R, packComponent_G, packComponent_B, packComponent_A };
+		uint8_t numChannels = packType == graphics::MNSY_PACKTYPE_RGBA ? 4 : 3;
+
+		// each texture is read once, even if several channels use it
+		graphics::PictureInfo pictures[graphics::MNSY_TEXTURE_COUNT];
+		graphics::PictureError errors[graphics::MNSY_TEXTURE_COUNT];
+		bool isUsed[graphics::MNSY_TEXTURE_COUNT] = {};
+
+		for (uint8_t c = 0; c < numChannels; c++) {
+
+			if (components[c] == graphics::MNSY_PACKCOMPONENT_NONE)
+				continue;
+
+			if (material.GetTextureFromPackComponent(components[c]) == nullptr) {
+
+				std::string packComponentString = graphics::TexUtil::get_string_from_channelPackComponent(components[c]);
+				MNEMOSY_WARN("ChannelPacking: Texture for pack type {} is not assigned, result may not be as expected", packComponentString);
+				MNEMOSY_POPUP("ChannelPacking: Texture for pack type {} is not assigned, result may not be as expected", packComponentString);
+				continue;
+			}
+
+			isUsed[graphics::TexUtil::get_PBRTextureType_from_channelPackComponent(components[c])] = true;
+		}
+
+		core::JobSystem& jobSystem = MnemosyEngine::GetInstance().GetJobSystem();
+		std::shared_ptr<core::JobGroup> readJobs = core::JobSystem::CreateGroup();
+
+		for (int i = 0; i < graphics::MNSY_TEXTURE_COUNT; i++) {
+
+			if (!isUsed[i])
+				continue;
+
+			graphics::PictureError* error = &errors[i];
+			graphics::PictureInfo* picture = &pictures[i];
+			jobSystem.Submit(readJobs, [error, picture, &materialDir, &entryName, i]() {
+				LibProcedures::PbrMaterial_ReadTexture(*error, *picture, materialDir, entryName, (graphics::PBRTextureType)i);
+			}, core::MNSY_JOB_PRIORITY_HIGH);
+		}
+
+		jobSystem.Wait(readJobs);
+
+		bool success = true;
+
+		for (int i = 0; i < graphics::MNSY_TEXTURE_COUNT; i++) {
+
+			if (isUsed[i] && !errors[i].wasSuccessfull) {
+				MNEMOSY_WARN("ChannelPacking: Failed to read {} texture \nMessage: {}", graphics::TexUtil::get_string_from_PBRTextureType((graphics::PBRTextureType)i), errors[i].what);
+				success = false;
+			}
+		}
+
+		if (success) {
+
+			graphics::ChannelPackSource sources[4];
+
+			for (uint8_t c = 0; c < numChannels; c++) {
+
+				graphics::ChannelPackComponent component = components[c];
+				graphics::PBRTextureType type = graphics::TexUtil::get_PBRTextureType_from_channelPackComponent(component);
+
+				if (type != graphics::MNSY_TEXTURE_NONE && isUsed[type]) {
+					sources[c].picture = &pictures[type];
+				}
+
+				sources[c].channel = graphics::TexUtil::get_sourceChannel_from_channelPackComponent(component);
+				sources[c].value = material.GetDefaultValueFromPackComponent(component);
+				sources[c].invert = component == graphics::MNSY_PACKCOMPONENT_SMOOTHNESS;
+			}
+
+			// textures are read bottom row first like on the gpu
+			graphics::PictureError packError;
+			graphics::ChannelPacker::PackToTiff(packError, exportPath, sources, numChannels, (uint16_t)width, (uint16_t)height, bitDepth, true);
+
+			if (!packError.wasSuccessfull) {
+				MNEMOSY_ERROR("ChannelPacking: Failed to write channel packed texture \nMessage: {}", packError.what);
+				success = false;
+			}
+		}
+
+		for (int i = 0; i < graphics::MNSY_TEXTURE_COUNT; i++) {
+			if (pictures[i].pixels) {
+				free(pictures[i].pixels);
+			}
+		}
+
+		return success;
+	}
+
 	bool TextureGenerationManager::IsInitialized() {
 
 		if (m_pTextureGenShader == nullptr)
@@ -0,0 +1,332 @@
+#include "Include/Systems/ThumbnailBatchRegenerator.h"
+
+#include "Include/MnemosyEngine.h"
+#include "Include/Core/Log.h"
+#include "Include/Core/Clock.h"
+#include "Include/Core/JobSystem.h"
+#include "Include/Systems/FolderTreeNode.h"
+#include "Include/Systems/LibraryProcedures.h"
+#include "Include/Systems/ThumbnailManager.h"
+#include "Include/Graphics/Renderer.h"
+#include "Include/Graphics/Material.h"
+#include "Include/Graphics/Skybox.h"
+#include "Include/Graphics/TextureDefinitions.h"
+#include "Include/Graphics/Utils/KtxImage.h"
+
+#include <glad/glad.h>
+#include <string.h>
+
+// materials whose textures are decoded ahead of the one that is rendered
+#define THUMBNAIL_BATCH_MATERIALS_IN_FLIGHT 8
+// rendered thumbnails waiting to be read back before the main thread waits for the oldest one
+#define THUMBNAIL_BATCH_READBACKS_IN_FLIGHT 4
+// textures do not need more resolution than this for a thumbnail of at most 512 pixels
+#define THUMBNAIL_BATCH_TEXTURE_RESOLUTION 1024
+// read back buffers are sized for the largest thumbnail resolution so they can be reused for any
+#define THUMBNAIL_BATCH_READBACK_BUFFER_SIZE (512 * 512 * 3)
+
+namespace mnemosy::systems {
+
+	void ThumbnailBatchRegenerator::Shutdown() {
+
+		Cancel();
+
+		while (!m_readbacks.empty()) {
+			glDeleteSync((GLsync)m_readbacks.front().fence);
+			m_freeBuffers.push_back(m_readbacks.front().bufferID);
+			m_readbacks.pop_front();
+		}
+
+		// encode jobs reference this object
+		if (m_encodeJobs) {
+			MnemosyEngine::GetInstance().GetJobSystem().Wait(m_encodeJobs);
+		}
+
+		LibEntry* libEntry = nullptr;
+		while (m_encodedEntries.TryPop(libEntry)) {}
+
+		for (unsigned int bufferID : m_freeBuffers) {
+			glDeleteBuffers(1, &bufferID);
+		}
+		m_freeBuffers.clear();
+
+		m_entries.clear();
+		m_isRunning = false;
+	}
+
+	void ThumbnailBatchRegenerator::Start(FolderNode* node) {
+
+		MNEMOSY_ASSERT(node != nullptr, "Batch needs a folder to start from");
+
+		if (m_isRunning) {
+			MNEMOSY_WARN("Thumbnails are already being regenerated");
+			return;
+		}
+
+		m_entries.clear();
+		CollectEntries_Internal(node);
+
+		m_nextEntry = 0;
+		m_finishedCount = 0;
+		m_failedCount = 0;
+		m_encodeJobs = core::JobSystem::CreateGroup();
+		m_startTime = MnemosyEngine::GetInstance().GetClock().GetTimeSinceLaunch();
+
+		m_isRunning = !m_entries.empty();
+
+		MNEMOSY_INFO("Regenerating {} thumbnails", m_entries.size());
+	}
+
+	// Entries that are still loading are dropped, thumbnails that are already rendered are still written
+	void ThumbnailBatchRegenerator::Cancel() {
+
+		if (!m_isRunning)
+			return;
+
+		for (LoadingEntry& entry : m_loading) {
+
+			if (entry.loadState) {
+				entry.loadState->jobs->Cancel();
+				LibProcedures::LibEntry_PbrMaterial_CancelUploads(*entry.loadState);
+			}
+
+			if (entry.pbrMat) {
+				delete entry.pbrMat;
+			}
+		}
+
+		m_loading.clear();
+		m_nextEntry = m_entries.size();
+
+		MNEMOSY_INFO("Regenerating thumbnails cancelled");
+	}
+
+	void ThumbnailBatchRegenerator::Update(const double budgetSeconds) {
+
+		if (!m_isRunning)
+			return;
+
+		core::Clock& clock = MnemosyEngine::GetInstance().GetClock();
+		double endTime = clock.GetTimeSinceLaunch() + budgetSeconds;
+
+		do {
+			// stage 3, hand finished read backs to the encode jobs
+			while (!m_readbacks.empty() && FinishReadback_Internal(m_readbacks.front(), false)) {
+				m_readbacks.pop_front();
+			}
+
+			// stage 1, keep the job system busy decoding the next materials
+			while (m_loading.size() < THUMBNAIL_BATCH_MATERIALS_IN_FLIGHT && m_nextEntry < m_entries.size()) {
+				StartLoading_Internal(m_entries[m_nextEntry]);
+				m_nextEntry++;
+			}
+
+			if (m_loading.empty())
+				break;
+
+			if (m_readbacks.size() >= THUMBNAIL_BATCH_READBACKS_IN_FLIGHT) {
+				FinishReadback_Internal(m_readbacks.front(), true);
+				m_readbacks.pop_front();
+			}
+
+			// stage 2, materials are rendered in order, if the next one is still decoding we try again next update
+			if (!RenderThumbnail_Internal(m_loading.front()))
+				break;
+
+			m_loading.pop_front();
+
+		} while (clock.GetTimeSinceLaunch() < endTime);
+
+		// thumbnails that are on screen show the new version
+		ThumbnailManager& thumbnailManager = MnemosyEngine::GetInstance().GetThumbnailManager();
+		LibEntry* encodedEntry = nullptr;
+		while (m_encodedEntries.TryPop(encodedEntry)) {
+			thumbnailManager.RefreshThumbnail(encodedEntry);
+		}
+
+		// everything is rendered, wait for the last read backs and encodes
+		if (m_loading.empty() && m_nextEntry == m_entries.size()) {
+
+			while (!m_readbacks.empty()) {
+				FinishReadback_Internal(m_readbacks.front(), true);
+				m_readbacks.pop_front();
+			}
+
+			if (m_encodeJobs->IsDone()) {
+				Finish_Internal();
+			}
+		}
+	}
+
+	// private
+
+	void ThumbnailBatchRegenerator::StartLoading_Internal(LibEntry* libEntry) {
+
+		LoadingEntry entry;
+		entry.libEntry = libEntry;
+
+		// unlit materials and skyboxes are loaded when they are rendered
+		if (libEntry->type == LibEntryType::MNSY_ENTRY_TYPE_PBRMAT) {
+			entry.pbrMat = LibProcedures::LibEntry_PbrMaterial_LoadFromFile_Async(libEntry, true, THUMBNAIL_BATCH_TEXTURE_RESOLUTION, entry.loadState, true);
+		}
+
+		m_loading.push_back(entry);
+	}
+
+	// returns false if the textures of the entry are not decoded yet
+	bool ThumbnailBatchRegenerator::RenderThumbnail_Internal(LoadingEntry& entry) {
+
+		graphics::Renderer& renderer = MnemosyEngine::GetInstance().GetRenderer();
+		LibEntry* libEntry = entry.libEntry;
+
+		if (libEntry->type == LibEntryType::MNSY_ENTRY_TYPE_PBRMAT) {
+
+			if (!LibProcedures::LibEntry_PbrMaterial_UploadDecodedTextures(*entry.pbrMat, *entry.loadState, SIZE_MAX))
+				return false;
+
+			renderer.RenderThumbnail_PbrMaterial(*entry.pbrMat);
+
+			delete entry.pbrMat;
+			entry.pbrMat = nullptr;
+			entry.loadState = nullptr;
+		}
+		else if (libEntry->type == LibEntryType::MNSY_ENTRY_TYPE_UNLITMAT) {
+
+			graphics::UnlitMaterial* unlitMat = LibProcedures::LibEntry_UnlitMaterial_LoadFromFile(libEntry, true);
+			renderer.RenderThumbnail_UnlitMaterial(unlitMat);
+			delete unlitMat;
+		}
+		else if (libEntry->type == LibEntryType::MNSY_ENTRY_TYPE_SKYBOX) {
+
+			std::filesystem::path entryFolder = LibProcedures::LibEntry_GetFolderPath(libEntry);
+			graphics::Skybox* sky = LibProcedures::LibEntry_SkyboxMaterial_LoadFromFile(entryFolder, libEntry->name, true);
+			renderer.RenderThumbnail_SkyboxMaterial(*sky);
+			delete sky;
+		}
+
+		StartReadback_Internal(libEntry);
+		return true;
+	}
+
+	// copies the thumbnail render texture into a pixel buffer without waiting for the gpu
+	void ThumbnailBatchRegenerator::StartReadback_Internal(LibEntry* libEntry) {
+
+		graphics::Renderer& renderer = MnemosyEngine::GetInstance().GetRenderer();
+
+		Readback readback;
+		readback.libEntry = libEntry;
+		readback.thumbnailPath = LibProcedures::LibEntry_GetFolderPath(libEntry) / std::filesystem::u8path(libEntry->name + "_thumbnail.ktx2");
+		readback.resolution = (uint16_t)renderer.GetThumbnailResolutionValue(renderer.GetThumbnailResolutionEnum());
+
+		if (!m_freeBuffers.empty()) {
+			readback.bufferID = m_freeBuffers.back();
+			m_freeBuffers.pop_back();
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.bufferID);
+		}
+		else {
+			glGenBuffers(1, &readback.bufferID);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.bufferID);
+			glBufferStorage(GL_PIXEL_PACK_BUFFER, THUMBNAIL_BATCH_READBACK_BUFFER_SIZE, nullptr, GL_MAP_READ_BIT);
+		}
+
+		glBindTexture(GL_TEXTURE_2D, renderer.GetThumbnailRenderTextureID());
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		m_readbacks.push_back(readback);
+	}
+
+	// returns false if the copy has not finished yet and wait is false
+	bool ThumbnailBatchRegenerator::FinishReadback_Internal(Readback& readback, const bool wait) {
+
+		GLenum status = glClientWaitSync((GLsync)readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? GL_TIMEOUT_IGNORED : 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+			return false;
+
+		glDeleteSync((GLsync)readback.fence);
+		readback.fence = nullptr;
+
+		size_t size = (size_t)readback.resolution * readback.resolution * 3;
+		uint8_t* pixels = (uint8_t*)malloc(size);
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.bufferID);
+		void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+		if (mapped && pixels) {
+			memcpy(pixels, mapped, size);
+		}
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		m_freeBuffers.push_back(readback.bufferID);
+
+		if (!mapped || !pixels) {
+			MNEMOSY_ERROR("Failed to read back thumbnail of {}", readback.libEntry->name.str());
+			free(pixels);
+			m_failedCount++;
+			return true;
+		}
+
+		LibEntry* libEntry = readback.libEntry;
+		std::filesystem::path thumbnailPath = readback.thumbnailPath;
+		uint16_t resolution = readback.resolution;
+
+		// stage 3, encode and write the file. A temporary file is renamed over the old thumbnail so it is never read half written.
+		MnemosyEngine::GetInstance().GetJobSystem().Submit(m_encodeJobs, [this, libEntry, thumbnailPath, resolution, pixels]() {
+
+			namespace fs = std::filesystem;
+
+			fs::path tmpPath = thumbnailPath;
+			tmpPath += ".tmp";
+
+			graphics::KtxImage thumbnailKtx;
+			unsigned int errorCode = thumbnailKtx.Save_WithoutMips(tmpPath.generic_string().c_str(), pixels, false, graphics::TextureFormat::MNSY_RGB8, resolution, resolution, false);
+			free(pixels);
+
+			std::error_code ec;
+			if (errorCode == 0) {
+				fs::rename(tmpPath, thumbnailPath, ec);
+			}
+
+			if (errorCode != 0 || ec) {
+				MNEMOSY_ERROR("Failed to write thumbnail: {}", thumbnailPath.generic_string());
+				fs::remove(tmpPath, ec);
+				m_failedCount++;
+				return;
+			}
+
+			m_finishedCount++;
+			m_encodedEntries.Push(libEntry);
+
+		}, core::MNSY_JOB_PRIORITY_NORMAL);
+
+		return true;
+	}
+
+	void ThumbnailBatchRegenerator::CollectEntries_Internal(FolderNode* node) {
+
+		for (LibEntry* libEntry : node->subEntries) {
+			m_entries.push_back(libEntry);
+		}
+
+		for (FolderNode* subNode : node->subNodes) {
+			CollectEntries_Internal(subNode);
+		}
+	}
+
+	void ThumbnailBatchRegenerator::Finish_Internal() {
+
+		double seconds = MnemosyEngine::GetInstance().GetClock().GetTimeSinceLaunch() - m_startTime;
+
+		MNEMOSY_INFO("Regenerated {} of {} thumbnails in {} seconds, {} failed", (uint32_t)m_finishedCount, m_entries.size(), seconds, (uint32_t)m_failedCount);
+
+		m_entries.clear();
+		m_nextEntry = 0;
+		m_isRunning = false;
+	}
+
+} // !mnemosy::systems
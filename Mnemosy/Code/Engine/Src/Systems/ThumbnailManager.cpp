@@ -2,6 +2,8 @@
 
 #include "Include/Core/Log.h"
 #include "Include/MnemosyEngine.h"
+#include "Include/Core/Clock.h"
+#include "Include/Core/JobSystem.h"
 #include "Include/Systems/MaterialLibraryRegistry.h"
 #include "Include/Systems/LibraryProcedures.h"
 #include "Include/Graphics/Renderer.h"
@@ -12,13 +14,25 @@
 #include "Include/Graphics/Material.h"
 #include "Include/Graphics/ThumbnailScene.h"
 #include "Include/Graphics/Camera.h"
+#include "Include/Graphics/Texture.h"
+#include "Include/Graphics/TextureDefinitions.h"
+#include "Include/Graphics/Utils/Picture.h"
 
 #include <glad/glad.h>
+#include <algorithm>
+
+// one pack per library collection, lives in the collection folder next to the data file
+#define THUMBNAIL_PACK_FILENAME "MnemosyThumbnailPack.mnsypack"
+#define THUMBNAIL_ATLAS_PAGE_SIZE 2048
+#define THUMBNAIL_ATLAS_MAX_TILE_SIZE 512
+// thumbnails that were not on screen for a while are unloaded once more than this are loaded
+#define THUMBNAIL_MAX_LOADED_OFFSCREEN 256
+#define THUMBNAIL_EVICT_AFTER_FRAMES 60
 
 namespace mnemosy::systems {
 
 	void ThumbnailManager::Init() {
-		m_activeEntriesFullyLoaded = false;
+		m_decodeGroup = core::JobSystem::CreateGroup();
 	}
 
 	void ThumbnailManager::Shutdown() {
@@ -27,7 +41,23 @@ namespace mnemosy::systems {
 			m_thumbnailsQuedForRefresh.clear();
 		}
 
+		m_batchRegenerator.Shutdown();
+
+		// jobs still reading files push into m_decodeResults, wait for them before anything below cancels them again and forgets their group
+		MnemosyEngine::GetInstance().GetJobSystem().Wait(CancelDecodes_Internal());
+
 		UnloadAllThumbnails();
+		CloseThumbnailPack();
+
+		DecodeResult result;
+		while (m_decodeResults.TryPop(result)) {
+			free(result.pixels);
+		}
+
+		for (AtlasPage& page : m_atlasPages) {
+			glDeleteTextures(1, &page.textureID);
+		}
+		m_atlasPages.clear();
 	}
 
 	void ThumbnailManager::Update() {
@@ -41,34 +71,73 @@ namespace mnemosy::systems {
 			for (int i = 0; i < m_thumbnailsQuedForRefresh.size(); i++) {
 
 				DeleteThumbnailGLTexture_Internal(m_thumbnailsQuedForRefresh[i]);
+				// a read that is still in flight would bring back the old pixels, its ticket is not pending anymore once erased
+				m_pendingDecodes.erase(m_thumbnailsQuedForRefresh[i]->runtime_ID);
 			}
 
 			m_thumbnailsQuedForRefresh.clear();
-			m_activeEntriesFullyLoaded = false;
+		}
+
+		// imGui is done drawing last frame so pages nobody uses anymore can go now
+		DeleteEmptyAtlasPages_Internal();
+
+		if (m_batchRegenerator.IsRunning()) {
+			m_batchRegenerator.Update(m_batchBudgetMilliseconds / 1000.0);
 		}
 		
+		m_frameIndex++;
+
 		//  Loading thumbnails
-		if (m_activeEntries.empty())
+		if (m_activeEntriesByID.empty()) {
+			m_visibleEntryIDs.clear();
 			return;
+		}
+
+		// only thumbnails the gui reported as on screen are loaded, the others are unloaded again after a while
+		EvictOffscreenThumbnails_Internal();
 
-		if (m_activeEntriesFullyLoaded)
+		if (m_visibleEntryIDs.empty() && m_pendingDecodes.empty() && m_thumbnailsQuedForRendering.empty()) {
 			return;
+		}
 
-		
-		for (int i = 0; i < m_activeEntries.size(); i++) {
+		OpenPackOfActiveCollection_Internal();
+
+		// Thumbnails found in the pack are copied straight from the mapped file, all others are read by workers.
+		// Copying into the atlas only happens as long as there is budget left this frame, everything else waits for the next one.
+		double budgetEndTime = MnemosyEngine::GetInstance().GetClock().GetTimeSinceLaunch() + m_uploadBudgetMilliseconds / 1000.0;
 
-			if (!m_activeEntries[i]->thumbnailLoaded) {
+		DecodeResult result;
+		while (MnemosyEngine::GetInstance().GetClock().GetTimeSinceLaunch() < budgetEndTime && m_decodeResults.TryPop(result)) {
+			HandleDecodeResult_Internal(result);
+		}
 
-				LoadThumbnailForMaterial_Internal(m_activeEntries[i]);
-				m_activeEntriesFullyLoaded = false;
-				return;
+		for (uint32_t runtimeID : m_visibleEntryIDs) {
+
+			auto it = m_activeEntriesByID.find(runtimeID);
+			if (it != m_activeEntriesByID.end()) {
+				LoadThumbnailForMaterial_Internal(it->second, budgetEndTime);
 			}
 		}
+		m_visibleEntryIDs.clear();
 
-		// if we reach this code it means all thumbnails in the list where loaded
-		
-		m_activeEntriesFullyLoaded = true;
+		// this is potentially super slow because we have to load all textures and stuff of the material, so only one per frame
+		if (!m_thumbnailsQuedForRendering.empty()) {
+
+			uint32_t runtimeID = *m_thumbnailsQuedForRendering.begin();
+			m_thumbnailsQuedForRendering.erase(m_thumbnailsQuedForRendering.begin());
 
+			auto it = m_activeEntriesByID.find(runtimeID);
+			if (it != m_activeEntriesByID.end()) {
+
+				MNEMOSY_WARN("Failed to load thumbnail, Generating new: {}", it->second->name.str());
+				RenderThumbnailForAnyLibEntry_Slow_Fallback(it->second);
+			}
+		}
+
+		// make the thumbnails read from ktx files available for the next time the folder is opened
+		if (m_pack.HasUnmappedRecords()) {
+			m_pack.Remap();
+		}
 	}
 
 	void ThumbnailManager::RenderThumbnailForActiveLibEntry(LibEntry* libEntry) {
@@ -112,19 +181,7 @@ namespace mnemosy::systems {
 		thumbnailKtx.ExportGlTexture(thumbnailAbsolutePath.generic_string().c_str(), renderer.GetThumbnailRenderTextureID(), 3, thumbnailRes, thumbnailRes, graphics::ktxImgFormat::MNSY_COLOR, false);
 
 
-		// check if the thumbnail is currently loaded and then que it for refresh
-		if (!m_activeEntries.empty()) {
-
-			for (int i = 0; i < m_activeEntries.size(); i++) {
-				
-				if (m_activeEntries[i]->runtime_ID == libEntry->runtime_ID) {
-					
-					m_thumbnailsQuedForRefresh.push_back(m_activeEntries[i]);
-					break;
-				}
-			}
-		}
-
+		RefreshThumbnail(libEntry);
 	}
 
 	void ThumbnailManager::RenderThumbnailForAnyLibEntry_Slow_Fallback(LibEntry* libEntry) {
@@ -141,7 +198,8 @@ namespace mnemosy::systems {
 		if (libEntry->type == systems::LibEntryType::MNSY_ENTRY_TYPE_PBRMAT) {
 
 
-			graphics::PbrMaterial* pbrMat = systems::LibProcedures::LibEntry_PbrMaterial_LoadFromFile_Multithreaded(libEntry,true);
+			uint16_t maxResolution = renderer.GetPreviewTextureResolutionValue(renderer.GetPreviewTextureResolutionEnum());
+			graphics::PbrMaterial* pbrMat = systems::LibProcedures::LibEntry_PbrMaterial_LoadFromFile_Multithreaded(libEntry, true, maxResolution);
 
 			renderer.RenderThumbnail_PbrMaterial(*pbrMat);
 			delete pbrMat;
@@ -171,118 +229,388 @@ namespace mnemosy::systems {
 		thumbnailKtx.ExportGlTexture(thumbnailPath.generic_string().c_str(), renderer.GetThumbnailRenderTextureID(), 3, thumbnailRes, thumbnailRes, graphics::ktxImgFormat::MNSY_COLOR, false);
 
 
+		RefreshThumbnail(libEntry);
+	}
+
+	void ThumbnailManager::RefreshThumbnail(LibEntry* libEntry) {
+
+		// the thumbnail file was just replaced, it may be read back before the next frame revalidates the folder
+		MnemosyEngine::GetInstance().GetMaterialLibraryRegistry().GetFileCache().InvalidateFolder(systems::LibProcedures::LibEntry_GetFolderPath(libEntry));
+
 		// check if the thumbnail is currently loaded and then que it for refresh
-		if (!m_activeEntries.empty()) {
+		auto it = m_activeEntriesByID.find(libEntry->runtime_ID);
+		if (it != m_activeEntriesByID.end()) {
+			m_thumbnailsQuedForRefresh.push_back(it->second);
+		}
+	}
 
-			for (int i = 0; i < m_activeEntries.size(); i++) {
+	void ThumbnailManager::QueueThumbnailRender(LibEntry* libEntry) {
 
-				if (m_activeEntries[i]->runtime_ID == libEntry->runtime_ID) {
+		if (m_activeEntriesByID.count(libEntry->runtime_ID) == 0)
+			return;
 
-					m_thumbnailsQuedForRefresh.push_back(m_activeEntries[i]);
-					break;
-				}
-			}
+		m_thumbnailsQuedForRendering.insert(libEntry->runtime_ID);
+	}
+
+	void ThumbnailManager::RemoveLibEntryFromActiveThumbnails(LibEntry* libEntry) {
+
+		MNEMOSY_ASSERT(libEntry != nullptr, "Should not happen");
+
+		if (m_activeEntriesByID.erase(libEntry->runtime_ID) == 0)
+			return;
+
+		DeleteThumbnailGLTexture_Internal(libEntry);
+		m_pendingDecodes.erase(libEntry->runtime_ID);
+		m_thumbnailsQuedForRendering.erase(libEntry->runtime_ID);
+		m_lastVisibleFrame.erase(libEntry->runtime_ID);
+	}
+
+	void ThumbnailManager::UnloadAllThumbnails() {
+
+
+		if (m_activeEntriesByID.empty())
+			return;
+
+		for (auto& [runtimeID, libEntry] : m_activeEntriesByID) {
+
+			DeleteThumbnailGLTexture_Internal(libEntry);
 		}
+
+		m_activeEntriesByID.clear();
+		m_visibleEntryIDs.clear();
+		m_thumbnailsQuedForRendering.clear();
+		m_lastVisibleFrame.clear();
+		CancelDecodes_Internal();
 	}
 
-	void ThumbnailManager::AddLibEntryToActiveThumbnails(LibEntry* libEntry) {
+	void ThumbnailManager::CloseThumbnailPack() {
+		m_pack.Close();
+	}
+
+	void ThumbnailManager::SetThumbnailVisible(LibEntry* libEntry) {
 
 		MNEMOSY_ASSERT(libEntry != nullptr, "NO!");
-		
 
-		// check if its already in the list
-		if (!m_activeEntries.empty()) {
+		m_activeEntriesByID.emplace(libEntry->runtime_ID, libEntry);
+		m_lastVisibleFrame[libEntry->runtime_ID] = m_frameIndex;
+
+		if (!libEntry->thumbnailLoaded) {
+			m_visibleEntryIDs.push_back(libEntry->runtime_ID);
+		}
+	}
+
+	void ThumbnailManager::GetThumbnailUVs(const LibEntry* libEntry, float& outU0, float& outV0, float& outU1, float& outV1) {
+
+		outU0 = 0.0f; outV0 = 1.0f;
+		outU1 = 1.0f; outV1 = 0.0f;
+
+		if (!libEntry->thumbnailLoaded)
+			return;
+
+		for (const AtlasPage& page : m_atlasPages) {
 
-			for (int i = 0; i < m_activeEntries.size(); i++) {
+			if (page.textureID != libEntry->thumbnailTexure_ID)
+				continue;
+
+			float x = (float)((libEntry->thumbnailAtlasTile % page.tilesPerRow) * page.tileSize);
+			float y = (float)((libEntry->thumbnailAtlasTile / page.tilesPerRow) * page.tileSize);
+			float texelSize = 1.0f / (float)THUMBNAIL_ATLAS_PAGE_SIZE;
+
+			// half a texel inset so linear filtering does not pick up the neighbouring tiles
+			outU0 = (x + 0.5f) * texelSize;
+			outU1 = (x + page.tileSize - 0.5f) * texelSize;
+			outV0 = (y + page.tileSize - 0.5f) * texelSize;
+			outV1 = (y + 0.5f) * texelSize;
+			return;
+		}
+	}
 
-				if (m_activeEntries[i]->runtime_ID == libEntry->runtime_ID) {
-					MNEMOSY_ERROR("Entry is already in the thumbnail list");
-					return;
+	// Frees the atlas tile of the thumbnail, the page itself is deleted in Update() once it is empty
+	void ThumbnailManager::DeleteThumbnailGLTexture_Internal(LibEntry* libEntry) {
+
+		MNEMOSY_ASSERT(libEntry != nullptr, "We should make sure to unload all thumbnails first");
+
+		if (libEntry->thumbnailLoaded) {
+
+			for (AtlasPage& page : m_atlasPages) {
+
+				if (page.textureID == libEntry->thumbnailTexure_ID && page.usedTiles[libEntry->thumbnailAtlasTile]) {
+
+					page.usedTiles[libEntry->thumbnailAtlasTile] = false;
+					page.usedTilesCount--;
+					break;
 				}
 			}
 		}
 
-		m_activeEntries.push_back(libEntry);
+		libEntry->thumbnailLoaded = false;
+		libEntry->thumbnailTexure_ID = 0;
+		libEntry->thumbnailAtlasTile = 0;
 
-		m_activeEntriesFullyLoaded = false;
+		m_loadedEntryIDs.erase(libEntry->runtime_ID);
 	}
 
-	void ThumbnailManager::RemoveLibEntryFromActiveThumbnails(LibEntry* libEntry) {
+	// Uploads the thumbnail from the pack if it is up to date there, otherwise a worker reads the ktx2 file
+	void ThumbnailManager::LoadThumbnailForMaterial_Internal(LibEntry* libEntry, const double budgetEndTime) {
+
+		uint32_t runtimeID = libEntry->runtime_ID;
+
+		if (libEntry->thumbnailLoaded || m_pendingDecodes.count(runtimeID) != 0 || m_thumbnailsQuedForRendering.count(runtimeID) != 0)
+			return;
 
-		if (m_activeEntries.empty())
+		if (MnemosyEngine::GetInstance().GetClock().GetTimeSinceLaunch() >= budgetEndTime)
 			return;
 
+		fs::path thumbnailPath = systems::LibProcedures::LibEntry_GetFolderPath(libEntry) / fs::u8path(libEntry->name + "_thumbnail.ktx2");
 
-		MNEMOSY_ASSERT(libEntry != nullptr, "Should not happen");
+		CachedFileInfo fileInfo;
+		if (!MnemosyEngine::GetInstance().GetMaterialLibraryRegistry().GetFileCache().GetFileInfo(thumbnailPath, fileInfo)) {
+			m_thumbnailsQuedForRendering.insert(runtimeID);
+			return;
+		}
+
+		ThumbnailStamp stamp;
+		stamp.size = fileInfo.size;
+		stamp.time = fileInfo.time;
+
+		std::string packKey = GetPackKey_Internal(libEntry);
+
+		uint16_t width, height;
+		uint8_t channels;
+		const uint8_t* pixels = m_pack.Find(packKey, stamp, width, height, channels);
+
+		if (pixels && UploadThumbnailToAtlas_Internal(libEntry, pixels, width, height, channels))
+			return;
+
+		SubmitThumbnailDecode_Internal(libEntry, thumbnailPath, packKey, stamp);
+	}
+
+	void ThumbnailManager::SubmitThumbnailDecode_Internal(LibEntry* libEntry, const std::filesystem::path& thumbnailPath, const std::string& packKey, const ThumbnailStamp& stamp) {
+
+		uint32_t ticket = m_nextDecodeTicket++;
+		m_pendingDecodes[libEntry->runtime_ID] = ticket;
+
+		DecodeResult result;
+		result.runtimeID = libEntry->runtime_ID;
+		result.ticket = ticket;
+		result.packKey = packKey;
+		result.stamp = stamp;
 
-		for (int i = 0; i < m_activeEntries.size(); i++) {
+		core::MpscQueue<DecodeResult>* decodeResults = &m_decodeResults;
+		std::string path = thumbnailPath.generic_string();
 
-			if (m_activeEntries[i]->runtime_ID == libEntry->runtime_ID) {
+		MnemosyEngine::GetInstance().GetJobSystem().Submit(m_decodeGroup, [decodeResults, path, result]() mutable {
 
-				DeleteThumbnailGLTexture_Internal(libEntry);
-				m_activeEntries.erase(m_activeEntries.begin() + i);
-				return;
+			graphics::KtxImage ktxThumbnail;
+			graphics::PictureInfo info;
+			uint32_t mipLevels = 0;
+
+			if (ktxThumbnail.LoadMipChain(path.c_str(), std::string(), THUMBNAIL_ATLAS_MAX_TILE_SIZE, info, mipLevels)) {
+
+				// only the first level is used
+				if (info.textureFormat == graphics::TextureFormat::MNSY_RGB8 || info.textureFormat == graphics::TextureFormat::MNSY_RGBA8) {
+					result.pixels = (uint8_t*)info.pixels;
+					result.width = info.width;
+					result.height = info.height;
+					result.channels = (uint8_t)graphics::TexUtil::get_channels_amount_from_textureFormat(info.textureFormat);
+				}
+				else {
+					free(info.pixels);
+				}
 			}
-		}
 
+			decodeResults->Push(std::move(result));
 
+		}, core::JobPriority::MNSY_JOB_PRIORITY_NORMAL);
 	}
 
-	void ThumbnailManager::UnloadAllThumbnails() {
+	// Adds the pixels read by a worker to the pack and uploads them to the atlas
+	void ThumbnailManager::HandleDecodeResult_Internal(DecodeResult& result) {
+
+		// the entry may have been refreshed and requested again while this read was running, that newer read is the one that counts
+		auto pendingIt = m_pendingDecodes.find(result.runtimeID);
+		bool isRequested = pendingIt != m_pendingDecodes.end() && pendingIt->second == result.ticket;
+		if (isRequested) {
+			m_pendingDecodes.erase(pendingIt);
+		}
 
+		auto it = m_activeEntriesByID.find(result.runtimeID);
 
-		if (m_activeEntries.empty())
-			return;
+		if (isRequested && it != m_activeEntriesByID.end() && !it->second->thumbnailLoaded) {
 
-		for (int i = 0; i < m_activeEntries.size(); i++) {
+			LibEntry* libEntry = it->second;
 
-			DeleteThumbnailGLTexture_Internal(m_activeEntries[i]);
+			if (result.pixels && UploadThumbnailToAtlas_Internal(libEntry, result.pixels, result.width, result.height, result.channels)) {
+				m_pack.Append(result.packKey, result.stamp, result.pixels, result.width, result.height, result.channels);
+			}
+			else {
+				MNEMOSY_WARN("Failed to load thumbnail for material: {}", libEntry->name.str());
+				m_thumbnailsQuedForRendering.insert(result.runtimeID);
+			}
 		}
 
-		m_activeEntries.clear();
-		m_activeEntriesFullyLoaded = true;
+		free(result.pixels);
+		result.pixels = nullptr;
 	}
 
-	// Delete the gl texture of the thumbnail
-	void ThumbnailManager::DeleteThumbnailGLTexture_Internal(LibEntry* libEntry) {
+	// Reads that are already running finish, their results are thrown away
+	std::shared_ptr<core::JobGroup> ThumbnailManager::CancelDecodes_Internal() {
 
-		MNEMOSY_ASSERT(libEntry != nullptr, "We should make sure to unload all thumbnails first");
+		std::shared_ptr<core::JobGroup> cancelledGroup = m_decodeGroup;
+		if (cancelledGroup) {
+			cancelledGroup->Cancel();
+		}
 
-		glDeleteTextures(1, &libEntry->thumbnailTexure_ID);
-		libEntry->thumbnailLoaded = false;
-		libEntry->thumbnailTexure_ID = 0;
+		m_decodeGroup = core::JobSystem::CreateGroup();
+		m_pendingDecodes.clear();
+
+		return cancelledGroup;
 	}
 
-	void ThumbnailManager::LoadThumbnailForMaterial_Internal(LibEntry* libEntry) {
+	bool ThumbnailManager::UploadThumbnailToAtlas_Internal(LibEntry* libEntry, const uint8_t* pixels, const uint16_t width, const uint16_t height, const uint8_t channels) {
 
-		namespace fs = std::filesystem;
+		if (width != height || width == 0 || width > THUMBNAIL_ATLAS_MAX_TILE_SIZE || (channels != 3 && channels != 4)) {
+			return false;
+		}
 
-		fs::path libPath = MnemosyEngine::GetInstance().GetMaterialLibraryRegistry().ActiveLibCollection_GetFolderPath();
+		int pageIndex = -1;
+		for (int i = 0; i < m_atlasPages.size(); i++) {
 
-		fs::path materialFolderPath = libPath / libEntry->GetPathFromRoot();// libEntry->parent->pathFromRoot / fs::path(libEntry->name);
+			if (m_atlasPages[i].tileSize == width && m_atlasPages[i].usedTilesCount < m_atlasPages[i].usedTiles.size()) {
+				pageIndex = i;
+				break;
+			}
+		}
 
-		fs::path thumbnailPath = materialFolderPath / fs::u8path(libEntry->name + "_thumbnail.ktx2");
+		if (pageIndex == -1) {
 
-		if (fs::exists(thumbnailPath)) {
+			AtlasPage page;
+			page.tileSize = width;
+			page.tilesPerRow = THUMBNAIL_ATLAS_PAGE_SIZE / width;
+			page.usedTiles.resize((size_t)page.tilesPerRow * page.tilesPerRow, false);
 
-			graphics::KtxImage ktxThumbnail;
-			bool success = ktxThumbnail.LoadKtx(thumbnailPath.generic_string().c_str(), libEntry->thumbnailTexure_ID);
-			if (success) {
-				libEntry->thumbnailLoaded = true;
+			glGenTextures(1, &page.textureID);
+			glBindTexture(GL_TEXTURE_2D, page.textureID);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, THUMBNAIL_ATLAS_PAGE_SIZE, THUMBNAIL_ATLAS_PAGE_SIZE);
+
+			m_atlasPages.push_back(std::move(page));
+			pageIndex = (int)m_atlasPages.size() - 1;
+		}
+
+		AtlasPage& page = m_atlasPages[pageIndex];
+
+		uint32_t tile = 0;
+		while (page.usedTiles[tile]) {
+			tile++;
+		}
+
+		page.usedTiles[tile] = true;
+		page.usedTilesCount++;
+
+		int x = (tile % page.tilesPerRow) * page.tileSize;
+		int y = (tile / page.tilesPerRow) * page.tileSize;
+
+		unsigned int internalFormat, format, type;
+		graphics::Texture::GetOpenGlFormat(channels == 4 ? graphics::TextureFormat::MNSY_RGBA8 : graphics::TextureFormat::MNSY_RGB8, false, internalFormat, format, type);
+
+		glBindTexture(GL_TEXTURE_2D, page.textureID);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, format, type, pixels);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		libEntry->thumbnailTexure_ID = page.textureID;
+		libEntry->thumbnailAtlasTile = tile;
+		libEntry->thumbnailLoaded = true;
+
+		m_loadedEntryIDs.insert(libEntry->runtime_ID);
+		return true;
+	}
+
+	// Frees the tiles of the thumbnails that have been off screen the longest, until at most THUMBNAIL_MAX_LOADED_OFFSCREEN remain loaded.
+	// Thumbnails on screen are never unloaded, scrolling back to an unloaded one reads it from the pack again.
+	void ThumbnailManager::EvictOffscreenThumbnails_Internal() {
+
+		if (m_loadedEntryIDs.size() <= THUMBNAIL_MAX_LOADED_OFFSCREEN)
+			return;
+
+		std::vector<std::pair<uint64_t, uint32_t>> candidates; // last visible frame, runtime id
+		candidates.reserve(m_loadedEntryIDs.size());
+
+		for (uint32_t runtimeID : m_loadedEntryIDs) {
+
+			auto it = m_lastVisibleFrame.find(runtimeID);
+			uint64_t lastVisible = it != m_lastVisibleFrame.end() ? it->second : 0;
+
+			if (lastVisible + THUMBNAIL_EVICT_AFTER_FRAMES < m_frameIndex) {
+				candidates.push_back({ lastVisible, runtimeID });
+			}
+		}
+
+		size_t evictCount = m_loadedEntryIDs.size() - THUMBNAIL_MAX_LOADED_OFFSCREEN;
+		if (evictCount > candidates.size()) {
+			evictCount = candidates.size();
+		}
+
+		std::partial_sort(candidates.begin(), candidates.begin() + evictCount, candidates.end());
+
+		for (size_t i = 0; i < evictCount; i++) {
+
+			auto it = m_activeEntriesByID.find(candidates[i].second);
+			if (it != m_activeEntriesByID.end()) {
+				DeleteThumbnailGLTexture_Internal(it->second);
 			}
 			else {
-				MNEMOSY_WARN("Failed to load thumbnail for material: {}", libEntry->name);
-				glDeleteTextures(1, &libEntry->thumbnailTexure_ID);
-				return;
+				m_loadedEntryIDs.erase(candidates[i].second);
 			}
 		}
-		else {
-			MNEMOSY_WARN("Failed to load thumbnail, Generating new: {}",  thumbnailPath.generic_string());
+	}
+
+	void ThumbnailManager::DeleteEmptyAtlasPages_Internal() {
+
+		for (int i = (int)m_atlasPages.size() - 1; i >= 0; i--) {
+
+			if (m_atlasPages[i].usedTilesCount == 0) {
+
+				glDeleteTextures(1, &m_atlasPages[i].textureID);
+				m_atlasPages.erase(m_atlasPages.begin() + i);
+			}
+		}
+	}
+
+	bool ThumbnailManager::OpenPackOfActiveCollection_Internal() {
+
+		MaterialLibraryRegistry& registry = MnemosyEngine::GetInstance().GetMaterialLibraryRegistry();
+
+		if (!registry.LibCollections_IsAnyActive())
+			return false;
+
+		fs::path collectionFolder = registry.ActiveLibCollection_GetFolderPath();
+		fs::path packPath = collectionFolder / fs::path(THUMBNAIL_PACK_FILENAME);
+
+		if (m_pack.IsOpen() && m_pack.GetPath() == packPath)
+			return true;
+
+		return m_pack.Open(packPath, collectionFolder);
+	}
+
+	// path of the entry relative to the library root, always with forward slashes
+	std::string ThumbnailManager::GetPackKey_Internal(const LibEntry* libEntry) {
+
+		std::string key = libEntry->name;
+
+		FolderNode* node = libEntry->parent;
+		while (node != nullptr && !node->IsRoot()) {
 
-			// this is potentially super slow because we have to load all textures and stuff of the material but should work and generate a new thumbnail
-			RenderThumbnailForAnyLibEntry_Slow_Fallback(libEntry);
+			key = node->name + "/" + key;
+			node = node->parent;
 		}
 
+		return key;
 	}
 
 
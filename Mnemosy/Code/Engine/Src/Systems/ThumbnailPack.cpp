@@ -0,0 +1,302 @@
+#include "Include/Systems/ThumbnailPack.h"
+
+#include "Include/Core/Log.h"
+
+#include <fstream>
+#include <string.h>
+
+// bump the version whenever the layout of the file changes, packs with another version are thrown away and rebuilt
+#define THUMBNAIL_PACK_MAGIC "MNSYTPK1"
+#define THUMBNAIL_PACK_VERSION 1
+// superseded records are only dropped once they waste more than this and more than the live records take up
+#define THUMBNAIL_PACK_COMPACT_MIN_GARBAGE 16777216
+
+namespace mnemosy::systems {
+
+	struct ThumbnailPackHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t reserved;
+	};
+
+	struct ThumbnailPackRecordHeader {
+		uint32_t keyLength;
+		uint16_t width;
+		uint16_t height;
+		uint8_t channels;
+		uint8_t reserved[7];
+		uint64_t stampSize;
+		int64_t stampTime;
+	};
+
+	static_assert(sizeof(ThumbnailPackHeader) == 16, "Thumbnail pack header layout changed");
+	static_assert(sizeof(ThumbnailPackRecordHeader) == 32, "Thumbnail pack record layout changed");
+
+	static bool ThumbnailPack_WriteHeader(std::ofstream& file) {
+
+		ThumbnailPackHeader header;
+		memcpy(header.magic, THUMBNAIL_PACK_MAGIC, sizeof(header.magic));
+		header.version = THUMBNAIL_PACK_VERSION;
+		header.reserved = 0;
+
+		file.write((const char*)&header, sizeof(header));
+		return (bool)file;
+	}
+
+	static bool ThumbnailPack_WriteRecord(std::ofstream& file, const std::string& key, const ThumbnailStamp& stamp, const uint8_t* pixels, const uint16_t width, const uint16_t height, const uint8_t channels) {
+
+		ThumbnailPackRecordHeader header;
+		memset(&header, 0, sizeof(header));
+		header.keyLength = (uint32_t)key.size();
+		header.width = width;
+		header.height = height;
+		header.channels = channels;
+		header.stampSize = stamp.size;
+		header.stampTime = stamp.time;
+
+		file.write((const char*)&header, sizeof(header));
+		file.write(key.data(), key.size());
+		file.write((const char*)pixels, (size_t)width * height * channels);
+		return (bool)file;
+	}
+
+	bool ThumbnailPack::Open(const std::filesystem::path& filepath, const std::filesystem::path& thumbnailsRoot) {
+
+		namespace fs = std::filesystem;
+
+		Close();
+
+		m_path = filepath;
+		m_thumbnailsRoot = thumbnailsRoot;
+
+		std::error_code ec;
+		bool exists = fs::exists(m_path, ec);
+
+		if (!exists || !MapAndReadIndex()) {
+
+			if (exists) {
+				MNEMOSY_WARN("ThumbnailPack::Open: Thumbnail pack is outdated or damaged, it will be rebuilt. \nPath: {}", m_path.generic_string());
+			}
+
+			m_file.Close();
+
+			std::ofstream file(m_path, std::ios::binary | std::ios::trunc);
+			if (!file || !ThumbnailPack_WriteHeader(file)) {
+				MNEMOSY_ERROR("ThumbnailPack::Open: Failed to create thumbnail pack \nPath: {}", m_path.generic_string());
+				return false;
+			}
+			file.close();
+
+			if (!MapAndReadIndex()) {
+				m_file.Close();
+				return false;
+			}
+		}
+
+		size_t garbageBytes = m_validBytes - sizeof(ThumbnailPackHeader) - m_liveBytes;
+		bool hasDamagedTail = m_validBytes < m_file.GetSize();
+
+		if (hasDamagedTail || (garbageBytes > THUMBNAIL_PACK_COMPACT_MIN_GARBAGE && garbageBytes > m_liveBytes)) {
+			Rewrite();
+		}
+
+		return m_file.IsOpen();
+	}
+
+	void ThumbnailPack::Close() {
+
+		m_file.Close();
+		m_records.clear();
+		m_liveBytes = 0;
+		m_validBytes = 0;
+		m_hasUnmappedRecords = false;
+	}
+
+	const uint8_t* ThumbnailPack::Find(const std::string& key, const ThumbnailStamp& stamp, uint16_t& outWidth, uint16_t& outHeight, uint8_t& outChannels) {
+
+		auto it = m_records.find(key);
+		if (it == m_records.end())
+			return nullptr;
+
+		const Record& record = it->second;
+		if (record.stamp.size != stamp.size || record.stamp.time != stamp.time)
+			return nullptr;
+
+		outWidth = record.width;
+		outHeight = record.height;
+		outChannels = record.channels;
+		return m_file.GetData() + record.dataOffset;
+	}
+
+	bool ThumbnailPack::Append(const std::string& key, const ThumbnailStamp& stamp, const uint8_t* pixels, const uint16_t width, const uint16_t height, const uint8_t channels) {
+
+		if (!IsOpen())
+			return false;
+
+		std::ofstream file(m_path, std::ios::binary | std::ios::app);
+		if (!file || !ThumbnailPack_WriteRecord(file, key, stamp, pixels, width, height, channels)) {
+			MNEMOSY_ERROR("ThumbnailPack::Append: Failed to write thumbnail of {} \nPath: {}", key, m_path.generic_string());
+			return false;
+		}
+
+		m_hasUnmappedRecords = true;
+		return true;
+	}
+
+	void ThumbnailPack::Remap() {
+
+		m_hasUnmappedRecords = false;
+
+		// records up to m_validBytes are already indexed and the file is append only
+		size_t readFrom = m_validBytes;
+
+		m_file.Close();
+
+		if (readFrom < sizeof(ThumbnailPackHeader) || !m_file.Open(m_path) || m_file.GetData() == nullptr || m_file.GetSize() < readFrom) {
+			// the file was replaced or never read, index everything again
+			m_file.Close();
+			MapAndReadIndex();
+			return;
+		}
+
+		ReadRecords(readFrom);
+	}
+
+	bool ThumbnailPack::GetStamp(const std::filesystem::path& thumbnailPath, ThumbnailStamp& outStamp) {
+
+		namespace fs = std::filesystem;
+
+		std::error_code ec;
+		uintmax_t size = fs::file_size(thumbnailPath, ec);
+		if (ec)
+			return false;
+
+		fs::file_time_type time = fs::last_write_time(thumbnailPath, ec);
+		if (ec)
+			return false;
+
+		outStamp.size = (uint64_t)size;
+		outStamp.time = (int64_t)time.time_since_epoch().count();
+		return true;
+	}
+
+	// private
+
+	// Maps the file and walks the record headers. Only the headers are touched, the pixel pages are read once they are uploaded.
+	bool ThumbnailPack::MapAndReadIndex() {
+
+		m_records.clear();
+		m_liveBytes = 0;
+		m_validBytes = 0;
+
+		if (!m_file.Open(m_path))
+			return false;
+
+		const uint8_t* data = m_file.GetData();
+		size_t size = m_file.GetSize();
+
+		if (data == nullptr || size < sizeof(ThumbnailPackHeader))
+			return false;
+
+		ThumbnailPackHeader header;
+		memcpy(&header, data, sizeof(header));
+		if (memcmp(header.magic, THUMBNAIL_PACK_MAGIC, sizeof(header.magic)) != 0 || header.version != THUMBNAIL_PACK_VERSION)
+			return false;
+
+		ReadRecords(sizeof(ThumbnailPackHeader));
+		return true;
+	}
+
+	void ThumbnailPack::ReadRecords(size_t offset) {
+
+		const uint8_t* data = m_file.GetData();
+		size_t size = m_file.GetSize();
+
+		while (offset + sizeof(ThumbnailPackRecordHeader) <= size) {
+
+			ThumbnailPackRecordHeader recordHeader;
+			memcpy(&recordHeader, data + offset, sizeof(recordHeader));
+
+			size_t pixelBytes = (size_t)recordHeader.width * recordHeader.height * recordHeader.channels;
+			size_t recordSize = sizeof(ThumbnailPackRecordHeader) + recordHeader.keyLength + pixelBytes;
+
+			// a record that was not written completely, everything after it is ignored
+			if (recordSize > size - offset)
+				break;
+
+			std::string key((const char*)data + offset + sizeof(ThumbnailPackRecordHeader), recordHeader.keyLength);
+
+			Record record;
+			record.stamp.size = recordHeader.stampSize;
+			record.stamp.time = recordHeader.stampTime;
+			record.dataOffset = offset + sizeof(ThumbnailPackRecordHeader) + recordHeader.keyLength;
+			record.width = recordHeader.width;
+			record.height = recordHeader.height;
+			record.channels = recordHeader.channels;
+
+			auto it = m_records.find(key);
+			if (it != m_records.end()) {
+				m_liveBytes -= sizeof(ThumbnailPackRecordHeader) + it->first.size() + (size_t)it->second.width * it->second.height * it->second.channels;
+				it->second = record;
+			}
+			else {
+				m_records.emplace(std::move(key), record);
+			}
+
+			m_liveBytes += recordSize;
+			offset += recordSize;
+		}
+
+		m_validBytes = offset;
+	}
+
+	// Writes the newest record of every entry that still has a thumbnail file into a new pack and swaps it in.
+	void ThumbnailPack::Rewrite() {
+
+		namespace fs = std::filesystem;
+
+		fs::path tmpPath = m_path;
+		tmpPath += ".tmp";
+
+		std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+		bool success = file && ThumbnailPack_WriteHeader(file);
+
+		size_t droppedRecords = 0;
+
+		for (auto& [key, record] : m_records) {
+
+			if (!success)
+				break;
+
+			std::string entryName = key.substr(key.find_last_of('/') + 1);
+			fs::path thumbnailPath = m_thumbnailsRoot / fs::u8path(key) / fs::u8path(entryName + "_thumbnail.ktx2");
+
+			std::error_code ec;
+			if (!fs::exists(thumbnailPath, ec)) {
+				droppedRecords++;
+				continue;
+			}
+
+			success = ThumbnailPack_WriteRecord(file, key, record.stamp, m_file.GetData() + record.dataOffset, record.width, record.height, record.channels);
+		}
+
+		file.close();
+		m_file.Close();
+
+		std::error_code ec;
+		if (success) {
+			fs::rename(tmpPath, m_path, ec);
+		}
+
+		if (!success || ec) {
+			MNEMOSY_ERROR("ThumbnailPack::Rewrite: Failed to rewrite thumbnail pack \nPath: {}", m_path.generic_string());
+			fs::remove(tmpPath, ec);
+		}
+		else {
+			MNEMOSY_TRACE("ThumbnailPack: Rewrote thumbnail pack, dropped {} records of removed entries", droppedRecords);
+		}
+
+		MapAndReadIndex();
+	}
+
+} // !mnemosy::systems
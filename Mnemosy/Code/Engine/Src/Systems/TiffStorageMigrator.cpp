@@ -0,0 +1,270 @@
+#include "Include/Systems/TiffStorageMigrator.h"
+
+#include "Include/MnemosyEngine.h"
+#include "Include/Core/Log.h"
+#include "Include/Core/JobSystem.h"
+#include "Include/Systems/FolderTreeNode.h"
+#include "Include/Systems/LibraryProcedures.h"
+#include "Include/Graphics/TextureDefinitions.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+namespace mnemosy::systems {
+
+	void TiffStorageMigrator::Shutdown() {
+
+		Cancel();
+
+		// jobs reference this object
+		if (m_jobs) {
+			MnemosyEngine::GetInstance().GetJobSystem().Wait(m_jobs);
+			m_jobs = nullptr;
+		}
+
+		m_entryFolders.clear();
+
+		std::lock_guard<std::mutex> lock(m_rewrittenMutex);
+		m_rewrittenTextures.clear();
+	}
+
+	void TiffStorageMigrator::Start(FolderNode* node) {
+
+		MNEMOSY_ASSERT(node != nullptr, "Migration needs a folder to start from");
+
+		if (IsRunning()) {
+			MNEMOSY_WARN("Textures are already being recompressed");
+			return;
+		}
+
+		// paths are resolved here, the jobs must not touch the folder tree
+		m_entryFolders.clear();
+		CollectEntries_Internal(node);
+
+		m_compression = graphics::Picture::GetTiffCompression();
+		m_finishedCount = 0;
+		m_failedCount = 0;
+		m_processedCount = 0;
+		m_cancelled = false;
+		m_bytesBefore = 0;
+		m_bytesAfter = 0;
+		m_jobs = core::JobSystem::CreateGroup();
+
+		{
+			std::lock_guard<std::mutex> lock(m_rewrittenMutex);
+			m_rewrittenTextures.clear();
+		}
+
+		MNEMOSY_INFO("Recompressing textures of {} entries", m_entryFolders.size());
+
+		core::JobSystem& jobSystem = MnemosyEngine::GetInstance().GetJobSystem();
+
+		for (const std::filesystem::path& entryFolder : m_entryFolders) {
+			jobSystem.Submit(m_jobs, [this, entryFolder]() { MigrateEntry_Internal(entryFolder); }, core::MNSY_JOB_PRIORITY_LOW);
+		}
+	}
+
+	void TiffStorageMigrator::Cancel() {
+
+		if (!IsRunning())
+			return;
+
+		// not cancelling the group itself, the job system would drop queued jobs without running them
+		// and the last one to return would never report the result
+		m_cancelled = true;
+
+		MNEMOSY_INFO("Recompressing textures cancelled");
+	}
+
+	bool TiffStorageMigrator::IsRunning() const {
+		return m_jobs && !m_jobs->IsDone();
+	}
+
+	bool TiffStorageMigrator::WasRewrittenByMigration(const std::filesystem::path& path) {
+
+		namespace fs = std::filesystem;
+
+		std::lock_guard<std::mutex> lock(m_rewrittenMutex);
+
+		if (m_rewrittenTextures.empty())
+			return false;
+
+		auto it = m_rewrittenTextures.find(path.lexically_normal().native());
+		if (it == m_rewrittenTextures.end())
+			return false;
+
+		// written again since, e.g. by an image editor
+		std::error_code ec;
+		fs::file_time_type writeTime = fs::last_write_time(path, ec);
+		return !ec && writeTime == it->second;
+	}
+
+	void TiffStorageMigrator::MigrateEntry_Internal(const std::filesystem::path& entryFolder) {
+
+		namespace fs = std::filesystem;
+
+		bool failed = false;
+		bool skipped = m_cancelled;
+
+		if (!skipped) {
+
+			std::error_code ec;
+			for (const fs::directory_entry& file : fs::directory_iterator(entryFolder, ec)) {
+
+				if (m_cancelled) {
+					skipped = true;
+					break;
+				}
+
+				if (!file.is_regular_file() || file.path().extension() != ".tif")
+					continue;
+
+				if (!MigrateTexture_Internal(file.path())) {
+					failed = true;
+				}
+			}
+
+			if (ec) {
+				MNEMOSY_WARN("TiffStorageMigrator: Failed to list entry folder {} \nPath: {}", ec.message(), entryFolder.generic_string());
+				failed = true;
+			}
+		}
+
+		if (failed)
+			m_failedCount++;
+		else if (!skipped)
+			m_finishedCount++;
+
+		// the last entry reports the result
+		if (++m_processedCount == (uint32_t)m_entryFolders.size()) {
+			Finish_Internal();
+		}
+	}
+
+	// Returns false only if the texture should have been rewritten but could not be. The original is never touched in that case.
+	bool TiffStorageMigrator::MigrateTexture_Internal(const std::filesystem::path& texturePath) {
+
+		namespace fs = std::filesystem;
+
+		std::string pathStr = texturePath.generic_string();
+
+		graphics::TiffCompression fileCompression = graphics::Picture::ReadTiffCompression(pathStr.c_str());
+		if (fileCompression == m_compression)
+			return true;
+
+		std::error_code ec;
+		uintmax_t sizeBefore = fs::file_size(texturePath, ec);
+		fs::file_time_type timeBefore = fs::last_write_time(texturePath, ec);
+		if (ec) {
+			MNEMOSY_WARN("TiffStorageMigrator: Failed to query file {} \nPath: {}", ec.message(), pathStr);
+			return false;
+		}
+
+		// identifies the version the mip chain caches of the texture were built from
+		std::string stampBefore = LibProcedures::PbrMaterial_GetTextureSourceStamp(texturePath);
+
+		graphics::PictureError picErr;
+		graphics::PictureInfo picInfo = graphics::Picture::ReadTiff(picErr, pathStr.c_str(), false, false);
+		if (!picErr.wasSuccessfull) {
+			MNEMOSY_WARN("TiffStorageMigrator: Failed to read texture: {} \nPath: {}", picErr.what, pathStr);
+			return false;
+		}
+
+		// e.g. bottom to top rows or an unusual sample format, writing them again would change how they are read. The compression differs anyway.
+		if (!graphics::Picture::TiffMatchesFormat(pathStr.c_str(), picInfo.textureFormat, graphics::MNSY_TIFF_COMPRESSION_COUNT)) {
+			free(picInfo.pixels);
+			return true;
+		}
+
+		fs::path tmpPath = texturePath;
+		tmpPath += ".tmp";
+		std::string tmpPathStr = tmpPath.generic_string();
+
+		graphics::Picture::WriteTiff(picErr, tmpPathStr.c_str(), picInfo, false);
+
+		// the new file has to decode to exactly the same samples
+		bool verified = false;
+		if (picErr.wasSuccessfull) {
+
+			graphics::PictureInfo checkInfo = graphics::Picture::ReadTiff(picErr, tmpPathStr.c_str(), false, false);
+			if (picErr.wasSuccessfull) {
+
+				uint8_t channels, bitsPerChannel, bytesPerPixel;
+				graphics::TexUtil::get_information_from_textureFormat(picInfo.textureFormat, channels, bitsPerChannel, bytesPerPixel);
+				size_t size = (size_t)picInfo.width * picInfo.height * bytesPerPixel;
+
+				verified = checkInfo.width == picInfo.width && checkInfo.height == picInfo.height && checkInfo.textureFormat == picInfo.textureFormat
+					&& memcmp(checkInfo.pixels, picInfo.pixels, size) == 0;
+
+				free(checkInfo.pixels);
+			}
+		}
+
+		free(picInfo.pixels);
+
+		if (!verified) {
+			MNEMOSY_WARN("TiffStorageMigrator: Recompressed texture does not match the original, keeping the original. {} \nPath: {}", picErr.what, pathStr);
+			fs::remove(tmpPath, ec);
+			return false;
+		}
+
+		// the library may have written the texture while we were working on it, the new version is kept
+		std::error_code sizeEc;
+		std::error_code timeEc;
+		bool unchanged = fs::file_size(texturePath, sizeEc) == sizeBefore && fs::last_write_time(texturePath, timeEc) == timeBefore && !sizeEc && !timeEc;
+		if (!unchanged) {
+			fs::remove(tmpPath, ec);
+			return true;
+		}
+
+		uintmax_t sizeAfter = fs::file_size(tmpPath, ec);
+
+		// recorded before the rename so the watcher event of it can't arrive first, the rename keeps the write time of the temporary file
+		fs::path::string_type normalizedPath = texturePath.lexically_normal().native();
+		fs::file_time_type timeAfter = fs::last_write_time(tmpPath, ec);
+		if (!ec) {
+			std::lock_guard<std::mutex> lock(m_rewrittenMutex);
+			m_rewrittenTextures[normalizedPath] = timeAfter;
+		}
+
+		fs::rename(tmpPath, texturePath, ec);
+		if (ec) {
+			MNEMOSY_WARN("TiffStorageMigrator: Failed to replace texture: {} \nPath: {}", ec.message(), pathStr);
+			fs::remove(tmpPath, ec);
+
+			std::lock_guard<std::mutex> lock(m_rewrittenMutex);
+			m_rewrittenTextures.erase(normalizedPath);
+			return false;
+		}
+
+		m_bytesBefore += (uint64_t)sizeBefore;
+		m_bytesAfter += (uint64_t)sizeAfter;
+
+		// the pixels were verified to be the same, the caches built from the old file are still valid for the new one
+		std::string stampAfter = LibProcedures::PbrMaterial_GetTextureSourceStamp(texturePath);
+		LibProcedures::PbrMaterial_RestampTextureCaches(texturePath.parent_path(), stampBefore, stampAfter);
+
+		return true;
+	}
+
+	void TiffStorageMigrator::CollectEntries_Internal(FolderNode* node) {
+
+		for (LibEntry* libEntry : node->subEntries) {
+			m_entryFolders.push_back(LibProcedures::LibEntry_GetFolderPath(libEntry));
+		}
+
+		for (FolderNode* subNode : node->subNodes) {
+			CollectEntries_Internal(subNode);
+		}
+	}
+
+	void TiffStorageMigrator::Finish_Internal() {
+
+		double mbBefore = (double)m_bytesBefore / (1024.0 * 1024.0);
+		double mbAfter = (double)m_bytesAfter / (1024.0 * 1024.0);
+
+		MNEMOSY_INFO("Recompressed textures of {} of {} entries, {} failed{}. Rewritten textures went from {:.1f} MB to {:.1f} MB",
+			(uint32_t)m_finishedCount, m_entryFolders.size(), (uint32_t)m_failedCount, m_cancelled ? ", cancelled" : "", mbBefore, mbAfter);
+	}
+
+} // !mnemosy::systems
@@ -17,6 +17,8 @@ ${ENGINE_SOURCE_PATH}/Include/Core/Clock.h
 ${ENGINE_SOURCE_PATH}/Src/Core/Clock.cpp
 ${ENGINE_SOURCE_PATH}/Include/Core/FileDirectories.h
 ${ENGINE_SOURCE_PATH}/Src/Core/FileDirectories.cpp
+${ENGINE_SOURCE_PATH}/Include/Core/JobSystem.h
+${ENGINE_SOURCE_PATH}/Src/Core/JobSystem.cpp
 
 ${ENGINE_SOURCE_PATH}/Include/Core/flcrm_arena_alloc.h
 ${ENGINE_SOURCE_PATH}/Src/Core/flcrm_arena_alloc.cpp
@@ -32,12 +34,26 @@ ${ENGINE_SOURCE_PATH}/Include/Systems/FolderTreeNode.h
 ${ENGINE_SOURCE_PATH}/Src/Systems/FolderTreeNode.cpp
 ${ENGINE_SOURCE_PATH}/Include/Systems/FolderTree.h
 ${ENGINE_SOURCE_PATH}/Src/Systems/FolderTree.cpp
+${ENGINE_SOURCE_PATH}/Include/Systems/SearchIndex.h
+${ENGINE_SOURCE_PATH}/Src/Systems/SearchIndex.cpp
+${ENGINE_SOURCE_PATH}/Include/Systems/LibraryJournal.h
+${ENGINE_SOURCE_PATH}/Src/Systems/LibraryJournal.cpp
+${ENGINE_SOURCE_PATH}/Include/Systems/LibraryIndex.h
+${ENGINE_SOURCE_PATH}/Src/Systems/LibraryIndex.cpp
+${ENGINE_SOURCE_PATH}/Include/Systems/LibraryFileCache.h
+${ENGINE_SOURCE_PATH}/Src/Systems/LibraryFileCache.cpp
 ${ENGINE_SOURCE_PATH}/Include/Systems/ThumbnailManager.h
 ${ENGINE_SOURCE_PATH}/Src/Systems/ThumbnailManager.cpp
+${ENGINE_SOURCE_PATH}/Include/Systems/ThumbnailPack.h
+${ENGINE_SOURCE_PATH}/Src/Systems/ThumbnailPack.cpp
+${ENGINE_SOURCE_PATH}/Include/Systems/ThumbnailBatchRegenerator.h
+${ENGINE_SOURCE_PATH}/Src/Systems/ThumbnailBatchRegenerator.cpp
 ${ENGINE_SOURCE_PATH}/Include/Systems/TextureGenerationManager.h
 ${ENGINE_SOURCE_PATH}/Src/Systems/TextureGenerationManager.cpp
 ${ENGINE_SOURCE_PATH}/Include/Systems/ExportManager.h
 ${ENGINE_SOURCE_PATH}/Src/Systems/ExportManager.cpp
+${ENGINE_SOURCE_PATH}/Include/Systems/TiffStorageMigrator.h
+${ENGINE_SOURCE_PATH}/Src/Systems/TiffStorageMigrator.cpp
 ${ENGINE_SOURCE_PATH}/Include/Systems/JsonKeys.h
 ${ENGINE_SOURCE_PATH}/Include/Systems/MeshRegistry.h
 ${ENGINE_SOURCE_PATH}/Src/Systems/MeshRegistry.cpp
@@ -54,6 +70,13 @@ ${ENGINE_SOURCE_PATH}/Include/Core/Utils/DropHandler_Windows.h
 ${ENGINE_SOURCE_PATH}/Src/Core/Utils/DropHandler_Windows.cpp
 ${ENGINE_SOURCE_PATH}/Include/Core/Utils/FileWatcher.h
 ${ENGINE_SOURCE_PATH}/Src/Core/Utils/FileWatcher.cpp
+${ENGINE_SOURCE_PATH}/Include/Core/Utils/MappedFile.h
+${ENGINE_SOURCE_PATH}/Src/Core/Utils/MappedFile.cpp
+${ENGINE_SOURCE_PATH}/Include/Core/Utils/MpscQueue.h
+${ENGINE_SOURCE_PATH}/Include/Core/Utils/SlotMap.h
+${ENGINE_SOURCE_PATH}/Include/Core/Utils/PoolAllocator.h
+${ENGINE_SOURCE_PATH}/Include/Core/Utils/StringPool.h
+${ENGINE_SOURCE_PATH}/Src/Core/Utils/StringPool.cpp
 ${ENGINE_SOURCE_PATH}/Include/Core/Utils/StringUtils.h
 
 # Graphics
@@ -64,6 +87,12 @@ ${ENGINE_SOURCE_PATH}/Include/Graphics/Utils/KtxImage.h
 ${ENGINE_SOURCE_PATH}/Src/Graphics/Utils/KtxImage.cpp
 ${ENGINE_SOURCE_PATH}/Include/Graphics/Utils/Picture.h
 ${ENGINE_SOURCE_PATH}/Src/Graphics/Utils/Picture.cpp
+${ENGINE_SOURCE_PATH}/Include/Graphics/Utils/ChannelPacker.h
+${ENGINE_SOURCE_PATH}/Src/Graphics/Utils/ChannelPacker.cpp
+${ENGINE_SOURCE_PATH}/Include/Graphics/Utils/PixelConvert.h
+${ENGINE_SOURCE_PATH}/Src/Graphics/Utils/PixelConvert.cpp
+${ENGINE_SOURCE_PATH}/Include/Graphics/Utils/ShaderBinaryCache.h
+${ENGINE_SOURCE_PATH}/Src/Graphics/Utils/ShaderBinaryCache.cpp
 ${ENGINE_SOURCE_PATH}/Include/Graphics/SceneSettings.h
 
 
@@ -79,6 +108,8 @@ ${ENGINE_SOURCE_PATH}/Src/Graphics/TextureDefinitions.cpp
 
 ${ENGINE_SOURCE_PATH}/Include/Graphics/Texture.h
 ${ENGINE_SOURCE_PATH}/Src/Graphics/Texture.cpp
+${ENGINE_SOURCE_PATH}/Include/Graphics/TextureUploader.h
+${ENGINE_SOURCE_PATH}/Src/Graphics/TextureUploader.cpp
 ${ENGINE_SOURCE_PATH}/Include/Graphics/Material.h
 ${ENGINE_SOURCE_PATH}/Src/Graphics/Material.cpp
 ${ENGINE_SOURCE_PATH}/Include/Graphics/Camera.h
@@ -14,25 +14,25 @@ uniform sampler2D _texture0;
 // loaction 1
 uniform sampler2D _channel_r;
 uniform bool _channel_r_isAssigned;
-uniform bool _channel_r_isSingleChannel;
+uniform int _channel_r_sourceChannel; // channel of the texture the component is read from, same as the cpu packer
 uniform bool _channel_r_invert;
 uniform float _channel_r_defaultValue;
 // loaction 2
 uniform sampler2D _channel_g;
 uniform bool _channel_g_isAssigned;
-uniform bool _channel_g_isSingleChannel;
+uniform int _channel_g_sourceChannel; // channel of the texture the component is read from, same as the cpu packer
 uniform bool _channel_g_invert;
 uniform float _channel_g_defaultValue;
 // loaction 3
 uniform sampler2D _channel_b;
 uniform bool _channel_b_isAssigned;
-uniform bool _channel_b_isSingleChannel;
+uniform int _channel_b_sourceChannel; // channel of the texture the component is read from, same as the cpu packer
 uniform bool _channel_b_invert;
 uniform float _channel_b_defaultValue;
 // loaction 4
 uniform sampler2D _channel_a;
 uniform bool _channel_a_isAssigned;
-uniform bool _channel_a_isSingleChannel;
+uniform int _channel_a_sourceChannel; // channel of the texture the component is read from, same as the cpu packer
 uniform bool _channel_a_invert;
 uniform float _channel_a_defaultValue;
 
@@ -63,7 +63,7 @@ vec4 Mode3_CreateChannelPack() {
   // ===== R - channel =====
   float R = 0.0f;
   if(_channel_r_isAssigned) {
-    R = texture(_channel_r,uv).r;
+    R = texture(_channel_r,uv)[_channel_r_sourceChannel];
   }
   else{
     R = _channel_r_defaultValue;
@@ -78,12 +78,7 @@ vec4 Mode3_CreateChannelPack() {
 
   if(_channel_g_isAssigned) {
 
-    if(_channel_g_isSingleChannel) {
-      G = texture(_channel_g,uv).r;
-    }
-    else {
-      G = texture(_channel_g,uv).g;
-    }
+    G = texture(_channel_g,uv)[_channel_g_sourceChannel];
   }
   else {
     G = _channel_g_defaultValue;
@@ -98,12 +93,7 @@ vec4 Mode3_CreateChannelPack() {
 
   if(_channel_b_isAssigned) {
 
-    if(_channel_b_isSingleChannel) {
-      B = texture(_channel_b,uv).r;
-    }
-    else {
-      B = texture(_channel_b,uv).b;
-    }
+    B = texture(_channel_b,uv)[_channel_b_sourceChannel];
   }
   else {
     B = _channel_b_defaultValue;
@@ -118,12 +108,7 @@ vec4 Mode3_CreateChannelPack() {
 
   if(_channel_a_isAssigned) {
 
-    if(_channel_a_isSingleChannel) {
-      A = texture(_channel_a,uv).r;
-    }
-    else {
-      A = texture(_channel_a,uv).a;
-    }
+    A = texture(_channel_a,uv)[_channel_a_sourceChannel];
   }
   else {
     A = _channel_a_defaultValue;